@@ -4,11 +4,13 @@
 #include "include/susfwk/core.h"
 #include "include/susfwk/thrprocessapi.h"
 #include "include/susfwk/hashtable.h"
+#include "include/susfwk/atom.h"
+#include "include/susfwk/cmap.h"
 #include "include/susfwk/appdata.h"
 
 // Application Data
 typedef struct sus_appdata {
-	SUS_HASHMAP data;		// LPCSTR -> SUS_OBJECT
+	SUS_CMAP	data;		// SUS_ATOM -> SUS_OBJECT (the lookups take no locks)
 	SUS_MUTEX	mutex;		// App mutex
 	LONG_PTR	userData;	// User data for the application
 } SUS_APPDATA, *SUS_LPAPPDATA;
@@ -21,24 +23,26 @@ VOID SUSAPI susAppInit()
 	SUS_PRINTDL("Initializing application data");
 	SUS_ASSERT(!appData.data);
 	appData.mutex = susMutexSetup();
-	appData.data = susNewMap(LPCSTR, SUS_OBJECT);
+	appData.data = susNewCMapEx(sizeof(SUS_ATOM), sizeof(SUS_OBJECT), susDefGetAtomHash, susDefCmpAtomKeys, 0);
 }
 // Install the application data
 SUS_OBJECT SUSAPI susAppSet(_In_ LPCSTR key, _In_ SUS_OBJECT value)
 {
 	SUS_PRINTDL("Application data installation - \"%s\"", key);
 	SUS_ASSERT(appData.data && key);
-	susMutexLock(&appData.mutex);
-	value = *(SUS_OBJECT*)susMapSet(&appData.data, &key, &value);
-	susMutexUnlock(&appData.mutex);
-	return value;
+	SUS_ATOM atom = susAtom(key);
+	if (!atom) return NULL;
+	return susCMapSet(appData.data, &atom, &value) ? value : NULL;
 }
 // Get application data
 SUS_OBJECT SUSAPI susAppGet(_In_ LPCSTR key)
 {
 	SUS_PRINTDL("Getting application data - \"%s\"", key);
 	SUS_ASSERT(appData.data && key);
-	return *(SUS_OBJECT*)susMapGet(appData.data, &key);
+	SUS_ATOM atom = susAtomFind(key);
+	if (!atom) return NULL;
+	SUS_OBJECT value;
+	return susCMapGet(appData.data, &atom, &value) ? value : NULL;
 }
 // Get your information about the app
 VOID SUSAPI susAppSetData(LONG_PTR data) {
@@ -64,7 +68,7 @@ VOID SUSAPI susAppCleanup()
 {
 	SUS_PRINTDL("Clearing application data");
 	SUS_ASSERT(appData.data);
-	susMapDestroy(appData.data);
+	susCMapDestroy(appData.data);
 	susMutexCleanup(&appData.mutex);
 	appData.data = NULL;
 }
@@ -0,0 +1,126 @@
+// atom.c
+//
+#include "coreframe.h"
+#include "include/susfwk/core.h"
+#include "include/susfwk/memory.h"
+#include "include/susfwk/hashtable.h"
+#include "include/susfwk/atom.h"
+
+// -------------------------------------------------------------------
+
+// Atom table
+static struct {
+	SRWLOCK				lock;		// Table lock
+	SUS_ARENA			arena;		// Atom memory
+	SUS_LPATOM_HEADER*	slots;		// Open addressing slots
+	DWORD				capacity;	// Number of slots (power of 2)
+	DWORD				count;		// Number of atoms
+} SUSAtomTable = { .lock = SRWLOCK_INIT };
+
+// Find the atom slot (\return NULL if the table is empty)
+static SUS_LPATOM_HEADER* SUSAPI susAtomTableLookup(_In_reads_(length) LPCSTR string, _In_ DWORD length, _In_ SUS_HASH_T hash)
+{
+	if (!SUSAtomTable.capacity) return NULL;
+	DWORD mask = SUSAtomTable.capacity - 1;
+	for (DWORD i = hash & mask;; i = (i + 1) & mask) {
+		SUS_LPATOM_HEADER* slot = &SUSAtomTable.slots[i];
+		if (!*slot) return slot;
+		if ((*slot)->hash == hash && (*slot)->length == length && sus_memcmp((sus_lpbyte_t)(*slot)->string, (sus_lpbyte_t)string, length)) return slot;
+	}
+}
+// Double the number of slots in the table
+static BOOL SUSAPI susAtomTableGrow()
+{
+	DWORD capacity = SUSAtomTable.capacity ? SUSAtomTable.capacity * 2 : SUS_ATOM_TABLE_INIT_COUNT;
+	SUS_LPATOM_HEADER* slots = sus_zalloc(capacity * sizeof(SUS_LPATOM_HEADER));
+	if (!slots) return FALSE;
+	for (DWORD i = 0; i < SUSAtomTable.capacity; i++) {
+		SUS_LPATOM_HEADER atom = SUSAtomTable.slots[i];
+		if (!atom) continue;
+		DWORD j = atom->hash & (capacity - 1);
+		while (slots[j]) j = (j + 1) & (capacity - 1);
+		slots[j] = atom;
+	}
+	if (SUSAtomTable.slots) sus_free(SUSAtomTable.slots);
+	else SUSAtomTable.arena = susArenaSetup();
+	SUSAtomTable.slots = slots;
+	SUSAtomTable.capacity = capacity;
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Intern a string of the specified length
+SUS_ATOM SUSAPI susAtomEx(_In_reads_(length) LPCSTR string, _In_ DWORD length)
+{
+	SUS_ASSERT(string);
+	SUS_HASH_T hash = susDefGetHash((SUS_DATAVIEW) { .data = (LPBYTE)string, .size = length * sizeof(CHAR) });
+	AcquireSRWLockShared(&SUSAtomTable.lock);
+	SUS_LPATOM_HEADER* slot = susAtomTableLookup(string, length, hash);
+	SUS_LPATOM_HEADER atom = slot ? *slot : NULL;
+	ReleaseSRWLockShared(&SUSAtomTable.lock);
+	if (atom) return atom->string;
+	AcquireSRWLockExclusive(&SUSAtomTable.lock);
+	if ((SUSAtomTable.count + 1) * 4 > SUSAtomTable.capacity * 3 && !susAtomTableGrow()) {
+		ReleaseSRWLockExclusive(&SUSAtomTable.lock);
+		SUS_PRINTDE("Couldn't intern the string");
+		return NULL;
+	}
+	slot = susAtomTableLookup(string, length, hash);
+	if (!*slot) {
+		atom = susArenaAlloc(&SUSAtomTable.arena, sizeof(SUS_ATOM_HEADER) + (length + 1) * sizeof(CHAR));
+		if (!atom) {
+			ReleaseSRWLockExclusive(&SUSAtomTable.lock);
+			SUS_PRINTDE("Couldn't intern the string");
+			return NULL;
+		}
+		atom->hash = hash;
+		atom->length = length;
+		sus_memcpy((sus_lpbyte_t)atom->string, (sus_lpbyte_t)string, length * sizeof(CHAR));
+		atom->string[length] = '\0';
+		*slot = atom;
+		SUSAtomTable.count++;
+	}
+	atom = *slot;
+	ReleaseSRWLockExclusive(&SUSAtomTable.lock);
+	return atom->string;
+}
+// Find an interned string of the specified length
+SUS_ATOM SUSAPI susAtomFindEx(_In_reads_(length) LPCSTR string, _In_ DWORD length)
+{
+	SUS_ASSERT(string);
+	SUS_HASH_T hash = susDefGetHash((SUS_DATAVIEW) { .data = (LPBYTE)string, .size = length * sizeof(CHAR) });
+	AcquireSRWLockShared(&SUSAtomTable.lock);
+	SUS_LPATOM_HEADER* slot = susAtomTableLookup(string, length, hash);
+	SUS_LPATOM_HEADER atom = slot ? *slot : NULL;
+	ReleaseSRWLockShared(&SUSAtomTable.lock);
+	return atom ? atom->string : NULL;
+}
+// Free all atoms
+VOID SUSAPI susAtomCleanup()
+{
+	SUS_PRINTDL("Clearing the atom table");
+	AcquireSRWLockExclusive(&SUSAtomTable.lock);
+	if (SUSAtomTable.slots) {
+		sus_free(SUSAtomTable.slots);
+		susArenaCleanup(&SUSAtomTable.arena);
+	}
+	SUSAtomTable.slots = NULL;
+	SUSAtomTable.capacity = 0;
+	SUSAtomTable.count = 0;
+	ReleaseSRWLockExclusive(&SUSAtomTable.lock);
+}
+
+// -------------------------------------------------------------------
+
+// Get a hash by the atom key
+SUS_HASH_T SUSAPI susDefGetAtomHash(_In_ SUS_DATAVIEW key) {
+	SUS_ASSERT(key.data && key.size == sizeof(SUS_ATOM));
+	return susAtomHash(*(SUS_ATOM*)key.data);
+}
+// Atom key comparison
+BOOL SUSAPI susDefCmpAtomKeys(_In_ SUS_OBJECT key1, _In_ SUS_OBJECT key2, _In_ SIZE_T size) {
+	SUS_ASSERT(key1 && key2 && size == sizeof(SUS_ATOM));
+	UNREFERENCED_PARAMETER(size);
+	return *(SUS_ATOM*)key1 == *(SUS_ATOM*)key2;
+}
@@ -0,0 +1,158 @@
+// bench.h
+//
+#ifndef _SUS_BENCH_
+#define _SUS_BENCH_
+
+/*
+* Benchmarks of the containers.
+* Every benchmark checks the results of the operations it measures, so the run
+* also works as a smoke test: the exit code of the process is the number of the failed benchmarks.
+* The command line selects the benchmarks by the prefix of the name:
+*	SUSBench.exe				- run all the benchmarks
+*	SUSBench.exe list vector	- run the benchmarks whose names start with "list" or "vector"
+* The numbers are meaningful only in the Release configuration.
+*/
+
+// =======================================================================================
+
+// -------------------------------------------------------------------
+
+// Benchmark function (\return FALSE if a check has failed)
+typedef BOOL(SUSAPI* SUS_BENCH_FUNC)();
+// Benchmark
+typedef struct sus_bench {
+	LPCSTR			name;	// Name of the benchmark
+	SUS_BENCH_FUNC	func;	// Benchmark function
+} SUS_BENCH;
+
+// The results are written here so that the compiler does not throw away the measured work
+extern volatile SIZE_T susBenchSink;
+
+// -------------------------------------------------------------------
+
+// Get the current value of the performance counter
+SUS_INLINE sus_u64_t SUSAPI susBenchNow() {
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (sus_u64_t)counter.QuadPart;
+}
+// Get the nanoseconds passed since the counter value
+SUS_INLINE sus_u64_t SUSAPI susBenchElapsed(_In_ sus_u64_t start) {
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	sus_u64_t ticks = susBenchNow() - start, hz = (sus_u64_t)frequency.QuadPart;
+	return ticks / hz * 1000000000ull + ticks % hz * 1000000000ull / hz;
+}
+// Get the next pseudo-random number (xorshift64, the state must not be 0)
+SUS_INLINE sus_u64_t SUSAPI susBenchRandom(_Inout_ sus_u64_t* state) {
+	sus_u64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+// Print the time of an operation (ns - total time, ops - number of the operations)
+VOID SUSAPI susBenchReport(_In_ LPCSTR name, _In_ sus_u64_t ns, _In_ sus_u64_t ops);
+
+// Print the percentiles of the operation times (samples - times of the operations in nanoseconds as sus_u64_t, they are sorted)
+BOOL SUSAPI susBenchReportPercentiles(_In_ LPCSTR name, _Inout_ SUS_VECTOR samples);
+
+// Stop the benchmark if the condition is false
+#define SUS_BENCH_CHECK(expr) do { if (!(expr)) { sus_printfA("\tcheck failed: %s (%s:%d)\n", #expr, __FILE__, __LINE__); return FALSE; } } while (0)
+
+// -------------------------------------------------------------------
+
+// =======================================================================================
+
+// -------------------------------------------------------------------
+//							bench_list.c
+// -------------------------------------------------------------------
+
+// Churn of the list nodes in the heap and in the node pool
+BOOL SUSAPI susBenchListChurn();
+
+// -------------------------------------------------------------------
+//							bench_buffer.c
+// -------------------------------------------------------------------
+
+// Stream of the small messages read by susBufferConsume and by susBufferShift
+BOOL SUSAPI susBenchBufferMessages();
+// The positional insertion after a consumption keeps the storage positions
+BOOL SUSAPI susBenchBufferConsumeInsert();
+
+// -------------------------------------------------------------------
+//							bench_cmap.c
+// -------------------------------------------------------------------
+
+// Read-mostly operations of the threads (5% of the writes)
+BOOL SUSAPI susBenchCMapReadMostly();
+// Write-heavy operations of the threads (50% of the writes)
+BOOL SUSAPI susBenchCMapWriteHeavy();
+
+// -------------------------------------------------------------------
+//							bench_deque.c
+// -------------------------------------------------------------------
+
+// Pass the elements through a FIFO queue of the deque and of the vector with 16 to 64K waiting elements
+BOOL SUSAPI susBenchDequeQueue();
+
+// -------------------------------------------------------------------
+//							bench_fileio.c
+// -------------------------------------------------------------------
+
+// Reads and writes of the sparse temporary files beyond 4 GB
+BOOL SUSAPI susBenchFileioLargeFiles();
+
+// -------------------------------------------------------------------
+//							bench_growth.c
+// -------------------------------------------------------------------
+
+// Churn of the vectors with every growth policy
+BOOL SUSAPI susBenchGrowthChurn();
+
+// -------------------------------------------------------------------
+//							bench_map.c
+// -------------------------------------------------------------------
+
+// Operations of 1M integer and string keys with the default and the seeded hashing
+BOOL SUSAPI susBenchMapKeys();
+// Latency percentiles of the insertions with the incremental and the full rehash and of the susMapStep calls
+BOOL SUSAPI susBenchMapRehash();
+// Quality of susHash64: the wyhash reference vectors, the bucket distribution of the sequential integers and the throughput
+BOOL SUSAPI susBenchMapHash();
+// Resize and lookups of the long string keys with the shared prefix, the stored hashes against hashing the keys again
+BOOL SUSAPI susBenchMapLongKeys();
+// Single against batch lookups in a table larger than the last level cache, in the middle of the rehash and after it
+BOOL SUSAPI susBenchMapBatch();
+
+// -------------------------------------------------------------------
+//							bench_memory.c
+// -------------------------------------------------------------------
+
+// Copy, initialization and comparison of the blocks from 1 byte to 64 MB
+BOOL SUSAPI susBenchMemoryBlocks();
+// Search of the last element of 1 to 16 bytes in the arrays of 10K to 10M elements
+BOOL SUSAPI susBenchMemoryFind();
+// The blocks freed by a thread that never allocates return to the shared depot at its exit
+BOOL SUSAPI susBenchMemoryRemoteFree();
+
+// -------------------------------------------------------------------
+//							bench_sort.c
+// -------------------------------------------------------------------
+
+// Sorting of 1M random numbers by the generic, typed, radix and stable sorts
+BOOL SUSAPI susBenchSortNumbers();
+// Binary search in a sorted array against the linear scans from 16 to 1M elements
+BOOL SUSAPI susBenchSortSearch();
+
+// -------------------------------------------------------------------
+//							bench_tree.c
+// -------------------------------------------------------------------
+
+// The ordered map against the hash table sorted on demand: the point lookups, the ordered scan and the range queries
+BOOL SUSAPI susBenchTreeOrdered();
+
+// -------------------------------------------------------------------
+
+#endif /* !_SUS_BENCH_ */
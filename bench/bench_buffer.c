@@ -0,0 +1,96 @@
+// bench_buffer.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Number of the messages passed through the stream
+#define SUS_BENCH_BUFFER_MESSAGES 4000000
+// Number of the messages waiting in the stream with the backlog
+#define SUS_BENCH_BUFFER_BACKLOG 1024
+
+// Write a message: the sus_u32_t length and the payload filled with the low byte of the sequence number
+static BOOL SUSAPI susBenchBufferWrite(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_u32_t seq) {
+	sus_u32_t length = 8 + (seq * 2654435761u >> 26);
+	sus_lpbyte_t message = susBufferPrepare(lpBuffer, sizeof(sus_u32_t) + length);
+	if (!message) return FALSE;
+	*(sus_u32_t*)message = length;
+	sus_memset(message + sizeof(sus_u32_t), (BYTE)seq, length);
+	susBufferCommit(*lpBuffer, sizeof(sus_u32_t) + length);
+	return TRUE;
+}
+// Read the front message and check it (consume - move the read offset instead of erasing the bytes)
+static BOOL SUSAPI susBenchBufferRead(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_u32_t seq, _In_ BOOL consume) {
+	SUS_DATAVIEW view = susBufferPeek(*lpBuffer);
+	if (view.size < sizeof(sus_u32_t)) return FALSE;
+	sus_u32_t length = *(sus_u32_t*)view.data;
+	if (view.size < sizeof(sus_u32_t) + length || (BYTE)view.data[sizeof(sus_u32_t) + length - 1] != (BYTE)seq) return FALSE;
+	if (consume) susBufferConsume(*lpBuffer, sizeof(sus_u32_t) + length);
+	else return susBufferShift(lpBuffer, sizeof(sus_u32_t) + length);
+	return TRUE;
+}
+
+// Pass the messages through the stream (backlog - number of the waiting messages)
+static BOOL SUSAPI susBenchBufferRun(_In_ LPCSTR name, _In_ sus_u32_t backlog, _In_ BOOL consume) {
+	SUS_BUFFER buffer = susNewBuffer(0);
+	SUS_BENCH_CHECK(buffer);
+	sus_u32_t written = 0, read = 0, messages = consume || !backlog ? SUS_BENCH_BUFFER_MESSAGES : SUS_BENCH_BUFFER_MESSAGES / 16;
+	BOOL ok = TRUE;
+	for (; written < backlog && ok; written++) ok = susBenchBufferWrite(&buffer, written);
+	sus_u64_t start = susBenchNow();
+	while (read < messages && ok) {
+		ok = susBenchBufferWrite(&buffer, written++) && susBenchBufferRead(&buffer, read++, consume);
+	}
+	susBenchReport(name, susBenchElapsed(start), messages);
+	while (read < written && ok) ok = susBenchBufferRead(&buffer, read++, consume);
+	ok = ok && !susBufferReadSize(buffer);
+	susBufferDestroy(buffer);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// Stream of the small messages read by susBufferConsume and by susBufferShift
+BOOL SUSAPI susBenchBufferMessages()
+{
+	return susBenchBufferRun("consume without backlog", 0, TRUE) &&
+		susBenchBufferRun("consume with backlog", SUS_BENCH_BUFFER_BACKLOG, TRUE) &&
+		susBenchBufferRun("shift without backlog", 0, FALSE) &&
+		susBenchBufferRun("shift with backlog", SUS_BENCH_BUFFER_BACKLOG, FALSE);
+}
+
+// -------------------------------------------------------------------
+
+// Number of the bytes written before the consumption
+#define SUS_BENCH_BUFFER_STREAM 64
+// Number of the consumed bytes (more than the unread ones, so an append would compact the buffer)
+#define SUS_BENCH_BUFFER_CONSUMED 40
+// Position of the insertion in the storage (in the middle of the unread data)
+#define SUS_BENCH_BUFFER_INSERT_POS 50
+// Number of the inserted bytes (more than the free space, the buffer grows)
+#define SUS_BENCH_BUFFER_INSERTED 100
+
+// The positional insertion after a consumption keeps the storage positions
+BOOL SUSAPI susBenchBufferConsumeInsert()
+{
+	SUS_BUFFER buffer = susNewBuffer(SUS_BENCH_BUFFER_STREAM);
+	SUS_BENCH_CHECK(buffer);
+	sus_byte_t stream[SUS_BENCH_BUFFER_STREAM], inserted[SUS_BENCH_BUFFER_INSERTED];
+	for (sus_uint_t i = 0; i < SUS_BENCH_BUFFER_STREAM; i++) stream[i] = (sus_byte_t)i;
+	for (sus_uint_t i = 0; i < SUS_BENCH_BUFFER_INSERTED; i++) inserted[i] = (sus_byte_t)(0x80 + i);
+	BOOL ok = susBufferPush(&buffer, stream, SUS_BENCH_BUFFER_STREAM) != NULL;
+	if (ok) susBufferConsume(buffer, SUS_BENCH_BUFFER_CONSUMED);
+	ok = ok && susBufferInsert(&buffer, SUS_BENCH_BUFFER_INSERT_POS, inserted, SUS_BENCH_BUFFER_INSERTED) == buffer->data + SUS_BENCH_BUFFER_INSERT_POS;
+	// The unread data is the rest of the stream with the inserted bytes in the middle
+	SUS_DATAVIEW view = susBufferPeek(buffer);
+	ok = ok && view.size == SUS_BENCH_BUFFER_STREAM - SUS_BENCH_BUFFER_CONSUMED + SUS_BENCH_BUFFER_INSERTED &&
+		sus_memcmp(view.data, stream + SUS_BENCH_BUFFER_CONSUMED, SUS_BENCH_BUFFER_INSERT_POS - SUS_BENCH_BUFFER_CONSUMED) &&
+		sus_memcmp(view.data + SUS_BENCH_BUFFER_INSERT_POS - SUS_BENCH_BUFFER_CONSUMED, inserted, SUS_BENCH_BUFFER_INSERTED) &&
+		sus_memcmp(view.data + SUS_BENCH_BUFFER_INSERT_POS - SUS_BENCH_BUFFER_CONSUMED + SUS_BENCH_BUFFER_INSERTED,
+			stream + SUS_BENCH_BUFFER_INSERT_POS, SUS_BENCH_BUFFER_STREAM - SUS_BENCH_BUFFER_INSERT_POS);
+	susBufferDestroy(buffer);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
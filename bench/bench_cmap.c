@@ -0,0 +1,147 @@
+// bench_cmap.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Number of the keys used by the threads
+#define SUS_BENCH_CMAP_KEYS 0x10000
+// Number of the operations of all the threads
+#define SUS_BENCH_CMAP_OPS 4000000
+// Maximum number of the threads
+#define SUS_BENCH_CMAP_THREADS 8
+
+// Shared state of the benchmark threads
+typedef struct sus_bench_cmap_run {
+	SUS_CMAP		cmap;		// Concurrent map
+	SUS_HASHMAP		map;		// Map under the lock
+	BOOL			locked;		// The map under the lock is used instead of the concurrent map
+	SRWLOCK			lock;		// Lock of the map
+	sus_u32_t		writes;		// Percent of the writes (a half of them are the removals)
+	sus_u32_t		ops;		// Number of the operations of every thread
+	volatile LONG	ready;		// Number of the started threads
+	volatile LONG	start;		// The threads are started
+	volatile LONG	errors;		// Number of the wrong values read
+} SUS_BENCH_CMAP_RUN;
+
+// Set the value of the key (the value is always the key multiplied by 3)
+static BOOL SUSAPI susBenchCMapSet(_Inout_ SUS_BENCH_CMAP_RUN* run, _In_ sus_u32_t key) {
+	sus_u32_t value = key * 3;
+	if (!run->locked) return susCMapSet(run->cmap, &key, &value);
+	AcquireSRWLockExclusive(&run->lock);
+	BOOL ok = susMapSet(&run->map, &key, &value) != NULL;
+	ReleaseSRWLockExclusive(&run->lock);
+	return ok;
+}
+// Remove the key if it is in the map
+static VOID SUSAPI susBenchCMapRemove(_Inout_ SUS_BENCH_CMAP_RUN* run, _In_ sus_u32_t key) {
+	if (!run->locked) {
+		susCMapRemove(run->cmap, &key);
+		return;
+	}
+	AcquireSRWLockExclusive(&run->lock);
+	if (susMapContains(run->map, &key)) susMapRemove(&run->map, &key);
+	ReleaseSRWLockExclusive(&run->lock);
+}
+// Get the value of the key (\return FALSE if the key is not found)
+static BOOL SUSAPI susBenchCMapGet(_Inout_ SUS_BENCH_CMAP_RUN* run, _In_ sus_u32_t key, _Out_ sus_u32_t* value) {
+	if (!run->locked) return susCMapGet(run->cmap, &key, value);
+	AcquireSRWLockShared(&run->lock);
+	sus_u32_t* found = susMapGet(run->map, &key);
+	if (found) *value = *found;
+	ReleaseSRWLockShared(&run->lock);
+	return found != NULL;
+}
+
+// Benchmark thread
+static DWORD WINAPI susBenchCMapThread(_In_ LPVOID param)
+{
+	SUS_BENCH_CMAP_RUN* run = (SUS_BENCH_CMAP_RUN*)param;
+	sus_u64_t seed = 0x9E3779B97F4A7C15ull * (sus_u64_t)(InterlockedIncrement(&run->ready));
+	while (!ReadAcquire(&run->start)) YieldProcessor();
+	LONG errors = 0;
+	for (sus_u32_t i = 0; i < run->ops; i++) {
+		sus_u64_t random = susBenchRandom(&seed);
+		sus_u32_t key = (sus_u32_t)random % SUS_BENCH_CMAP_KEYS, pick = (sus_u32_t)(random >> 32) % 100, value;
+		if (pick < run->writes / 2) susBenchCMapRemove(run, key);
+		else if (pick < run->writes) errors += !susBenchCMapSet(run, key);
+		else if (susBenchCMapGet(run, key, &value)) errors += value != key * 3;
+	}
+	InterlockedExchangeAdd(&run->errors, errors);
+	return 0;
+}
+
+// Run the operations in the threads (\return FALSE if a thread could not be started or a wrong value was read)
+static BOOL SUSAPI susBenchCMapRun(_In_ LPCSTR name, _Inout_ SUS_BENCH_CMAP_RUN* run, _In_ sus_u32_t threads)
+{
+	SUS_THREAD handles[SUS_BENCH_CMAP_THREADS];
+	run->ops = SUS_BENCH_CMAP_OPS / threads;
+	run->ready = run->start = run->errors = 0;
+	sus_u32_t started = 0;
+	for (; started < threads; started++) {
+		if (!(handles[started] = susCreateThread(susBenchCMapThread, run, TRUE))) break;
+	}
+	while (ReadAcquire(&run->ready) < (LONG)started) YieldProcessor();
+	sus_u64_t start = susBenchNow();
+	InterlockedExchange(&run->start, 1);
+	for (sus_u32_t i = 0; i < started; i++) {
+		susWaitForObjectFinish(handles[i]);
+		sus_fclose(handles[i]);
+	}
+	susBenchReport(name, susBenchElapsed(start), (sus_u64_t)run->ops * started);
+	SUS_BENCH_CHECK(started == threads && !run->errors);
+	return TRUE;
+}
+// Check the keys left in the map after the run
+static BOOL SUSAPI susBenchCMapVerify(_Inout_ SUS_BENCH_CMAP_RUN* run) {
+	DWORD found = 0;
+	for (sus_u32_t key = 0; key < SUS_BENCH_CMAP_KEYS; key++) {
+		sus_u32_t value;
+		if (!susBenchCMapGet(run, key, &value)) continue;
+		SUS_BENCH_CHECK(value == key * 3);
+		found++;
+	}
+	SUS_BENCH_CHECK(found == (run->locked ? run->map->count : susCMapCount(run->cmap)));
+	return TRUE;
+}
+
+// The operations of 1 to 8 threads on the concurrent map and on the map under an SRW lock (writes - percent of the writes)
+static BOOL SUSAPI susBenchCMapMix(_In_ sus_u32_t writes)
+{
+	static const sus_u32_t threadCounts[] = { 1, 2, 4, SUS_BENCH_CMAP_THREADS };
+	SUS_BENCH_CMAP_RUN run = { .writes = writes };
+	InitializeSRWLock(&run.lock);
+	run.cmap = susNewCMap(sus_u32_t, sus_u32_t);
+	run.map = susNewMap(sus_u32_t, sus_u32_t);
+	BOOL ok = run.cmap && run.map;
+	// A half of the keys is in the maps at the start
+	for (sus_u32_t key = 0; key < SUS_BENCH_CMAP_KEYS && ok; key += 2) {
+		sus_u32_t value = key * 3;
+		ok = susCMapSet(run.cmap, &key, &value) && susMapSet(&run.map, &key, &value);
+	}
+	for (sus_uint_t t = 0; t < SUS_COUNT_OF(threadCounts) && ok; t++) {
+		sus_printfA("\t%d threads\n", (INT)threadCounts[t]);
+		run.locked = FALSE;
+		ok = susBenchCMapRun("\tconcurrent map", &run, threadCounts[t]) && susBenchCMapVerify(&run);
+		run.locked = TRUE;
+		ok = ok && susBenchCMapRun("\tlocked map", &run, threadCounts[t]) && susBenchCMapVerify(&run);
+	}
+	if (run.cmap) susCMapDestroy(run.cmap);
+	if (run.map) susMapDestroy(run.map);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// Read-mostly operations of the threads (5% of the writes)
+BOOL SUSAPI susBenchCMapReadMostly()
+{
+	return susBenchCMapMix(5);
+}
+// Write-heavy operations of the threads (50% of the writes)
+BOOL SUSAPI susBenchCMapWriteHeavy()
+{
+	return susBenchCMapMix(50);
+}
+
+// -------------------------------------------------------------------
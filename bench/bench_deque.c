@@ -0,0 +1,54 @@
+// bench_deque.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Number of the elements passed through the deque queue
+#define SUS_BENCH_DEQUE_OPS 4000000
+// Number of the bytes moved by the vector queue of every size
+#define SUS_BENCH_DEQUE_MOVE_BYTES 0x80000000ull
+
+// Pass the elements through a FIFO queue of the deque and of the vector with 16 to 64K waiting elements
+BOOL SUSAPI susBenchDequeQueue()
+{
+	static const sus_uint_t depths[] = { 16, 1024, 65536 };
+	BOOL ok = TRUE;
+	for (sus_uint_t d = 0; d < SUS_COUNT_OF(depths) && ok; d++) {
+		sus_uint_t depth = depths[d];
+		sus_printfA("\t%p waiting\n", (SIZE_T)depth);
+		// Deque: the push and the pop touch only the ends of the ring
+		SUS_DEQUE deque = susNewDeque(sus_u64_t);
+		SUS_BENCH_CHECK(deque);
+		sus_u64_t next = 0, expected = 0;
+		for (; next < depth && ok; next++) ok = susDequePushBack(&deque, &next) != NULL;
+		sus_u64_t start = susBenchNow();
+		for (sus_uint_t i = 0; i < SUS_BENCH_DEQUE_OPS && ok; i++) {
+			sus_u64_t value;
+			ok = susDequePopFront(deque, &value) && value == expected++ && susDequePushBack(&deque, &next);
+			next++;
+		}
+		susBenchReport("\tdeque", susBenchElapsed(start), SUS_BENCH_DEQUE_OPS);
+		ok = ok && deque->length == depth;
+		susDequeDestroy(deque);
+		// Vector: the pop from the front moves the waiting elements
+		SUS_VECTOR vector = susNewVector(sus_u64_t);
+		SUS_BENCH_CHECK(vector);
+		sus_uint_t ops = (sus_uint_t)min(SUS_BENCH_DEQUE_MOVE_BYTES / ((sus_u64_t)depth * sizeof(sus_u64_t)), SUS_BENCH_DEQUE_OPS);
+		next = expected = 0;
+		for (; next < depth && ok; next++) ok = susVectorPush(&vector, &next) != NULL;
+		start = susBenchNow();
+		for (sus_uint_t i = 0; i < ops && ok; i++) {
+			ok = *(sus_u64_t*)susVectorAt(vector, 0) == expected++ && susVectorErase(&vector, 0) && susVectorPush(&vector, &next);
+			next++;
+		}
+		susBenchReport("\tvector", susBenchElapsed(start), ops);
+		ok = ok && vector->length == depth;
+		susVectorDestroy(vector);
+	}
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
@@ -0,0 +1,107 @@
+// bench_fileio.c
+//
+#include "framework.h"
+#include <winioctl.h>
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Size of the block written across the 4 GB boundary
+#define SUS_BENCH_FILEIO_BLOCK 0x10000
+// Offset of the block (the block ends after the 4 GB boundary)
+#define SUS_BENCH_FILEIO_OFFSET (0x100000000ll - SUS_BENCH_FILEIO_BLOCK / 2)
+// Size of the single transfer larger than 4 GB
+#define SUS_BENCH_FILEIO_LARGE (0x100000000ull + SUS_BENCH_FILEIO_BLOCK)
+
+// Create a sparse temporary file, the holes take no disk space
+static SUS_FILE SUSAPI susBenchFileioCreate() {
+	SUS_FILE hFile = susCreateTempFileA("sus", NULL, SUS_TEMP_FILE_DELETE_ON_CLOSE, NULL);
+	if (!hFile) return NULL;
+	DWORD bytes;
+	// Without the sparse attribute the holes are filled with zeros on disk, the checks still pass
+	DeviceIoControl(hFile, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &bytes, NULL);
+	return hFile;
+}
+
+// Transfers that cross the 4 GB offset and a hole of a sparse file
+static BOOL SUSAPI susBenchFileioBoundary()
+{
+	SUS_FILE hFile = susBenchFileioCreate();
+	SUS_BENCH_CHECK(hFile);
+	sus_lpbyte_t block = sus_malloc(SUS_BENCH_FILEIO_BLOCK * 2);
+	if (!block) {
+		sus_fclose(hFile);
+		SUS_BENCH_CHECK(block);
+	}
+	sus_lpbyte_t back = block + SUS_BENCH_FILEIO_BLOCK;
+	sus_u64_t seed = 3;
+	for (SIZE_T i = 0; i < SUS_BENCH_FILEIO_BLOCK; i += sizeof(sus_u64_t)) *(sus_u64_t*)(block + i) = susBenchRandom(&seed);
+	BOOL ok = sus_fseek(hFile, SUS_BENCH_FILEIO_OFFSET, FILE_BEGIN) &&
+		sus_fwriteall(hFile, (LPBYTE)block, SUS_BENCH_FILEIO_BLOCK) == SUS_BENCH_FILEIO_BLOCK &&
+		sus_fsize(hFile) == SUS_BENCH_FILEIO_OFFSET + SUS_BENCH_FILEIO_BLOCK;
+	// The block is read back across the boundary
+	ok = ok && sus_fseek(hFile, SUS_BENCH_FILEIO_OFFSET, FILE_BEGIN) &&
+		sus_freadall(hFile, (LPBYTE)back, SUS_BENCH_FILEIO_BLOCK) == SUS_BENCH_FILEIO_BLOCK &&
+		sus_memcmp(block, back, SUS_BENCH_FILEIO_BLOCK);
+	// The hole is read as zeros and the end of the file stops the read
+	ok = ok && sus_fseek(hFile, 0x80000000ll, FILE_BEGIN) &&
+		sus_freadall(hFile, (LPBYTE)back, SUS_BENCH_FILEIO_BLOCK) == SUS_BENCH_FILEIO_BLOCK &&
+		sus_memiszero(back, SUS_BENCH_FILEIO_BLOCK);
+	ok = ok && sus_fseek(hFile, SUS_BENCH_FILEIO_OFFSET + SUS_BENCH_FILEIO_BLOCK / 2, FILE_BEGIN) &&
+		sus_freadall(hFile, (LPBYTE)back, SUS_BENCH_FILEIO_BLOCK) == SUS_BENCH_FILEIO_BLOCK / 2 &&
+		sus_memcmp(block + SUS_BENCH_FILEIO_BLOCK / 2, back, SUS_BENCH_FILEIO_BLOCK / 2);
+	sus_free(block);
+	sus_fclose(hFile);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// One write and one read of more than 4 GB (the transfers are split into SUS_FILE_IO_PART_SIZE parts)
+static BOOL SUSAPI susBenchFileioLarge()
+{
+#ifdef _WIN64
+	// The untouched pages of the buffer stay zero, only the marks around the part borders are written
+	LPBYTE buffer = VirtualAlloc(NULL, SUS_BENCH_FILEIO_LARGE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (!buffer) {
+		sus_printfA("\tskipped: no memory for the 4 GB buffer\n");
+		return TRUE;
+	}
+	SUS_FILE hFile = susBenchFileioCreate();
+	if (!hFile) {
+		VirtualFree(buffer, 0, MEM_RELEASE);
+		SUS_BENCH_CHECK(hFile);
+	}
+	for (SIZE_T part = SUS_FILE_IO_PART_SIZE; part < SUS_BENCH_FILEIO_LARGE; part += SUS_FILE_IO_PART_SIZE) {
+		buffer[part - 1] = (BYTE)(part >> 30);
+		buffer[part] = (BYTE)~(part >> 30);
+	}
+	buffer[SUS_BENCH_FILEIO_LARGE - 1] = 0x5A;
+	sus_u64_t start = susBenchNow();
+	BOOL ok = sus_fwriteall(hFile, buffer, SUS_BENCH_FILEIO_LARGE) == SUS_BENCH_FILEIO_LARGE;
+	susBenchReport("write 4 GB", susBenchElapsed(start), 1);
+	ok = ok && (sus_u64_t)sus_fsize(hFile) == SUS_BENCH_FILEIO_LARGE;
+	for (SIZE_T part = SUS_FILE_IO_PART_SIZE; part < SUS_BENCH_FILEIO_LARGE; part += SUS_FILE_IO_PART_SIZE) buffer[part - 1] = buffer[part] = 0;
+	buffer[SUS_BENCH_FILEIO_LARGE - 1] = 0;
+	start = susBenchNow();
+	ok = ok && sus_fseek(hFile, 0, FILE_BEGIN) && sus_freadall(hFile, buffer, SUS_BENCH_FILEIO_LARGE) == SUS_BENCH_FILEIO_LARGE;
+	susBenchReport("read 4 GB", susBenchElapsed(start), 1);
+	for (SIZE_T part = SUS_FILE_IO_PART_SIZE; part < SUS_BENCH_FILEIO_LARGE && ok; part += SUS_FILE_IO_PART_SIZE) {
+		ok = buffer[part - 1] == (BYTE)(part >> 30) && buffer[part] == (BYTE)~(part >> 30);
+	}
+	ok = ok && buffer[SUS_BENCH_FILEIO_LARGE - 1] == 0x5A;
+	sus_fclose(hFile);
+	VirtualFree(buffer, 0, MEM_RELEASE);
+	SUS_BENCH_CHECK(ok);
+#else
+	sus_printfA("\tskipped: the 4 GB buffer needs a 64-bit process\n");
+#endif // !_WIN64
+	return TRUE;
+}
+
+// Reads and writes of the sparse temporary files beyond 4 GB
+BOOL SUSAPI susBenchFileioLargeFiles()
+{
+	return susBenchFileioBoundary() && susBenchFileioLarge();
+}
+
+// -------------------------------------------------------------------
@@ -0,0 +1,92 @@
+// bench_growth.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Number of the push and pop bursts
+#define SUS_BENCH_GROWTH_BURSTS 2000
+// Largest length reached by a burst
+#define SUS_BENCH_GROWTH_PEAK 0x10000
+// Number of the push/pop pairs at the shrink threshold
+#define SUS_BENCH_GROWTH_EDGE 1000000
+
+// Names of the policies
+static const LPCSTR SUSBenchGrowthNames[][2] = {
+	{ "factor bursts", "factor edge" },
+	{ "pow2 bursts", "pow2 edge" },
+	{ "never-shrink bursts", "never-shrink edge" },
+	{ "hysteresis bursts", "hysteresis edge" }
+};
+
+// Push an element and count the reallocations
+static BOOL SUSAPI susBenchGrowthPush(_Inout_ SUS_LPVECTOR vector, _In_ sus_u64_t value, _Inout_ SIZE_T* resizes) {
+	sus_csize_t capacity = (*vector)->capacity;
+	if (!susVectorPush(vector, &value)) return FALSE;
+	*resizes += (*vector)->capacity != capacity;
+	return TRUE;
+}
+// Pop an element and count the reallocations
+static BOOL SUSAPI susBenchGrowthPop(_Inout_ SUS_LPVECTOR vector, _Inout_ SIZE_T* resizes) {
+	sus_csize_t capacity = (*vector)->capacity;
+	if (!susVectorPop(vector)) return FALSE;
+	*resizes += (*vector)->capacity != capacity;
+	return TRUE;
+}
+
+// Grow the vector in bursts and shrink it back, then push and pop right after a shrink
+static BOOL SUSAPI susBenchGrowthRun(_In_ SUS_GROWTH_POLICY policy)
+{
+	SUS_VECTOR vector = susNewVector(sus_u64_t);
+	SUS_BENCH_CHECK(vector);
+	susVectorSetPolicy(vector, policy);
+	sus_u64_t seed = 0x2545F4914F6CDD1Dull, sum = 0, ops = 0;
+	SIZE_T resizes = 0, peak = 0;
+	BOOL ok = TRUE;
+	// Bursts: the length jumps between a few elements and a random peak
+	sus_u64_t start = susBenchNow();
+	for (sus_uint_t burst = 0; burst < SUS_BENCH_GROWTH_BURSTS && ok; burst++) {
+		sus_csize_t high = (sus_csize_t)(susBenchRandom(&seed) % SUS_BENCH_GROWTH_PEAK) + 1, low = (sus_csize_t)(susBenchRandom(&seed) % 64);
+		while (vector->length < high && ok) {
+			ok = susBenchGrowthPush(&vector, vector->length, &resizes);
+			ops++;
+		}
+		peak = max(peak, (SIZE_T)vector->capacity);
+		while (vector->length > low && ok) {
+			sum += *(sus_u64_t*)susVectorAt(vector, vector->length - 1);
+			ok = susBenchGrowthPop(&vector, &resizes);
+			ops++;
+		}
+	}
+	susBenchReport(SUSBenchGrowthNames[policy][0], susBenchElapsed(start), ops);
+	sus_printfA("\t\t%p reallocations, peak capacity %p\n", resizes, peak);
+	// Edge: the vector is shrunk by a pop, then a pop and a push alternate at that length (a policy without a margin would reallocate on every operation)
+	while (vector->length < SUS_BENCH_GROWTH_PEAK && ok) ok = susBenchGrowthPush(&vector, vector->length, &resizes);
+	for (SIZE_T shrunk = resizes; vector->length > 1 && resizes == shrunk && ok;) ok = susBenchGrowthPop(&vector, &resizes);
+	ok = ok && susBenchGrowthPush(&vector, vector->length, &resizes);
+	resizes = 0;
+	start = susBenchNow();
+	for (sus_uint_t i = 0; i < SUS_BENCH_GROWTH_EDGE && ok; i++) {
+		ok = susBenchGrowthPop(&vector, &resizes) && susBenchGrowthPush(&vector, vector->length, &resizes);
+	}
+	susBenchReport(SUSBenchGrowthNames[policy][1], susBenchElapsed(start), SUS_BENCH_GROWTH_EDGE * 2);
+	sus_printfA("\t\t%p reallocations\n", resizes);
+	// The values are the indexes, so the remaining elements are checked directly
+	for (sus_csize_t i = 0; i < vector->length && ok; i++) ok = *(sus_u64_t*)susVectorAt(vector, i) == i;
+	susBenchSink += (SIZE_T)sum;
+	susVectorDestroy(vector);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// Churn of the vectors with every growth policy
+BOOL SUSAPI susBenchGrowthChurn()
+{
+	for (sus_uint_t policy = SUS_GROWTH_POLICY_FACTOR; policy <= SUS_GROWTH_POLICY_HYSTERESIS; policy++) {
+		if (!susBenchGrowthRun((SUS_GROWTH_POLICY)policy)) return FALSE;
+	}
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
@@ -0,0 +1,66 @@
+// bench_list.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Number of the live nodes of the churn
+#define SUS_BENCH_LIST_LIVE 4096
+// Number of the replaced nodes of the churn
+#define SUS_BENCH_LIST_CHURN 4000000
+
+// Replace the nodes of the list in a FIFO order and in a random order (names - names of the FIFO, random and cleanup results)
+static BOOL SUSAPI susBenchListChurnRun(_In_ const LPCSTR names[3], _Inout_ SUS_LPLIST list)
+{
+	sus_u64_t sum = 0, expected = 0;
+	for (sus_u64_t i = 0; i < SUS_BENCH_LIST_LIVE; i++) {
+		SUS_BENCH_CHECK(susListPush(list, &i));
+		expected += i;
+	}
+	sus_u64_t start = susBenchNow();
+	for (sus_u64_t i = SUS_BENCH_LIST_LIVE; i < SUS_BENCH_LIST_LIVE + SUS_BENCH_LIST_CHURN; i++) {
+		expected -= *(sus_u64_t*)list->head->value;
+		susListShift(list);
+		if (!susListPush(list, &i)) return FALSE;
+		expected += i;
+	}
+	susBenchReport(names[0], susBenchElapsed(start), SUS_BENCH_LIST_CHURN);
+	susListForeach(node, *list) sum += *(sus_u64_t*)node->value;
+	SUS_BENCH_CHECK(sum == expected && list->count == SUS_BENCH_LIST_LIVE);
+	// The random removals scatter the free nodes over the pool blocks
+	sus_u64_t seed = 0x9E3779B97F4A7C15ull;
+	start = susBenchNow();
+	for (sus_uint_t i = 0; i < SUS_BENCH_LIST_CHURN / 16; i++) {
+		SUS_LIST_NODE node = list->head;
+		for (sus_u64_t skip = susBenchRandom(&seed) % 16; skip--;) node = node->next;
+		expected -= *(sus_u64_t*)node->value;
+		susListErase(list, node);
+		sus_u64_t value = susBenchRandom(&seed);
+		if (!susListInsert(list, list->head, &value)) return FALSE;
+		expected += value;
+	}
+	susBenchReport(names[1], susBenchElapsed(start), SUS_BENCH_LIST_CHURN / 16);
+	sum = 0;
+	susListForeach(node, *list) sum += *(sus_u64_t*)node->value;
+	SUS_BENCH_CHECK(sum == expected && list->count == SUS_BENCH_LIST_LIVE);
+	start = susBenchNow();
+	susListCleanup(list);
+	susBenchReport(names[2], susBenchElapsed(start), SUS_BENCH_LIST_LIVE);
+	SUS_BENCH_CHECK(!list->head && !list->count);
+	return TRUE;
+}
+
+// Churn of the list nodes in the heap and in the node pool
+BOOL SUSAPI susBenchListChurn()
+{
+	static const LPCSTR heapNames[3] = { "heap fifo", "heap random", "heap cleanup" };
+	static const LPCSTR poolNames[3] = { "pool fifo", "pool random", "pool cleanup" };
+	SUS_LIST heap = susListSetup(sus_u64_t);
+	if (!susBenchListChurnRun(heapNames, &heap)) return FALSE;
+	SUS_LIST pool = susListSetupPool(sus_u64_t);
+	SUS_BENCH_CHECK(pool.pool);
+	return susBenchListChurnRun(poolNames, &pool);
+}
+
+// -------------------------------------------------------------------
@@ -0,0 +1,324 @@
+// bench_map.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Number of the keys in the map
+#define SUS_BENCH_MAP_COUNT 1000000
+// Size of the string key buffer with the terminator
+#define SUS_BENCH_MAP_NAME 16
+
+// Write the string key of the number ("key-" and the hexadecimal digits)
+static VOID SUSAPI susBenchMapName(_Out_writes_(SUS_BENCH_MAP_NAME) LPSTR name, _In_ sus_u32_t number) {
+	sus_memcpy((LPBYTE)name, (LPBYTE)"key-", 4);
+	for (sus_uint_t i = 0; i < 8; i++) name[4 + i] = "0123456789abcdef"[(number >> (28 - i * 4)) & 0xF];
+	name[12] = '\0';
+}
+
+// Insert, find, miss and remove the keys (keys - SUS_BENCH_MAP_COUNT inserted keys followed by as many missing keys)
+static BOOL SUSAPI susBenchMapRun(_In_ LPCSTR name, _In_ SUS_HASHMAP map, _In_ LPBYTE keys)
+{
+	SUS_BENCH_CHECK(map);
+	sus_printfA("\t%s\n", name);
+	BOOL ok = TRUE;
+	sus_u64_t start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_COUNT && ok; i++) ok = susMapAdd(&map, keys + (SIZE_T)i * map->keySize, &i) != NULL;
+	susBenchReport("\tinsert", susBenchElapsed(start), SUS_BENCH_MAP_COUNT);
+	ok = ok && map->count == SUS_BENCH_MAP_COUNT;
+	start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_COUNT && ok; i++) {
+		sus_u32_t* value = susMapGet(map, keys + (SIZE_T)i * map->keySize);
+		ok = value && *value == i;
+	}
+	susBenchReport("\thit", susBenchElapsed(start), SUS_BENCH_MAP_COUNT);
+	start = susBenchNow();
+	for (sus_u32_t i = SUS_BENCH_MAP_COUNT; i < SUS_BENCH_MAP_COUNT * 2 && ok; i++) ok = !susMapGet(map, keys + (SIZE_T)i * map->keySize);
+	susBenchReport("\tmiss", susBenchElapsed(start), SUS_BENCH_MAP_COUNT);
+	start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_COUNT && ok; i++) susMapRemove(&map, keys + (SIZE_T)i * map->keySize);
+	susBenchReport("\tremove", susBenchElapsed(start), SUS_BENCH_MAP_COUNT);
+	ok = ok && !map->count;
+	susMapDestroy(map);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// Operations of 1M integer and string keys with the default and the seeded hashing
+BOOL SUSAPI susBenchMapKeys()
+{
+	// The multiplication by an odd number gives the different scattered integers
+	sus_u32_t* numbers = sus_malloc(SUS_BENCH_MAP_COUNT * 2 * sizeof(sus_u32_t));
+	SUS_BENCH_CHECK(numbers);
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_COUNT * 2; i++) numbers[i] = i * 2654435761u;
+	BOOL ok = susBenchMapRun("integer keys", susNewMap(sus_u32_t, sus_u32_t), (LPBYTE)numbers) &&
+		susBenchMapRun("integer keys (seeded)", susNewSeededMap(sus_u32_t, sus_u32_t), (LPBYTE)numbers);
+	sus_free(numbers);
+	if (!ok) return FALSE;
+	LPSTR names = sus_malloc(SUS_BENCH_MAP_COUNT * 2 * SUS_BENCH_MAP_NAME);
+	LPCSTR* strings = sus_malloc(SUS_BENCH_MAP_COUNT * 2 * sizeof(LPCSTR));
+	if (!names || !strings) {
+		if (names) sus_free(names);
+		if (strings) sus_free(strings);
+		SUS_BENCH_CHECK(names && strings);
+	}
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_COUNT * 2; i++) {
+		susBenchMapName(names + (SIZE_T)i * SUS_BENCH_MAP_NAME, i * 2654435761u);
+		strings[i] = names + (SIZE_T)i * SUS_BENCH_MAP_NAME;
+	}
+	ok = susBenchMapRun("string keys", susNewStringMap(sus_u32_t), (LPBYTE)strings) &&
+		susBenchMapRun("string keys (seeded)", susNewSeededStringMap(sus_u32_t), (LPBYTE)strings);
+	sus_free(strings);
+	sus_free(names);
+	return ok;
+}
+
+// -------------------------------------------------------------------
+
+// Insert the keys and measure every insertion (resize - grow the full table at once instead of the incremental rehash)
+static BOOL SUSAPI susBenchMapInsertLatency(_In_ LPCSTR name, _In_ BOOL resize, _Inout_ SUS_VECTOR samples)
+{
+	SUS_HASHMAP map = susNewMap(sus_u32_t, sus_u32_t);
+	SUS_BENCH_CHECK(map);
+	samples->length = 0;
+	BOOL ok = TRUE;
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_COUNT && ok; i++) {
+		sus_u32_t key = i * 2654435761u;
+		sus_u64_t start = susBenchNow();
+		if (resize && !map->growthLeft) susMapResize(&map, map->capacity * SUS_HASHTABLE_GROWTH_FACTOR);
+		ok = susMapAdd(&map, &key, &i) != NULL;
+		sus_u64_t ns = susBenchElapsed(start);
+		ok = ok && susVectorPush(&samples, &ns);
+	}
+	ok = ok && map->count == SUS_BENCH_MAP_COUNT && susBenchReportPercentiles(name, samples);
+	susMapDestroy(map);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// Latency percentiles of the insertions with the incremental and the full rehash and of the susMapStep calls
+BOOL SUSAPI susBenchMapRehash()
+{
+	SUS_VECTOR samples = susNewVector(sus_u64_t);
+	SUS_BENCH_CHECK(samples && susVectorReserve(&samples, SUS_BENCH_MAP_COUNT));
+	if (!susBenchMapInsertLatency("insert (incremental rehash)", FALSE, samples) ||
+		!susBenchMapInsertLatency("insert (full rehash)", TRUE, samples)) {
+		susVectorDestroy(samples);
+		return FALSE;
+	}
+	// The table is filled until the rehash of 1M slots starts, then the steps move them
+	SUS_HASHMAP map = susNewMap(sus_u32_t, sus_u32_t);
+	BOOL ok = map != NULL;
+	sus_u32_t count = 0;
+	for (; ok && !(map->old && map->old->capacity >= SUS_BENCH_MAP_COUNT); count++) {
+		sus_u32_t key = count * 2654435761u;
+		ok = susMapAdd(&map, &key, &count) != NULL;
+	}
+	samples->length = 0;
+	for (BOOL rehashing = ok; rehashing && ok;) {
+		sus_u64_t start = susBenchNow();
+		rehashing = susMapStep(map, SUS_HASHTABLE_MIGRATE_STEP);
+		sus_u64_t ns = susBenchElapsed(start);
+		ok = susVectorPush(&samples, &ns) != NULL;
+	}
+	ok = ok && !susMapIsRehashing(map) && map->count == count && susBenchReportPercentiles("step", samples);
+	for (sus_u32_t i = 0; i < count && ok; i++) {
+		sus_u32_t key = i * 2654435761u;
+		sus_u32_t* value = susMapGet(map, &key);
+		ok = value && *value == i;
+	}
+	if (map) susMapDestroy(map);
+	susVectorDestroy(samples);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Number of the sequential integer keys of the distribution check
+#define SUS_BENCH_MAP_HASH_KEYS 0x100000
+// Number of the buckets of the distribution check (16 keys per bucket)
+#define SUS_BENCH_MAP_HASH_BUCKETS 0x10000
+// Number of the bytes hashed for every size of the throughput check
+#define SUS_BENCH_MAP_HASH_BYTES 0x10000000ull
+
+// Spread of the bucket counts (\return the chi-square statistic per degree of freedom in thousandths, 1000 for the uniform hash)
+static sus_u64_t SUSAPI susBenchMapChiSquare(_In_reads_(SUS_BENCH_MAP_HASH_BUCKETS) const sus_u32_t* buckets) {
+	sus_u64_t sum = 0, expected = SUS_BENCH_MAP_HASH_KEYS / SUS_BENCH_MAP_HASH_BUCKETS;
+	for (sus_uint_t i = 0; i < SUS_BENCH_MAP_HASH_BUCKETS; i++) sum += (buckets[i] - expected) * (buckets[i] - expected);
+	return sum * 1000 / expected / (SUS_BENCH_MAP_HASH_BUCKETS - 1);
+}
+// Distribute the sequential integer keys by the low, the group (as the map takes them) and the high bits of the hash
+static BOOL SUSAPI susBenchMapDistribution(_In_ LPCSTR name, _In_ BOOL integer, _Out_writes_(SUS_BENCH_MAP_HASH_BUCKETS * 3) sus_u32_t* buckets)
+{
+	SUS_HASH64_T seed = susHashSeed();
+	sus_zeromem((LPBYTE)buckets, SUS_BENCH_MAP_HASH_BUCKETS * 3 * sizeof(sus_u32_t));
+	for (sus_u32_t key = 0; key < SUS_BENCH_MAP_HASH_KEYS; key++) {
+		SUS_HASH64_T hash = integer ? susHash64Int(key, seed) : susHash64(&key, sizeof(key), seed);
+		SUS_HASH_T folded = (SUS_HASH_T)(hash ^ (hash >> 32));
+		buckets[hash & (SUS_BENCH_MAP_HASH_BUCKETS - 1)]++;
+		buckets[SUS_BENCH_MAP_HASH_BUCKETS + ((folded >> 7) & (SUS_BENCH_MAP_HASH_BUCKETS - 1))]++;
+		buckets[SUS_BENCH_MAP_HASH_BUCKETS * 2 + (hash >> 48)]++;
+	}
+	sus_u64_t low = susBenchMapChiSquare(buckets), group = susBenchMapChiSquare(buckets + SUS_BENCH_MAP_HASH_BUCKETS), high = susBenchMapChiSquare(buckets + SUS_BENCH_MAP_HASH_BUCKETS * 2);
+	sus_printfA("\t%s: chi-square/df low %d.%3d, group %d.%3d, high %d.%3d\n", name,
+		(INT)(low / 1000), (INT)(low % 1000), (INT)(group / 1000), (INT)(group % 1000), (INT)(high / 1000), (INT)(high % 1000)
+	);
+	// The deviation of the uniform hash is about 0.006, the sequential keys of a weak hash give 0 or a large number
+	SUS_BENCH_CHECK(low > 950 && low < 1050 && group > 950 && group < 1050 && high > 950 && high < 1050);
+	return TRUE;
+}
+
+// Quality of susHash64: the wyhash reference vectors, the bucket distribution of the sequential integers and the throughput
+BOOL SUSAPI susBenchMapHash()
+{
+	// The results of wyhash (final version 4) with the seed equal to the index of the message
+	static const struct { LPCSTR message; SUS_HASH64_T hash; } vectors[] = {
+		{ "", 0x93228A4DE0EEC5A2ull },
+		{ "a", 0xC5BAC3DB178713C4ull },
+		{ "abc", 0xA97F2F7B1D9B3314ull },
+		{ "message digest", 0x786D1F1DF3801DF4ull },
+		{ "abcdefghijklmnopqrstuvwxyz", 0xDCA5A8138AD37C87ull },
+		{ "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", 0xB9E734F117CFAF70ull },
+		{ "12345678901234567890123456789012345678901234567890123456789012345678901234567890", 0x6CC5EAB49A92D617ull },
+	};
+	for (sus_uint_t i = 0; i < SUS_COUNT_OF(vectors); i++) {
+		SUS_BENCH_CHECK(susHash64(vectors[i].message, lstrlenA(vectors[i].message), i) == vectors[i].hash);
+	}
+	sus_printfA("\treference vectors: %d passed\n", (INT)SUS_COUNT_OF(vectors));
+	sus_u32_t* buckets = sus_malloc(SUS_BENCH_MAP_HASH_BUCKETS * 3 * sizeof(sus_u32_t));
+	SUS_BENCH_CHECK(buckets);
+	BOOL ok = susBenchMapDistribution("susHash64Int", TRUE, buckets) && susBenchMapDistribution("susHash64", FALSE, buckets);
+	sus_free(buckets);
+	if (!ok) return FALSE;
+	// The throughput of the 64-bit hash against the FNV-1a hash of the unseeded maps
+	static const sus_u32_t sizes[] = { 4, 16, 64, 256, 4096 };
+	LPBYTE data = sus_malloc(4096);
+	SUS_BENCH_CHECK(data);
+	sus_u64_t seed = 5;
+	for (sus_uint_t i = 0; i < 4096; i += sizeof(sus_u64_t)) *(sus_u64_t*)(data + i) = susBenchRandom(&seed);
+	for (sus_uint_t s = 0; s < SUS_COUNT_OF(sizes); s++) {
+		SIZE_T ops = (SIZE_T)(SUS_BENCH_MAP_HASH_BYTES / sizes[s] / (sizes[s] < 64 ? 4 : 1));
+		sus_printfA("\t%d bytes\n", (INT)sizes[s]);
+		sus_u64_t sum = 0, start = susBenchNow();
+		for (SIZE_T i = 0; i < ops; i++) sum += susHash64(data, sizes[s], i);
+		susBenchReport("\tsusHash64", susBenchElapsed(start), ops);
+		start = susBenchNow();
+		for (SIZE_T i = 0; i < ops; i++) {
+			data[0] = (BYTE)i;
+			sum += susDefGetHash((SUS_DATAVIEW) { .data = data, .size = sizes[s] });
+		}
+		susBenchReport("\tFNV-1a", susBenchElapsed(start), ops);
+		susBenchSink += (SIZE_T)sum;
+	}
+	sus_u64_t sum = 0, start = susBenchNow();
+	for (SIZE_T i = 0; i < SUS_BENCH_MAP_HASH_BYTES / 8; i++) sum += susHash64Int(i, 1);
+	susBenchReport("susHash64Int", susBenchElapsed(start), SUS_BENCH_MAP_HASH_BYTES / 8);
+	susBenchSink += (SIZE_T)sum;
+	sus_free(data);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Number of the long string keys
+#define SUS_BENCH_MAP_LONG_COUNT 0x40000
+// Size of the long string key buffer (a shared prefix and a short key at the end)
+#define SUS_BENCH_MAP_LONG_NAME 128
+
+// Resize and lookups of the long string keys with the shared prefix, the stored hashes against hashing the keys again
+BOOL SUSAPI susBenchMapLongKeys()
+{
+	LPSTR names = sus_malloc((SIZE_T)SUS_BENCH_MAP_LONG_COUNT * 2 * SUS_BENCH_MAP_LONG_NAME);
+	LPCSTR* strings = sus_malloc((SIZE_T)SUS_BENCH_MAP_LONG_COUNT * 2 * sizeof(LPCSTR));
+	SUS_HASHMAP map = susNewStringMap(sus_u32_t), copy = NULL;
+	BOOL ok = names && strings && map;
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_LONG_COUNT * 2 && ok; i++) {
+		LPSTR name = names + (SIZE_T)i * SUS_BENCH_MAP_LONG_NAME;
+		sus_memset((LPBYTE)name, '/', SUS_BENCH_MAP_LONG_NAME - SUS_BENCH_MAP_NAME);
+		susBenchMapName(name + SUS_BENCH_MAP_LONG_NAME - SUS_BENCH_MAP_NAME, i * 2654435761u);
+		strings[i] = name;
+	}
+	sus_u64_t start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_LONG_COUNT && ok; i++) ok = susMapAdd(&map, &strings[i], &i) != NULL;
+	susBenchReport("insert", susBenchElapsed(start), SUS_BENCH_MAP_LONG_COUNT);
+	// The entries are moved by the stored hashes
+	start = susBenchNow();
+	if (ok) susMapResize(&map, map->capacity * 4);
+	susBenchReport("resize (stored hashes)", susBenchElapsed(start), SUS_BENCH_MAP_LONG_COUNT);
+	ok = ok && map->count == SUS_BENCH_MAP_LONG_COUNT && !susMapIsRehashing(map);
+	// Every key is hashed and inserted again
+	start = susBenchNow();
+	if (ok) copy = susNewMapEx(sizeof(LPCSTR), sizeof(sus_u32_t), susDefGetStringHashA, susDefCmpStringKeysA, map->capacity);
+	ok = ok && copy;
+	if (ok) susMapForeach(map, i) ok = ok && susMapAdd(&copy, susMapIterKey(i), susMapIterValue(i));
+	susBenchReport("resize (hashing the keys)", susBenchElapsed(start), SUS_BENCH_MAP_LONG_COUNT);
+	ok = ok && copy->count == SUS_BENCH_MAP_LONG_COUNT;
+	start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_LONG_COUNT && ok; i++) {
+		sus_u32_t* value = susMapGet(map, &strings[i]);
+		ok = value && *value == i;
+	}
+	susBenchReport("hit", susBenchElapsed(start), SUS_BENCH_MAP_LONG_COUNT);
+	start = susBenchNow();
+	for (sus_u32_t i = SUS_BENCH_MAP_LONG_COUNT; i < SUS_BENCH_MAP_LONG_COUNT * 2 && ok; i++) ok = !susMapGet(map, &strings[i]);
+	susBenchReport("miss", susBenchElapsed(start), SUS_BENCH_MAP_LONG_COUNT);
+	if (copy) susMapDestroy(copy);
+	if (map) susMapDestroy(map);
+	if (strings) sus_free(strings);
+	if (names) sus_free(names);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Number of the old table slots when the measured rehash starts (the tables take hundreds of MB, more than the last level cache)
+#define SUS_BENCH_MAP_BATCH_SLOTS 0x1000000
+// Number of the random lookups of every measurement
+#define SUS_BENCH_MAP_BATCH_LOOKUPS 0x100000
+
+// Random lookups of the existing keys by susMapGet and by susMapGetBatch
+static BOOL SUSAPI susBenchMapBatchLookups(_In_ SUS_HASHMAP map, _In_ sus_u32_t count, _Inout_ sus_u32_t* keys, _Inout_ SUS_OBJECT* values)
+{
+	sus_u64_t seed = 5;
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_BATCH_LOOKUPS; i++) keys[i] = (sus_u32_t)(susBenchRandom(&seed) % count) * 2654435761u;
+	BOOL ok = TRUE;
+	sus_u64_t start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_BATCH_LOOKUPS && ok; i++) ok = susMapGet(map, &keys[i]) != NULL;
+	susBenchReport("\tsingle lookups", susBenchElapsed(start), SUS_BENCH_MAP_BATCH_LOOKUPS);
+	start = susBenchNow();
+	ok = ok && susMapGetBatch(map, keys, SUS_BENCH_MAP_BATCH_LOOKUPS, values) == SUS_BENCH_MAP_BATCH_LOOKUPS;
+	susBenchReport("\tbatch lookups", susBenchElapsed(start), SUS_BENCH_MAP_BATCH_LOOKUPS);
+	for (sus_u32_t i = 0; i < SUS_BENCH_MAP_BATCH_LOOKUPS && ok; i++) ok = *(sus_u32_t*)values[i] * 2654435761u == keys[i];
+	return ok;
+}
+
+// Single against batch lookups in a table larger than the last level cache, in the middle of the rehash and after it
+BOOL SUSAPI susBenchMapBatch()
+{
+	sus_u32_t* keys = sus_malloc(SUS_BENCH_MAP_BATCH_LOOKUPS * sizeof(sus_u32_t));
+	SUS_OBJECT* values = sus_malloc(SUS_BENCH_MAP_BATCH_LOOKUPS * sizeof(SUS_OBJECT));
+	SUS_HASHMAP map = susNewMap(sus_u32_t, sus_u32_t);
+	BOOL ok = keys && values && map;
+	sus_u32_t count = 0;
+	for (; ok && !(map->old && map->old->capacity >= SUS_BENCH_MAP_BATCH_SLOTS); count++) {
+		sus_u32_t key = count * 2654435761u;
+		ok = susMapAdd(&map, &key, &count) != NULL;
+	}
+	// A half of the entries is moved, a miss in the new table probes the old one then
+	while (ok && map->migrated < map->old->capacity / 2) susMapStep(map, SUS_HASHTABLE_MIGRATE_STEP);
+	if (ok) sus_printfA("\t%p entries, half of them in the old table\n", (SIZE_T)count);
+	ok = ok && susBenchMapBatchLookups(map, count, keys, values);
+	while (ok && susMapStep(map, SUS_HASHTABLE_MIGRATE_STEP));
+	if (ok) sus_printfA("\t%p entries after the rehash\n", (SIZE_T)count);
+	ok = ok && map->count == count && susBenchMapBatchLookups(map, count, keys, values);
+	if (map) susMapDestroy(map);
+	if (values) sus_free(values);
+	if (keys) sus_free(keys);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
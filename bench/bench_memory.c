@@ -0,0 +1,148 @@
+// bench_memory.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Largest measured block
+#define SUS_BENCH_MEMORY_MAX 0x4000000
+// Number of the bytes processed by each operation of the size
+#define SUS_BENCH_MEMORY_BYTES 0x10000000ull
+
+// Copy, initialization and comparison of the blocks from 1 byte to 64 MB
+BOOL SUSAPI susBenchMemoryBlocks()
+{
+	// The offset of the block moves by i & 7, so the compiler cannot merge the repeated calls
+	sus_lpbyte_t a = sus_malloc(SUS_BENCH_MEMORY_MAX + 8), b = sus_malloc(SUS_BENCH_MEMORY_MAX + 8);
+	if (!a || !b) {
+		if (a) sus_free(a);
+		if (b) sus_free(b);
+		return FALSE;
+	}
+	sus_u64_t seed = 0x9E3779B97F4A7C15ull;
+	for (SIZE_T i = 0; i < SUS_BENCH_MEMORY_MAX + 8; i += 8) *(sus_u64_t*)(a + i) = susBenchRandom(&seed);
+	sus_memcpy(b, a, SUS_BENCH_MEMORY_MAX + 8);
+	BOOL ok = TRUE;
+	for (SIZE_T size = 1; size <= SUS_BENCH_MEMORY_MAX && ok; size <<= 1) {
+		SIZE_T repeat = (SIZE_T)(SUS_BENCH_MEMORY_BYTES / (size + 64));
+		if (repeat < 4) repeat = 4;
+		sus_printfA("\t%p B\n", size);
+		sus_u64_t start = susBenchNow();
+		for (SIZE_T i = 0; i < repeat; i++) sus_memcpy(b + (i & 7), a + (i & 7), size);
+		susBenchReport("\tcopy", susBenchElapsed(start), repeat);
+		start = susBenchNow();
+		SIZE_T equal = 0;
+		for (SIZE_T i = 0; i < repeat; i++) equal += sus_memcmp(b + (i & 7), a + (i & 7), size);
+		susBenchReport("\tcompare", susBenchElapsed(start), repeat);
+		ok = equal == repeat;
+		start = susBenchNow();
+		for (SIZE_T i = 0; i < repeat; i++) sus_memset(b + (i & 7), (BYTE)i, size);
+		susBenchReport("\tset", susBenchElapsed(start), repeat);
+		BYTE last = (BYTE)(repeat - 1);
+		ok = ok && (BYTE)b[((repeat - 1) & 7)] == last && (BYTE)b[((repeat - 1) & 7) + size - 1] == last;
+		susBenchSink += equal;
+		sus_memcpy(b, a, SUS_BENCH_MEMORY_MAX + 8);
+	}
+	sus_free(a);
+	sus_free(b);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Largest number of the searched elements
+#define SUS_BENCH_MEMFIND_MAX 10000000
+// Number of the bytes scanned by each search of the size
+#define SUS_BENCH_MEMFIND_BYTES 0x10000000ull
+
+// Search of the last element of 1 to 16 bytes in the arrays of 10K to 10M elements
+BOOL SUSAPI susBenchMemoryFind()
+{
+	// The elements are filled with the zeros and the key is 0xFF.., so only the last element matches
+	sus_lpbyte_t data = sus_malloc(SUS_BENCH_MEMFIND_MAX * 16);
+	SUS_BENCH_CHECK(data);
+	BYTE key[16];
+	sus_memset((sus_lpbyte_t)key, 0xFF, sizeof(key));
+	BOOL ok = TRUE;
+	for (SIZE_T size = 1; size <= 16 && ok; size <<= 1) {
+		for (SIZE_T count = 10000; count <= SUS_BENCH_MEMFIND_MAX && ok; count *= 10) {
+			sus_zeromem(data, count * size);
+			sus_memcpy(data + (count - 1) * size, (sus_lpbyte_t)key, size);
+			SIZE_T repeat = (SIZE_T)(SUS_BENCH_MEMFIND_BYTES / (count * size));
+			if (repeat < 4) repeat = 4;
+			sus_printfA("\t%p x %p B\n", count, size);
+			SIZE_T found = 0;
+			sus_u64_t start = susBenchNow();
+			for (SIZE_T i = 0; i < repeat; i++) found += sus_memfind(data, count, (sus_lpbyte_t)key, size);
+			susBenchReport("\tsus_memfind", susBenchElapsed(start), repeat);
+			ok = found == (count - 1) * repeat;
+			// The loop of the generic IndexOf compares the elements one by one
+			found = 0;
+			start = susBenchNow();
+			for (SIZE_T i = 0; i < repeat; i++) {
+				SIZE_T j = 0;
+				while (j < count && !sus_memcmp(data + j * size, (sus_lpbyte_t)key, size)) j++;
+				found += j;
+			}
+			susBenchReport("\telement loop", susBenchElapsed(start), repeat);
+			ok = ok && found == (count - 1) * repeat;
+			susBenchSink += found;
+		}
+	}
+	sus_free(data);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Number of the blocks freed by the other thread (twice the batch of the 1 KB class, the cache keeps all of them)
+#define SUS_BENCH_MEMORY_REMOTE_BLOCKS 32
+// Size of the blocks freed by the other thread
+#define SUS_BENCH_MEMORY_REMOTE_SIZE 1024
+
+// Free the blocks without allocating any
+static DWORD WINAPI susBenchMemoryFreeThread(_In_ LPVOID param)
+{
+	SUS_LPMEMORY* blocks = (SUS_LPMEMORY*)param;
+	for (sus_uint_t i = 0; i < SUS_BENCH_MEMORY_REMOTE_BLOCKS; i++) sus_free(blocks[i]);
+	return 0;
+}
+
+// The blocks freed by a thread that never allocates return to the shared depot at its exit
+BOOL SUSAPI susBenchMemoryRemoteFree()
+{
+	SUS_LPMEMORY blocks[SUS_BENCH_MEMORY_REMOTE_BLOCKS], again[SUS_BENCH_MEMORY_REMOTE_BLOCKS];
+	sus_uint_t count = 0;
+	for (; count < SUS_BENCH_MEMORY_REMOTE_BLOCKS; count++) {
+		if (!(blocks[count] = sus_malloc(SUS_BENCH_MEMORY_REMOTE_SIZE))) break;
+	}
+	BOOL allocated = count == SUS_BENCH_MEMORY_REMOTE_BLOCKS;
+	if (!allocated) while (count) sus_free(blocks[--count]);
+	SUS_BENCH_CHECK(allocated);
+	// The blocks left in the cache of this thread go to the depot before the freed ones
+	sus_mflush();
+	SUS_THREAD hThread = susCreateThread(susBenchMemoryFreeThread, blocks, TRUE);
+	if (!hThread) {
+		for (sus_uint_t i = 0; i < SUS_BENCH_MEMORY_REMOTE_BLOCKS; i++) sus_free(blocks[i]);
+		SUS_BENCH_CHECK(hThread);
+	}
+	susWaitForObjectFinish(hThread);
+	sus_fclose(hThread);
+	// The depot gives out the last returned blocks first, a leaked cache would leave them unused
+	BOOL ok = TRUE;
+	for (count = 0; count < SUS_BENCH_MEMORY_REMOTE_BLOCKS; count++) {
+		if (!(again[count] = sus_malloc(SUS_BENCH_MEMORY_REMOTE_SIZE))) break;
+		BOOL found = FALSE;
+		for (sus_uint_t i = 0; i < SUS_BENCH_MEMORY_REMOTE_BLOCKS && !found; i++) found = again[count] == blocks[i];
+		ok = ok && found;
+	}
+	ok = ok && count == SUS_BENCH_MEMORY_REMOTE_BLOCKS;
+	while (count) sus_free(again[--count]);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
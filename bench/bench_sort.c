@@ -0,0 +1,141 @@
+// bench_sort.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Number of the sorted elements
+#define SUS_BENCH_SORT_COUNT 1000000
+// Number of the lookups of every search
+#define SUS_BENCH_SORT_LOOKUPS 200000
+// Number of the bytes scanned by the linear searches of every size
+#define SUS_BENCH_SORT_SCAN_BYTES 0x20000000ull
+
+#define susBenchSortLess(a, b) ((a) < (b))
+SUS_DECLARE_VECTOR(susBenchU32Vector, sus_u32_t)
+SUS_DECLARE_VECTOR_SORT(susBenchU32Vector, sus_u32_t, susBenchSortLess)
+
+// Compare two sus_u32_t
+static sus_int_t SUSAPI susBenchSortCompare(_In_ SUS_LPMEMORY a, _In_ SUS_LPMEMORY b) {
+	sus_u32_t x = *(sus_u32_t*)a, y = *(sus_u32_t*)b;
+	return (x > y) - (x < y);
+}
+
+// Fill the vector with the random numbers (\return The sum of the numbers)
+static sus_u64_t SUSAPI susBenchSortFill(_Inout_ SUS_VECTOR vector, _In_ sus_csize_t count, _In_ sus_u64_t seed) {
+	vector->length = 0;
+	sus_u64_t sum = 0;
+	for (sus_csize_t i = 0; i < count; i++) {
+		sus_u32_t value = (sus_u32_t)susBenchRandom(&seed);
+		susBenchU32VectorPush(&vector, value);
+		sum += value;
+	}
+	return sum;
+}
+// Check that the vector is sorted and keeps the numbers
+static BOOL SUSAPI susBenchSortCheck(_In_ SUS_VECTOR vector, _In_ sus_u64_t sum) {
+	sus_u32_t* data = susBenchU32VectorData(vector);
+	for (sus_csize_t i = 1; i < vector->length; i++) if (data[i - 1] > data[i]) return FALSE;
+	for (sus_csize_t i = 0; i < vector->length; i++) sum -= data[i];
+	return !sum;
+}
+
+// Sorting of 1M random numbers by the generic, typed, radix and stable sorts
+BOOL SUSAPI susBenchSortNumbers()
+{
+	SUS_VECTOR vector = susBenchU32VectorNew();
+	SUS_BENCH_CHECK(vector && susVectorReserve(&vector, SUS_BENCH_SORT_COUNT));
+	BOOL ok = TRUE;
+	sus_u64_t sum = susBenchSortFill(vector, SUS_BENCH_SORT_COUNT, 1);
+	sus_u64_t start = susBenchNow();
+	susVectorSort(vector, susBenchSortCompare);
+	susBenchReport("generic sort", susBenchElapsed(start), SUS_BENCH_SORT_COUNT);
+	ok = ok && susBenchSortCheck(vector, sum);
+	sum = susBenchSortFill(vector, SUS_BENCH_SORT_COUNT, 1);
+	start = susBenchNow();
+	susBenchU32VectorSort(vector);
+	susBenchReport("typed sort", susBenchElapsed(start), SUS_BENCH_SORT_COUNT);
+	ok = ok && susBenchSortCheck(vector, sum);
+	sum = susBenchSortFill(vector, SUS_BENCH_SORT_COUNT, 1);
+	start = susBenchNow();
+	ok = ok && susVectorRadixSort32(vector);
+	susBenchReport("radix sort", susBenchElapsed(start), SUS_BENCH_SORT_COUNT);
+	ok = ok && susBenchSortCheck(vector, sum);
+	sum = susBenchSortFill(vector, SUS_BENCH_SORT_COUNT, 1);
+	start = susBenchNow();
+	ok = ok && susVectorStableSort(vector, susBenchSortCompare);
+	susBenchReport("stable sort", susBenchElapsed(start), SUS_BENCH_SORT_COUNT);
+	ok = ok && susBenchSortCheck(vector, sum);
+	// An already sorted array is the worst case of a naive pivot choice
+	start = susBenchNow();
+	susBenchU32VectorSort(vector);
+	susBenchReport("typed sort (sorted)", susBenchElapsed(start), SUS_BENCH_SORT_COUNT);
+	ok = ok && susBenchSortCheck(vector, sum);
+	susVectorDestroy(vector);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Binary search in a sorted array against the linear scans from 16 to 1M elements
+BOOL SUSAPI susBenchSortSearch()
+{
+	SUS_VECTOR vector = susBenchU32VectorNew();
+	SUS_BENCH_CHECK(vector && susVectorReserve(&vector, SUS_BENCH_SORT_COUNT));
+	BOOL ok = TRUE;
+	static const sus_csize_t counts[] = { 16, 256, 4096, 65536, SUS_BENCH_SORT_COUNT };
+	for (sus_uint_t c = 0; c < SUS_COUNT_OF(counts) && ok; c++) {
+		sus_csize_t count = counts[c];
+		// Even numbers are stored, so the odd keys miss and half of the lookups fail
+		vector->length = 0;
+		for (sus_csize_t i = 0; i < count; i++) susBenchU32VectorPush(&vector, (sus_u32_t)i * 2);
+		sus_u32_t* data = susBenchU32VectorData(vector);
+		SIZE_T scans = (SIZE_T)(SUS_BENCH_SORT_SCAN_BYTES / ((sus_u64_t)count * sizeof(sus_u32_t)));
+		scans = min(max(scans, 16), SUS_BENCH_SORT_LOOKUPS);
+		sus_printfA("\t%p elements\n", (SIZE_T)count);
+		sus_u64_t seed = 7, hits = 0, expected = 0;
+		sus_u64_t start = susBenchNow();
+		for (SIZE_T i = 0; i < SUS_BENCH_SORT_LOOKUPS; i++) {
+			sus_u32_t key = (sus_u32_t)(susBenchRandom(&seed) % (count * 2));
+			hits += susBenchU32VectorBinarySearch(vector, key) != SUS_CSIZE_MAX;
+			expected += !(key & 1);
+		}
+		susBenchReport("\ttyped binary search", susBenchElapsed(start), SUS_BENCH_SORT_LOOKUPS);
+		ok = ok && hits == expected;
+		seed = 7, hits = 0;
+		start = susBenchNow();
+		for (SIZE_T i = 0; i < SUS_BENCH_SORT_LOOKUPS; i++) {
+			sus_u32_t key = (sus_u32_t)(susBenchRandom(&seed) % (count * 2));
+			hits += susVectorBinarySearch(vector, &key, susBenchSortCompare) != SUS_CSIZE_MAX;
+		}
+		susBenchReport("\tgeneric binary search", susBenchElapsed(start), SUS_BENCH_SORT_LOOKUPS);
+		ok = ok && hits == expected;
+		// The linear scans repeat the first keys of the same sequence
+		seed = 7, hits = 0, expected = 0;
+		start = susBenchNow();
+		for (SIZE_T i = 0; i < scans; i++) {
+			sus_u32_t key = (sus_u32_t)(susBenchRandom(&seed) % (count * 2));
+			hits += susBenchU32VectorIndexOf(vector, key) != SUS_CSIZE_MAX;
+			expected += !(key & 1);
+		}
+		susBenchReport("\tsimd linear scan", susBenchElapsed(start), scans);
+		ok = ok && hits == expected;
+		seed = 7, hits = 0;
+		start = susBenchNow();
+		for (SIZE_T i = 0; i < scans; i++) {
+			sus_u32_t key = (sus_u32_t)(susBenchRandom(&seed) % (count * 2));
+			sus_csize_t j = 0;
+			while (j < count && data[j] != key) j++;
+			hits += j < count;
+		}
+		susBenchReport("\tplain linear scan", susBenchElapsed(start), scans);
+		ok = ok && hits == expected;
+	}
+	susVectorDestroy(vector);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
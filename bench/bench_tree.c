@@ -0,0 +1,161 @@
+// bench_tree.c
+//
+#include "framework.h"
+#include "bench.h"
+
+// -------------------------------------------------------------------
+
+// Number of the keys
+#define SUS_BENCH_TREE_COUNT 1000000
+// Average number of the keys in a range
+#define SUS_BENCH_TREE_RANGE 100
+// Number of the range queries without the updates
+#define SUS_BENCH_TREE_QUERIES 100000
+// Number of the rounds of the updates followed by a range query
+#define SUS_BENCH_TREE_ROUNDS 100
+// Number of the removed and inserted keys in a round
+#define SUS_BENCH_TREE_UPDATES 16
+// Width of a range in the key space
+#define SUS_BENCH_TREE_WIDTH ((sus_u32_t)(0x100000000ull / SUS_BENCH_TREE_COUNT * SUS_BENCH_TREE_RANGE))
+
+// Get the key of the number (the multiplication by an odd number gives the different scattered keys)
+#define susBenchTreeKey(i) ((sus_u32_t)(i) * 2654435761u)
+
+// Collect the keys of the map and sort them (the sort-on-demand of the unordered map)
+static BOOL SUSAPI susBenchTreeSortKeys(_In_ SUS_HASHMAP map, _Inout_ SUS_LPVECTOR lpKeys) {
+	(*lpKeys)->length = 0;
+	susMapForeach(map, i) if (!susVectorPush(lpKeys, susMapIterKey(i))) return FALSE;
+	return susVectorRadixSort32(*lpKeys);
+}
+// Sum the keys of the sorted array from the low key (inclusive) to the high key (exclusive)
+static sus_u64_t SUSAPI susBenchTreeSortedRange(_In_ SUS_VECTOR keys, _In_ sus_u32_t low, _In_ sus_u32_t high) {
+	const sus_u32_t* data = (const sus_u32_t*)keys->data;
+	sus_csize_t first = 0, count = keys->length;
+	while (count) {
+		sus_csize_t half = count / 2;
+		if (data[first + half] < low) {
+			first += half + 1;
+			count -= half + 1;
+		}
+		else count = half;
+	}
+	sus_u64_t sum = 0;
+	for (; first < keys->length && data[first] < high; first++) sum += data[first];
+	return sum;
+}
+// Sum the keys of the tree from the low key (inclusive) to the high key (exclusive)
+static sus_u64_t SUSAPI susBenchTreeRange(_In_ SUS_LPTREE tree, _In_ sus_u32_t low, _In_ sus_u32_t high) {
+	sus_u64_t sum = 0;
+	susTreeForeachRange(tree, c, &low, &high) sum += *(sus_u32_t*)susTreeCursorKey(c);
+	return sum;
+}
+// Get the random low key of a range
+#define susBenchTreeLow(seed) ((sus_u32_t)(susBenchRandom(seed) % (0x100000000ull - SUS_BENCH_TREE_WIDTH)))
+
+// The ordered map against the hash table sorted on demand: the point lookups, the ordered scan and the range queries
+BOOL SUSAPI susBenchTreeOrdered()
+{
+	SUS_TREE tree = susTreeSetup(sus_u32_t, sus_u32_t), loaded = susTreeSetup(sus_u32_t, sus_u32_t);
+	SUS_HASHMAP map = susNewMap(sus_u32_t, sus_u32_t);
+	SUS_VECTOR keys = susNewVector(sus_u32_t);
+	BOOL ok = map && keys && susVectorReserve(&keys, SUS_BENCH_TREE_COUNT + SUS_BENCH_TREE_ROUNDS * SUS_BENCH_TREE_UPDATES);
+	sus_u64_t start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_TREE_COUNT && ok; i++) {
+		sus_u32_t key = susBenchTreeKey(i);
+		ok = susTreeInsert(&tree, &key, &key) != NULL;
+	}
+	susBenchReport("tree insert", susBenchElapsed(start), SUS_BENCH_TREE_COUNT);
+	start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_TREE_COUNT && ok; i++) {
+		sus_u32_t key = susBenchTreeKey(i);
+		ok = susMapAdd(&map, &key, &key) != NULL;
+	}
+	susBenchReport("map insert", susBenchElapsed(start), SUS_BENCH_TREE_COUNT);
+	ok = ok && tree.count == SUS_BENCH_TREE_COUNT && map->count == SUS_BENCH_TREE_COUNT;
+	// The point lookups
+	sus_u64_t treeSum = 0, mapSum = 0;
+	start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_TREE_COUNT && ok; i++) {
+		sus_u32_t key = susBenchTreeKey(i), * value = susTreeGet(&tree, &key);
+		ok = value && *value == key;
+	}
+	susBenchReport("tree lookup", susBenchElapsed(start), SUS_BENCH_TREE_COUNT);
+	start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_TREE_COUNT && ok; i++) {
+		sus_u32_t key = susBenchTreeKey(i), * value = susMapGet(map, &key);
+		ok = value && *value == key;
+	}
+	susBenchReport("map lookup", susBenchElapsed(start), SUS_BENCH_TREE_COUNT);
+	// The ordered scan: the leaves are already in order, the map keys are collected and sorted first
+	sus_u32_t previous = 0;
+	start = susBenchNow();
+	susTreeForeach(&tree, c) {
+		sus_u32_t key = *(sus_u32_t*)susTreeCursorKey(c);
+		ok = ok && key >= previous;
+		previous = key;
+		treeSum += key;
+	}
+	susBenchReport("tree ordered scan", susBenchElapsed(start), SUS_BENCH_TREE_COUNT);
+	start = susBenchNow();
+	ok = ok && susBenchTreeSortKeys(map, &keys);
+	for (sus_csize_t i = 0; i < keys->length && ok; i++) mapSum += ((sus_u32_t*)keys->data)[i];
+	susBenchReport("map sort and scan", susBenchElapsed(start), SUS_BENCH_TREE_COUNT);
+	ok = ok && treeSum == mapSum;
+	// The tree can be built from the sorted keys without the splits
+	start = susBenchNow();
+	ok = ok && susTreeBulkLoad(&loaded, keys->data, keys->data, (DWORD)keys->length);
+	susBenchReport("tree bulk load", susBenchElapsed(start), SUS_BENCH_TREE_COUNT);
+	ok = ok && loaded.count == SUS_BENCH_TREE_COUNT;
+	// The range queries over the unchanged keys: the sorted keys of the map are reused
+	sus_u64_t seed = 11;
+	treeSum = mapSum = 0;
+	start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_TREE_QUERIES && ok; i++) {
+		sus_u32_t low = susBenchTreeLow(&seed);
+		treeSum += susBenchTreeRange(&tree, low, low + SUS_BENCH_TREE_WIDTH);
+	}
+	susBenchReport("tree range", susBenchElapsed(start), SUS_BENCH_TREE_QUERIES);
+	seed = 11;
+	start = susBenchNow();
+	for (sus_u32_t i = 0; i < SUS_BENCH_TREE_QUERIES && ok; i++) {
+		sus_u32_t low = susBenchTreeLow(&seed);
+		mapSum += susBenchTreeSortedRange(keys, low, low + SUS_BENCH_TREE_WIDTH);
+	}
+	susBenchReport("sorted keys range", susBenchElapsed(start), SUS_BENCH_TREE_QUERIES);
+	ok = ok && treeSum == mapSum;
+	// The range queries after the updates: the map keys have to be sorted again every time
+	seed = 13;
+	treeSum = mapSum = 0;
+	start = susBenchNow();
+	for (sus_u32_t r = 0; r < SUS_BENCH_TREE_ROUNDS && ok; r++) {
+		for (sus_u32_t u = r * SUS_BENCH_TREE_UPDATES; u < (r + 1) * SUS_BENCH_TREE_UPDATES && ok; u++) {
+			sus_u32_t removed = susBenchTreeKey(u), added = susBenchTreeKey(SUS_BENCH_TREE_COUNT + u);
+			ok = susTreeRemove(&tree, &removed) && susTreeInsert(&tree, &added, &added);
+		}
+		sus_u32_t low = susBenchTreeLow(&seed);
+		treeSum += susBenchTreeRange(&tree, low, low + SUS_BENCH_TREE_WIDTH);
+	}
+	susBenchReport("tree updates and range", susBenchElapsed(start), SUS_BENCH_TREE_ROUNDS);
+	seed = 13;
+	start = susBenchNow();
+	for (sus_u32_t r = 0; r < SUS_BENCH_TREE_ROUNDS && ok; r++) {
+		for (sus_u32_t u = r * SUS_BENCH_TREE_UPDATES; u < (r + 1) * SUS_BENCH_TREE_UPDATES && ok; u++) {
+			sus_u32_t removed = susBenchTreeKey(u), added = susBenchTreeKey(SUS_BENCH_TREE_COUNT + u);
+			susMapRemove(&map, &removed);
+			ok = susMapAdd(&map, &added, &added) != NULL;
+		}
+		sus_u32_t low = susBenchTreeLow(&seed);
+		ok = ok && susBenchTreeSortKeys(map, &keys);
+		mapSum += susBenchTreeSortedRange(keys, low, low + SUS_BENCH_TREE_WIDTH);
+	}
+	susBenchReport("map updates, sort and range", susBenchElapsed(start), SUS_BENCH_TREE_ROUNDS);
+	ok = ok && treeSum == mapSum && tree.count == map->count;
+	susTreeCleanup(&tree);
+	susTreeCleanup(&loaded);
+	if (map) susMapDestroy(map);
+	if (keys) susVectorDestroy(keys);
+	SUS_BENCH_CHECK(ok);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
@@ -0,0 +1,90 @@
+// main.c
+//
+#include "framework.h"
+#include "bench.h"
+
+int _fltused = 1;
+
+volatile SIZE_T susBenchSink = 0;
+
+// -------------------------------------------------------------------
+
+// All the benchmarks
+static const SUS_BENCH SUSBenchmarks[] = {
+	{ "list.churn", susBenchListChurn },
+	{ "growth.churn", susBenchGrowthChurn },
+	{ "deque.queue", susBenchDequeQueue },
+	{ "buffer.messages", susBenchBufferMessages },
+	{ "buffer.consumeinsert", susBenchBufferConsumeInsert },
+	{ "memory.blocks", susBenchMemoryBlocks },
+	{ "memory.find", susBenchMemoryFind },
+	{ "memory.remotefree", susBenchMemoryRemoteFree },
+	{ "sort.numbers", susBenchSortNumbers },
+	{ "sort.search", susBenchSortSearch },
+	{ "fileio.large", susBenchFileioLargeFiles },
+	{ "map.keys", susBenchMapKeys },
+	{ "map.rehash", susBenchMapRehash },
+	{ "map.hash", susBenchMapHash },
+	{ "map.longkeys", susBenchMapLongKeys },
+	{ "map.batch", susBenchMapBatch },
+	{ "cmap.readmostly", susBenchCMapReadMostly },
+	{ "cmap.writeheavy", susBenchCMapWriteHeavy },
+	{ "tree.ordered", susBenchTreeOrdered },
+};
+
+// -------------------------------------------------------------------
+
+// Print the time of an operation
+VOID SUSAPI susBenchReport(_In_ LPCSTR name, _In_ sus_u64_t ns, _In_ sus_u64_t ops) {
+	sus_u64_t tenths = ops ? ns * 10 / ops : 0;
+	sus_printfA("\t%s: %p.%d ns/op (%p ops, %p ms)\n", name, (SIZE_T)(tenths / 10), (INT)(tenths % 10), (SIZE_T)ops, (SIZE_T)(ns / 1000000));
+}
+
+// Print the percentiles of the operation times (samples - times of the operations in nanoseconds as sus_u64_t, they are sorted)
+BOOL SUSAPI susBenchReportPercentiles(_In_ LPCSTR name, _Inout_ SUS_VECTOR samples) {
+	if (!samples->length || !susVectorRadixSort64(samples)) return FALSE;
+	const sus_u64_t* data = (const sus_u64_t*)samples->data;
+	sus_u64_t count = samples->length;
+	sus_printfA("\t%s: p50 %p ns, p99 %p ns, p99.9 %p ns, max %p ns (%p ops)\n", name,
+		(SIZE_T)data[count / 2], (SIZE_T)data[count * 99 / 100], (SIZE_T)data[count * 999 / 1000], (SIZE_T)data[count - 1], (SIZE_T)count
+	);
+	return TRUE;
+}
+
+// Check whether the benchmark is selected by the command line
+static BOOL SUSAPI susBenchSelected(_In_ LPCSTR name, _In_ LPCSTR args) {
+	BOOL empty = TRUE;
+	while (*args) {
+		while (*args == ' ' || *args == '\t') args++;
+		if (!*args) break;
+		empty = FALSE;
+		LPCSTR prefix = name;
+		while (*args && *args != ' ' && *args != '\t' && *args == *prefix) { args++; prefix++; }
+		if (!*args || *args == ' ' || *args == '\t') return TRUE;
+		while (*args && *args != ' ' && *args != '\t') args++;
+	}
+	return empty;
+}
+
+int main()
+{
+	// Skipping the name of the program
+	LPCSTR args = GetCommandLineA();
+	if (*args == '"') {
+		args++;
+		while (*args && *args != '"') args++;
+		if (*args) args++;
+	}
+	else while (*args && *args != ' ' && *args != '\t') args++;
+	INT failed = 0;
+	for (sus_uint_t i = 0; i < SUS_COUNT_OF(SUSBenchmarks); i++) {
+		if (!susBenchSelected(SUSBenchmarks[i].name, args)) continue;
+		sus_printfA("%s\n", SUSBenchmarks[i].name);
+		if (!SUSBenchmarks[i].func()) {
+			sus_printfA("\tFAILED\n");
+			failed++;
+		}
+	}
+	sus_printfA("%d failed\n", failed);
+	sus_exit(failed);
+}
@@ -0,0 +1,250 @@
+// memkernels_test.c
+//
+// Correctness checks and microbenchmarks of the memory kernels
+// The program uses the C runtime and is built outside of SUSBench:
+//	gcc -O2 -I.. memkernels_test.c ../memkernels.c -o memkernels_test
+//	clang -O2 -I.. memkernels_test.c ../memkernels.c -o memkernels_test
+//	cl /O2 /I.. memkernels_test.c ..\memkernels.c
+// Arguments: [-quick] skips the benchmarks
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <Windows.h>
+#endif // !_WIN32
+#include "include/susfwk/memkernels.h"
+
+// Names of the instruction sets
+static const char* SUSIsaNames[] = { "auto", "portable", "sse2", "avx2" };
+
+static int susTestFailed = 0;
+static volatile size_t susTestSink = 0;
+
+// Report a failed check
+#define SUS_TEST_CHECK(expr, ...) do { if (!(expr)) { if (susTestFailed++ < 20) { printf("\tcheck failed: " __VA_ARGS__); printf("\n"); } } } while (0)
+
+// Fill the memory with pseudo-random bytes
+static void susTestFill(unsigned char* data, size_t size, unsigned int seed)
+{
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245u + 12345u;
+		data[i] = (unsigned char)(seed >> 16);
+	}
+}
+
+// Get the monotonic time in nanoseconds
+static unsigned long long susTestNow(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER t, hz;
+	QueryPerformanceCounter(&t);
+	QueryPerformanceFrequency(&hz);
+	return (unsigned long long)(t.QuadPart / hz.QuadPart * 1000000000ull + t.QuadPart % hz.QuadPart * 1000000000ull / hz.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+#endif // !_WIN32
+}
+
+// -------------------------------------
+
+// Sizes of the checked blocks: around the vector widths, the unrolled loops and the streaming threshold
+static const size_t SUSTestSizes[] = {
+	17, 18, 23, 24, 31, 32, 33, 47, 48, 63, 64, 65, 95, 96, 127, 128, 129, 255, 256, 257, 1000, 4095, 4096, 4097, 65537,
+	SUS_MEMORY_STREAM_SIZE - 1, SUS_MEMORY_STREAM_SIZE, SUS_MEMORY_STREAM_SIZE + 33
+};
+#define SUS_TEST_SIZE_COUNT (sizeof(SUSTestSizes) / sizeof(*SUSTestSizes))
+// Offsets of the blocks from the aligned base
+static const size_t SUSTestOffsets[] = { 0, 1, 7, 31 };
+#define SUS_TEST_OFFSET_COUNT (sizeof(SUSTestOffsets) / sizeof(*SUSTestOffsets))
+#define SUS_TEST_BUFFER_SIZE (SUS_MEMORY_STREAM_SIZE * 2 + 256)
+
+// Check the copy, set, compare and zero kernels
+static void susTestBlocks(const SUS_MEMORY_KERNELS* kernels, unsigned char* a, unsigned char* b, unsigned char* ref)
+{
+	for (size_t s = 0; s < SUS_TEST_SIZE_COUNT; s++) {
+		size_t size = SUSTestSizes[s];
+		for (size_t o = 0; o < SUS_TEST_OFFSET_COUNT; o++) {
+			size_t off = SUSTestOffsets[o];
+			// Copy
+			susTestFill(a, size + 64, (unsigned int)(size + off));
+			memset(b, 0xCC, size + 64);
+			kernels->copy((char*)b + off, (char*)a + 3, size);
+			SUS_TEST_CHECK(!memcmp(b + off, a + 3, size), "copy size %zu offset %zu", size, off);
+			SUS_TEST_CHECK(b[off + size] == 0xCC && (!off || b[off - 1] == 0xCC), "copy overrun size %zu offset %zu", size, off);
+			// Compare
+			SUS_TEST_CHECK(kernels->compare((char*)b + off, (char*)a + 3, size), "compare equal size %zu", size);
+			size_t pos[3] = { 0, size / 2, size - 1 };
+			for (int p = 0; p < 3; p++) {
+				b[off + pos[p]] ^= 0x80;
+				SUS_TEST_CHECK(!kernels->compare((char*)b + off, (char*)a + 3, size), "compare differs size %zu at %zu", size, pos[p]);
+				b[off + pos[p]] ^= 0x80;
+			}
+			// Set and zero check
+			memset(b, 0xCC, size + 64);
+			kernels->set((char*)b + off, 0, size);
+			SUS_TEST_CHECK(kernels->iszero((char*)b + off, size), "iszero size %zu offset %zu", size, off);
+			SUS_TEST_CHECK(b[off + size] == 0xCC && (!off || b[off - 1] == 0xCC), "set overrun size %zu offset %zu", size, off);
+			for (int p = 0; p < 3; p++) {
+				b[off + pos[p]] = 1;
+				SUS_TEST_CHECK(!kernels->iszero((char*)b + off, size), "iszero nonzero size %zu at %zu", size, pos[p]);
+				b[off + pos[p]] = 0;
+			}
+			kernels->set((char*)b + off, 0xA5, size);
+			memset(ref, 0xA5, size);
+			SUS_TEST_CHECK(!memcmp(b + off, ref, size), "set size %zu offset %zu", size, off);
+		}
+		// Overlapping moves in both directions
+		size_t shifts[] = { 1, 8, 33, size / 2 };
+		for (size_t d = 0; d < sizeof(shifts) / sizeof(*shifts); d++) {
+			size_t shift = shifts[d];
+			susTestFill(a, size + shift + 64, (unsigned int)size);
+			memcpy(ref, a, size + shift + 64);
+			memmove(ref + shift, ref, size);
+			kernels->move((char*)a + shift, (char*)a, size);
+			SUS_TEST_CHECK(!memcmp(a, ref, size + shift + 64), "move forward size %zu shift %zu", size, shift);
+			susTestFill(a, size + shift + 64, (unsigned int)size);
+			memcpy(ref, a, size + shift + 64);
+			memmove(ref, ref + shift, size);
+			kernels->move((char*)a, (char*)a + shift, size);
+			SUS_TEST_CHECK(!memcmp(a, ref, size + shift + 64), "move backward size %zu shift %zu", size, shift);
+		}
+	}
+}
+
+// Find the element by the naive scan
+static size_t susTestFindNaive(const unsigned char* data, size_t count, const unsigned char* key, size_t size)
+{
+	for (size_t i = 0; i < count; i++) if (!memcmp(data + i * size, key, size)) return i;
+	return (size_t)-1;
+}
+
+// Check the find kernel
+static void susTestFind(const SUS_MEMORY_KERNELS* kernels, unsigned char* data)
+{
+	static const size_t counts[] = { 0, 1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 64, 100, 257, 1000 };
+	for (size_t size = 1; size <= 16; size <<= 1) {
+		for (size_t c = 0; c < sizeof(counts) / sizeof(*counts); c++) {
+			size_t count = counts[c];
+			// Element bytes have the high bit set to catch sign extension of the key
+			for (size_t i = 0; i < count * size; i++) data[i] = (unsigned char)(0x80 | (i % 0x7F));
+			unsigned char key[16];
+			for (size_t i = 0; i < size; i++) key[i] = 0xFF;
+			SUS_TEST_CHECK(kernels->find((char*)data, count, (char*)key, size) == (size_t)-1, "find missing size %zu count %zu", size, count);
+			size_t at[] = { 0, count / 2, count ? count - 1 : 0 };
+			for (int p = 0; p < 3 && count; p++) {
+				memcpy(data + at[p] * size, key, size);
+				size_t expected = susTestFindNaive(data, count, key, size);
+				size_t found = kernels->find((char*)data, count, (char*)key, size);
+				SUS_TEST_CHECK(found == expected, "find size %zu count %zu at %zu: %zu", size, count, at[p], found);
+			}
+			// A key split across two elements must not match
+			if (count >= 2 && size > 1) {
+				for (size_t i = 0; i < count * size; i++) data[i] = (unsigned char)(0x80 | (i % 0x7F));
+				memcpy(key, data + size / 2, size);
+				size_t expected = susTestFindNaive(data, count, key, size);
+				SUS_TEST_CHECK(kernels->find((char*)data, count, (char*)key, size) == expected, "find unaligned key size %zu count %zu", size, count);
+			}
+		}
+	}
+}
+
+// -------------------------------------
+
+// The C runtime is called through the pointers, so the compiler does not inline or hoist the measured calls
+static void* (*volatile susLibcCopy)(void*, const void*, size_t) = memcpy;
+static void* (*volatile susLibcSet)(void*, int, size_t) = memset;
+static int (*volatile susLibcCompare)(const void*, const void*, size_t) = memcmp;
+
+// Sizes of the benchmarked blocks
+static const size_t SUSBenchSizes[] = { 1, 8, 17, 32, 64, 256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 16777216, 67108864 };
+#define SUS_BENCH_SIZE_COUNT (sizeof(SUSBenchSizes) / sizeof(*SUSBenchSizes))
+#define SUS_BENCH_BYTES 0x20000000ull
+
+// Get the number of the repetitions for the block size
+static size_t susBenchRepeat(size_t size) {
+	size_t n = (size_t)(SUS_BENCH_BYTES / (size + 64));
+	return n < 4 ? 4 : n;
+}
+
+// Print the throughput of the operation
+static void susBenchPrint(const char* name, size_t size, size_t repeat, unsigned long long ns) {
+	printf("\t%-10s %9zu B: %8.2f ns/op %9.2f GB/s\n", name, size, (double)ns / (double)repeat, ns ? (double)size * (double)repeat / (double)ns : 0.0);
+}
+
+// Measure the kernels against the C runtime
+static void susBenchKernels(const char* name, const SUS_MEMORY_KERNELS* kernels, unsigned char* a, unsigned char* b)
+{
+	printf("%s\n", name);
+	for (size_t s = 0; s < SUS_BENCH_SIZE_COUNT; s++) {
+		size_t size = SUSBenchSizes[s], repeat = susBenchRepeat(size);
+		// The kernels require blocks larger than SUS_MEMORY_INLINE_SIZE, memory.h handles the rest inline
+		if (kernels && size <= SUS_MEMORY_INLINE_SIZE) continue;
+		unsigned long long t = susTestNow();
+		if (kernels) for (size_t i = 0; i < repeat; i++) kernels->copy((char*)b, (char*)a, size);
+		else for (size_t i = 0; i < repeat; i++) susLibcCopy(b, a, size);
+		susBenchPrint("copy", size, repeat, susTestNow() - t);
+		t = susTestNow();
+		if (kernels) for (size_t i = 0; i < repeat; i++) kernels->set((char*)b, (unsigned char)i, size);
+		else for (size_t i = 0; i < repeat; i++) susLibcSet(b, (int)i, size);
+		susBenchPrint("set", size, repeat, susTestNow() - t);
+		memcpy(b, a, size);
+		t = susTestNow();
+		size_t sum = 0;
+		if (kernels) for (size_t i = 0; i < repeat; i++) sum += (size_t)kernels->compare((char*)a, (char*)b, size);
+		else for (size_t i = 0; i < repeat; i++) sum += (size_t)!susLibcCompare(a, b, size);
+		susBenchPrint("compare", size, repeat, susTestNow() - t);
+		susTestSink += sum;
+		unsigned int key = 0xFFFFFFFFu;
+		size_t count = size / 4;
+		t = susTestNow();
+		if (kernels) for (size_t i = 0; i < repeat; i++) sum += kernels->find((char*)a, count, (char*)&key, 4);
+		else for (size_t i = 0; i < repeat; i++) sum += susTestFindNaive(a, count, (unsigned char*)&key, 4);
+		susBenchPrint("find u32", size, repeat, susTestNow() - t);
+		susTestSink += sum;
+	}
+}
+
+// -------------------------------------
+
+int main(int argc, char** argv)
+{
+	int quick = argc > 1 && !strcmp(argv[1], "-quick");
+	size_t bytes = SUS_TEST_BUFFER_SIZE > 67108864 + 64 ? SUS_TEST_BUFFER_SIZE : 67108864 + 64;
+	unsigned char* a = (unsigned char*)malloc(bytes);
+	unsigned char* b = (unsigned char*)malloc(bytes);
+	unsigned char* ref = (unsigned char*)malloc(bytes);
+	if (!a || !b || !ref) {
+		printf("out of memory\n");
+		return 1;
+	}
+	SUS_MEMORY_ISA best = susMemoryDetectIsa();
+	printf("detected: %s\n", SUSIsaNames[best]);
+	for (int isa = SUS_MEMORY_ISA_PORTABLE; isa <= SUS_MEMORY_ISA_AVX2; isa++) {
+		const SUS_MEMORY_KERNELS* kernels = susMemoryGetKernels((SUS_MEMORY_ISA)isa);
+		if (!kernels || isa > (int)best) {
+			printf("%s: skipped\n", SUSIsaNames[isa]);
+			continue;
+		}
+		int failed = susTestFailed;
+		susTestBlocks(kernels, a, b, ref);
+		susTestFind(kernels, a);
+		printf("%s: %s\n", SUSIsaNames[isa], failed == susTestFailed ? "ok" : "FAILED");
+	}
+	if (!quick && !susTestFailed) {
+		susTestFill(a, bytes, 1);
+		susBenchKernels("libc", NULL, a, b);
+		for (int isa = SUS_MEMORY_ISA_PORTABLE; isa <= (int)best; isa++) {
+			const SUS_MEMORY_KERNELS* kernels = susMemoryGetKernels((SUS_MEMORY_ISA)isa);
+			if (kernels) susBenchKernels(SUSIsaNames[isa], kernels, a, b);
+		}
+	}
+	free(a);
+	free(b);
+	free(ref);
+	printf("%d failed\n", susTestFailed);
+	return susTestFailed != 0;
+}
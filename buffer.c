@@ -1,55 +1,157 @@
 // buffer.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_BUFFER
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/buffer.h"
 
 // ---------------------------------------------------------------------------------------
 
-// reate a new buffer
-SUS_BUFFER SUSAPI susNewBuffer(_In_opt_ sus_size32_t capacity) {
+// Get the capacity for the required size
+sus_csize_t SUSAPI susGrowthPolicyGrow(_In_ SUS_GROWTH_POLICY policy, _In_ sus_csize_t required) {
+	if (policy == SUS_GROWTH_POLICY_POW2) {
+		sus_csize_t capacity = 1;
+		while (capacity && capacity < required) capacity <<= 1;
+		return capacity ? capacity : required;
+	}
+	// The growth step is limited by the largest size of the container
+	if ((sus_float_t)required * SUS_BUFFER_GROW_FACTOR >= (sus_float_t)SUS_CSIZE_MAX) return SUS_CSIZE_MAX;
+	return max((sus_csize_t)((sus_float_t)required * SUS_BUFFER_GROW_FACTOR), required);
+}
+// Get the capacity after the removal
+sus_csize_t SUSAPI susGrowthPolicyShrink(_In_ SUS_GROWTH_POLICY policy, _In_ sus_csize_t size, _In_ sus_csize_t capacity, _In_ sus_csize_t minCapacity, _Inout_ sus_u16_t* underload) {
+	SUS_ASSERT(underload);
+	if (!susGrowthPolicyIsUnderloaded(policy, size, capacity, minCapacity)) {
+		*underload = 0;
+		return capacity;
+	}
+	switch (policy) {
+	case SUS_GROWTH_POLICY_POW2: return susGrowthPolicyGrow(policy, max(size * 2, minCapacity));
+	case SUS_GROWTH_POLICY_HYSTERESIS: {
+		// The container is used in bursts - keep the memory until the load stays low
+		if (++*underload < SUS_BUFFER_SHRINK_DELAY) return capacity;
+		*underload = 0;
+		return max(size * 2, minCapacity);
+	}
+	default: return max((sus_csize_t)((sus_float_t)size * SUS_BUFFER_GROW_FACTOR), minCapacity);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+// Create a new buffer in the allocator memory
+SUS_BUFFER SUSAPI susNewBufferAllocator(_In_opt_ sus_csize_t capacity, _In_opt_ SUS_LPALLOCATOR allocator) {
 	SUS_PRINTDL("Creating a new buffer");
 	if (!capacity) capacity = SUS_BUFFER_CAPACITY;
-	SUS_BUFFER buffer = sus_malloc(sizeof(SUS_BUFFER_STRUCT) + capacity);
+	SUS_BUFFER buffer = susAllocatorAlloc(allocator, sizeof(SUS_BUFFER_STRUCT) + capacity);
 	if (!buffer) return NULL;
 	buffer->capacity = capacity;
 	buffer->size = 0;
+	buffer->head = 0;
+	buffer->allocator = allocator;
+	buffer->policy = SUS_GROWTH_POLICY_FACTOR;
+	buffer->underload = 0;
+	return buffer;
+}
+// reate a new buffer
+SUS_BUFFER SUSAPI susNewBufferEx(_In_opt_ sus_csize_t capacity, _In_opt_ SIZE_T alignment) {
+	SUS_LPALLOCATOR allocator = NULL;
+	if (alignment > MEMORY_ALLOCATION_ALIGNMENT) {
+		allocator = susAlignedAllocator(alignment, sizeof(SUS_BUFFER_STRUCT));
+		if (!allocator) return NULL;
+	}
+	return susNewBufferAllocator(capacity, allocator);
+}
+// Create a new buffer that grows in place inside a reserved region
+SUS_BUFFER SUSAPI susNewBufferRegion(_In_opt_ sus_csize_t capacity, _In_ SIZE_T maxCapacity, _In_ SUS_VREGION_FLAGS flags) {
+	SUS_ASSERT(maxCapacity && capacity <= maxCapacity);
+	// The growth step may overshoot the maximum, the reserve only costs address space
+	SUS_LPVREGION region = susNewVRegion(sizeof(SUS_BUFFER_STRUCT) + maxCapacity * 2, flags);
+	if (!region) return NULL;
+	SUS_BUFFER buffer = susNewBufferAllocator(capacity, &region->super);
+	if (!buffer) susVRegionDestroy(region);
 	return buffer;
 }
 // Delete Buffer
 VOID SUSAPI susBufferDestroy(_In_ SUS_BUFFER buffer) {
 	SUS_PRINTDL("Deleting a buffer");
 	SUS_ASSERT(buffer);
-	sus_free(buffer);
+	susAllocatorFree(buffer->allocator, buffer, sizeof(SUS_BUFFER_STRUCT) + buffer->capacity);
 }
-// Apply changes to the buffer
-BOOL SUSAPI susBufferFlush(_Inout_ SUS_LPBUFFER lpBuffer) {
+// Change the capacity of the buffer
+static BOOL SUSAPI susBufferResize(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t oldCapacity) {
 	SUS_ASSERT(lpBuffer && *lpBuffer);
-	SUS_BUFFER newBuffer = (SUS_BUFFER)sus_realloc(*lpBuffer, sizeof(SUS_BUFFER_STRUCT) + (*lpBuffer)->capacity);
-	if (!newBuffer) return FALSE;
+	SUS_BUFFER buffer = *lpBuffer;
+	SUS_BUFFER newBuffer = (SUS_BUFFER)susAllocatorRealloc(buffer->allocator, buffer, sizeof(SUS_BUFFER_STRUCT) + oldCapacity, sizeof(SUS_BUFFER_STRUCT) + buffer->capacity);
+	if (!newBuffer) {
+		buffer->capacity = oldCapacity;
+		return FALSE;
+	}
 	*lpBuffer = newBuffer;
 	return TRUE;
 }
+// Apply changes to the buffer
+BOOL SUSAPI susBufferFlush(_Inout_ SUS_LPBUFFER lpBuffer) {
+	SUS_ASSERT(lpBuffer && *lpBuffer);
+	return susBufferResize(lpBuffer, (*lpBuffer)->capacity);
+}
 
 // ---------------------------------------------------------------------------------------
 
-// Guaranteed buffer size
-static BOOL SUSAPI susBufferReserve(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t reserve) {
+// Guarantee the space for the specified number of bytes after the end of the data
+BOOL SUSAPI susBufferReserve(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t reserve) {
 	SUS_ASSERT(lpBuffer && *lpBuffer);
 	SUS_BUFFER buffer = *lpBuffer;
+	if (reserve > SUS_CSIZE_MAX - buffer->size) {
+		SUS_PRINTDE("The buffer size exceeds the limit of sus_csize_t");
+		return FALSE;
+	}
 	if (buffer->capacity < buffer->size + reserve) {
-		buffer->capacity = (sus_size32_t)(((sus_float_t)buffer->size + reserve) * SUS_BUFFER_GROW_FACTOR);
-		return susBufferFlush(lpBuffer);
+		sus_csize_t oldCapacity = buffer->capacity;
+		buffer->capacity = susGrowthPolicyGrow(buffer->policy, buffer->size + reserve);
+		buffer->underload = 0;
+		return susBufferResize(lpBuffer, oldCapacity);
 	}
 	return TRUE;
 }
-// Shrink the buffer to the minimum size
+// Shrink the capacity of the buffer to its size
+BOOL SUSAPI susBufferShrinkToFit(_Inout_ SUS_LPBUFFER lpBuffer) {
+	SUS_ASSERT(lpBuffer && *lpBuffer);
+	SUS_BUFFER buffer = *lpBuffer;
+	susBufferCompact(buffer);
+	sus_csize_t capacity = max(buffer->size, 1);
+	if (buffer->capacity == capacity) return TRUE;
+	sus_csize_t oldCapacity = buffer->capacity;
+	buffer->capacity = capacity;
+	buffer->underload = 0;
+	return susBufferResize(lpBuffer, oldCapacity);
+}
+// Move the unread data to the beginning of the storage
+VOID SUSAPI susBufferCompact(_Inout_ SUS_BUFFER buffer) {
+	SUS_ASSERT(buffer);
+	if (!buffer->head) return;
+	sus_memmove(buffer->data, buffer->data + buffer->head, susBufferReadSize(buffer));
+	buffer->size -= buffer->head;
+	buffer->head = 0;
+}
+// Get the free space at the end of the buffer for direct writing
+sus_lpbyte_t SUSAPI susBufferPrepare(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t size) {
+	SUS_ASSERT(lpBuffer && *lpBuffer);
+	SUS_BUFFER buffer = *lpBuffer;
+	// The consumed space is reused once no less data is consumed than is left to move
+	if (buffer->capacity - buffer->size < size && buffer->head && buffer->head >= susBufferReadSize(buffer)) susBufferCompact(buffer);
+	if (!susBufferReserve(lpBuffer, size)) return NULL;
+	return (*lpBuffer)->data + (*lpBuffer)->size;
+}
+// Shrink the buffer according to its policy
 static BOOL SUSAPI susBufferCompress(_Inout_ SUS_LPBUFFER lpBuffer) {
 	SUS_ASSERT(lpBuffer && *lpBuffer);
 	SUS_BUFFER buffer = *lpBuffer;
-	if (buffer->capacity > SUS_BUFFER_CAPACITY * SUS_BUFFER_GROW_FACTOR && buffer->capacity > buffer->size * SUS_BUFFER_SHRINK_THRESHOLD) {
-		buffer->capacity = (sus_size32_t)((sus_float_t)buffer->size * SUS_BUFFER_GROW_FACTOR);
-		return susBufferFlush(lpBuffer);
+	sus_csize_t capacity = susGrowthPolicyShrink(buffer->policy, buffer->size, buffer->capacity, SUS_BUFFER_CAPACITY, &buffer->underload);
+	if (capacity < buffer->capacity) {
+		sus_csize_t oldCapacity = buffer->capacity;
+		buffer->capacity = capacity;
+		return susBufferResize(lpBuffer, oldCapacity);
 	}
 	return TRUE;
 }
@@ -57,30 +159,30 @@ static BOOL SUSAPI susBufferCompress(_Inout_ SUS_LPBUFFER lpBuffer) {
 // ---------------------------------------------------------------------------------------
 
 // Paste the data into the buffer
-SUS_LPMEMORY SUSAPI susBufferInsert(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t pos, _In_opt_ sus_lpbyte_t data, _In_ sus_size32_t size)
+SUS_LPMEMORY SUSAPI susBufferInsert(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t pos, _In_opt_ sus_lpbyte_t data, _In_ sus_csize_t size)
 {
 	SUS_PRINTDL("Inserting an item into the buffer");
 	SUS_ASSERT(lpBuffer && *lpBuffer && pos <= (*lpBuffer)->size);
 	if (!susBufferReserve(lpBuffer, size)) return NULL;
 	SUS_BUFFER buffer = *lpBuffer;
-	sus_size32_t byteToMove = buffer->size - pos;
+	sus_csize_t byteToMove = buffer->size - pos;
 	if (byteToMove) sus_memmove(buffer->data + pos + size, buffer->data + pos, byteToMove);
 	if (data) sus_memcpy(buffer->data + pos, data, size);
 	buffer->size += size;
 	return buffer->data + pos;
 }
 // Paste the data into the buffer
-BOOL SUSAPI susBufferErase(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t pos, _In_ sus_size32_t size)
+BOOL SUSAPI susBufferErase(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t pos, _In_ sus_csize_t size)
 {
 	SUS_PRINTDL("Deleting an item from the buffer");
 	SUS_ASSERT(lpBuffer && *lpBuffer && pos + size <= (*lpBuffer)->size);
 	SUS_BUFFER buffer = *lpBuffer;
-	sus_memmove(buffer->data + pos, buffer->data + pos + size, (sus_size_t)(buffer->size - pos));
+	sus_memmove(buffer->data + pos, buffer->data + pos + size, (sus_size_t)(buffer->size - pos - size));
 	buffer->size -= size;
 	return susBufferCompress(lpBuffer);
 }
 // Set the data to the buffer
-SUS_LPMEMORY SUSAPI susBufferSet(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t pos, _In_opt_ sus_lpbyte_t data, _In_ sus_size32_t size)
+SUS_LPMEMORY SUSAPI susBufferSet(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t pos, _In_opt_ sus_lpbyte_t data, _In_ sus_csize_t size)
 {
 	SUS_ASSERT(lpBuffer && *lpBuffer && pos + size <= (*lpBuffer)->size);
 	SUS_BUFFER buffer = *lpBuffer;
@@ -89,7 +191,7 @@ SUS_LPMEMORY SUSAPI susBufferSet(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_
 	return buffer->data + pos;
 }
 // Swap two buffer elements
-BOOL SUSAPI susBufferSwap(_Inout_ SUS_BUFFER buffer, _In_ sus_size32_t from, _In_ sus_size32_t to, _In_ sus_size32_t size)
+BOOL SUSAPI susBufferSwap(_Inout_ SUS_BUFFER buffer, _In_ sus_csize_t from, _In_ sus_csize_t to, _In_ sus_csize_t size)
 {
 	SUS_PRINTDL("Swapping buffer data");
 	SUS_ASSERT(buffer && from + size <= buffer->size && to + size <= buffer->size);
@@ -0,0 +1,243 @@
+// chain.c
+//
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_BUFFER
+#include "coreframe.h"
+#include "include/susfwk/core.h"
+#include "include/susfwk/memory.h"
+#include "include/susfwk/chain.h"
+
+// =======================================================================================
+
+// Free space before the data of the first block for the headers
+#define SUS_CHAIN_HEADROOM 64
+
+// Shared block pool
+static SUS_POOL SUSChainPool = { 0 };
+// Initialization of the shared block pool
+static INIT_ONCE SUSChainPoolInitOnce = INIT_ONCE_STATIC_INIT;
+
+// Create the shared block pool
+static BOOL CALLBACK susChainPoolInit(_Inout_ PINIT_ONCE initOnce, _Inout_opt_ PVOID param, _Out_opt_ PVOID* context)
+{
+	UNREFERENCED_PARAMETER(initOnce);
+	UNREFERENCED_PARAMETER(param);
+	UNREFERENCED_PARAMETER(context);
+	SUSChainPool = susPoolSetup(SUS_CHAIN_BLOCK_SIZE);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Get the storage size of the pool blocks
+SUS_INLINE sus_size32_t SUSAPI susChainBlockCapacity(_In_ SUS_LPCHAIN chain) {
+	return (sus_size32_t)(chain->pool->objectSize - sizeof(SUS_CHAIN_BLOCK));
+}
+// Create a block (the blocks larger than the pool blocks are allocated in the heap)
+static SUS_LPCHAIN_BLOCK SUSAPI susChainNewBlock(_Inout_ SUS_LPCHAIN chain, _In_ SIZE_T capacity)
+{
+	SUS_LPCHAIN_BLOCK block;
+	if (capacity <= susChainBlockCapacity(chain)) {
+		block = susPoolAlloc(chain->pool);
+		capacity = susChainBlockCapacity(chain);
+	}
+	else {
+		// The offsets of the block are 32-bit
+		if (capacity > MAXDWORD) return NULL;
+		block = sus_malloc(sizeof(SUS_CHAIN_BLOCK) + capacity);
+	}
+	if (!block) return NULL;
+	block->next = NULL;
+	block->begin = block->end = 0;
+	block->capacity = (sus_size32_t)capacity;
+	return block;
+}
+// Free the block
+static VOID SUSAPI susChainFreeBlock(_Inout_ SUS_LPCHAIN chain, _In_ SUS_LPCHAIN_BLOCK block)
+{
+	if (block->capacity == susChainBlockCapacity(chain)) susPoolFree(chain->pool, block);
+	else sus_free(block);
+}
+
+// -------------------------------------------------------------------
+
+// Create a chain with the blocks from the pool
+SUS_CHAIN SUSAPI susChainSetupEx(_In_opt_ SUS_LPPOOL pool)
+{
+	if (!pool) {
+		InitOnceExecuteOnce(&SUSChainPoolInitOnce, susChainPoolInit, NULL, NULL);
+		pool = &SUSChainPool;
+	}
+	SUS_ASSERT(pool->objectSize > sizeof(SUS_CHAIN_BLOCK) + SUS_CHAIN_HEADROOM);
+	return (SUS_CHAIN) { .pool = pool };
+}
+// Free all the chain blocks
+VOID SUSAPI susChainCleanup(_Inout_ SUS_LPCHAIN chain)
+{
+	SUS_ASSERT(chain && chain->pool);
+	for (SUS_LPCHAIN_BLOCK block = chain->first; block;) {
+		SUS_LPCHAIN_BLOCK next = block->next;
+		susChainFreeBlock(chain, block);
+		block = next;
+	}
+	chain->first = chain->last = NULL;
+	chain->size = 0;
+}
+
+// -------------------------------------------------------------------
+
+// =======================================================================================
+
+// -------------------------------------------------------------------
+
+// Get the free space at the end of the chain for direct writing
+sus_lpbyte_t SUSAPI susChainPrepare(_Inout_ SUS_LPCHAIN chain, _Out_ sus_size32_t* available)
+{
+	SUS_ASSERT(chain && chain->pool && available);
+	SUS_LPCHAIN_BLOCK last = chain->last;
+	if (!last || last->end == last->capacity) {
+		SUS_LPCHAIN_BLOCK block = susChainNewBlock(chain, 0);
+		if (!block) return NULL;
+		if (last) last->next = block;
+		else {
+			// The first block keeps a space for the headers
+			block->begin = block->end = SUS_CHAIN_HEADROOM;
+			chain->first = block;
+		}
+		chain->last = last = block;
+	}
+	*available = last->capacity - last->end;
+	return last->data + last->end;
+}
+// Add the bytes written to the prepared space to the data
+VOID SUSAPI susChainCommit(_Inout_ SUS_LPCHAIN chain, _In_ sus_size32_t size)
+{
+	SUS_ASSERT(chain && (!size || (chain->last && chain->last->end + size <= chain->last->capacity)));
+	if (!size) return;
+	chain->last->end += size;
+	chain->size += size;
+}
+// Add the data to the end of the chain
+BOOL SUSAPI susChainAppend(_Inout_ SUS_LPCHAIN chain, _In_reads_bytes_(size) const sus_lpbyte_t data, _In_ SIZE_T size)
+{
+	SUS_ASSERT(chain && (data || !size));
+	for (SIZE_T written = 0; written < size;) {
+		sus_size32_t available;
+		sus_lpbyte_t space = susChainPrepare(chain, &available);
+		if (!space) return FALSE;
+		sus_size32_t part = (sus_size32_t)min(available, size - written);
+		sus_memcpy(space, data + written, part);
+		susChainCommit(chain, part);
+		written += part;
+	}
+	return TRUE;
+}
+// Add the data to the beginning of the chain
+BOOL SUSAPI susChainPrepend(_Inout_ SUS_LPCHAIN chain, _In_reads_bytes_(size) const sus_lpbyte_t data, _In_ SIZE_T size)
+{
+	SUS_ASSERT(chain && chain->pool && (data || !size));
+	while (size) {
+		SUS_LPCHAIN_BLOCK first = chain->first;
+		if (!first || !first->begin) {
+			// The new block is filled from the end, so the next headers fit before the data
+			SUS_LPCHAIN_BLOCK block = susChainNewBlock(chain, 0);
+			if (!block) return FALSE;
+			block->begin = block->end = block->capacity;
+			block->next = first;
+			chain->first = first = block;
+			if (!chain->last) chain->last = block;
+		}
+		sus_size32_t part = (sus_size32_t)min(first->begin, size);
+		first->begin -= part;
+		sus_memcpy(first->data + first->begin, data + size - part, part);
+		chain->size += part;
+		size -= part;
+	}
+	return TRUE;
+}
+// Move all the blocks of the source chain to the end of the chain
+VOID SUSAPI susChainSplice(_Inout_ SUS_LPCHAIN chain, _Inout_ SUS_LPCHAIN source)
+{
+	SUS_ASSERT(chain && source && chain != source && chain->pool == source->pool);
+	if (!source->first) return;
+	if (chain->last) chain->last->next = source->first;
+	else chain->first = source->first;
+	chain->last = source->last;
+	chain->size += source->size;
+	source->first = source->last = NULL;
+	source->size = 0;
+}
+// Remove the bytes from the beginning of the chain
+VOID SUSAPI susChainConsume(_Inout_ SUS_LPCHAIN chain, _In_ SIZE_T size)
+{
+	SUS_ASSERT(chain && size <= chain->size);
+	chain->size -= size;
+	while (chain->first) {
+		SUS_LPCHAIN_BLOCK block = chain->first;
+		sus_size32_t length = block->end - block->begin;
+		if (size < length || (!size && block == chain->last)) {
+			block->begin += (sus_size32_t)size;
+			return;
+		}
+		size -= length;
+		chain->first = block->next;
+		susChainFreeBlock(chain, block);
+	}
+	chain->last = NULL;
+}
+
+// -------------------------------------------------------------------
+
+// =======================================================================================
+
+// -------------------------------------------------------------------
+
+// Get the spans of the data in order
+sus_uint_t SUSAPI susChainSpans(_In_ SUS_LPCHAIN chain, _Out_writes_to_(maxCount, return) SUS_LPDATAVIEW spans, _In_ sus_uint_t maxCount)
+{
+	SUS_ASSERT(chain && (spans || !maxCount));
+	sus_uint_t count = 0;
+	for (SUS_LPCHAIN_BLOCK block = chain->first; block && count < maxCount; block = block->next) {
+		if (block->end == block->begin) continue;
+		spans[count++] = susDataView(block->data + block->begin, block->end - block->begin);
+	}
+	return count;
+}
+// Copy the bytes from the beginning of the chain to the buffer
+SIZE_T SUSAPI susChainRead(_In_ SUS_LPCHAIN chain, _Out_writes_bytes_(size) sus_lpbyte_t buffer, _In_ SIZE_T size)
+{
+	SUS_ASSERT(chain && (buffer || !size));
+	SIZE_T copied = 0;
+	for (SUS_LPCHAIN_BLOCK block = chain->first; block && copied < size; block = block->next) {
+		SIZE_T part = min((SIZE_T)(block->end - block->begin), size - copied);
+		sus_memcpy(buffer + copied, block->data + block->begin, part);
+		copied += part;
+	}
+	return copied;
+}
+// Make the data of the chain contiguous
+SUS_DATAVIEW SUSAPI susChainLinearize(_Inout_ SUS_LPCHAIN chain)
+{
+	SUS_PRINTDL("Linearizing a chain of %d bytes", chain->size);
+	SUS_ASSERT(chain && chain->pool);
+	if (!chain->first) return susDataView(NULL, 0);
+	if (chain->first->end - chain->first->begin == chain->size) return susDataView(chain->first->data + chain->first->begin, chain->size);
+	if (chain->size > MAXDWORD) {
+		SUS_PRINTDE("The chain is larger than MAXDWORD bytes and cannot be linearized");
+		return susDataView(NULL, 0);
+	}
+	SUS_LPCHAIN_BLOCK block = susChainNewBlock(chain, chain->size);
+	if (!block) {
+		SUS_PRINTDE("Couldn't linearize the chain");
+		return susDataView(NULL, 0);
+	}
+	block->end = (sus_size32_t)susChainRead(chain, block->data, chain->size);
+	SIZE_T size = chain->size;
+	susChainCleanup(chain);
+	chain->first = chain->last = block;
+	chain->size = size;
+	return susDataView(block->data, size);
+}
+
+// -------------------------------------------------------------------
+
+// =======================================================================================
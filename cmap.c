@@ -0,0 +1,257 @@
+// cmap.c
+//
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_MAP
+#include "coreframe.h"
+#include "include/susfwk/core.h"
+#include "include/susfwk/memory.h"
+#include "include/susfwk/hashtable.h"
+#include "include/susfwk/cmap.h"
+
+// =======================================================================================
+
+// Get the hash of the key spread over all the bits
+SUS_INLINE SUS_HASH_T SUSAPI susCMapHash(_In_ SUS_CMAP map, _In_ const SUS_OBJECT key) {
+	return susHashFinalize(map->getHash((SUS_DATAVIEW) { .data = key, .size = map->keySize }));
+}
+// Get the write lock of the hash (the same for any number of the buckets)
+#define susCMapStripe(map, hash) (&(map)->stripes[(hash) & (SUS_CMAP_STRIPE_COUNT - 1)])
+// Get the bucket of the hash
+#define susCMapBucket(table, hash) (&(table)->buckets[(hash) & ((table)->capacity - 1)])
+// Get the current bucket table
+#define susCMapTable(map) ((SUS_LPCMAP_TABLE)ReadPointerAcquire((PVOID const volatile*)&(map)->table))
+// Get the next node of the chain
+#define susCMapNext(link) ((SUS_LPCMAP_NODE)ReadPointerAcquire((PVOID const volatile*)(link)))
+// Publish the node in the chain
+#define susCMapPublish(link, node) WritePointerRelease((PVOID volatile*)(link), (PVOID)(node))
+
+// -------------------------------------------------------------------
+
+// Enter the reading (\return the epoch of the reader)
+static LONG SUSAPI susCMapReadBegin(_Inout_ SUS_CMAP map, _In_ DWORD slot)
+{
+	for (;;) {
+		LONG epoch = ReadAcquire(&map->epoch);
+		InterlockedIncrement(&map->readers[slot].value.count[epoch & 1]);
+		// The epoch is checked again, so the reclamation that has just advanced it waits for the reader
+		if (ReadAcquire(&map->epoch) == epoch) return epoch;
+		InterlockedDecrement(&map->readers[slot].value.count[epoch & 1]);
+	}
+}
+// Leave the reading
+SUS_INLINE VOID SUSAPI susCMapReadEnd(_Inout_ SUS_CMAP map, _In_ DWORD slot, _In_ LONG epoch) {
+	InterlockedDecrement(&map->readers[slot].value.count[epoch & 1]);
+}
+// Wait until the readers that could see the removed memory leave
+static VOID SUSAPI susCMapSynchronize(_Inout_ SUS_CMAP map)
+{
+	LONG epoch = InterlockedIncrement(&map->epoch) - 1;
+	for (DWORD i = 0; i < SUS_CMAP_READER_SLOTS; i++) {
+		while (ReadAcquire(&map->readers[i].value.count[epoch & 1])) SwitchToThread();
+	}
+}
+// Put the removed memory to the reclamation list (\return the number of the removed blocks)
+static DWORD SUSAPI susCMapRetire(_Inout_ SUS_CMAP map, _In_ SUS_LPCMAP_GARBAGE garbage)
+{
+	AcquireSRWLockExclusive(&map->garbageLock);
+	garbage->next = map->garbage;
+	map->garbage = garbage;
+	DWORD count = ++map->garbageCount;
+	ReleaseSRWLockExclusive(&map->garbageLock);
+	return count;
+}
+// Free the removed memory that is no longer seen by the readers
+VOID SUSAPI susCMapReclaim(_Inout_ SUS_CMAP map)
+{
+	SUS_ASSERT(map);
+	AcquireSRWLockExclusive(&map->reclaimLock);
+	AcquireSRWLockExclusive(&map->garbageLock);
+	SUS_LPCMAP_GARBAGE garbage = map->garbage;
+	map->garbage = NULL;
+	map->garbageCount = 0;
+	ReleaseSRWLockExclusive(&map->garbageLock);
+	if (garbage) {
+		susCMapSynchronize(map);
+		while (garbage) {
+			SUS_LPCMAP_GARBAGE next = garbage->next;
+			sus_free(garbage);
+			garbage = next;
+		}
+	}
+	ReleaseSRWLockExclusive(&map->reclaimLock);
+}
+
+// -------------------------------------------------------------------
+
+// Create a bucket table
+static SUS_LPCMAP_TABLE SUSAPI susCMapNewTable(_In_ DWORD capacity)
+{
+	SUS_LPCMAP_TABLE table = sus_zalloc(sizeof(SUS_CMAP_TABLE) + (SIZE_T)capacity * sizeof(SUS_LPCMAP_NODE));
+	if (!table) return NULL;
+	table->capacity = capacity;
+	return table;
+}
+// Free the bucket table with its nodes
+static VOID SUSAPI susCMapFreeTable(_In_ SUS_LPCMAP_TABLE table)
+{
+	for (DWORD i = 0; i < table->capacity; i++) {
+		for (SUS_LPCMAP_NODE node = table->buckets[i], next; node; node = next) {
+			next = node->next;
+			sus_free(node);
+		}
+	}
+	sus_free(table);
+}
+// Create a node of the key-value pair
+static SUS_LPCMAP_NODE SUSAPI susCMapNewNode(_In_ SUS_CMAP map, _In_ SUS_HASH_T hash, _In_ const SUS_OBJECT key, _In_opt_ const SUS_OBJECT value)
+{
+	SUS_LPCMAP_NODE node = sus_malloc(sizeof(SUS_CMAP_NODE) + map->keySize + map->valueSize);
+	if (!node) return NULL;
+	node->next = NULL;
+	node->hash = hash;
+	sus_memcpy(susCMapNodeKey(map, node), key, map->keySize);
+	if (value) sus_memcpy(susCMapNodeValue(map, node), value, map->valueSize);
+	else sus_zeromem(susCMapNodeValue(map, node), map->valueSize);
+	return node;
+}
+// Find the node of the key in the chain (\return NULL if the key is not found, lpLink - the link to the node or to the chain end)
+static SUS_LPCMAP_NODE SUSAPI susCMapFind(_In_ SUS_CMAP map, _Inout_ SUS_LPCMAP_NODE volatile** lpLink, _In_ const SUS_OBJECT key, _In_ SUS_HASH_T hash)
+{
+	// The link is read once: the writers can change it after the node is taken
+	for (SUS_LPCMAP_NODE node; (node = susCMapNext(*lpLink)); *lpLink = &node->next) {
+		if (node->hash == hash && map->cmpKeys(susCMapNodeKey(map, node), key, map->keySize)) return node;
+	}
+	return NULL;
+}
+
+// -------------------------------------------------------------------
+
+// Create a concurrent hash table
+SUS_CMAP SUSAPI susNewCMapEx(_In_ SIZE_T keySize, _In_ SIZE_T valueSize, _In_opt_ SUS_GET_HASH_CALLBACK getHash, _In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys, _In_opt_ DWORD initCount)
+{
+	SUS_PRINTDL("Creating a new concurrent hash table");
+	SUS_ASSERT(keySize);
+	SUS_CMAP map = sus_malloc_aligned(sizeof(SUS_CMAP_STRUCT), SUS_MEMORY_CACHE_LINE);
+	if (!map) return NULL;
+	sus_zeromem((LPBYTE)map, sizeof(SUS_CMAP_STRUCT));
+	DWORD capacity = SUS_CMAP_INIT_COUNT;
+	while (capacity < initCount && capacity < 0x80000000u) capacity <<= 1;
+	map->table = susCMapNewTable(capacity);
+	if (!map->table) {
+		sus_free_aligned(map);
+		return NULL;
+	}
+	map->keySize = (DWORD)keySize;
+	map->valueSize = (DWORD)valueSize;
+	map->getHash = getHash ? getHash : (keySize <= 4 ? susDefGetHashInt : susDefGetHash);
+	map->cmpKeys = cmpKeys ? cmpKeys : susDefCmpKeys;
+	for (DWORD i = 0; i < SUS_CMAP_STRIPE_COUNT; i++) InitializeSRWLock(&map->stripes[i]);
+	InitializeSRWLock(&map->garbageLock);
+	InitializeSRWLock(&map->reclaimLock);
+	return map;
+}
+// Destroy the concurrent hash table (no other thread may use it)
+VOID SUSAPI susCMapDestroy(_In_ SUS_CMAP map)
+{
+	SUS_PRINTDL("Destroying a concurrent hash table");
+	SUS_ASSERT(map);
+	susCMapFreeTable(map->table);
+	susCMapReclaim(map);
+	sus_free_aligned(map);
+}
+// Double the number of the buckets (the readers go on with the old table, the writers wait for the copy)
+static VOID SUSAPI susCMapGrow(_Inout_ SUS_CMAP map)
+{
+	for (DWORD i = 0; i < SUS_CMAP_STRIPE_COUNT; i++) AcquireSRWLockExclusive(&map->stripes[i]);
+	SUS_LPCMAP_TABLE old = map->table;
+	SUS_LPCMAP_TABLE table = NULL;
+	// Another writer could grow the table while the locks were being taken
+	if ((DWORD)map->count > old->capacity * SUS_CMAP_RATIO && old->capacity < 0x80000000u && (table = susCMapNewTable(old->capacity * 2))) {
+		SUS_PRINTDL("Resizing a concurrent hash table");
+		// The old chains are still walked by the readers, so the nodes are copied
+		for (DWORD i = 0; table && i < old->capacity; i++) {
+			for (SUS_LPCMAP_NODE node = old->buckets[i]; node; node = node->next) {
+				SUS_LPCMAP_NODE copy = susCMapNewNode(map, node->hash, susCMapNodeKey(map, node), susCMapNodeValue(map, node));
+				if (!copy) {
+					susCMapFreeTable(table);
+					table = NULL;
+					break;
+				}
+				SUS_LPCMAP_NODE volatile* bucket = susCMapBucket(table, node->hash);
+				copy->next = *bucket;
+				*bucket = copy;
+			}
+		}
+		if (table) susCMapPublish(&map->table, table);
+	}
+	for (DWORD i = SUS_CMAP_STRIPE_COUNT; i--;) ReleaseSRWLockExclusive(&map->stripes[i]);
+	if (!table) return;
+	for (DWORD i = 0; i < old->capacity; i++) {
+		for (SUS_LPCMAP_NODE node = old->buckets[i], next; node; node = next) {
+			next = node->next;
+			susCMapRetire(map, &node->garbage);
+		}
+	}
+	susCMapRetire(map, &old->garbage);
+	susCMapReclaim(map);
+}
+
+// -------------------------------------------------------------------
+
+// Copy the value of the key without locks (\return FALSE if the key is not found)
+BOOL SUSAPI susCMapGet(_In_ SUS_CMAP map, _In_bytecount_(map->keySize) const SUS_OBJECT key, _Out_writes_bytes_opt_(map->valueSize) SUS_OBJECT value)
+{
+	SUS_ASSERT(map && key);
+	SUS_HASH_T hash = susCMapHash(map, key);
+	DWORD slot = GetCurrentThreadId() % SUS_CMAP_READER_SLOTS;
+	LONG epoch = susCMapReadBegin(map, slot);
+	SUS_LPCMAP_TABLE table = susCMapTable(map);
+	SUS_LPCMAP_NODE volatile* link = susCMapBucket(table, hash);
+	SUS_LPCMAP_NODE node = susCMapFind(map, &link, key, hash);
+	if (node && value) sus_memcpy(value, susCMapNodeValue(map, node), map->valueSize);
+	susCMapReadEnd(map, slot, epoch);
+	return node ? TRUE : FALSE;
+}
+// Add or change a value (\return FALSE if there is not enough memory)
+BOOL SUSAPI susCMapSet(_Inout_ SUS_CMAP map, _In_bytecount_(map->keySize) const SUS_OBJECT key, _In_opt_bytecount_(map->valueSize) const SUS_OBJECT value)
+{
+	SUS_ASSERT(map && key);
+	SUS_HASH_T hash = susCMapHash(map, key);
+	SUS_LPCMAP_NODE node = susCMapNewNode(map, hash, key, value);
+	if (!node) return FALSE;
+	PSRWLOCK stripe = susCMapStripe(map, hash);
+	AcquireSRWLockExclusive(stripe);
+	SUS_LPCMAP_TABLE table = map->table;
+	DWORD capacity = table->capacity;
+	SUS_LPCMAP_NODE volatile* link = susCMapBucket(table, hash);
+	SUS_LPCMAP_NODE old = susCMapFind(map, &link, key, hash);
+	// The new node takes the place of the old one, so the readers see either of them
+	if (old) node->next = old->next;
+	else node->next = NULL;
+	susCMapPublish(link, node);
+	LONG count = old ? ReadAcquire(&map->count) : InterlockedIncrement(&map->count);
+	ReleaseSRWLockExclusive(stripe);
+	if (old && susCMapRetire(map, &old->garbage) >= SUS_CMAP_RECLAIM_COUNT) susCMapReclaim(map);
+	if ((DWORD)count > capacity * SUS_CMAP_RATIO) susCMapGrow(map);
+	return TRUE;
+}
+// Delete a key-value pair (\return FALSE if the key is not found)
+BOOL SUSAPI susCMapRemove(_Inout_ SUS_CMAP map, _In_bytecount_(map->keySize) const SUS_OBJECT key)
+{
+	SUS_ASSERT(map && key);
+	SUS_HASH_T hash = susCMapHash(map, key);
+	PSRWLOCK stripe = susCMapStripe(map, hash);
+	AcquireSRWLockExclusive(stripe);
+	SUS_LPCMAP_NODE volatile* link = susCMapBucket(map->table, hash);
+	SUS_LPCMAP_NODE node = susCMapFind(map, &link, key, hash);
+	// The removed node keeps its link, so the readers on it go on along the chain
+	if (node) {
+		susCMapPublish(link, node->next);
+		InterlockedDecrement(&map->count);
+	}
+	ReleaseSRWLockExclusive(stripe);
+	if (!node) return FALSE;
+	if (susCMapRetire(map, &node->garbage) >= SUS_CMAP_RECLAIM_COUNT) susCMapReclaim(map);
+	return TRUE;
+}
+
+// =======================================================================================
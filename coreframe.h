@@ -19,10 +19,12 @@
 #include <WinSock2.h>
 #include <WS2tcpip.h>
 #include <winhttp.h>
+#include <bcrypt.h>
 
 //#define SUS_DEBUGONLYERRORS
 
 #pragma comment(lib, "ws2_32.lib")
 #pragma comment(lib, "opengl32.lib")
 #pragma comment(lib, "comctl32.lib")
+#pragma comment(lib, "bcrypt.lib")
 
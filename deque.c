@@ -0,0 +1,126 @@
+// deque.c
+//
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_VECTOR
+#include "coreframe.h"
+#include "include/susfwk/core.h"
+#include "include/susfwk/memory.h"
+#include "include/susfwk/deque.h"
+
+// -------------------------------------
+
+// Create a new deque in the allocator memory
+SUS_DEQUE SUSAPI susNewDequeAllocator(_In_ sus_size_t itemSize, _In_opt_ SUS_LPALLOCATOR allocator) {
+	SUS_PRINTDL("A new deque of %d bytes is created", itemSize);
+	SUS_ASSERT(itemSize);
+	SUS_DEQUE deque = susAllocatorAlloc(allocator, sizeof(SUS_DEQUE_STRUCT) + SUS_DEQUE_CAPACITY * itemSize);
+	if (!deque) return NULL;
+	deque->head = 0;
+	deque->length = 0;
+	deque->capacity = SUS_DEQUE_CAPACITY;
+	deque->itemSize = itemSize;
+	deque->allocator = allocator;
+	return deque;
+}
+// Create a new deque
+SUS_DEQUE SUSAPI susNewDequeEx(_In_ sus_size_t itemSize, _In_opt_ SIZE_T alignment) {
+	SUS_LPALLOCATOR allocator = NULL;
+	if (alignment > MEMORY_ALLOCATION_ALIGNMENT) {
+		allocator = susAlignedAllocator(alignment, sizeof(SUS_DEQUE_STRUCT));
+		if (!allocator) return NULL;
+	}
+	return susNewDequeAllocator(itemSize, allocator);
+}
+// Delete a deque
+VOID SUSAPI susDequeDestroy(_In_ SUS_DEQUE deque) {
+	SUS_PRINTDL("Deleting a deque");
+	SUS_ASSERT(deque);
+	susAllocatorFree(deque->allocator, deque, sizeof(SUS_DEQUE_STRUCT) + deque->capacity * deque->itemSize);
+}
+// Guarantee the space for the specified number of elements
+BOOL SUSAPI susDequeReserve(_Inout_ SUS_LPDEQUE lpDeque, _In_ sus_uint_t reserve)
+{
+	SUS_ASSERT(lpDeque && *lpDeque);
+	SUS_DEQUE deque = *lpDeque;
+	if (deque->capacity - deque->length >= reserve) return TRUE;
+	// The capacity is a power of two, so the doubling must not pass the highest bit of sus_uint_t
+	if (reserve > (sus_uint_t)-1 / 2 - deque->length) {
+		SUS_PRINTDE("The deque length exceeds the limit of sus_uint_t");
+		return FALSE;
+	}
+	sus_uint_t oldCapacity = deque->capacity, capacity = oldCapacity;
+	while (capacity - deque->length < reserve) capacity <<= 1;
+	SUS_DEQUE newDeque = (SUS_DEQUE)susAllocatorRealloc(deque->allocator, deque,
+		sizeof(SUS_DEQUE_STRUCT) + oldCapacity * deque->itemSize,
+		sizeof(SUS_DEQUE_STRUCT) + capacity * deque->itemSize
+	);
+	if (!newDeque) return FALSE;
+	// The wrapped part is moved after the old end of the storage
+	if (newDeque->head + newDeque->length > oldCapacity) {
+		sus_uint_t wrapped = newDeque->head + newDeque->length - oldCapacity;
+		sus_memcpy(newDeque->data + oldCapacity * newDeque->itemSize, newDeque->data, wrapped * newDeque->itemSize);
+	}
+	newDeque->capacity = capacity;
+	*lpDeque = newDeque;
+	return TRUE;
+}
+
+// -------------------------------------
+
+// Insert elements at the end of the deque
+SUS_LPMEMORY SUSAPI susDequePushBackArray(_Inout_ SUS_LPDEQUE lpDeque, _In_opt_ SUS_LPMEMORY data, _In_ sus_uint_t count)
+{
+	SUS_ASSERT(lpDeque && *lpDeque);
+	if (!susDequeReserve(lpDeque, count)) return NULL;
+	SUS_DEQUE deque = *lpDeque;
+	sus_uint_t tail = (deque->head + deque->length) & (deque->capacity - 1);
+	sus_uint_t first = min(count, deque->capacity - tail);
+	if (data) {
+		sus_memcpy(deque->data + tail * deque->itemSize, data, first * deque->itemSize);
+		if (count > first) sus_memcpy(deque->data, (sus_lpbyte_t)data + first * deque->itemSize, (count - first) * deque->itemSize);
+	}
+	else {
+		sus_zeromem(deque->data + tail * deque->itemSize, first * deque->itemSize);
+		if (count > first) sus_zeromem(deque->data, (count - first) * deque->itemSize);
+	}
+	deque->length += count;
+	return deque->data + tail * deque->itemSize;
+}
+// Insert an element at the beginning of the deque
+SUS_LPMEMORY SUSAPI susDequePushFront(_Inout_ SUS_LPDEQUE lpDeque, _In_opt_ SUS_LPMEMORY data)
+{
+	SUS_ASSERT(lpDeque && *lpDeque);
+	if (!susDequeReserve(lpDeque, 1)) return NULL;
+	SUS_DEQUE deque = *lpDeque;
+	deque->head = (deque->head - 1) & (deque->capacity - 1);
+	deque->length++;
+	sus_lpbyte_t item = deque->data + deque->head * deque->itemSize;
+	if (data) sus_memcpy(item, data, deque->itemSize);
+	else sus_zeromem(item, deque->itemSize);
+	return item;
+}
+// Remove elements from the beginning of the deque
+sus_uint_t SUSAPI susDequeDrain(_Inout_ SUS_DEQUE deque, _Out_opt_ SUS_LPMEMORY buffer, _In_ sus_uint_t count)
+{
+	SUS_ASSERT(deque);
+	count = min(count, deque->length);
+	if (buffer && count) {
+		sus_uint_t first = min(count, deque->capacity - deque->head);
+		sus_memcpy(buffer, deque->data + deque->head * deque->itemSize, first * deque->itemSize);
+		if (count > first) sus_memcpy((sus_lpbyte_t)buffer + first * deque->itemSize, deque->data, (count - first) * deque->itemSize);
+	}
+	deque->head = (deque->head + count) & (deque->capacity - 1);
+	deque->length -= count;
+	if (!deque->length) deque->head = 0;
+	return count;
+}
+// Get the contiguous spans of the elements in order
+sus_uint_t SUSAPI susDequeSpans(_In_ SUS_DEQUE deque, _Out_writes_(2) SUS_LPDATAVIEW spans)
+{
+	SUS_ASSERT(deque && spans);
+	sus_uint_t first = min(deque->length, deque->capacity - deque->head);
+	spans[0] = susDataView(deque->data + deque->head * deque->itemSize, first * deque->itemSize);
+	spans[1] = susDataView(deque->data, (deque->length - first) * deque->itemSize);
+	return (first ? 1 : 0) + (deque->length > first ? 1 : 0);
+}
+
+// -------------------------------------
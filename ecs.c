@@ -1,10 +1,12 @@
 // ecs.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_ECS
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/memory.h"
 #include "include/susfwk/bitset.h"
 #include "include/susfwk/vector.h"
+#include "include/susfwk/deque.h"
 #include "include/susfwk/hashtable.h"
 #include "include/susfwk/ecs.h"
 
@@ -18,19 +20,19 @@
 
 // Add an entity to queries
 static VOID SUSAPI susQueryAddEntity(_In_ SUS_ARCHETYPE archetype, _In_ SUS_ENTITY entity) {
-	susVecForeach(i, archetype->questions) {
-		SUS_QUERY query = susVectorGet(archetype->questions, i, SUS_QUERY);
-		SUS_ASSERT(!susVectorContains(query->entities, &entity, NULL));
-		susVectorPush(&query->entities, &entity);
+	susSmallVectorForeach(i, &archetype->questions.super) {
+		SUS_QUERY query = susSmallVectorGet(&archetype->questions.super, i, SUS_QUERY);
+		SUS_ASSERT(!susEntityVectorContains(query->entities, entity));
+		susEntityVectorPush(&query->entities, entity);
 	}
 }
 // Delete an entity from queries
 static VOID SUSAPI susQueryRemoveEntity(_In_ SUS_ARCHETYPE archetype, _In_ SUS_ENTITY entity) {
-	susVecForeach(i, archetype->questions) {
-		SUS_QUERY query = susVectorGet(archetype->questions, i, SUS_QUERY);
-		INT index = susVectorIndexOf(query->entities, &entity, NULL);
-		SUS_ASSERT(index != -1);
-		susVectorSwapErase(&query->entities, index);
+	susSmallVectorForeach(i, &archetype->questions.super) {
+		SUS_QUERY query = susSmallVectorGet(&archetype->questions.super, i, SUS_QUERY);
+		sus_csize_t index = susEntityVectorIndexOf(query->entities, entity);
+		SUS_ASSERT(index != SUS_CSIZE_MAX);
+		if (index != SUS_CSIZE_MAX) susEntityVectorSwapErase(&query->entities, index);
 	}
 }
 
@@ -46,14 +48,17 @@ static inline SUS_ARCHETYPE SUSAPI susNewArchetype(_Inout_ SUS_WORLD world, _In_
 	SUS_ASSERT(world && world->archetypes && !susFindArchetype(world, mask));
 	SUS_ARCHETYPE_STRUCT archetype = {
 		.componentPools = susNewMap(SUS_COMPONENT_TYPE, SUS_VECTOR),
-		.entities = susNewVector(SUS_ENTITY),
-		.questions = susNewVector(SUS_QUERY),
+		.entities = susEntityVectorNew(),
 		.mask = mask
 	};
+	susSmallVectorSetup(&archetype.questions);
+	// Entities migrate between the archetypes back and forth - keep the pools from oscillating
+	if (archetype.entities) susVectorSetPolicy(archetype.entities, SUS_GROWTH_POLICY_HYSTERESIS);
 	susVecForeach(i, world->registeredComponents) {
 		if (susBitmask256Test(mask, i)) {
 			SUS_LPREGISTERED_COMPONENT component = (SUS_LPREGISTERED_COMPONENT)susVectorAt(world->registeredComponents, i);
 			SUS_VECTOR pool = susNewVectorEx(component->size);
+			if (pool) susVectorSetPolicy(pool, SUS_GROWTH_POLICY_HYSTERESIS);
 			susMapAdd(&archetype.componentPools, &i, &pool);
 		}
 	}
@@ -71,7 +76,7 @@ static inline SUS_ARCHETYPE SUSAPI susCreateArchetype(_Inout_ SUS_WORLD world, _
 // Add an entity to an archetype
 static inline sus_uint_t SUSAPI susArchetypeAddEntityEx(_In_ SUS_WORLD world, _Inout_ SUS_ARCHETYPE archetype, _In_ SUS_ENTITY entity, _In_opt_ SUS_ENTITY_LOCATION constructor) {
 	SUS_ASSERT(world && archetype);
-	susVectorPush(&archetype->entities, &entity);
+	susEntityVectorPush(&archetype->entities, entity);
 	susQueryAddEntity(archetype, entity);
 	SUS_COMPONENTMASK mask = archetype->mask;
 	SUS_COMPONENTMASK intersection = constructor.archetype ? susBitmask256op(mask, &, constructor.archetype->mask) : (SUS_COMPONENTMASK) { 0 };
@@ -102,17 +107,17 @@ static inline VOID SUSAPI susArchetypeCull(_Inout_ SUS_WORLD world, _In_ SUS_ARC
 	if (!archetype->entities->length) {
 		susVectorDestroy(archetype->entities);
 		susMapDestroy(archetype->componentPools);
-		susVectorDestroy(archetype->questions);
+		susSmallVectorCleanup(&archetype->questions.super);
 		susMapRemove(&world->archetypes, &archetype->mask);
 	}
 }
 // Remove an entity component from an archetype
 static inline VOID SUSAPI susArchetypeRemoveEntity(_In_ SUS_WORLD world, _In_ SUS_ENTITY_LOCATION location) {
 	SUS_ASSERT(world && location.archetype && world->registeredComponents && location.archetype->componentPools);
-	SUS_ENTITY entity = susVectorGet(location.archetype->entities, location.index, SUS_ENTITY);
+	SUS_ENTITY entity = *susEntityVectorAt(location.archetype->entities, location.index);
 	susQueryRemoveEntity(location.archetype, entity);
-	susVectorSwapErase(&location.archetype->entities, location.index);
-	((SUS_LPENTITY_LOCATION)susMapGet(world->entities, (SUS_ENTITY*)susVectorAt(location.archetype->entities, location.index)))->index = location.index;
+	susEntityVectorSwapErase(&location.archetype->entities, location.index);
+	if (location.index < location.archetype->entities->length) ((SUS_LPENTITY_LOCATION)susMapGet(world->entities, susEntityVectorAt(location.archetype->entities, location.index)))->index = location.index;
 	susVecForeach(i, world->registeredComponents) {
 		if (susBitmask256Test(location.archetype->mask, i)) {
 			SUS_LPVECTOR pool = susMapGet(location.archetype->componentPools, &i);
@@ -157,7 +162,7 @@ SUS_WORLD_STRUCT SUSAPI susWorldSetup()
 		.archetypes = susNewMap(SUS_COMPONENTMASK, SUS_ARCHETYPE_STRUCT),
 		.entities = susNewMap(SUS_ENTITY, SUS_ENTITY_LOCATION),
 		.questions = susNewMap(SUS_COMPONENTMASK, SUS_QUERY_STRUCT),
-		.freeEntities = susNewVector(SUS_ENTITY),
+		.freeEntities = susNewDeque(SUS_ENTITY),
 		.next = 0,
 		.registeredComponents = susNewVector(SUS_REGISTERED_COMPONENT),
 		.systems = susNewVector(SUS_SYSTEM)
@@ -178,11 +183,11 @@ VOID SUSAPI susWorldCleanup(_In_ SUS_WORLD_STRUCT* world)
 {
 	SUS_PRINTDL("The destruction of the world");
 	susVectorDestroy(world->systems);
-	SUS_VECTOR rootEntities = susNewVector(SUS_ENTITY);
+	SUS_VECTOR rootEntities = susEntityVectorNew();
 	susMapForeach(world->entities, i) {
 		SUS_ENTITY* entity = (SUS_ENTITY*)susMapIterKey(i);
 		SUS_LPENTITY_LOCATION location = susMapGet(world->entities, entity);
-		if (location->parent == SUS_INVALID_ENTITY) susVectorPush(&rootEntities, entity);
+		if (location->parent == SUS_INVALID_ENTITY) susEntityVectorPush(&rootEntities, *entity);
 	}
 	susVecForeach(i, rootEntities) {
 		susEntityDestroy(world, susVectorGet(rootEntities, i, SUS_ENTITY));
@@ -195,6 +200,7 @@ VOID SUSAPI susWorldCleanup(_In_ SUS_WORLD_STRUCT* world)
 	}
 	susMapDestroy(world->questions);
 	susMapDestroy(world->entities);
+	susDequeDestroy(world->freeEntities);
 	susVectorDestroy(world->registeredComponents);
 }
 // Destroy the world
@@ -267,13 +273,13 @@ SUS_VECTOR SUSAPI susWorldGetEntitiesWith(_Inout_ SUS_WORLD world, _In_ SUS_COMP
 	SUS_ASSERT(world);
 	SUS_QUERY_STRUCT* query = susMapGet(world->questions, &mask);
 	if (query) return query->entities;
-	SUS_QUERY_STRUCT queryStruct = { .entities = susNewVector(SUS_ENTITY) };
+	SUS_QUERY_STRUCT queryStruct = { .entities = susEntityVectorNew() };
 	query = susMapAdd(&world->questions, &mask, &queryStruct);
 	susMapForeach(world->archetypes, i) {
 		if (susBitmask256Contains(*(SUS_LPBITMASK256)susMapIterKey(i), mask)) {
 			SUS_ARCHETYPE archetype = (SUS_ARCHETYPE)susMapIterValue(i);
 			susVectorInsertArray(&query->entities, query->entities->length, archetype->entities->data, archetype->entities->length);
-			susVectorPush(&archetype->questions, &query);
+			susSmallVectorPush(&archetype->questions.super, &query);
 		}
 	}
 	return query->entities;
@@ -292,14 +298,11 @@ SUS_ENTITY SUSAPI susNewEntity(_Inout_ SUS_WORLD world, _In_ SUS_COMPONENTMASK i
 {
 	SUS_ASSERT(world && world->entities && world->freeEntities);
 	SUS_ENTITY entity;
-	if (world->freeEntities->length) {
-		entity = susVectorGet(world->freeEntities, world->freeEntities->length - 1, SUS_ENTITY);
-		susVectorPop(&world->freeEntities);
-	}
-	else entity = world->next++;
+	// The oldest freed id is reused first, so a stale id does not point to a new entity right away
+	if (!susDequePopFront(world->freeEntities, &entity)) entity = world->next++;
 	SUS_ENTITY_LOCATION location = susArchetypeAddEntity(world, entity, initMask);
 	location.parent = SUS_INVALID_ENTITY;
-	location.children = susNewSet(SUS_ENTITY);
+	susSmallVectorSetup(&location.children);
 	susMapAdd(&world->entities, &entity, &location);
 	susEntitySetParent(world, entity, parent);
 	return entity;
@@ -309,16 +312,20 @@ VOID SUSAPI susEntityDestroy(_Inout_ SUS_WORLD world, _In_ SUS_ENTITY entity)
 {
 	SUS_ASSERT(world && world->entities && world->freeEntities && susEntityExists(world, entity));
 	SUS_LPENTITY_LOCATION location = susMapGet(world->entities, &entity);
-	if (location->parent != SUS_INVALID_ENTITY) {
-		SUS_LPENTITY_LOCATION parentLocation = susMapGet(world->entities, &entity);
-		susSetRemove(&parentLocation->children, &entity);
+	// Each child removes itself from the list, the entity table may be rebuilt on the way
+	while (location->children.super.length) {
+		susEntityDestroy(world, susSmallVectorGet(&location->children.super, location->children.super.length - 1, SUS_ENTITY));
+		location = susMapGet(world->entities, &entity);
 	}
-	susSetForeach(location->children, i) {
-		susEntityDestroy(world, *(SUS_ENTITY*)susMapIterKey(i));
+	if (location->parent != SUS_INVALID_ENTITY) {
+		SUS_LPENTITY_LOCATION parentLocation = susMapGet(world->entities, &location->parent);
+		sus_csize_t index = susSmallVectorIndexOf(&parentLocation->children.super, &entity);
+		if (index != SUS_CSIZE_MAX) susSmallVectorSwapErase(&parentLocation->children.super, index);
 	}
+	susSmallVectorCleanup(&location->children.super);
 	susArchetypeRemoveEntity(world, *location);
 	susMapRemove(&world->entities, &entity);
-	susVectorPush(&world->freeEntities, &entity);
+	susDequePushBack(&world->freeEntities, &entity);
 }
 
 // --------------------------------------------------------------------------------------
@@ -380,9 +387,12 @@ VOID SUSAPI susEntitySetParent(_Inout_ SUS_WORLD world, _In_ SUS_ENTITY entity,
 	SUS_LPENTITY_LOCATION location = susMapGet(world->entities, &entity);
 	if (location->parent != SUS_INVALID_ENTITY) {
 		SUS_LPENTITY_LOCATION oldParentLocation = susMapGet(world->entities, &location->parent);
-		susSetRemove(&oldParentLocation->children, &entity);
+		sus_csize_t index = susSmallVectorIndexOf(&oldParentLocation->children.super, &entity);
+		if (index != SUS_CSIZE_MAX) susSmallVectorSwapErase(&oldParentLocation->children.super, index);
+	}
+	if (parent != SUS_INVALID_ENTITY) {
 		SUS_LPENTITY_LOCATION parentLocation = susMapGet(world->entities, &parent);
-		susSetAdd(&parentLocation->children, &entity);
+		susSmallVectorPush(&parentLocation->children.super, &entity);
 	}
 	location->parent = parent;
 }
@@ -397,11 +407,11 @@ SUS_ENTITY SUSAPI susEntityGetParent(_In_ SUS_WORLD world, _In_ SUS_ENTITY entit
 // --------------------------------------------------------------------------------------
 
 // Get kids
-SUS_HASHSET SUSAPI susEntityGetChildren(_In_ SUS_WORLD world, _In_ SUS_ENTITY entity)
+SUS_SMALL_VECTOR SUSAPI susEntityGetChildren(_In_ SUS_WORLD world, _In_ SUS_ENTITY entity)
 {
 	SUS_ASSERT(world && susEntityExists(world, entity));
 	SUS_LPENTITY_LOCATION location = susMapGet(world->entities, &entity);
-	return location->children;
+	return &location->children.super;
 }
 // Check the affiliation
 BOOL SUSAPI susEntityIsDescendantOf(_In_ SUS_WORLD world, _In_ SUS_ENTITY entity, _In_ SUS_ENTITY ancestor)
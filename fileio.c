@@ -233,17 +233,62 @@ INT SUSAPI sus_freadex(
 	SUS_PRINTDL("The data has been read successfully");
 	return bytesRead;
 }
+// Read the specified number of bytes from a file
+SIZE_T SUSAPI sus_freadall(
+	_In_ SUS_FILE hFile,
+	_Out_writes_bytes_(size) LPBYTE lpBuffer,
+	_In_ SIZE_T size)
+{
+	SUS_PRINTDL("Reading data from a file");
+	SUS_ASSERT(lpBuffer && hFile);
+	SIZE_T total = 0;
+	while (total < size) {
+		// ReadFile takes a DWORD size, so the large reads are split into parts
+		DWORD bytesRead;
+		if (!ReadFile(hFile, lpBuffer + total, (DWORD)min(size - total, SUS_FILE_IO_PART_SIZE), &bytesRead, NULL)) {
+			SUS_PRINTDE("Couldn't read data from the file");
+			SUS_PRINTDC(GetLastError());
+			return (SIZE_T)-1;
+		}
+		if (!bytesRead) break;
+		total += bytesRead;
+	}
+	return total;
+}
 // Read the entire file
 SUS_DATAVIEW SUSAPI sus_fread(_In_ SUS_FILE hFile)
 {
 	SUS_PRINTDL("Reading the entire file");
-	SUS_DATAVIEW data = susNewData(sus_fsize(hFile) + 1);
-	if (sus_freadex(hFile, data.data, (DWORD)data.size - 1) < 0) {
+	LONGLONG size = sus_fsize(hFile);
+	if ((ULONGLONG)size >= (SIZE_T)-1) {
+		SUS_PRINTDE("The file does not fit into the address space");
+		return (SUS_DATAVIEW) { 0 };
+	}
+	SUS_DATAVIEW data = susNewData((SIZE_T)size + 1);
+	if (!data.data) return data;
+	SIZE_T bytesRead = sus_freadall(hFile, data.data, data.size - 1);
+	if (bytesRead == (SIZE_T)-1) {
 		susDataDestroy(data);
 		return (SUS_DATAVIEW) { 0 };
 	}
+	data.data[bytesRead] = '\0';
+	data.size = bytesRead + 1;
 	return data;
 }
+// Read the entire file into shared bytes
+SUS_BYTES SUSAPI sus_freadBytes(_In_ SUS_FILE hFile)
+{
+	SUS_PRINTDL("Reading the entire file");
+	LONGLONG size = sus_fsize(hFile);
+	if ((ULONGLONG)size >= (SIZE_T)-1) {
+		SUS_PRINTDE("The file does not fit into the address space");
+		return (SUS_BYTES) { 0 };
+	}
+	SUS_BYTES bytes = susNewBytes((SIZE_T)size);
+	if (!bytes.data) return bytes;
+	if (sus_freadall(hFile, bytes.data, bytes.size) != bytes.size) susBytesRelease(&bytes);
+	return bytes;
+}
 // Writing to a file
 DWORD SUSAPI sus_fwrite(
 	_In_ SUS_FILE hFile,
@@ -267,6 +312,26 @@ DWORD SUSAPI sus_fwrite(
 	SUS_PRINTDL("The data has been successfully written to the file");
 	return bytesWritten;
 }
+// Write the specified number of bytes to a file
+SIZE_T SUSAPI sus_fwriteall(
+	_In_ SUS_FILE hFile,
+	_In_reads_bytes_(size) CONST LPBYTE lpData,
+	_In_ SIZE_T size)
+{
+	SUS_PRINTDL("Writing to a file");
+	SUS_ASSERT(lpData && hFile);
+	SIZE_T total = 0;
+	while (total < size) {
+		DWORD bytesWritten;
+		if (!WriteFile(hFile, lpData + total, (DWORD)min(size - total, SUS_FILE_IO_PART_SIZE), &bytesWritten, NULL)) {
+			SUS_PRINTDE("Couldn't write data to a file");
+			SUS_PRINTDC(GetLastError());
+			break;
+		}
+		total += bytesWritten;
+	}
+	return total;
+}
 
 // --------------------------------------------------------
 
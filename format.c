@@ -620,14 +620,15 @@ DWORD SUSAPI sus_escapeW(_Out_opt_ LPWSTR buff, _In_ LPCWSTR src)
 	if (buff) *buff = L'\0';
 	return length;
 }
-// parsing a string with esc characters into special characters
-DWORD SUSAPI sus_unescapeA(_Out_opt_ LPSTR buff, _In_ LPCSTR src)
+// parsing a string of the specified length with esc characters into special characters
+DWORD SUSAPI sus_unescapeExA(_Out_opt_ LPSTR buff, _In_reads_(count) LPCSTR src, _In_ DWORD count)
 {
+	LPCSTR end = src + count;
 	DWORD length = 0;
-	while (*src) {
+	while (src < end) {
 		if (*src == '\\') {
 			src++;
-			if (!*src) break;
+			if (src == end) break;
 			switch (*(src++))
 			{
 			case '"': if (buff) *buff++ = '\"'; break;
@@ -657,13 +658,18 @@ DWORD SUSAPI sus_unescapeA(_Out_opt_ LPSTR buff, _In_ LPCSTR src)
 	return length;
 }
 // parsing a string with esc characters into special characters
-DWORD SUSAPI sus_unescapeW(_Out_opt_ LPWSTR buff, _In_ LPCWSTR src)
+DWORD SUSAPI sus_unescapeA(_Out_opt_ LPSTR buff, _In_ LPCSTR src) {
+	return sus_unescapeExA(buff, src, lstrlenA(src));
+}
+// parsing a string of the specified length with esc characters into special characters
+DWORD SUSAPI sus_unescapeExW(_Out_opt_ LPWSTR buff, _In_reads_(count) LPCWSTR src, _In_ DWORD count)
 {
+	LPCWSTR end = src + count;
 	DWORD length = 0;
-	while (*src) {
+	while (src < end) {
 		if (*src == L'\\') {
 			src++;
-			if (!*src) break;
+			if (src == end) break;
 			switch (*(src++))
 			{
 			case L'"': if (buff) *buff++ = L'\"'; break;
@@ -692,3 +698,7 @@ DWORD SUSAPI sus_unescapeW(_Out_opt_ LPWSTR buff, _In_ LPCWSTR src)
 	if (buff) *buff = L'\0';
 	return length;
 }
+// parsing a string with esc characters into special characters
+DWORD SUSAPI sus_unescapeW(_Out_opt_ LPWSTR buff, _In_ LPCWSTR src) {
+	return sus_unescapeExW(buff, src, lstrlenW(src));
+}
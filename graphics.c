@@ -284,7 +284,7 @@ static HBITMAP SUSAPI susGraphicsImageBuilder(_In_ SUS_SIZE size, VOID** bits) {
 // Create an image from a bitmap
 static SUS_GRAPHICS_IMAGE SUSAPI susGraphicsBuildImage(_In_ HBITMAP hBitMap) {
 	SUS_ASSERT(hBitMap);
-	SUS_GRAPHICS_IMAGE image = sus_malloc(sizeof(SUS_GRAPHICS_IMAGE_STRUCT));
+	SUS_GRAPHICS_IMAGE image = sus_zalloc(sizeof(SUS_GRAPHICS_IMAGE_STRUCT));
 	if (!image) return NULL;
 	image->super = hBitMap;
 	image->hdcMem = CreateCompatibleDC(NULL);
@@ -348,7 +348,7 @@ SUS_GRAPHICS_IMAGE SUSAPI susGraphicsImageCopyEx(_In_ SUS_GRAPHICS_IMAGE image,
 {
 	SUS_ASSERT(image && image->super);
 	HDC hdc = GetDC(NULL);
-	SUS_GRAPHICS_IMAGE copy = sus_malloc(sizeof(SUS_GRAPHICS_IMAGE_STRUCT));
+	SUS_GRAPHICS_IMAGE copy = sus_zalloc(sizeof(SUS_GRAPHICS_IMAGE_STRUCT));
 	if (!copy) goto error;
 	copy->super = CreateCompatibleBitmap(hdc, image->size.cx, image->size.cy);
 	if (!copy->super) { ReleaseDC(NULL, hdc); sus_free(copy); goto error; }
@@ -1,41 +1,375 @@
 // hashtable.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_MAP
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/memory.h"
 #include "include/susfwk/vector.h"
 #include "include/susfwk/hashtable.h"
 
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SUS_HASHTABLE_SSE2
+#include <emmintrin.h>
+#endif // !SUS_HASHTABLE_SSE2
+
 // -------------------------------------------------------------------
 
-// Create a hash table
-SUS_HASHMAP SUSAPI susNewMapEx(_In_ SIZE_T keySize, _In_ SIZE_T valueSize, _In_opt_ SUS_GET_HASH_CALLBACK getHash, _In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys, _In_opt_ DWORD initCount)
+#ifdef SUS_HASHTABLE_SSE2
+
+// Get the mask of the group slots with the control byte
+SUS_INLINE sus_u32_t SUSAPI susMapGroupMatch(_In_reads_(SUS_HASHTABLE_GROUP_WIDTH) const sus_u8_t* ctrl, _In_ sus_u8_t value) {
+	return (sus_u32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)ctrl), _mm_set1_epi8((char)value)));
+}
+// Get the mask of the empty and deleted slots of the group
+SUS_INLINE sus_u32_t SUSAPI susMapGroupMatchFree(_In_reads_(SUS_HASHTABLE_GROUP_WIDTH) const sus_u8_t* ctrl) {
+	return (sus_u32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+}
+
+#else
+
+// Get the mask of the group slots with the control byte
+SUS_INLINE sus_u32_t SUSAPI susMapGroupMatch(_In_reads_(SUS_HASHTABLE_GROUP_WIDTH) const sus_u8_t* ctrl, _In_ sus_u8_t value) {
+	sus_u32_t mask = 0;
+	for (sus_uint_t i = 0; i < SUS_HASHTABLE_GROUP_WIDTH; i++) if (ctrl[i] == value) mask |= 1u << i;
+	return mask;
+}
+// Get the mask of the empty and deleted slots of the group
+SUS_INLINE sus_u32_t SUSAPI susMapGroupMatchFree(_In_reads_(SUS_HASHTABLE_GROUP_WIDTH) const sus_u8_t* ctrl) {
+	sus_u32_t mask = 0;
+	for (sus_uint_t i = 0; i < SUS_HASHTABLE_GROUP_WIDTH; i++) if (!susMapCtrlIsFull(ctrl[i])) mask |= 1u << i;
+	return mask;
+}
+
+#endif // !SUS_HASHTABLE_SSE2
+
+// Get the index of the lowest slot in the mask
+SUS_INLINE DWORD SUSAPI susMapMaskFirst(_In_ sus_u32_t mask) {
+	DWORD i;
+	_BitScanForward(&i, mask);
+	return i;
+}
+
+// -------------------------------------------------------------------
+
+// Random seed of the process
+static SUS_HASH64_T SUSHashSeed = 0;
+// Initialization of the random seed
+static INIT_ONCE SUSHashSeedInitOnce = INIT_ONCE_STATIC_INIT;
+
+// Secret constants of the 64-bit hashing
+static const sus_u64_t SUSHashSecret[4] = { 0x2D358DCCAA6C78A5ull, 0x8BB84B93962EACC9ull, 0x4B33A62ED433D4A3ull, 0x4D5A2DA51DE1AA47ull };
+
+// Multiply two numbers to 128 bits (a - the low half, b - the high half)
+SUS_INLINE VOID SUSAPI susHashMultiply(_Inout_ sus_u64_t* a, _Inout_ sus_u64_t* b)
+{
+#if defined(_M_X64)
+	*a = _umul128(*a, *b, b);
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 product = (unsigned __int128)*a * *b;
+	*a = (sus_u64_t)product;
+	*b = (sus_u64_t)(product >> 64);
+#else
+	sus_u64_t ha = *a >> 32, la = (sus_u32_t)*a, hb = *b >> 32, lb = (sus_u32_t)*b;
+	sus_u64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+	sus_u64_t t = ll + (hl << 32), c = t < ll;
+	*a = t + (lh << 32);
+	c += *a < t;
+	*b = hh + (hl >> 32) + (lh >> 32) + c;
+#endif // !_M_X64
+}
+// Multiply two numbers to 128 bits and fold the product to 64 bits
+SUS_INLINE sus_u64_t SUSAPI susHashMix(_In_ sus_u64_t a, _In_ sus_u64_t b) {
+	susHashMultiply(&a, &b);
+	return a ^ b;
+}
+// Read 8 bytes of the data
+#define susHashRead8(p) (*(const UNALIGNED sus_u64_t*)(p))
+// Read 4 bytes of the data
+#define susHashRead4(p) ((sus_u64_t)*(const UNALIGNED sus_u32_t*)(p))
+
+// Generate the random seed of the process
+static BOOL CALLBACK susHashSeedInit(_Inout_ PINIT_ONCE initOnce, _Inout_opt_ PVOID param, _Out_opt_ PVOID* context)
+{
+	UNREFERENCED_PARAMETER(initOnce);
+	UNREFERENCED_PARAMETER(param);
+	UNREFERENCED_PARAMETER(context);
+	if (!BCRYPT_SUCCESS(BCryptGenRandom(NULL, (PUCHAR)&SUSHashSeed, sizeof(SUSHashSeed), BCRYPT_USE_SYSTEM_PREFERRED_RNG))) {
+		SUS_PRINTDE("Couldn't generate a random hash seed");
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		SUSHashSeed = susHashMix((sus_u64_t)counter.QuadPart ^ SUSHashSecret[0], ((sus_u64_t)GetCurrentProcessId() << 32 | GetCurrentThreadId()) ^ (sus_u64_t)(ULONG_PTR)&counter);
+	}
+	return TRUE;
+}
+// Get the random seed of the process
+SUS_HASH64_T SUSAPI susHashSeed() {
+	InitOnceExecuteOnce(&SUSHashSeedInitOnce, susHashSeedInit, NULL, NULL);
+	return SUSHashSeed;
+}
+// Get the seeded 64-bit hash of the data
+SUS_HASH64_T SUSAPI susHash64(_In_reads_bytes_(size) const VOID* data, _In_ SIZE_T size, _In_ SUS_HASH64_T seed)
+{
+	SUS_ASSERT(data || !size);
+	const BYTE* p = (const BYTE*)data;
+	sus_u64_t a, b;
+	seed ^= susHashMix(seed ^ SUSHashSecret[0], SUSHashSecret[1]);
+	if (size <= 16) {
+		if (size >= 4) {
+			SIZE_T shift = (size >> 3) << 2;
+			a = (susHashRead4(p) << 32) | susHashRead4(p + shift);
+			b = (susHashRead4(p + size - 4) << 32) | susHashRead4(p + size - 4 - shift);
+		}
+		else if (size) {
+			a = ((sus_u64_t)p[0] << 16) | ((sus_u64_t)p[size >> 1] << 8) | p[size - 1];
+			b = 0;
+		}
+		else a = b = 0;
+	}
+	else {
+		SIZE_T i = size;
+		// Three independent lanes for the long data
+		if (i > 48) {
+			sus_u64_t seed1 = seed, seed2 = seed;
+			do {
+				seed = susHashMix(susHashRead8(p) ^ SUSHashSecret[1], susHashRead8(p + 8) ^ seed);
+				seed1 = susHashMix(susHashRead8(p + 16) ^ SUSHashSecret[2], susHashRead8(p + 24) ^ seed1);
+				seed2 = susHashMix(susHashRead8(p + 32) ^ SUSHashSecret[3], susHashRead8(p + 40) ^ seed2);
+				p += 48; i -= 48;
+			} while (i > 48);
+			seed ^= seed1 ^ seed2;
+		}
+		for (; i > 16; p += 16, i -= 16) {
+			seed = susHashMix(susHashRead8(p) ^ SUSHashSecret[1], susHashRead8(p + 8) ^ seed);
+		}
+		// The last 16 bytes (overlap the processed ones)
+		a = susHashRead8(p + i - 16);
+		b = susHashRead8(p + i - 8);
+	}
+	a ^= SUSHashSecret[1];
+	b ^= seed;
+	susHashMultiply(&a, &b);
+	return susHashMix(a ^ SUSHashSecret[0] ^ size, b ^ SUSHashSecret[1]);
+}
+// Get the seeded 64-bit hash of the integer
+SUS_HASH64_T SUSAPI susHash64Int(_In_ sus_u64_t value, _In_ SUS_HASH64_T seed) {
+	return susHashMix(susHashMix(value ^ SUSHashSecret[0], seed ^ SUSHashSecret[1]) ^ SUSHashSecret[2], SUSHashSecret[3]);
+}
+
+// -------------------------------------------------------------------
+
+// Get the hash of the key spread over all the bits (the weak hashes like the integer keys differ only in the low bits)
+SUS_INLINE SUS_HASH_T SUSAPI susMapHash(_In_ SUS_HASHMAP map, _In_ const SUS_OBJECT key) {
+	// The 64-bit hashes are already mixed
+	if (map->getHash64) {
+		SUS_HASH64_T hash64 = map->getHash64((SUS_DATAVIEW) { .data = key, .size = map->keySize }, map->seed);
+		return (SUS_HASH_T)(hash64 ^ (hash64 >> 32));
+	}
+	return susHashFinalize(map->getHash((SUS_DATAVIEW) { .data = key, .size = map->keySize }));
+}
+// Get the control byte of the hash
+#define susMapHashCtrl(hash) ((sus_u8_t)((hash) & 0x7F))
+// Get the first probed group of the hash
+#define susMapHashGroup(map, hash) (((hash) >> 7) & ((map)->capacity / SUS_HASHTABLE_GROUP_WIDTH - 1))
+// Get the number of the slots that can be occupied in the table of the capacity
+#define susMapMaxLoad(capacity) ((DWORD)((capacity) * SUS_HASHTABLE_RATIO))
+
+// Set the control byte of the slot
+SUS_INLINE VOID SUSAPI susMapSetCtrl(_Inout_ SUS_HASHMAP map, _In_ DWORD i, _In_ sus_u8_t ctrl) {
+	map->ctrl[i] = ctrl;
+}
+// Occupy the slot by the hash
+SUS_INLINE VOID SUSAPI susMapSetHash(_Inout_ SUS_HASHMAP map, _In_ DWORD i, _In_ SUS_HASH_T hash) {
+	susMapSetCtrl(map, i, susMapHashCtrl(hash));
+	susMapSlotHash(map, i) = hash;
+}
+// Find an empty or deleted slot for the hash
+static DWORD SUSAPI susMapFindFree(_In_ SUS_HASHMAP map, _In_ SUS_HASH_T hash)
+{
+	DWORD groupMask = map->capacity / SUS_HASHTABLE_GROUP_WIDTH - 1;
+	for (DWORD group = susMapHashGroup(map, hash), step = 1;; group = (group + step++) & groupMask) {
+		sus_u32_t mask = susMapGroupMatchFree(map->ctrl + group * SUS_HASHTABLE_GROUP_WIDTH);
+		if (mask) return group * SUS_HASHTABLE_GROUP_WIDTH + susMapMaskFirst(mask);
+	}
+}
+// Find the slot of the key (\return (DWORD)-1 if the key is not found)
+static DWORD SUSAPI susMapFind(_In_ SUS_HASHMAP map, _In_ const SUS_OBJECT key, _In_ SUS_HASH_T hash)
+{
+	sus_u8_t h2 = susMapHashCtrl(hash);
+	DWORD groupMask = map->capacity / SUS_HASHTABLE_GROUP_WIDTH - 1;
+	for (DWORD group = susMapHashGroup(map, hash), step = 1; step <= groupMask + 1; group = (group + step++) & groupMask) {
+		const sus_u8_t* ctrl = map->ctrl + group * SUS_HASHTABLE_GROUP_WIDTH;
+		for (sus_u32_t mask = susMapGroupMatch(ctrl, h2); mask; mask &= mask - 1) {
+			DWORD i = group * SUS_HASHTABLE_GROUP_WIDTH + susMapMaskFirst(mask);
+			if (susMapSlotHash(map, i) == hash && map->cmpKeys(susMapKey(map, susMapSlot(map, i)), key, map->keySize)) return i;
+		}
+		// The key would have taken the empty slot of the group
+		if (susMapGroupMatch(ctrl, SUS_HASHTABLE_CTRL_EMPTY)) break;
+	}
+	return (DWORD)-1;
+}
+// Find the entry of the key in the table and in the old table (\return NULL if the key is not found)
+static SUS_OBJECT SUSAPI susMapFindEntry(_In_ SUS_HASHMAP map, _In_ const SUS_OBJECT key, _In_ SUS_HASH_T hash)
+{
+	DWORD i = susMapFind(map, key, hash);
+	if (i != (DWORD)-1) return susMapSlot(map, i);
+	// The entry has not been moved from the old table yet
+	if (map->old && (i = susMapFind(map->old, key, hash)) != (DWORD)-1) return susMapSlot(map->old, i);
+	return NULL;
+}
+// Request the cache lines of the first probed group of the hash in the table
+SUS_INLINE VOID SUSAPI susMapPrefetchGroup(_In_ SUS_HASHMAP table, _In_ SUS_HASH_T hash) {
+	DWORD i = susMapHashGroup(table, hash) * SUS_HASHTABLE_GROUP_WIDTH;
+	PreFetchCacheLine(PF_TEMPORAL_LEVEL_1, table->ctrl + i);
+	PreFetchCacheLine(PF_TEMPORAL_LEVEL_1, &susMapSlotHash(table, i));
+	PreFetchCacheLine(PF_TEMPORAL_LEVEL_1, susMapSlot(table, i));
+}
+// Request the cache lines of the first probed groups of the hash
+SUS_INLINE VOID SUSAPI susMapPrefetch(_In_ SUS_HASHMAP map, _In_ SUS_HASH_T hash) {
+	susMapPrefetchGroup(map, hash);
+	// During the rehash a miss in the new table probes the old one as well
+	if (map->old) susMapPrefetchGroup(map->old, hash);
+}
+// Free the slot of the removed entry
+static VOID SUSAPI susMapFreeSlot(_Inout_ SUS_HASHMAP map, _In_ DWORD i)
+{
+	// While the group has an empty slot, no probe has gone past it, so the slot becomes empty again
+	if (susMapGroupMatch(map->ctrl + (i & ~(DWORD)(SUS_HASHTABLE_GROUP_WIDTH - 1)), SUS_HASHTABLE_CTRL_EMPTY)) {
+		susMapSetCtrl(map, i, SUS_HASHTABLE_CTRL_EMPTY);
+		map->growthLeft++;
+	}
+	else susMapSetCtrl(map, i, SUS_HASHTABLE_CTRL_DELETED);
+}
+// Get the number of the slots for the requested count (a power of two)
+SUS_INLINE DWORD SUSAPI susMapNormalizeCapacity(_In_ DWORD count) {
+	DWORD capacity = SUS_HASHTABLE_GROUP_WIDTH;
+	while (capacity < count && capacity < 0x80000000u) capacity <<= 1;
+	return capacity;
+}
+
+// -------------------------------------------------------------------
+
+// Create a hash table in the allocator memory
+SUS_HASHMAP SUSAPI susNewMapAllocator(_In_ SIZE_T keySize, _In_ SIZE_T valueSize, _In_opt_ SUS_GET_HASH_CALLBACK getHash, _In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys, _In_opt_ DWORD initCount, _In_opt_ SUS_LPALLOCATOR allocator)
 {
 	SUS_PRINTDL("Creating a new hash table");
 	SUS_ASSERT(keySize);
-	SUS_HASHMAP map = sus_malloc(sizeof(SUS_HASHMAP_STRUCT) + (initCount ? initCount : SUS_HASHTABLE_INIT_COUNT) * sizeof(SUS_VECTOR));
+	DWORD capacity = susMapNormalizeCapacity(initCount ? initCount : SUS_HASHTABLE_INIT_COUNT);
+	DWORD entrySize = (DWORD)(keySize + valueSize);
+	SUS_HASHMAP map = susAllocatorAlloc(allocator, susMapTableSize(capacity, entrySize));
 	if (!map) return NULL;
-	map->capacity = initCount ? initCount : SUS_HASHTABLE_INIT_COUNT;
+	map->capacity = capacity;
 	map->count = 0;
+	map->growthLeft = susMapMaxLoad(capacity);
+	map->entrySize = entrySize;
 	map->valueSize = (DWORD)valueSize;
 	map->keySize = (DWORD)keySize;
 	map->getHash = getHash ? getHash : (keySize <= 4 ? susDefGetHashInt : susDefGetHash);
 	map->cmpKeys = cmpKeys ? cmpKeys : susDefCmpKeys;
-	for (DWORD i = 0; i < map->capacity; i++) map->buckets[i] = susNewVectorEx(keySize + valueSize);
+	map->getHash64 = NULL;
+	map->seed = 0;
+	map->allocator = allocator;
+	map->old = NULL;
+	map->migrated = 0;
+	sus_memset(map->ctrl, (BYTE)SUS_HASHTABLE_CTRL_EMPTY, capacity);
 	return map;
 }
+// Create a hash table
+SUS_HASHMAP SUSAPI susNewMapEx(_In_ SIZE_T keySize, _In_ SIZE_T valueSize, _In_opt_ SUS_GET_HASH_CALLBACK getHash, _In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys, _In_opt_ DWORD initCount) {
+	return susNewMapAllocator(keySize, valueSize, getHash, cmpKeys, initCount, NULL);
+}
+// Create a hash table with the seeded 64-bit hashing
+SUS_HASHMAP SUSAPI susNewMapSeededEx(_In_ SIZE_T keySize, _In_ SIZE_T valueSize, _In_opt_ SUS_GET_HASH64_CALLBACK getHash64, _In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys, _In_opt_ DWORD initCount, _In_opt_ SUS_LPALLOCATOR allocator)
+{
+	SUS_HASHMAP map = susNewMapAllocator(keySize, valueSize, NULL, cmpKeys, initCount, allocator);
+	if (!map) return NULL;
+	map->getHash64 = getHash64 ? getHash64 : (keySize <= sizeof(sus_u64_t) ? susDefGetHash64Int : susDefGetHash64);
+	map->seed = susHashSeed();
+	return map;
+}
+// Create an empty hash table with the same hashing as the source
+static SUS_HASHMAP SUSAPI susMapNewLike(_In_ SUS_HASHMAP source, _In_ DWORD initCount)
+{
+	SUS_HASHMAP map = susNewMapAllocator(source->keySize, source->valueSize, source->getHash, source->cmpKeys, initCount, source->allocator);
+	if (!map) return NULL;
+	map->getHash64 = source->getHash64;
+	map->seed = source->seed;
+	return map;
+}
+// Move the entry to the table by its stored hash without the key comparisons
+SUS_INLINE VOID SUSAPI susMapMoveEntry(_Inout_ SUS_HASHMAP map, _In_ SUS_HASHMAP source, _In_ DWORD i)
+{
+	SUS_OBJECT entry = susMapSlot(source, i);
+	SUS_HASH_T hash = susMapSlotHash(source, i);
+	DWORD slot = susMapFindFree(map, hash);
+	if (map->ctrl[slot] == SUS_HASHTABLE_CTRL_EMPTY) map->growthLeft--;
+	susMapSetHash(map, slot, hash);
+	sus_memcpy(susMapSlot(map, slot), entry, map->entrySize);
+}
+// Move the entries of one table to another without the key comparisons
+static VOID SUSAPI susMapMoveAll(_Inout_ SUS_HASHMAP map, _In_ SUS_HASHMAP source) {
+	for (DWORD i = 0; i < source->capacity; i++) {
+		if (!susMapCtrlIsFull(source->ctrl[i])) continue;
+		susMapMoveEntry(map, source, i);
+		map->count++;
+	}
+}
 // Change the size of the hash table
 SUS_HASHMAP SUSAPI susMapCopy(_In_ SUS_HASHMAP source, _In_ DWORD initCount)
 {
 	SUS_PRINTDL("Copying a hash table");
 	SUS_ASSERT(source);
-	SUS_HASHMAP map = susNewMapEx(source->keySize, source->valueSize, source->getHash, source->cmpKeys, initCount);
+	// The table must fit all the entries of the source
+	initCount = max(initCount, (DWORD)(source->count / SUS_HASHTABLE_RATIO) + 1);
+	SUS_HASHMAP map = susMapNewLike(source, initCount);
 	if (!map) return NULL;
-	susMapForeach(source, i) {
-		susMapAdd(&map, susMapIterKey(i), susMapIterValue(i));
-	}
+	susMapMoveAll(map, source);
+	if (source->old) susMapMoveAll(map, source->old);
 	return map;
 }
+// Change the size of the hash table at once
+VOID SUSAPI susMapResize(_Inout_ SUS_LPHASHMAP lpMap, _In_ DWORD newCount)
+{
+	SUS_ASSERT(lpMap && *lpMap);
+	SUS_HASHMAP source = *lpMap;
+	SUS_HASHMAP map = susMapCopy(source, newCount);
+	if (!map) return;
+	susMapDestroy(source);
+	*lpMap = map;
+}
+
+// Move the slots of the old table during the rehash (\return TRUE if the rehash is not finished yet)
+BOOL SUSAPI susMapStep(_Inout_ SUS_HASHMAP map, _In_ DWORD slotCount)
+{
+	SUS_ASSERT(map);
+	SUS_HASHMAP old = map->old;
+	if (!old) return FALSE;
+	DWORD end = old->capacity - map->migrated > slotCount ? map->migrated + slotCount : old->capacity;
+	for (; map->migrated < end && old->count; map->migrated++) {
+		if (!susMapCtrlIsFull(old->ctrl[map->migrated])) continue;
+		SUS_ASSERT(map->growthLeft);
+		susMapMoveEntry(map, old, map->migrated);
+		susMapSetCtrl(old, map->migrated, SUS_HASHTABLE_CTRL_DELETED);
+		old->count--;
+	}
+	if (map->migrated < old->capacity && old->count) return TRUE;
+	SUS_PRINTDL("The hash table rehash is finished");
+	susMapDestroy(old);
+	map->old = NULL;
+	map->migrated = 0;
+	return FALSE;
+}
+// Start the incremental rehash of the hash table to the new capacity
+static VOID SUSAPI susMapRehash(_Inout_ SUS_LPHASHMAP lpMap, _In_ DWORD newCount)
+{
+	SUS_PRINTDL("Starting the hash table rehash");
+	SUS_HASHMAP source = *lpMap;
+	SUS_ASSERT(!source->old);
+	SUS_HASHMAP map = susMapNewLike(source, newCount);
+	if (!map) return;
+	map->count = source->count;
+	map->old = source;
+	*lpMap = map;
+}
 
 // -------------------------------------------------------------------
 
@@ -44,17 +378,24 @@ VOID SUSAPI susMapReserve(_Inout_ SUS_LPHASHMAP lpMap)
 {
 	SUS_ASSERT(lpMap && *lpMap);
 	SUS_HASHMAP map = *lpMap;
-	if ((map->count + 1) >= map->capacity * SUS_HASHTABLE_RATIO) {
-		susMapResize(lpMap, map->capacity * SUS_HASHTABLE_GROWTH_FACTOR);
+	if (map->growthLeft) return;
+	// The previous rehash is finished before the next one
+	if (map->old) {
+		susMapStep(map, MAXDWORD);
+		if (map->growthLeft) return;
 	}
+	// The free slots are taken by the deleted ones - the table is rebuilt in the same size
+	if (map->count < susMapMaxLoad(map->capacity) / 2) susMapRehash(lpMap, map->capacity);
+	else susMapRehash(lpMap, map->capacity * SUS_HASHTABLE_GROWTH_FACTOR);
 }
 // Optimizing a hash table by resizing it for improved performance
 VOID SUSAPI susMapCompress(_Inout_ SUS_LPHASHMAP lpMap)
 {
 	SUS_ASSERT(lpMap && *lpMap);
 	SUS_HASHMAP map = *lpMap;
+	if (map->old) return;
 	if (map->count < map->capacity * (1 - SUS_HASHTABLE_RATIO) && map->capacity > SUS_HASHTABLE_INIT_COUNT) {
-		susMapResize(lpMap, map->capacity / SUS_HASHTABLE_GROWTH_FACTOR);
+		susMapRehash(lpMap, map->capacity / SUS_HASHTABLE_GROWTH_FACTOR);
 	}
 }
 
@@ -65,25 +406,49 @@ SUS_OBJECT SUSAPI susMapGetEntry(_In_ SUS_HASHMAP map, _In_bytecount_(map->value
 {
 	SUS_PRINTDL("Getting a node from a hash table");
 	SUS_ASSERT(map && key);
-	SUS_VECTOR bucket = map->buckets[susMapGetIndex(map, key)];
-	susVecForeach(i, bucket) {
-		LPBYTE entry = (LPBYTE)susVectorAt(bucket, i);
-		if (map->cmpKeys(susMapKey(map, entry), key, map->keySize)) {
-			return entry;
+	return susMapFindEntry(map, key, susMapHash(map, key));
+}
+// Get the values of the keys at once
+DWORD SUSAPI susMapGetBatch(_In_ SUS_HASHMAP map, _In_reads_bytes_(count * map->keySize) const SUS_OBJECT keys, _In_ DWORD count, _Out_writes_(count) SUS_OBJECT* values)
+{
+	SUS_PRINTDL("Getting a batch of nodes from a hash table");
+	SUS_ASSERT(map && ((keys && values) || !count));
+	SUS_HASH_T hashes[SUS_HASHTABLE_BATCH_SIZE];
+	DWORD found = 0;
+	for (DWORD start = 0; start < count; start += SUS_HASHTABLE_BATCH_SIZE) {
+		LPBYTE batch = (LPBYTE)keys + (SIZE_T)start * map->keySize;
+		DWORD size = min(count - start, SUS_HASHTABLE_BATCH_SIZE);
+		// All the groups of the batch are requested before the first one is read
+		for (DWORD j = 0; j < size; j++) {
+			hashes[j] = susMapHash(map, batch + (SIZE_T)j * map->keySize);
+			susMapPrefetch(map, hashes[j]);
+		}
+		for (DWORD j = 0; j < size; j++) {
+			SUS_OBJECT entry = susMapFindEntry(map, batch + (SIZE_T)j * map->keySize, hashes[j]);
+			values[start + j] = entry ? susMapValue(map, entry) : NULL;
+			if (entry) found++;
 		}
 	}
-	return NULL;
+	return found;
 }
 // Add a new key-value pair to the hash table
 SUS_OBJECT SUSAPI susMapAdd(_Inout_ SUS_LPHASHMAP lpMap, _In_bytecount_((*lpMap)->keySize) SUS_OBJECT key, _In_opt_bytecount_((*lpMap)->valueSize) SUS_OBJECT value)
 {
 	SUS_PRINTDL("Adding a new key-value pair to a hash table");
 	SUS_ASSERT(lpMap && *lpMap && key && !susMapGetEntry(*lpMap, key));
-	susMapReserve(lpMap);
+	susMapStep(*lpMap, SUS_HASHTABLE_MIGRATE_STEP);
+	SUS_HASH_T hash = susMapHash(*lpMap, key);
+	DWORD i = susMapFindFree(*lpMap, hash);
+	// The deleted slot is reused without the growth
+	if ((*lpMap)->ctrl[i] == SUS_HASHTABLE_CTRL_EMPTY && !(*lpMap)->growthLeft) {
+		susMapReserve(lpMap);
+		if (!(*lpMap)->growthLeft) return NULL;
+		i = susMapFindFree(*lpMap, hash);
+	}
 	SUS_HASHMAP map = *lpMap;
-	SUS_LPVECTOR bucket = &map->buckets[susMapGetIndex(map, key)];
-	sus_lpbyte_t entry = susVectorPush(bucket, NULL);
-	if (!entry) return NULL;
+	if (map->ctrl[i] == SUS_HASHTABLE_CTRL_EMPTY) map->growthLeft--;
+	susMapSetHash(map, i, hash);
+	SUS_OBJECT entry = susMapSlot(map, i);
 	sus_memcpy(susMapKey(map, entry), key, map->keySize);
 	if (value) sus_memcpy(susMapValue(map, entry), value, map->valueSize);
 	else sus_zeromem(susMapValue(map, entry), map->valueSize);
@@ -105,34 +470,50 @@ VOID SUSAPI susMapRemove(_Inout_ SUS_LPHASHMAP lpMap, _In_bytecount_((*lpMap)->k
 	SUS_PRINTDL("Deleting an item from a table");
 	SUS_ASSERT(lpMap && *lpMap && key && susMapGet(*lpMap, key));
 	SUS_HASHMAP map = *lpMap;
-	SUS_LPVECTOR bucket = &map->buckets[susMapGetIndex(map, key)];
-	susVecForeach(i, *bucket) {
-		LPBYTE entry = (LPBYTE)susVectorAt(*bucket, i);
-		if (map->cmpKeys(susMapKey(map, entry), key, map->keySize)) {
-			susVectorErase(bucket, i);
-			map->count--;
-			susMapCompress(lpMap);
-			return;
-		}
+	susMapStep(map, SUS_HASHTABLE_MIGRATE_STEP);
+	SUS_HASH_T hash = susMapHash(map, key);
+	DWORD i = susMapFind(map, key, hash);
+	if (i != (DWORD)-1) susMapFreeSlot(map, i);
+	else if (map->old && (i = susMapFind(map->old, key, hash)) != (DWORD)-1) {
+		susMapFreeSlot(map->old, i);
+		map->old->count--;
 	}
+	else return;
+	map->count--;
+	susMapCompress(lpMap);
 }
 // Clearing all hash table elements
 VOID SUSAPI susMapClear(_In_ SUS_HASHMAP map)
 {
-	for (DWORD i = 0; i < map->capacity; i++) {
-		susVectorDestroy(map->buckets[i]);
+	SUS_ASSERT(map);
+	if (map->old) {
+		susMapDestroy(map->old);
+		map->old = NULL;
+		map->migrated = 0;
 	}
+	sus_memset(map->ctrl, (BYTE)SUS_HASHTABLE_CTRL_EMPTY, map->capacity);
 	map->count = 0;
+	map->growthLeft = susMapMaxLoad(map->capacity);
 }
 
 // -------------------------------------------------------------------
 
+// Skip the free slots of the iterator (the old table goes after the new one)
+static VOID SUSAPI susMapIterSeek(_Inout_ SUS_LPMAP_ITER iter)
+{
+	for (;;) {
+		while (iter->slotIndex < iter->table->capacity && !susMapCtrlIsFull(iter->table->ctrl[iter->slotIndex])) iter->slotIndex++;
+		if (iter->slotIndex < iter->table->capacity || iter->table != iter->map || !iter->map->old) return;
+		iter->table = iter->map->old;
+		iter->slotIndex = 0;
+	}
+}
 // Start getting data from the hash table
 SUS_MAP_ITER SUSAPI susMapIterBegin(_In_ SUS_HASHMAP map)
 {
 	SUS_ASSERT(map);
-	SUS_MAP_ITER iter = { .map = map, .bucketIndex = 0, .entryIndex = 0 };
-	while (iter.bucketIndex < iter.map->capacity && !iter.map->buckets[iter.bucketIndex]->length) iter.bucketIndex++;
+	SUS_MAP_ITER iter = { .map = map, .table = map, .slotIndex = 0, .count = 0 };
+	susMapIterSeek(&iter);
 	return iter;
 }
 // Go to the next element in the hash table
@@ -141,13 +522,9 @@ BOOL SUSAPI susMapIterNext(_Inout_ SUS_LPMAP_ITER iter)
 	SUS_ASSERT(iter && iter->map);
 	if (iter->count >= iter->map->count) return FALSE;
 	iter->count++;
-	if (iter->entryIndex + 1 < iter->map->buckets[iter->bucketIndex]->length) {
-		iter->entryIndex++;
-		return TRUE;
-	}
-	iter->entryIndex = 0;
-	do iter->bucketIndex++; while (iter->bucketIndex < iter->map->capacity && !iter->map->buckets[iter->bucketIndex]->length);
-	return iter->bucketIndex < iter->map->capacity;
+	iter->slotIndex++;
+	susMapIterSeek(iter);
+	return iter->slotIndex < iter->table->capacity;
 }
 
 // -------------------------------------------------------------------
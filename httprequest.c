@@ -1,5 +1,6 @@
 // httprequest.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_NET
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/memory.h"
@@ -183,22 +184,28 @@ static BOOL SUSAPI susHttpQueryHeaders(_In_ HINTERNET hRequest, _Inout_ SUS_LPHA
 	return FALSE;
 }
 // Request a response body
-static BOOL SUSAPI susHttpQueryBody(_In_ HINTERNET hRequest, _Out_ SUS_LPDATAVIEW body) {
+static BOOL SUSAPI susHttpQueryBody(_In_ HINTERNET hRequest, _Out_ SUS_LPBYTES body) {
 	SUS_ASSERT(hRequest && body);
-	*body = (SUS_DATAVIEW){ 0 };
-	SUS_BUFFER buff = susNewBuffer(1024);
+	*body = (SUS_BYTES){ 0 };
+	SUS_BYTES content = susNewBytes(1024);
+	if (!content.data) return FALSE;
+	SIZE_T size = 0;
 	DWORD dwAvailable = 0;
 	while (WinHttpQueryDataAvailable(hRequest, &dwAvailable) && dwAvailable) {
 		DWORD read = 0;
-		if (!WinHttpReadData(hRequest, susBufferPush(&buff, NULL, dwAvailable), dwAvailable, &read) || !read) {
-			susBufferDestroy(buff);
+		if ((size + dwAvailable > content.size && !susBytesResize(&content, max(content.size * 2, size + dwAvailable)))
+			|| !WinHttpReadData(hRequest, content.data + size, dwAvailable, &read) || !read) {
+			susBytesRelease(&content);
 			SUS_PRINTDE("Couldn't read response body data");
 			return FALSE;
 		}
+		size += read;
+	}
+	if (!susBytesResize(&content, size)) {
+		content.size = size;
+		content.data[size] = 0;
 	}
-	*body = susNewData(buff->size);
-	sus_memcpy((sus_lpbyte_t)body->data, buff->data, buff->size);
-	susBufferDestroy(buff);
+	*body = content;
 	return TRUE;
 }
 
@@ -318,14 +325,17 @@ BOOL SUSAPI susHttpRequestExecute(_In_ HINTERNET hRequest, _In_opt_ LPCWSTR lpsz
 		susHttpSetHeader(hRequest, L"Content-Type", susHttpContentTypeToString[body.type], FALSE);
 		susHttpSetHeader(hRequest, L"Content-Encoding", susHttpContentEncodingToString[body.encoding], FALSE);
 	}
-	if (!WinHttpSendRequest(hRequest, lpszHeaders, (DWORD)-1, NULL, 0, (DWORD)body.content.size, 0)) {
+	// The total length is a DWORD, the larger bodies are sent with the Content-Length header only
+	DWORD dwTotalLength = body.content.size > MAXDWORD ? WINHTTP_IGNORE_REQUEST_TOTAL_LENGTH : (DWORD)body.content.size;
+	if (!WinHttpSendRequest(hRequest, lpszHeaders, (DWORD)-1, NULL, 0, dwTotalLength, 0)) {
 		SUS_PRINTDE("Couldn't send request");
 		SUS_PRINTDC(GetLastError());
 		return FALSE;
 	}
 	if (body.content.data) {
-		for (SIZE_T sent = 0, written = 1; sent < body.content.size; sent += written) {
-			if (!WinHttpWriteData(hRequest, body.content.data + sent, (DWORD)min(body.content.size - sent, 1024), (LPDWORD)&written)) return FALSE;
+		DWORD written = 0;
+		for (SIZE_T sent = 0; sent < body.content.size; sent += written) {
+			if (!WinHttpWriteData(hRequest, body.content.data + sent, (DWORD)min(body.content.size - sent, SUS_HTTP_WRITE_PART_SIZE), &written)) return FALSE;
 			if (!written) break;
 		}
 	}
@@ -396,6 +406,5 @@ VOID SUSAPI susHttpResponseCleanup(_Inout_ SUS_LPHTTP_RESPONSE res)
 		susMapDestroy(res->headers);
 	}
 	res->headers = NULL;
-	if (res->body.content.data) susDataDestroy(res->body.content);
-	res->body.content.data = NULL;
+	susBytesRelease(&res->body.content);
 }
\ No newline at end of file
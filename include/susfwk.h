@@ -40,9 +40,14 @@ Abstract:
 
 #include "susfwk/memory.h"
 #include "susfwk/buffer.h"
+#include "susfwk/chain.h"
 #include "susfwk/vector.h"
+#include "susfwk/deque.h"
 #include "susfwk/linkedlist.h"
 #include "susfwk/hashtable.h"
+#include "susfwk/atom.h"
+#include "susfwk/cmap.h"
+#include "susfwk/tree.h"
 
 #ifndef SSUSINIMAL
     #include "susfwk/regapi.h"
@@ -7,7 +7,7 @@
 
 //////////////////////////////////////////////
 // KeyFormat - "/module/submodule/.../name"	//
-// Key - String literal						//
+// Key - Any string (interned)				//
 // Value - Pointer							//
 //////////////////////////////////////////////
 
@@ -0,0 +1,102 @@
+// atom.h
+//
+#ifndef _SUS_ATOM_
+#define _SUS_ATOM_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // !__cplusplus
+
+#include "hashtable.h"
+#pragma warning(push)
+#pragma warning(disable: 4200)
+
+/*
+* An atom is an interned string: every distinct string is stored once for
+* the lifetime of the process, so two atoms are equal only if the pointers are equal.
+* An atom is an ordinary null-terminated string and can be passed wherever LPCSTR is expected.
+* The hash and the length are computed once when the string is interned.
+*/
+
+// ================================================================================================
+
+// Initial number of slots in the atom table
+#define SUS_ATOM_TABLE_INIT_COUNT 256
+
+// ---------------------------------------------------------
+
+// Interned string
+typedef LPCSTR SUS_ATOM;
+// Atom header (precedes the atom string)
+typedef struct sus_atom_header {
+	SUS_HASH_T	hash;		// String hash
+	DWORD		length;		// String length in characters
+	CHAR		string[];	// Null-terminated string
+} SUS_ATOM_HEADER, *SUS_LPATOM_HEADER;
+
+// Get the atom header
+#define susAtomHeader(atom) ((SUS_LPATOM_HEADER)((LPBYTE)(atom) - SUS_OFFSET_OF(SUS_ATOM_HEADER, string)))
+
+// ---------------------------------------------------------
+
+// Intern a string of the specified length
+SUS_ATOM SUSAPI susAtomEx(
+	_In_reads_(length) LPCSTR string,
+	_In_ DWORD length
+);
+// Find an interned string of the specified length (\return NULL if the string is not interned)
+SUS_ATOM SUSAPI susAtomFindEx(
+	_In_reads_(length) LPCSTR string,
+	_In_ DWORD length
+);
+// Free all atoms (all atoms and atom maps become invalid)
+VOID SUSAPI susAtomCleanup();
+
+// Intern a string
+SUS_INLINE SUS_ATOM SUSAPI susAtom(_In_ LPCSTR string) {
+	SUS_ASSERT(string);
+	return susAtomEx(string, lstrlenA(string));
+}
+// Find an interned string
+SUS_INLINE SUS_ATOM SUSAPI susAtomFind(_In_ LPCSTR string) {
+	SUS_ASSERT(string);
+	return susAtomFindEx(string, lstrlenA(string));
+}
+// Get the hash of the atom
+SUS_INLINE SUS_HASH_T SUSAPI susAtomHash(_In_ SUS_ATOM atom) {
+	SUS_ASSERT(atom);
+	return susAtomHeader(atom)->hash;
+}
+// Get the length of the atom
+SUS_INLINE DWORD SUSAPI susAtomLength(_In_ SUS_ATOM atom) {
+	SUS_ASSERT(atom);
+	return susAtomHeader(atom)->length;
+}
+
+// ================================================================================================
+
+// Get a hash by the atom key
+SUS_HASH_T SUSAPI susDefGetAtomHash(
+	_In_ SUS_DATAVIEW key
+);
+// Atom key comparison
+BOOL SUSAPI susDefCmpAtomKeys(
+	_In_ SUS_OBJECT key1,
+	_In_ SUS_OBJECT key2,
+	_In_ SIZE_T size
+);
+
+// Create a hash table with atom keys
+#define susNewAtomMap(valueType) susNewMapEx(sizeof(SUS_ATOM), sizeof(valueType), susDefGetAtomHash, susDefCmpAtomKeys, 0)
+// Check whether the hash table keys are atoms
+#define susMapIsAtomKeys(map) ((map)->cmpKeys == susDefCmpAtomKeys)
+
+// ================================================================================================
+
+#pragma warning(pop)
+
+#ifdef __cplusplus
+}
+#endif // !__cplusplus
+
+#endif // !_SUS_ATOM_
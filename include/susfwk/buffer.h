@@ -17,44 +17,129 @@
 #define	SUS_BUFFER_GROW_FACTOR 1.6f
 // The degree to which the buffer will be folded
 #define	SUS_BUFFER_SHRINK_THRESHOLD 4.0f
+// Number of underloaded removals before the hysteresis policy shrinks the container
+#define SUS_BUFFER_SHRINK_DELAY 16
+
+// Growth and shrink policy of the dynamic containers
+typedef enum sus_growth_policy {
+	SUS_GROWTH_POLICY_FACTOR,		// Grow by SUS_BUFFER_GROW_FACTOR, shrink when the occupancy drops below 1/SUS_BUFFER_SHRINK_THRESHOLD (default)
+	SUS_GROWTH_POLICY_POW2,			// Capacity is a power of two, halved when no more than a quarter is occupied
+	SUS_GROWTH_POLICY_NEVER_SHRINK,	// Grow by SUS_BUFFER_GROW_FACTOR, shrink only on request
+	SUS_GROWTH_POLICY_HYSTERESIS	// Grow by SUS_BUFFER_GROW_FACTOR, shrink to twice the size after SUS_BUFFER_SHRINK_DELAY underloaded removals
+} SUS_GROWTH_POLICY;
+
+// Get the capacity for the required size
+sus_csize_t SUSAPI susGrowthPolicyGrow(_In_ SUS_GROWTH_POLICY policy, _In_ sus_csize_t required);
+// Get the capacity after the removal (\return the current capacity if the container should stay as it is)
+sus_csize_t SUSAPI susGrowthPolicyShrink(_In_ SUS_GROWTH_POLICY policy, _In_ sus_csize_t size, _In_ sus_csize_t capacity, _In_ sus_csize_t minCapacity, _Inout_ sus_u16_t* underload);
+// Check whether the container is underloaded according to the policy
+#define susGrowthPolicyIsUnderloaded(policy, size, capacity, minCapacity) ( \
+	(policy) == SUS_GROWTH_POLICY_NEVER_SHRINK ? FALSE : \
+	(policy) == SUS_GROWTH_POLICY_POW2 ? ((capacity) > (minCapacity) && (sus_size_t)(size) * 4 <= (capacity)) : \
+	((capacity) > (minCapacity) * SUS_BUFFER_GROW_FACTOR && (capacity) > (size) * SUS_BUFFER_SHRINK_THRESHOLD))
+
+// ---------------------------------------------------------------------------------------
+
+/*
+* A buffer can be used as a byte stream: the data is appended at the end
+* (susBufferPush or susBufferPrepare + susBufferCommit) and consumed from the front
+* with susBufferConsume, which only moves the read offset. The unread data is always
+* one contiguous span (susBufferPeek); the consumed space is reclaimed when susBufferPush
+* or susBufferPrepare runs out of room and no less data is consumed than is left unread,
+* so every byte is moved at most once on average. The positional functions count from
+* the beginning of the storage, including the consumed bytes; they never compact the buffer,
+* so the positions stay valid between a consumption and the next append.
+*/
+
 // Dynamically expandable buffer
 typedef struct sus_buffer {
-	sus_size32_t	size;		// Occupied size in bytes
-	sus_size32_t	capacity;	// Buffer capacity in bytes
-	sus_byte_t		data[];		// Buffer Data
+	sus_csize_t	size;		// Occupied size in bytes (the end of the data)
+	sus_csize_t	capacity;	// Buffer capacity in bytes
+	sus_csize_t	head;		// Read offset - the number of the consumed bytes at the front
+	SUS_LPALLOCATOR	allocator;	// Memory allocator (NULL - process heap)
+	sus_u16_t		policy;		// Growth policy (SUS_GROWTH_POLICY)
+	sus_u16_t		underload;	// Underloaded removals counter (hysteresis policy)
+	SUS_ALIGNAS(MEMORY_ALLOCATION_ALIGNMENT) sus_byte_t data[];	// Buffer Data
 } SUS_BUFFER_STRUCT, *SUS_BUFFER, **SUS_LPBUFFER;
 
 // ---------------------------------------------------------------------------------------
 
+// reate a new buffer (alignment - alignment of the data, 0 - MEMORY_ALLOCATION_ALIGNMENT)
+SUS_BUFFER SUSAPI susNewBufferEx(_In_opt_ sus_csize_t capacity, _In_opt_ SIZE_T alignment);
 // reate a new buffer
-SUS_BUFFER SUSAPI susNewBuffer(_In_opt_ sus_size32_t capacity);
+#define susNewBuffer(capacity) susNewBufferEx(capacity, 0)
+// Create a new buffer in the allocator memory
+SUS_BUFFER SUSAPI susNewBufferAllocator(_In_opt_ sus_csize_t capacity, _In_opt_ SUS_LPALLOCATOR allocator);
+// Create a new buffer in the arena
+#define susNewBufferArena(arena, capacity) susNewBufferAllocator(capacity, &(arena)->super)
+// Create a new buffer that grows in place inside a reserved region (the buffer pointer never changes)
+SUS_BUFFER SUSAPI susNewBufferRegion(_In_opt_ sus_csize_t capacity, _In_ SIZE_T maxCapacity, _In_ SUS_VREGION_FLAGS flags);
 // Delete Buffer
 VOID SUSAPI susBufferDestroy(_In_ SUS_BUFFER buffer);
 // Apply changes to the buffer
 BOOL SUSAPI susBufferFlush(_Inout_ SUS_LPBUFFER lpBuffer);
+// Set the growth policy of the buffer
+#define susBufferSetPolicy(buffer, growthPolicy) ((buffer)->policy = (sus_u16_t)(growthPolicy), (buffer)->underload = 0)
+// Guarantee the space for the specified number of bytes after the end of the data
+BOOL SUSAPI susBufferReserve(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t reserve);
+// Shrink the capacity of the buffer to its size
+BOOL SUSAPI susBufferShrinkToFit(_Inout_ SUS_LPBUFFER lpBuffer);
+// Move the unread data to the beginning of the storage
+VOID SUSAPI susBufferCompact(_Inout_ SUS_BUFFER buffer);
+// Get the free space at the end of the buffer for direct writing (\return NULL on failure)
+sus_lpbyte_t SUSAPI susBufferPrepare(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t size);
 
 // ---------------------------------------------------------------------------------------
 
 // Paste the data into the buffer
-SUS_LPMEMORY SUSAPI susBufferInsert(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t pos, _In_opt_ sus_lpbyte_t data, _In_ sus_size32_t size);
+SUS_LPMEMORY SUSAPI susBufferInsert(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t pos, _In_opt_ sus_lpbyte_t data, _In_ sus_csize_t size);
 // Paste the data into the buffer
-BOOL SUSAPI susBufferErase(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t pos, _In_ sus_size32_t size);
+BOOL SUSAPI susBufferErase(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t pos, _In_ sus_csize_t size);
 // Set the data to the buffer
-SUS_LPMEMORY SUSAPI susBufferSet(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t pos, _In_opt_ sus_lpbyte_t data, _In_ sus_size32_t size);
+SUS_LPMEMORY SUSAPI susBufferSet(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t pos, _In_opt_ sus_lpbyte_t data, _In_ sus_csize_t size);
 // Swap two buffer elements
-BOOL SUSAPI susBufferSwap(_Inout_ SUS_BUFFER buffer, _In_ sus_size32_t from, _In_ sus_size32_t to, _In_ sus_size32_t size);
+BOOL SUSAPI susBufferSwap(_Inout_ SUS_BUFFER buffer, _In_ sus_csize_t from, _In_ sus_csize_t to, _In_ sus_csize_t size);
 
 // ---------------------------------------------------------------------------------------
 
 // Insert the last element
-SUS_INLINE SUS_LPMEMORY SUSAPI susBufferPush(_Inout_ SUS_LPBUFFER lpBuffer, _In_opt_ sus_lpbyte_t data, _In_ sus_size32_t size) { return susBufferInsert(lpBuffer, (*lpBuffer)->size, data, size); }
+SUS_INLINE SUS_LPMEMORY SUSAPI susBufferPush(_Inout_ SUS_LPBUFFER lpBuffer, _In_opt_ sus_lpbyte_t data, _In_ sus_csize_t size) {
+	// The preparation may reclaim the consumed space and move the end of the data
+	if (!susBufferPrepare(lpBuffer, size)) return NULL;
+	return susBufferInsert(lpBuffer, (*lpBuffer)->size, data, size);
+}
 // Delete the last buffer element
-SUS_INLINE BOOL SUSAPI susBufferPop(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t size) { return susBufferErase(lpBuffer, (*lpBuffer)->size - size, size); }
+SUS_INLINE BOOL SUSAPI susBufferPop(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t size) { return susBufferErase(lpBuffer, (*lpBuffer)->size - size, size); }
 
 // Insert the first element
-SUS_INLINE SUS_LPMEMORY SUSAPI susBufferUnshift(_Inout_ SUS_LPBUFFER lpBuffer, _In_opt_ sus_lpbyte_t data, _In_ sus_size32_t size) { return susBufferInsert(lpBuffer, 0, data, size); }
+SUS_INLINE SUS_LPMEMORY SUSAPI susBufferUnshift(_Inout_ SUS_LPBUFFER lpBuffer, _In_opt_ sus_lpbyte_t data, _In_ sus_csize_t size) { return susBufferInsert(lpBuffer, 0, data, size); }
 // Delete the first buffer element
-SUS_INLINE BOOL SUSAPI susBufferShift(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_size32_t size) { return susBufferErase(lpBuffer, 0, size); }
+SUS_INLINE BOOL SUSAPI susBufferShift(_Inout_ SUS_LPBUFFER lpBuffer, _In_ sus_csize_t size) { return susBufferErase(lpBuffer, 0, size); }
+
+// ---------------------------------------------------------------------------------------
+
+// Get the unread data of the buffer
+#define susBufferReadData(buffer) ((buffer)->data + (buffer)->head)
+// Get the size of the unread data of the buffer
+#define susBufferReadSize(buffer) ((buffer)->size - (buffer)->head)
+
+// Add the bytes written to the prepared space to the data
+SUS_INLINE VOID SUSAPI susBufferCommit(_Inout_ SUS_BUFFER buffer, _In_ sus_csize_t size) {
+	SUS_ASSERT(buffer && buffer->size + size <= buffer->capacity);
+	buffer->size += size;
+}
+// Look at the unread data without consuming it
+SUS_INLINE SUS_DATAVIEW SUSAPI susBufferPeek(_In_ SUS_BUFFER buffer) {
+	SUS_ASSERT(buffer);
+	return (SUS_DATAVIEW) { .data = susBufferReadData(buffer), .size = susBufferReadSize(buffer) };
+}
+// Remove the bytes from the front of the unread data
+SUS_INLINE VOID SUSAPI susBufferConsume(_Inout_ SUS_BUFFER buffer, _In_ sus_csize_t size) {
+	SUS_ASSERT(buffer && size <= susBufferReadSize(buffer));
+	buffer->head += size;
+	// Everything is read - the stream starts from the beginning again
+	if (buffer->head == buffer->size) buffer->head = buffer->size = 0;
+}
 
 // ---------------------------------------------------------------------------------------
 
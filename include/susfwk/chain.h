@@ -0,0 +1,127 @@
+// chain.h
+//
+#ifndef _SUS_CHAIN_
+#define _SUS_CHAIN_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // !__cplusplus
+
+#pragma warning(push)
+#pragma warning(disable: 4200)
+
+/*
+* A chain is a byte sequence stored in a list of fixed-size blocks taken from a pool.
+* Appending never moves the data that is already written, and the chains are joined
+* by relinking the blocks. The data is visible as the list of the block spans
+* (susChainSpans), which can be passed to a vectored send or write as it is;
+* a contiguous copy is made only on request (susChainLinearize).
+*/
+
+// =======================================================================================
+
+// Size of the chain block in bytes (including the block header)
+#define SUS_CHAIN_BLOCK_SIZE 4096
+
+// -------------------------------------------------------------------
+
+// Chain block
+typedef struct sus_chain_block {
+	struct sus_chain_block*	next;		// The next block
+	sus_size32_t			begin;		// Offset of the first byte of the data
+	sus_size32_t			end;		// Offset behind the last byte of the data
+	sus_size32_t			capacity;	// Size of the block storage in bytes
+	SUS_ALIGNAS(16) sus_byte_t data[];	// Block storage
+} SUS_CHAIN_BLOCK, *SUS_LPCHAIN_BLOCK;
+
+// Chain of data blocks
+typedef struct sus_chain {
+	SUS_LPCHAIN_BLOCK	first;		// The first block
+	SUS_LPCHAIN_BLOCK	last;		// The last block
+	SIZE_T				size;		// Total size of the data in bytes
+	SUS_LPPOOL			pool;		// Block pool
+} SUS_CHAIN, *SUS_LPCHAIN;
+
+// -------------------------------------------------------------------
+
+// Create a chain with the blocks from the pool (NULL - the shared block pool)
+SUS_CHAIN SUSAPI susChainSetupEx(
+	_In_opt_ SUS_LPPOOL pool
+);
+// Create a chain with the blocks from the shared block pool
+#define susChainSetup() susChainSetupEx(NULL)
+// Free all the chain blocks (the chain stays usable)
+VOID SUSAPI susChainCleanup(
+	_Inout_ SUS_LPCHAIN chain
+);
+
+// -------------------------------------------------------------------
+
+// Add the data to the end of the chain
+BOOL SUSAPI susChainAppend(
+	_Inout_ SUS_LPCHAIN chain,
+	_In_reads_bytes_(size) const sus_lpbyte_t data,
+	_In_ SIZE_T size
+);
+// Add the data to the beginning of the chain (headers are written into the free space before the data if there is enough)
+BOOL SUSAPI susChainPrepend(
+	_Inout_ SUS_LPCHAIN chain,
+	_In_reads_bytes_(size) const sus_lpbyte_t data,
+	_In_ SIZE_T size
+);
+// Get the free space at the end of the chain for direct writing (\return NULL on failure)
+sus_lpbyte_t SUSAPI susChainPrepare(
+	_Inout_ SUS_LPCHAIN chain,
+	_Out_ sus_size32_t* available
+);
+// Add the bytes written to the prepared space to the data
+VOID SUSAPI susChainCommit(
+	_Inout_ SUS_LPCHAIN chain,
+	_In_ sus_size32_t size
+);
+// Move all the blocks of the source chain to the end of the chain (the source becomes empty)
+VOID SUSAPI susChainSplice(
+	_Inout_ SUS_LPCHAIN chain,
+	_Inout_ SUS_LPCHAIN source
+);
+// Remove the bytes from the beginning of the chain
+VOID SUSAPI susChainConsume(
+	_Inout_ SUS_LPCHAIN chain,
+	_In_ SIZE_T size
+);
+
+// -------------------------------------------------------------------
+
+// Get the spans of the data in order (\return the number of the received spans)
+sus_uint_t SUSAPI susChainSpans(
+	_In_ SUS_LPCHAIN chain,
+	_Out_writes_to_(maxCount, return) SUS_LPDATAVIEW spans,
+	_In_ sus_uint_t maxCount
+);
+// Copy the bytes from the beginning of the chain to the buffer (\return the number of the copied bytes)
+SIZE_T SUSAPI susChainRead(
+	_In_ SUS_LPCHAIN chain,
+	_Out_writes_bytes_(size) sus_lpbyte_t buffer,
+	_In_ SIZE_T size
+);
+// Make the data of the chain contiguous (the data stays owned by the chain)\return An empty view if the memory ran out or the chain is larger than MAXDWORD bytes
+SUS_DATAVIEW SUSAPI susChainLinearize(
+	_Inout_ SUS_LPCHAIN chain
+);
+
+// Walk through the chain blocks
+#define susChainForeach(block, chain) for (SUS_LPCHAIN_BLOCK block = (chain)->first; block; block = block->next)
+// Add the string to the end of the chain
+#define susChainAppendText(chain, text) susChainAppend(chain, (sus_lpbyte_t)(text), (SIZE_T)lstrlenA(text) * sizeof(CHAR))
+
+// -------------------------------------------------------------------
+
+// =======================================================================================
+
+#pragma warning(pop)
+
+#ifdef __cplusplus
+}
+#endif // !__cplusplus
+
+#endif // !_SUS_CHAIN_
@@ -0,0 +1,146 @@
+// cmap.h
+//
+#ifndef _SUS_CONCURRENT_MAP_
+#define _SUS_CONCURRENT_MAP_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // !__cplusplus
+
+#include "hashtable.h"
+#pragma warning(push)
+#pragma warning(disable: 4200)
+
+/*
+* A concurrent map is a hash table shared by threads. The lookups take no locks:
+* a reader marks itself in the reader counters of the current epoch and walks
+* the bucket chains, which are changed only by publishing whole nodes.
+* The writers lock one of the stripes selected by the key hash, and the resize
+* locks all the stripes while the readers go on with the old table.
+* The resize stops the writers: the nodes are copied to the doubled table at once,
+* so a writer that comes during the copy waits for all of it (O(n) once per doubling,
+* O(1) per insertion on average). The buckets are not moved one by one, since that would
+* need forwarding nodes in the chains that every lookup has to follow. A map whose writers
+* must not stall is created with initCount of the expected number of the entries.
+* The nodes and the tables removed by the writers are freed after all the readers
+* that could see them have left (the epoch is advanced and the old readers are waited for).
+*/
+
+// =======================================================================================
+
+// Number of the write locks (a power of two)
+#define SUS_CMAP_STRIPE_COUNT 16
+// Number of the reader counters (the threads are spread over them by the thread id)
+#define SUS_CMAP_READER_SLOTS 16
+// Default number of the buckets (a power of two, not less than SUS_CMAP_STRIPE_COUNT)
+#define SUS_CMAP_INIT_COUNT 16
+// Maximum number of the entries per bucket
+#define SUS_CMAP_RATIO 1
+// Number of the removed nodes after which the memory is reclaimed
+#define SUS_CMAP_RECLAIM_COUNT 64
+
+// -------------------------------------------------------------------
+
+// Removed memory that is waiting for the readers to leave
+typedef struct sus_cmap_garbage {
+	struct sus_cmap_garbage*	next;	// The next removed block
+} SUS_CMAP_GARBAGE, *SUS_LPCMAP_GARBAGE;
+
+// Concurrent map node
+typedef struct sus_cmap_node {
+	SUS_CMAP_GARBAGE				garbage;	// Link of the removed nodes
+	struct sus_cmap_node* volatile	next;		// The next node of the bucket
+	SUS_HASH_T						hash;		// Key hash
+	SUS_ALIGNAS(16) sus_byte_t		entry[];	// Key followed by the value
+} SUS_CMAP_NODE, *SUS_LPCMAP_NODE;
+
+// Concurrent map bucket table
+typedef struct sus_cmap_table {
+	SUS_CMAP_GARBAGE				garbage;	// Link of the removed tables
+	DWORD							capacity;	// Number of the buckets (a power of two)
+	SUS_LPCMAP_NODE volatile		buckets[];	// Bucket chains
+} SUS_CMAP_TABLE, *SUS_LPCMAP_TABLE;
+
+// Reader counters of the odd and even epochs
+typedef struct sus_cmap_readers {
+	volatile LONG count[2];
+} SUS_CMAP_READERS;
+
+// Concurrent hash table
+typedef struct sus_cmap {
+	SUS_LPCMAP_TABLE volatile	table;		// Current bucket table
+	SUS_GET_HASH_CALLBACK		getHash;	// Hashing function
+	SUS_CMP_KEYS_CALLBACK		cmpKeys;	// Key comparison function
+	DWORD						keySize;	// Key size in bytes
+	DWORD						valueSize;	// Value size in bytes
+	volatile LONG				count;		// Total number of the entries
+	volatile LONG				epoch;		// Current epoch of the readers
+	SRWLOCK						stripes[SUS_CMAP_STRIPE_COUNT];	// Write locks of the buckets
+	SRWLOCK						garbageLock;	// Lock of the removed memory list
+	SRWLOCK						reclaimLock;	// Lock of the memory reclamation
+	SUS_LPCMAP_GARBAGE			garbage;		// Removed memory waiting for the readers
+	DWORD						garbageCount;	// Number of the removed blocks
+	SUS_CACHE_PADDED(SUS_CMAP_READERS) readers[SUS_CMAP_READER_SLOTS];	// Active readers
+} SUS_CMAP_STRUCT, *SUS_CMAP;
+
+// Get the key of the node
+#define susCMapNodeKey(map, node) ((SUS_OBJECT)(node)->entry)
+// Get the value of the node
+#define susCMapNodeValue(map, node) ((SUS_OBJECT)((node)->entry + (map)->keySize))
+// Get the number of the entries
+#define susCMapCount(map) ((DWORD)(map)->count)
+
+// -------------------------------------------------------------------
+
+// Create a concurrent hash table
+SUS_CMAP SUSAPI susNewCMapEx(
+	_In_ SIZE_T keySize,
+	_In_ SIZE_T valueSize,
+	_In_opt_ SUS_GET_HASH_CALLBACK getHash,
+	_In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys,
+	_In_opt_ DWORD initCount
+);
+// Create a concurrent hash table
+#define susNewCMapSized(keySize, valueSize) susNewCMapEx(keySize, valueSize, NULL, NULL, 0)
+// Create a concurrent hash table
+#define susNewCMap(keyType, valueType) susNewCMapSized(sizeof(keyType), sizeof(valueType))
+// Destroy the concurrent hash table (no other thread may use it)
+VOID SUSAPI susCMapDestroy(
+	_In_ SUS_CMAP map
+);
+
+// -------------------------------------------------------------------
+
+// Copy the value of the key without locks (\return FALSE if the key is not found)
+BOOL SUSAPI susCMapGet(
+	_In_ SUS_CMAP map,
+	_In_bytecount_(map->keySize) const SUS_OBJECT key,
+	_Out_writes_bytes_opt_(map->valueSize) SUS_OBJECT value
+);
+// Check if the concurrent hash table contains the key
+#define susCMapContains(map, key) susCMapGet(map, key, NULL)
+// Add or change a value (\return FALSE if there is not enough memory)
+BOOL SUSAPI susCMapSet(
+	_Inout_ SUS_CMAP map,
+	_In_bytecount_(map->keySize) const SUS_OBJECT key,
+	_In_opt_bytecount_(map->valueSize) const SUS_OBJECT value
+);
+// Delete a key-value pair (\return FALSE if the key is not found)
+BOOL SUSAPI susCMapRemove(
+	_Inout_ SUS_CMAP map,
+	_In_bytecount_(map->keySize) const SUS_OBJECT key
+);
+// Free the removed memory that is no longer seen by the readers
+VOID SUSAPI susCMapReclaim(
+	_Inout_ SUS_CMAP map
+);
+
+// =======================================================================================
+
+#pragma warning(pop)
+
+#ifdef __cplusplus
+}
+#endif // !__cplusplus
+
+#endif // !_SUS_CONCURRENT_MAP_
@@ -57,6 +57,8 @@ and when used, access it via super.
 #define SUS_FORCEINLINE __forceinline
 #define SUS_EXTERN extern
 #define SUS_STATIC static
+#define SUS_THREAD_LOCAL __declspec(thread)
+#define SUS_ALIGNAS(alignment) __declspec(align(alignment))
 #define SUS_STRUCT struct
 
 #ifdef _WIN32
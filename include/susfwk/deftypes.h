@@ -45,6 +45,14 @@ typedef sus_u64_t sus_size_t;
 typedef sus_u32_t sus_size_t;
 #endif // !_WIN64
 typedef sus_size_t *sus_psize_t;
+// Size of the buffers and vectors (SUS_CONTAINER_SIZE64 - 64-bit sizes in the x64 build)
+#if defined(SUS_CONTAINER_SIZE64) && defined(_WIN64)
+typedef sus_u64_t sus_csize_t;
+#define SUS_CSIZE_MAX 0xFFFFFFFFFFFFFFFFULL
+#else
+typedef sus_u32_t sus_csize_t;
+#define SUS_CSIZE_MAX 0xFFFFFFFFU
+#endif // !SUS_CONTAINER_SIZE64
 
 typedef unsigned char sus_ubyte_t, *sus_lpubyte_t;
 typedef char sus_byte_t, *sus_lpbyte_t;
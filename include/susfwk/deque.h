@@ -0,0 +1,88 @@
+// deque.h
+//
+#ifndef _SUS_DEQUE_
+#define _SUS_DEQUE_
+
+#pragma warning(push)
+#pragma warning(disable: 4200)
+
+/*
+* A deque is a ring buffer of elements with a power of two capacity:
+* the elements are added and removed at both ends without moving the rest.
+* The data wraps around the end of the storage, so it is visible as
+* at most two contiguous spans (susDequeSpans).
+*/
+
+// -------------------------------------
+
+// Default base deque size (a power of two)
+#define SUS_DEQUE_CAPACITY 8
+// Double-ended queue
+typedef struct sus_deque {
+	sus_uint_t	head;		// Index of the first element in the storage
+	sus_uint_t	length;		// Number of elements
+	sus_uint_t	capacity;	// Deque capacity in elements (a power of two)
+	sus_size_t	itemSize;	// The size of the element in bytes
+	SUS_LPALLOCATOR	allocator;	// Memory allocator (NULL - process heap)
+	SUS_ALIGNAS(MEMORY_ALLOCATION_ALIGNMENT) sus_byte_t data[];	// Ring data
+} SUS_DEQUE_STRUCT, *SUS_DEQUE, **SUS_LPDEQUE;
+
+// -------------------------------------
+
+// Create a new deque (alignment - alignment of the data, 0 - MEMORY_ALLOCATION_ALIGNMENT)
+SUS_DEQUE SUSAPI susNewDequeEx(_In_ sus_size_t itemSize, _In_opt_ SIZE_T alignment);
+// Create a new deque
+#define susNewDeque(type) susNewDequeEx(sizeof(type), 0)
+// Create a new deque in the allocator memory
+SUS_DEQUE SUSAPI susNewDequeAllocator(_In_ sus_size_t itemSize, _In_opt_ SUS_LPALLOCATOR allocator);
+// Create a new deque in the arena
+#define susNewDequeArena(arena, type) susNewDequeAllocator(sizeof(type), &(arena)->super)
+// Delete a deque
+VOID SUSAPI susDequeDestroy(_In_ SUS_DEQUE deque);
+// Guarantee the space for the specified number of elements
+BOOL SUSAPI susDequeReserve(_Inout_ SUS_LPDEQUE lpDeque, _In_ sus_uint_t reserve);
+
+// -------------------------------------
+
+// Insert elements at the end of the deque
+SUS_LPMEMORY SUSAPI susDequePushBackArray(_Inout_ SUS_LPDEQUE lpDeque, _In_opt_ SUS_LPMEMORY data, _In_ sus_uint_t count);
+// Insert an element at the beginning of the deque
+SUS_LPMEMORY SUSAPI susDequePushFront(_Inout_ SUS_LPDEQUE lpDeque, _In_opt_ SUS_LPMEMORY data);
+// Remove elements from the beginning of the deque (buffer - receives the elements, NULL - discard them)\return The number of the removed elements
+sus_uint_t SUSAPI susDequeDrain(_Inout_ SUS_DEQUE deque, _Out_opt_ SUS_LPMEMORY buffer, _In_ sus_uint_t count);
+// Get the contiguous spans of the elements in order\return The number of the non-empty spans
+sus_uint_t SUSAPI susDequeSpans(_In_ SUS_DEQUE deque, _Out_writes_(2) SUS_LPDATAVIEW spans);
+
+// -------------------------------------
+
+// Get a pointer to the deque element
+#define susDequeAt(deque, i) ((SUS_LPMEMORY)((deque)->data + (((deque)->head + (i)) & ((deque)->capacity - 1)) * (deque)->itemSize))
+// Get the deque element
+#define susDequeGet(deque, i, type) (*(type*)susDequeAt(deque, i))
+// Get the first element
+#define susDequeFront(deque) susDequeAt(deque, 0)
+// Get the last element
+#define susDequeBack(deque) susDequeAt(deque, (deque)->length - 1)
+// Remove all the elements
+#define susDequeClear(deque) ((deque)->head = (deque)->length = 0)
+// Walk through the deque
+#define susDequeForeach(i, deque) for (sus_uint_t i = 0; i < (deque)->length; i++)
+
+// Insert an element at the end of the deque
+SUS_INLINE SUS_LPMEMORY SUSAPI susDequePushBack(_Inout_ SUS_LPDEQUE lpDeque, _In_opt_ SUS_LPMEMORY data) { return susDequePushBackArray(lpDeque, data, 1); }
+// Remove the first element of the deque (value - receives the element)
+SUS_INLINE BOOL SUSAPI susDequePopFront(_Inout_ SUS_DEQUE deque, _Out_opt_ SUS_LPMEMORY value) { return susDequeDrain(deque, value, 1) ? TRUE : FALSE; }
+// Remove the last element of the deque (value - receives the element)
+SUS_INLINE BOOL SUSAPI susDequePopBack(_Inout_ SUS_DEQUE deque, _Out_opt_ SUS_LPMEMORY value) {
+	SUS_ASSERT(deque);
+	if (!deque->length) return FALSE;
+	if (value) sus_memcpy(value, susDequeBack(deque), deque->itemSize);
+	deque->length--;
+	return TRUE;
+}
+
+// -------------------------------------
+
+#pragma warning(pop)
+
+#endif /* !_SUS_DEQUE_ */
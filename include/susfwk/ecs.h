@@ -23,6 +23,8 @@ typedef sus_uint_t SUS_SYSTEM_ID;
 #define SUS_DECLARE_COMPONENT(ComponentName) extern SUS_COMPONENT_TYPE ComponentName##Type; SUS_STRUCT ComponentName
 // Define the component
 #define SUS_DEFINE_COMPONENT(ComponentName) SUS_COMPONENT_TYPE ComponentName##Type	
+// Vector of entities
+SUS_DECLARE_VECTOR(susEntityVector, SUS_ENTITY)
 
 // --------------------------------------------------------------------------------------
 
@@ -35,14 +37,14 @@ typedef struct sus_archetype {
 	SUS_COMPONENTMASK	mask;			// The mask of the archetype components
 	SUS_VECTOR			entities;		// SUS_ENTITY
 	SUS_HASHMAP			componentPools; // SUS_COMPONENT_TYPE -> SUS_VECTOR(of components)
-	SUS_VECTOR			questions;		// SUS_QUERY
+	SUS_SMALL_VECTOR_OF(SUS_QUERY, 4) questions;	// SUS_QUERY, rarely more than a few per archetype
 } SUS_ARCHETYPE_STRUCT, *SUS_ARCHETYPE;
 // The position of the entity in the archetype
 typedef struct sus_entity_location {
 	SUS_ARCHETYPE	archetype;	// The Archetype
 	sus_uint_t		index;		// The index of the entity in the archetype
 	SUS_ENTITY		parent;		// Parent Entity
-	SUS_HASHSET		children;	// Children of the entity
+	SUS_SMALL_VECTOR_OF(SUS_ENTITY, 4) children;	// Children of the entity
 } SUS_ENTITY_LOCATION, *SUS_LPENTITY_LOCATION;
 // The system's callback function
 typedef VOID(SUSAPI* SUS_SYSTEM_ENTITY_CALLBACK)(SUS_OBJECT world, SUS_ENTITY entity, FLOAT deltaTime, SUS_OBJECT userData);
@@ -92,7 +94,7 @@ typedef struct sus_world {
 	SUS_VECTOR		systems;				// SUS_SYSTEM
 	SUS_HASHMAP		questions;				// SUS_COMPONENTMASK -> SUS_QUERY_STRUCT
 	SUS_VECTOR		registeredComponents;	// SUS_REGISTERED_COMPONENT
-	SUS_VECTOR		freeEntities;			// SUS_ENTITY
+	SUS_DEQUE		freeEntities;			// SUS_ENTITY (first in, first out)
 	SUS_ENTITY		next;					// The following entity id
 	SUS_USERDATA	userData;				// User data
 } SUS_WORLD_STRUCT, *SUS_WORLD;
@@ -258,8 +260,8 @@ SUS_ENTITY SUSAPI susEntityGetParent(
 
 // --------------------------------------------------------------------------------------
 
-// Get kids
-SUS_HASHSET SUSAPI susEntityGetChildren(
+// Get kids (the vector is valid until the entities of the world change)
+SUS_SMALL_VECTOR SUSAPI susEntityGetChildren(
 	_In_ SUS_WORLD world,
 	_In_ SUS_ENTITY entity
 );
@@ -111,14 +111,25 @@ SUS_FILE SUSAPI susCreateTempFileW(
 
 // --------------------------------------------------------
 
+// The largest size of a single read or write call (the larger data is transferred in parts)
+#define SUS_FILE_IO_PART_SIZE 0x40000000
+
 // Reading data from a file
 INT SUSAPI sus_freadex(
 	_In_ SUS_FILE hFile,
 	_Out_ LPBYTE lpBuffer,
 	_In_ DWORD dwReadBufferSize
 );
+// Read the specified number of bytes from a file (\return the number of the read bytes, (SIZE_T)-1 on failure)
+SIZE_T SUSAPI sus_freadall(
+	_In_ SUS_FILE hFile,
+	_Out_writes_bytes_(size) LPBYTE lpBuffer,
+	_In_ SIZE_T size
+);
 // Read the entire file
 SUS_DATAVIEW SUSAPI sus_fread(_In_ SUS_FILE hFile);
+// Read the entire file into shared bytes
+SUS_BYTES SUSAPI sus_freadBytes(_In_ SUS_FILE hFile);
 
 // Writing to a file
 DWORD SUSAPI sus_fwrite(
@@ -126,6 +137,12 @@ DWORD SUSAPI sus_fwrite(
 	_In_ CONST LPBYTE lpData,
 	_In_ DWORD dwNumberOfBytesWrite
 );
+// Write the specified number of bytes to a file (\return the number of the written bytes)
+SIZE_T SUSAPI sus_fwriteall(
+	_In_ SUS_FILE hFile,
+	_In_reads_bytes_(size) CONST LPBYTE lpData,
+	_In_ SIZE_T size
+);
 // Move the pointer to the specified blend
 #define sus_fseek(hFile, offset, origin)	SetFilePointerEx(hFile, (LARGE_INTEGER) { .QuadPart = offset }, NULL, origin)
 
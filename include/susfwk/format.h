@@ -151,6 +151,18 @@ DWORD SUSAPI sus_unescapeW(
 	_Out_opt_ LPWSTR buff,
 	_In_ LPCWSTR src
 );
+// parsing a string of the specified length with esc characters into special characters
+DWORD SUSAPI sus_unescapeExA(
+	_Out_opt_ LPSTR buff,
+	_In_reads_(count) LPCSTR src,
+	_In_ DWORD count
+);
+// parsing a string of the specified length with esc characters into special characters
+DWORD SUSAPI sus_unescapeExW(
+	_Out_opt_ LPWSTR buff,
+	_In_reads_(count) LPCWSTR src,
+	_In_ DWORD count
+);
 
 #ifdef UNICODE
 #define sus_unescape	sus_unescapeW
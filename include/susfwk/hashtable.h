@@ -56,6 +56,16 @@ SUS_INLINE SUS_HASH_T SUSAPI susDefGetStringHashW(SUS_DATAVIEW key) {
 	return susDefGetHash((SUS_DATAVIEW) { .data = (LPBYTE)(*(LPWSTR*)key.data), .size = lstrlenW(*(LPWSTR*)key.data) * sizeof(WCHAR) });
 }
 
+// Spread the hash over all the bits (the MurmurHash3 finalizer)
+SUS_INLINE SUS_HASH_T SUSAPI susHashFinalize(_In_ SUS_HASH_T hash) {
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35u;
+	hash ^= hash >> 16;
+	return hash;
+}
+
 // Default Key Comparison
 SUS_INLINE BOOL SUSAPI susDefCmpKeys(SUS_OBJECT key1, SUS_OBJECT key2, SIZE_T size) {
 	SUS_ASSERT(key1 && key2 && size);
@@ -74,28 +84,121 @@ SUS_INLINE BOOL SUSAPI susDefCmpStringKeysW(SUS_OBJECT key1, SUS_OBJECT key2, SI
 	return !lstrcmpW(*(LPCWSTR*)key1, *(LPCWSTR*)key2);
 }
 
+// ================================================================================================
+
+/*
+* The 64-bit hashes are seeded: the seed is random for every process, so the keys
+* that collide in one run can not be picked in advance. The data is read by 8 bytes
+* and mixed by the 64x64->128 bit multiplication (wyhash).
+*/
+
+// 64-bit hash type
+typedef sus_u64_t SUS_HASH64_T;
+// Callback function for the seeded 64-bit data hashing
+typedef SUS_HASH64_T(SUSAPI* SUS_GET_HASH64_CALLBACK)(SUS_DATAVIEW key, SUS_HASH64_T seed);
+
+// Get the random seed of the process
+SUS_HASH64_T SUSAPI susHashSeed();
+// Get the seeded 64-bit hash of the data
+SUS_HASH64_T SUSAPI susHash64(
+	_In_reads_bytes_(size) const VOID* data,
+	_In_ SIZE_T size,
+	_In_ SUS_HASH64_T seed
+);
+// Get the seeded 64-bit hash of the integer
+SUS_HASH64_T SUSAPI susHash64Int(
+	_In_ sus_u64_t value,
+	_In_ SUS_HASH64_T seed
+);
+
+// Get a 64-bit hash by key
+SUS_INLINE SUS_HASH64_T SUSAPI susDefGetHash64(SUS_DATAVIEW key, SUS_HASH64_T seed) {
+	SUS_ASSERT(key.data);
+	return susHash64(key.data, key.size, seed);
+}
+// Get a 64-bit hash by the integer key (up to 8 bytes)
+SUS_INLINE SUS_HASH64_T SUSAPI susDefGetHash64Int(SUS_DATAVIEW key, SUS_HASH64_T seed) {
+	SUS_ASSERT(key.data && key.size <= sizeof(sus_u64_t));
+	sus_u64_t value = 0;
+	sus_memcpy((LPBYTE)&value, key.data, key.size);
+	return susHash64Int(value, seed);
+}
+// Get a 64-bit hash by key
+SUS_INLINE SUS_HASH64_T SUSAPI susDefGetStringHash64A(SUS_DATAVIEW key, SUS_HASH64_T seed) {
+	SUS_ASSERT(key.data && key.size == sizeof(LPCSTR));
+	return susHash64(*(LPSTR*)key.data, lstrlenA(*(LPSTR*)key.data) * sizeof(CHAR), seed);
+}
+// Get a 64-bit hash by key
+SUS_INLINE SUS_HASH64_T SUSAPI susDefGetStringHash64W(SUS_DATAVIEW key, SUS_HASH64_T seed) {
+	SUS_ASSERT(key.data && key.size == sizeof(LPCWSTR));
+	return susHash64(*(LPWSTR*)key.data, lstrlenW(*(LPWSTR*)key.data) * sizeof(WCHAR), seed);
+}
+
 
 // ================================================================================================
 
-#define SUS_HASHTABLE_INIT_COUNT 7
+/*
+* The hash table uses open addressing: the entries are stored in one array of slots,
+* and each slot has a control byte with its state - empty, deleted or the low 7 bits
+* of the hash of the occupied slot. The lookup loads a group of 16 control bytes
+* and compares them with the hash bits at once (SSE2), so the keys are compared
+* only for the slots whose bits match. The groups are probed in the triangular order
+* over the power of two number of the groups. The full hashes of the slots are stored
+* in a separate array, so the keys of the different hashes are not compared, and the rehash
+* does not hash the keys again.
+* The table grows incrementally: the new table takes the old one, and every modification
+* moves a few groups of the old slots (SUS_HASHTABLE_MIGRATE_STEP) until it is empty,
+* while the lookups check both tables. susMapStep moves the slots in the idle time.
+* susMapGetBatch hashes a batch of keys and prefetches their first groups (in both tables
+* during the rehash) before any of them is probed, so the cache misses of the independent
+* lookups overlap.
+*/
+
+// Number of the control bytes in a probed group
+#define SUS_HASHTABLE_GROUP_WIDTH 16
+// Default number of the slots (a power of two, not less than SUS_HASHTABLE_GROUP_WIDTH)
+#define SUS_HASHTABLE_INIT_COUNT 16
 #define SUS_HASHTABLE_GROWTH_FACTOR 2
+// Maximum load of the table
 #define SUS_HASHTABLE_RATIO 0.75f
+// Number of the old table slots moved by each modification during the rehash
+#define SUS_HASHTABLE_MIGRATE_STEP (SUS_HASHTABLE_GROUP_WIDTH * 2)
+// Number of the keys hashed and prefetched together by the batch lookup
+#define SUS_HASHTABLE_BATCH_SIZE 16
+
+// Control byte of an empty slot
+#define SUS_HASHTABLE_CTRL_EMPTY ((sus_u8_t)0x80)
+// Control byte of a deleted slot (the probing goes on through it)
+#define SUS_HASHTABLE_CTRL_DELETED ((sus_u8_t)0xFE)
+// Check whether the control byte is of an occupied slot
+#define susMapCtrlIsFull(ctrl) ((ctrl) < 0x80)
 
 // ---------------------------------------------------------
 
 // Hash table
 typedef struct sus_hashmap{
 	SUS_GET_HASH_CALLBACK	getHash;	// Hashing function
+	SUS_GET_HASH64_CALLBACK	getHash64;	// Seeded 64-bit hashing function (NULL - getHash is used)
+	SUS_HASH64_T			seed;		// Seed of the 64-bit hashing
 	SUS_CMP_KEYS_CALLBACK	cmpKeys;	// Key comparison function
 	DWORD					keySize;	// Key size in bytes
 	DWORD					valueSize;	// Value size in bytes
-	DWORD					capacity;	// Number of buckets
+	DWORD					capacity;	// Number of slots (a power of two)
 	DWORD					count;		// Total number of table elements
-	SUS_VECTOR				buckets[];	// Buckets
+	DWORD					growthLeft;	// Number of the empty slots that can be occupied before the rehash
+	DWORD					entrySize;	// Size of the slot in bytes
+	SUS_LPALLOCATOR			allocator;	// Memory allocator (NULL - process heap)
+	struct sus_hashmap*		old;		// The table being moved to this one (NULL - no rehash is in progress)
+	DWORD					migrated;	// Number of the old table slots that are already moved
+	SUS_ALIGNAS(16) sus_u8_t ctrl[];	// Control bytes of the slots followed by the hashes of the slots and the slots
 } SUS_HASHMAP_STRUCT, *SUS_HASHMAP, **SUS_LPHASHMAP;
 
-// Get the entry from the hash table node
-#define susMapEntry(bucket, i) (SUS_OBJECT)susVectorAt(bucket, i)
+// Get the size of the hash table memory
+#define susMapTableSize(capacity, entrySize) (sizeof(SUS_HASHMAP_STRUCT) + (SIZE_T)(capacity) * ((entrySize) + 1 + sizeof(SUS_HASH_T)))
+// Get the stored hash of the slot
+#define susMapSlotHash(map, i) (((SUS_HASH_T*)((map)->ctrl + (map)->capacity))[i])
+// Get the slot of the hash table
+#define susMapSlot(map, i) ((SUS_OBJECT)((LPBYTE)(map)->ctrl + (SIZE_T)(map)->capacity * (1 + sizeof(SUS_HASH_T)) + (SIZE_T)(i) * (map)->entrySize))
 // Get the key from the hash table node
 #define susMapKey(map, entry) (entry)
 // Get the value from the hash table node
@@ -111,6 +214,24 @@ SUS_HASHMAP SUSAPI susNewMapEx(
 	_In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys,
 	_In_opt_ DWORD initCount
 );
+// Create a hash table in the allocator memory
+SUS_HASHMAP SUSAPI susNewMapAllocator(
+	_In_ SIZE_T keySize,
+	_In_ SIZE_T valueSize,
+	_In_opt_ SUS_GET_HASH_CALLBACK getHash,
+	_In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys,
+	_In_opt_ DWORD initCount,
+	_In_opt_ SUS_LPALLOCATOR allocator
+);
+// Create a hash table with the seeded 64-bit hashing
+SUS_HASHMAP SUSAPI susNewMapSeededEx(
+	_In_ SIZE_T keySize,
+	_In_ SIZE_T valueSize,
+	_In_opt_ SUS_GET_HASH64_CALLBACK getHash64,
+	_In_opt_ SUS_CMP_KEYS_CALLBACK cmpKeys,
+	_In_opt_ DWORD initCount,
+	_In_opt_ SUS_LPALLOCATOR allocator
+);
 // Create a hash table
 #define susNewMapSized(keySize, valueSize) susNewMapEx(keySize, valueSize, NULL, NULL, 0)
 // Create a hash table
@@ -119,14 +240,20 @@ SUS_HASHMAP SUSAPI susNewMapEx(
 #define susNewStringMap(valueType) susNewMapEx(sizeof(LPCSTR), sizeof(valueType), susDefGetStringHashA, susDefCmpStringKeysA, 0)
 // Create a hash table
 #define susNewWStringMap(valueType) susNewMapEx(sizeof(LPCWSTR), sizeof(valueType), susDefGetStringHashW, susDefCmpStringKeysW, 0)
+// Create a hash table with the seeded 64-bit hashing
+#define susNewSeededMap(keyType, valueType) susNewMapSeededEx(sizeof(keyType), sizeof(valueType), NULL, NULL, 0, NULL)
+// Create a hash table with the seeded 64-bit hashing
+#define susNewSeededStringMap(valueType) susNewMapSeededEx(sizeof(LPCSTR), sizeof(valueType), susDefGetStringHash64A, susDefCmpStringKeysA, 0, NULL)
+// Create a hash table with the seeded 64-bit hashing
+#define susNewSeededWStringMap(valueType) susNewMapSeededEx(sizeof(LPCWSTR), sizeof(valueType), susDefGetStringHash64W, susDefCmpStringKeysW, 0, NULL)
 
 // ---------------------------------------------------------
 
 // Destroy the hash table
 SUS_INLINE VOID SUSAPI susMapDestroy(SUS_HASHMAP map) {
 	SUS_ASSERT(map);
-	for (DWORD i = 0; i < map->capacity; i++) susVectorDestroy(map->buckets[i]);
-	sus_free(map);
+	if (map->old) susMapDestroy(map->old);
+	susAllocatorFree(map->allocator, map, susMapTableSize(map->capacity, map->entrySize));
 }
 // Change the size of the hash table
 SUS_HASHMAP SUSAPI susMapCopy(
@@ -144,25 +271,33 @@ VOID SUSAPI susMapReserve(
 VOID SUSAPI susMapCompress(
 	_Inout_ SUS_LPHASHMAP lpMap
 );
-// Change the size of the hash table
-SUS_INLINE VOID SUSAPI susMapResize(_In_ SUS_LPHASHMAP lpMap, _In_ DWORD newCount) {
-	SUS_HASHMAP newHt = susMapCopy(*lpMap, newCount);
-	if (!newHt) return;
-	susMapDestroy(*lpMap);
-	*lpMap = newHt;
-}
+// Change the size of the hash table at once
+VOID SUSAPI susMapResize(
+	_Inout_ SUS_LPHASHMAP lpMap,
+	_In_ DWORD newCount
+);
+// Move the slots of the old table during the rehash (\return TRUE if the rehash is not finished yet)
+BOOL SUSAPI susMapStep(
+	_Inout_ SUS_HASHMAP map,
+	_In_ DWORD slotCount
+);
+// Check whether the incremental rehash of the hash table is in progress
+#define susMapIsRehashing(map) ((map)->old != NULL)
 
 // ---------------------------------------------------------
 
-// Get an index in a hash table by key
-SUS_INLINE DWORD SUSAPI susMapGetIndex(SUS_HASHMAP map, LPBYTE key) {
-	return map->getHash((SUS_DATAVIEW) { .data = key, map->keySize }) % map->capacity;
-}
 // Get an item by key
 SUS_OBJECT SUSAPI susMapGetEntry(
 	_In_ SUS_HASHMAP map,
 	_In_bytecount_(map->valueSize) const SUS_OBJECT key
 );
+// Get the values of the keys at once (\return the number of the found keys, the values of the missing keys are NULL)
+DWORD SUSAPI susMapGetBatch(
+	_In_ SUS_HASHMAP map,
+	_In_reads_bytes_(count * map->keySize) const SUS_OBJECT keys,
+	_In_ DWORD count,
+	_Out_writes_(count) SUS_OBJECT* values
+);
 // Check if the hash table contains an element
 SUS_INLINE BOOL SUSAPI susMapContains(_In_ SUS_HASHMAP map, _In_bytecount_(map->valueSize) const SUS_OBJECT key) {
 	return susMapGetEntry(map, key) ? TRUE : FALSE;
@@ -207,8 +342,8 @@ VOID SUSAPI susMapClear(
 // Hash Table Iterator
 typedef struct sus_map_iter {
 	SUS_HASHMAP map;
-	DWORD bucketIndex;
-	DWORD entryIndex;
+	SUS_HASHMAP table;	// The table of the current slot (the map or its old table)
+	DWORD slotIndex;
 	DWORD count;
 } SUS_MAP_ITER, *SUS_LPMAP_ITER;
 
@@ -224,12 +359,12 @@ BOOL SUSAPI susMapIterNext(
 // Get the key of the current element in the iterator
 SUS_INLINE SUS_OBJECT SUSAPI susMapIterKey(SUS_MAP_ITER iter) {
 	SUS_ASSERT(iter.map);
-	return susMapKey(iter.map, susVectorAt(iter.map->buckets[iter.bucketIndex], iter.entryIndex));
+	return susMapKey(iter.table, susMapSlot(iter.table, iter.slotIndex));
 }
 // Get the value of the current element in the iterator
 SUS_INLINE SUS_OBJECT SUSAPI susMapIterValue(SUS_MAP_ITER iter) {
 	SUS_ASSERT(iter.map);
-	return susMapValue(iter.map, susVectorAt(iter.map->buckets[iter.bucketIndex], iter.entryIndex));
+	return susMapValue(iter.table, susMapSlot(iter.table, iter.slotIndex));
 }
 // Iterate over all elements of the hash table
 #define susMapForeach(map, i) for (SUS_MAP_ITER i = susMapIterBegin(map); i.count < map->count; susMapIterNext(&i))
@@ -246,6 +381,7 @@ typedef SUS_HASHMAP_STRUCT SUS_HASHSET_STRUCT, *SUS_HASHSET, **SUS_LPHASHSET;
 
 #define susNewSetSized(typeSize)		(SUS_HASHSET)susNewMapSized(typeSize, 0)
 #define susNewSet(type)					susNewSetSized(sizeof(type))
+#define susNewSeededSet(type)			(SUS_HASHSET)susNewMapSeededEx(sizeof(type), 0, NULL, NULL, 0, NULL)
 #define susSetCopy						(SUS_HASHSET)susMapCopy
 #define susSetDestroy					susMapDestroy
 
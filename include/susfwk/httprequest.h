@@ -13,6 +13,9 @@
 
 // ------------------------------------------------------------
 
+// The largest size of the request body part passed to a single write
+#define SUS_HTTP_WRITE_PART_SIZE 0x10000
+
 // HTTP request structure
 typedef struct sus_http_request {
 	HINTERNET hConnect;	// Connection descriptor
@@ -50,7 +53,7 @@ static const LPWSTR susHttpContentEncodingToString[SUS_HTTP_CONTENT_ENCODING_COU
 typedef struct sus_http_body {
 	SUS_HTTP_CONTENT_TYPE		type;		// Message Content Type
 	SUS_HTTP_CONTENT_ENCODING	encoding;	// The type of encoding of the message content
-	SUS_DATAVIEW				content;	// Content of the message body
+	SUS_BYTES					content;	// Content of the message body
 } SUS_HTTP_BODY, *SUS_LPHTTP_BODY;
 // HTTP response structure
 typedef struct sus_http_response {
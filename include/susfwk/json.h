@@ -4,7 +4,9 @@
 #define _SUS_JSON_API_
 
 #include "vector.h"
+#include "chain.h"
 #include "hashtable.h"
+#include "atom.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //						       The structure of the json object                                   //
@@ -32,7 +34,7 @@ typedef struct sus_json {
 		sus_f32_t number;
 		sus_bool_t boolean;
 		SUS_VECTOR array; // SUS_JSON
-		SUS_HASHMAP object; // LPSTR -> SUS_JSON
+		SUS_HASHMAP object; // LPSTR or SUS_ATOM -> SUS_JSON
 	} value;
 } SUS_JSON, *SUS_LPJSON;
 
@@ -71,6 +73,11 @@ SUS_INLINE SUS_JSON SUSAPI susJsonStringView(_In_opt_ LPCSTR text) {
 		.value.str = (LPSTR)text
 	} : susJsonNull();
 }
+// Create string json from the bytes (the bytes must be null-terminated and outlive the json)
+SUS_INLINE SUS_JSON SUSAPI susJsonBytesView(_In_ SUS_BYTES bytes) {
+	SUS_ASSERT(!bytes.data || susBytesIsTerminated(bytes));
+	return susJsonStringView((LPCSTR)bytes.data);
+}
 // Create Boolean json
 SUS_INLINE SUS_JSON SUSAPI susJsonBoolean(_In_ BOOL boolean) {
 	return (SUS_JSON) {
@@ -78,20 +85,33 @@ SUS_INLINE SUS_JSON SUSAPI susJsonBoolean(_In_ BOOL boolean) {
 		.value.boolean = boolean
 	};
 }
-// Create a json array
-SUS_INLINE SUS_JSON SUSAPI susJsonArray() {
+// Create a json array in the allocator memory
+SUS_INLINE SUS_JSON SUSAPI susJsonArrayEx(_In_opt_ SUS_LPALLOCATOR allocator) {
 	return (SUS_JSON) {
 		.type = SUS_JSON_TYPE_ARRAY,
-		.value.array = susNewVector(SUS_JSON)
+		.value.array = susNewVectorAllocator(sizeof(SUS_JSON), allocator)
+	};
+}
+// Create a json array
+#define susJsonArray() susJsonArrayEx(NULL)
+// Create a json object in the allocator memory
+SUS_INLINE SUS_JSON SUSAPI susJsonObjectEx(_In_opt_ SUS_LPALLOCATOR allocator) {
+	return (SUS_JSON) {
+		.type = SUS_JSON_TYPE_OBJECT,
+		.value.object = susNewMapAllocator(sizeof(LPSTR), sizeof(SUS_JSON), susDefGetStringHashA, susDefCmpStringKeysA, 0, allocator)
 	};
 }
 // Create a json object
-SUS_INLINE SUS_JSON SUSAPI susJsonObject() {
+#define susJsonObject() susJsonObjectEx(NULL)
+// Create a json object with atom keys in the allocator memory
+SUS_INLINE SUS_JSON SUSAPI susJsonAtomObjectEx(_In_opt_ SUS_LPALLOCATOR allocator) {
 	return (SUS_JSON) {
 		.type = SUS_JSON_TYPE_OBJECT,
-		.value.object = susNewMapEx(sizeof(LPSTR), sizeof(SUS_JSON), susDefGetStringHashA, susDefCmpStringKeysA, 0)
+		.value.object = susNewMapAllocator(sizeof(SUS_ATOM), sizeof(SUS_JSON), susDefGetAtomHash, susDefCmpAtomKeys, 0, allocator)
 	};
 }
+// Create a json object with atom keys
+#define susJsonAtomObject() susJsonAtomObjectEx(NULL)
 
 // -----------------------------------------------
 
@@ -117,10 +137,36 @@ SUS_JSON SUSAPI susJsonCopy(
 LPSTR SUSAPI susJsonStringify(
 	_In_ SUS_JSON json
 );
+// Convert json to a string at the end of the chain (without the null terminator)\return FALSE if the memory ran out, the chain keeps the part written before
+BOOL SUSAPI susJsonStringifyChain(
+	_In_ SUS_JSON json,
+	_Inout_ SUS_LPCHAIN chain
+);
+// Json parsing flags
+typedef enum sus_json_parse_flags {
+	SUS_JSON_PARSE_FLAG_NONE		= 0,
+	SUS_JSON_PARSE_FLAG_ATOM_KEYS	= 1 << 0	// Object keys are interned as atoms
+} SUS_JSON_PARSE_FLAGS;
+// Convert string to json in the allocator memory
+SUS_JSON SUSAPI susJsonParseEx(
+	_In_ LPCSTR text,
+	_Inout_opt_ SUS_LPALLOCATOR allocator,
+	_In_ SUS_JSON_PARSE_FLAGS flags
+);
 // Convert string to json
 SUS_JSON SUSAPI susJsonParse(
 	_In_ LPCSTR text
 );
+// Convert string to json in the arena (the result is freed by resetting the arena)
+SUS_JSON SUSAPI susJsonParseArena(
+	_In_ LPCSTR text,
+	_Inout_ SUS_LPARENA arena
+);
+// Convert bytes to json (terminated bytes are parsed without copying)
+SUS_JSON SUSAPI susJsonParseBytes(
+	_In_ SUS_BYTES bytes,
+	_In_ SUS_JSON_PARSE_FLAGS flags
+);
 
 // -----------------------------------------------
 
@@ -133,6 +179,11 @@ BOOL SUSAPI susJsonEquals(
 SUS_INLINE BOOL SUSAPI susJsonIsValid(_In_ SUS_JSON json) {
 	return json.type || ((json.type == SUS_JSON_TYPE_OBJECT || json.type == SUS_JSON_TYPE_ARRAY) && json.value.object);
 }
+// Get the json string as bytes (the bytes are borrowed from the json)
+SUS_INLINE SUS_BYTES SUSAPI susJsonGetBytes(_In_ SUS_JSON json) {
+	if ((json.type != SUS_JSON_TYPE_STRING && json.type != SUS_JSON_TYPE_STRING_VIEW) || !json.value.str) return (SUS_BYTES) { 0 };
+	return susBytesBorrow(json.value.str, lstrlenA(json.value.str) * sizeof(CHAR));
+}
 
 // -----------------------------------------------
 
@@ -150,6 +201,14 @@ SUS_INLINE BOOL SUSAPI susJsonIsValid(_In_ SUS_JSON json) {
 SUS_INLINE SUS_LPJSON SUSAPI susJsonObjectGet(_In_ SUS_JSON obj, _In_ LPCSTR key) {
 	SUS_ASSERT(key);
 	if (obj.type != SUS_JSON_TYPE_OBJECT || !obj.value.object) return NULL;
+	if (susMapIsAtomKeys(obj.value.object) && !(key = susAtomFind(key))) return NULL;
+	return (SUS_LPJSON)susMapGet(obj.value.object, &key);
+}
+// Get the object value by the atom key (the object keys must be atoms)
+SUS_INLINE SUS_LPJSON SUSAPI susJsonObjectGetAtom(_In_ SUS_JSON obj, _In_ SUS_ATOM key) {
+	SUS_ASSERT(key);
+	if (obj.type != SUS_JSON_TYPE_OBJECT || !obj.value.object) return NULL;
+	SUS_ASSERT(susMapIsAtomKeys(obj.value.object));
 	return (SUS_LPJSON)susMapGet(obj.value.object, &key);
 }
 // Check the presence of an element in an object
@@ -167,6 +226,12 @@ SUS_LPJSON SUSAPI susJsonObjectSet(
 	_In_ LPCSTR key,
 	_In_ SUS_JSON value
 );
+// Set a value for an object by the atom key (the object keys must be atoms)
+SUS_LPJSON SUSAPI susJsonObjectSetAtom(
+	_Inout_ SUS_LPJSON obj,
+	_In_ SUS_ATOM key,
+	_In_ SUS_JSON value
+);
 // Delete an object value
 VOID SUSAPI susJsonObjectRemove(
 	_Inout_ SUS_LPJSON obj,
@@ -256,12 +321,14 @@ static BOOL SUSAPI susJsonElementsCompareCallBack(_In_ SUS_VECTOR vector, _In_ s
 // Find the first item you see
 SUS_INLINE INT SUSAPI susJsonArrayFind(_Inout_ SUS_JSON arr, _In_ SUS_JSON value) {
 	if (arr.type != SUS_JSON_TYPE_ARRAY || !arr.value.array) return -1;
-	return susVectorIndexOf(arr.value.array, &value, susJsonElementsCompareCallBack);
+	sus_csize_t i = susVectorIndexOf(arr.value.array, &value, susJsonElementsCompareCallBack);
+	return i != SUS_CSIZE_MAX ? (INT)i : -1;
 }
 // Find the first available element from the end
 SUS_INLINE INT SUSAPI susJsonArrayFindLast(_Inout_ SUS_JSON arr, _In_ SUS_JSON value) {
 	if (arr.type != SUS_JSON_TYPE_ARRAY || !arr.value.array) return -1;
-	return susVectorLastIndexOf(arr.value.array, &value, susJsonElementsCompareCallBack);
+	sus_csize_t i = susVectorLastIndexOf(arr.value.array, &value, susJsonElementsCompareCallBack);
+	return i != SUS_CSIZE_MAX ? (INT)i : -1;
 }
 //
 #define susJsonArrayForeach(jsonArray, i) susVecForeach(i, (jsonArray).value.array)
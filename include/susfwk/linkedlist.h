@@ -29,6 +29,7 @@ typedef struct sus_list {
 	SUS_LIST_NODE	tail;		// The last node in the list
 	sus_size32_t	valueSize;	// Default value size
 	sus_uint_t		count;		// Number of list items
+	SUS_LPPOOL		pool;		// Node pool (NULL - nodes are allocated in the heap)
 } SUS_LIST, *SUS_LPLIST;
 
 // -------------------------------------------------------------------
@@ -43,7 +44,13 @@ SUS_LIST SUSAPI susListSetupEx(
 );
 // Create a list structure
 #define susListSetup(type) susListSetupEx(sizeof(type))
-// Clear the list
+// Create a list structure with a node pool
+SUS_LIST SUSAPI susListSetupPoolEx(
+	_In_ sus_size32_t typeSize
+);
+// Create a list structure with a node pool
+#define susListSetupPool(type) susListSetupPoolEx(sizeof(type))
+// Clear the list (the node pool is released at once)
 VOID SUSAPI susListCleanup(
 	_Inout_ SUS_LPLIST list
 );
@@ -115,7 +122,7 @@ BOOL SUSAPI susListContains(
 
 // Change the type size for new values
 SUS_INLINE VOID SUSAPI susListSetValueSize(_Inout_ SUS_LPLIST list, _In_ sus_size32_t	newValueSize) {
-	SUS_ASSERT(list);
+	SUS_ASSERT(list && (!list->pool || sizeof(SUS_LIST_NODE_STRUCT) + newValueSize <= list->pool->objectSize));
 	list->valueSize = newValueSize;
 }
 // Go through all the items in the list
@@ -0,0 +1,84 @@
+// memkernels.h
+//
+#ifndef _SUS_MEMKERNELS_
+#define _SUS_MEMKERNELS_
+
+/*
+* Kernels of the basic memory operations.
+* The kernels do not depend on the Windows headers, so memkernels.c is compiled
+* by MSVC, GCC and Clang on any platform (bench/memkernels_test.c checks and measures them outside Windows).
+* memory.c selects the kernels of the best instruction set and dispatches sus_mem*Large through them.
+* The copy, move, set, compare and zero kernels require blocks larger than SUS_MEMORY_INLINE_SIZE bytes,
+* the find kernel accepts any number of the elements.
+*/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // !__cplusplus
+
+#ifndef SUSAPI
+#ifdef _MSC_VER
+#define SUSAPI __fastcall
+#else
+#define SUSAPI
+#endif // !_MSC_VER
+#endif // !SUSAPI
+
+// =======================================================================================
+
+// -------------------------------------------------------------------
+
+// Maximum size of the block processed inline
+#define SUS_MEMORY_INLINE_SIZE 16
+// Minimum size of the copy that bypasses the cache
+#define SUS_MEMORY_STREAM_SIZE 0x400000
+
+// Unaligned access to the memory
+#ifdef _MSC_VER
+typedef unsigned long long __unaligned sus_unaligned64_t;
+typedef unsigned int __unaligned sus_unaligned32_t;
+typedef unsigned short __unaligned sus_unaligned16_t;
+#else
+typedef unsigned long long __attribute__((aligned(1), may_alias)) sus_unaligned64_t;
+typedef unsigned int __attribute__((aligned(1), may_alias)) sus_unaligned32_t;
+typedef unsigned short __attribute__((aligned(1), may_alias)) sus_unaligned16_t;
+#endif // !_MSC_VER
+
+// Instruction set of the memory operations
+typedef enum sus_memory_isa {
+	SUS_MEMORY_ISA_AUTO,		// Select the best set supported by the processor
+	SUS_MEMORY_ISA_PORTABLE,	// Word-sized loops without vector instructions
+	SUS_MEMORY_ISA_SSE2,		// 16-byte vectors
+	SUS_MEMORY_ISA_AVX2			// 32-byte vectors
+} SUS_MEMORY_ISA;
+
+// Memory operation kernels
+typedef struct sus_memory_kernels {
+	char*(SUSAPI* copy)(char* buff, char* source, size_t size);				// Copy the memory forward
+	char*(SUSAPI* move)(char* buff, char* source, size_t size);				// Copy the overlapping memory
+	void(SUSAPI* set)(char* data, unsigned char value, size_t size);		// Initialize the memory
+	int(SUSAPI* compare)(char* lpBuf1, char* lpBuf2, size_t size);			// Compare the memory (\return TRUE if the blocks are equal)
+	int(SUSAPI* iszero)(char* lpBuff, size_t size);							// Check the memory for zeros
+	size_t(SUSAPI* find)(char* data, size_t count, char* key, size_t size);	// Find an element of 1, 2, 4, 8 or 16 bytes (\return (size_t)-1 if not found)
+} SUS_MEMORY_KERNELS;
+
+// -------------------------------------------------------------------
+
+// Get the best instruction set supported by the processor
+SUS_MEMORY_ISA SUSAPI susMemoryDetectIsa(void);
+// Get the kernels of the instruction set\return NULL if the set is not compiled for the platform
+const SUS_MEMORY_KERNELS* SUSAPI susMemoryGetKernels(
+	SUS_MEMORY_ISA isa
+);
+
+// -------------------------------------------------------------------
+
+// =======================================================================================
+
+#ifdef __cplusplus
+}
+#endif // !__cplusplus
+
+#endif /* !_SUS_MEMKERNELS_ */
@@ -3,12 +3,24 @@
 #ifndef _SUS_MEMORY_
 #define _SUS_MEMORY_
 
+#include "memkernels.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif // !__cplusplus
 
-	// Number of attempts to allocate memory
-#define SUS_NUMBER_ATTEMPTS_ALLOCATE_MEMORY 0xff
+/*
+*
+* SUS_MEMORY_TRACKING Track heap allocations by call site and subsystem tag
+* SUS_MEMORY_SUBSYSTEM Subsystem tag of the allocations of the translation unit (define before the includes)
+*/
+
+// Maximum size of the block served by the size classes
+#define SUS_MALLOC_SMALL_SIZE 0x2000
+// Minimum size of the block allocated directly in virtual memory
+#define SUS_MALLOC_LARGE_SIZE 0x40000
+// Size of the span of the size class
+#define SUS_MALLOC_SPAN_SIZE 0x10000
 
 // Dynamic data type
 typedef LPVOID SUS_DYNAMIC, *SUS_PDYNAMIC, *SUS_LPDYNAMIC;
@@ -22,12 +34,16 @@ typedef SUS_FILE SUS_MEMORY;
 //					Dynamic memory in heaps						//
 //////////////////////////////////////////////////////////////////
 
-// Allocate memory to the heap
+// Allocate memory to the heap (the block is not initialized)
 SUS_LPMEMORY SUSAPI sus_malloc(
 	_In_ SIZE_T size
 );
+// Allocate zero-initialized memory to the heap
+SUS_LPMEMORY SUSAPI sus_zalloc(
+	_In_ SIZE_T size
+);
 // Allocating a memory array
-#define sus_calloc(count, size) sus_malloc((count) * (size))
+#define sus_calloc(count, size) sus_zalloc((count) * (size))
 // Memory reallocation
 SUS_LPMEMORY SUSAPI sus_realloc(
 	_In_ SUS_LPMEMORY block,
@@ -42,18 +58,195 @@ SUS_LPMEMORY SUSAPI sus_newmem(
 	_In_ SIZE_T size,
 	_In_opt_ SUS_OBJECT value
 );
+// Return the blocks cached by the current thread to the shared depot
+VOID SUSAPI sus_mflush();
+
+// Size of the processor cache line
+#define SUS_MEMORY_CACHE_LINE 64
+// Align the type or variable to the cache line
+#define SUS_CACHE_ALIGN SUS_ALIGNAS(SUS_MEMORY_CACHE_LINE)
+// A value that occupies whole cache lines (per-thread data without false sharing)
+#define SUS_CACHE_PADDED(type) union SUS_CACHE_ALIGN { type value; sus_byte_t padding[SUS_ALIGN(sizeof(type), SUS_MEMORY_CACHE_LINE)]; }
+
+// Allocate memory so that the address block + offset is aligned
+SUS_LPMEMORY SUSAPI sus_malloc_alignedEx(
+	_In_ SIZE_T size,
+	_In_ SIZE_T alignment,
+	_In_ SIZE_T offset
+);
+// Allocate aligned memory (the alignment is a power of two)
+#define sus_malloc_aligned(size, alignment) sus_malloc_alignedEx(size, alignment, 0)
+// Free the memory allocated with sus_malloc_aligned
+VOID SUSAPI sus_free_aligned(
+	_In_opt_ SUS_LPMEMORY block
+);
+
+//////////////////////////////////////////////////////////////////
+//					Allocation tracking							//
+//////////////////////////////////////////////////////////////////
+
+// Maximum number of the tracked call sites
+#define SUS_MEMORY_SITE_COUNT 1024
+// Number of the size histogram buckets (powers of two)
+#define SUS_MEMORY_HISTOGRAM_SIZE 32
+
+// Subsystem tag of the allocation
+typedef enum sus_memory_tag {
+	SUS_MEMORY_TAG_GENERAL,	// Allocations without a subsystem
+	SUS_MEMORY_TAG_VECTOR,	// Dynamic arrays
+	SUS_MEMORY_TAG_BUFFER,	// Byte buffers
+	SUS_MEMORY_TAG_MAP,		// Hash tables
+	SUS_MEMORY_TAG_LIST,	// Linked lists
+	SUS_MEMORY_TAG_JSON,	// JSON values
+	SUS_MEMORY_TAG_ECS,		// Entities, components and systems
+	SUS_MEMORY_TAG_NET,		// Sockets and HTTP requests
+	SUS_MEMORY_TAG_COUNT
+} SUS_MEMORY_TAG;
+// Allocation counters
+typedef struct sus_memory_counters {
+	SIZE_T allocations;	// Number of allocations
+	SIZE_T releases;	// Number of releases
+	SIZE_T bytes;		// Total allocated bytes
+	SIZE_T blocks;		// Number of live blocks
+	SIZE_T live;		// Live bytes
+	SIZE_T peak;		// Peak of the live bytes
+} SUS_MEMORY_COUNTERS, *SUS_LPMEMORY_COUNTERS;
+// Allocation call site
+typedef struct sus_memory_site {
+	LPCSTR				file;		// Source file (NULL - the sites that didn't fit in the table)
+	DWORD				line;		// Source line
+	SUS_MEMORY_TAG		tag;		// Subsystem tag
+	SUS_MEMORY_COUNTERS	counters;	// Counters of the site
+} SUS_MEMORY_SITE, *SUS_LPMEMORY_SITE;
+// Allocation statistics
+typedef struct sus_memory_stats {
+	SUS_MEMORY_COUNTERS total;								// Counters of all allocations
+	SUS_MEMORY_COUNTERS tags[SUS_MEMORY_TAG_COUNT];			// Counters of the subsystems
+	SIZE_T				histogram[SUS_MEMORY_HISTOGRAM_SIZE];	// Number of allocations of 2^i..2^(i+1)-1 bytes
+	sus_uint_t			sites;								// Number of the call sites
+} SUS_MEMORY_STATS, *SUS_LPMEMORY_STATS;
+
+#ifdef SUS_MEMORY_TRACKING
+
+#ifndef SUS_MEMORY_SUBSYSTEM
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_GENERAL
+#endif // !SUS_MEMORY_SUBSYSTEM
+
+// Allocate memory to the heap and record the call site
+SUS_LPMEMORY SUSAPI sus_mallocAt(
+	_In_ SIZE_T size,
+	_In_ SUS_MEMORY_TAG tag,
+	_In_ LPCSTR file,
+	_In_ DWORD line
+);
+// Allocate zero-initialized memory to the heap and record the call site
+SUS_LPMEMORY SUSAPI sus_zallocAt(
+	_In_ SIZE_T size,
+	_In_ SUS_MEMORY_TAG tag,
+	_In_ LPCSTR file,
+	_In_ DWORD line
+);
+// Memory reallocation with the call site record
+SUS_LPMEMORY SUSAPI sus_reallocAt(
+	_In_ SUS_LPMEMORY block,
+	_In_ SIZE_T newSize,
+	_In_ SUS_MEMORY_TAG tag,
+	_In_ LPCSTR file,
+	_In_ DWORD line
+);
+
+#define sus_malloc(size) sus_mallocAt(size, SUS_MEMORY_SUBSYSTEM, __FILE__, __LINE__)
+#define sus_zalloc(size) sus_zallocAt(size, SUS_MEMORY_SUBSYSTEM, __FILE__, __LINE__)
+#define sus_realloc(block, newSize) sus_reallocAt(block, newSize, SUS_MEMORY_SUBSYSTEM, __FILE__, __LINE__)
+
+// Get a snapshot of the allocation statistics
+VOID SUSAPI susMemorySnapshot(
+	_Out_ SUS_LPMEMORY_STATS stats
+);
+// Get the call sites with the most allocated bytes\return Number of the sites written
+sus_uint_t SUSAPI susMemoryGetSites(
+	_Out_writes_(count) SUS_LPMEMORY_SITE sites,
+	_In_ sus_uint_t count
+);
+// Print the call sites with the most allocated bytes to the debugger
+VOID SUSAPI susMemoryDumpSites(
+	_In_ sus_uint_t count
+);
+// Print the call sites of the live blocks to the debugger\return Number of the live blocks
+SIZE_T SUSAPI susMemoryDumpLeaks();
+
+// Report the leaks before the exit
+#undef sus_exit
+#define sus_exit(code) (susMemoryDumpLeaks(), ExitProcess(code))
+
+#else
+
+#define susMemorySnapshot(stats) sus_zeromem((sus_lpbyte_t)(stats), sizeof(SUS_MEMORY_STATS))
+#define susMemoryGetSites(sites, count) (0)
+#define susMemoryDumpSites(count)
+#define susMemoryDumpLeaks() (0)
+
+#endif // !SUS_MEMORY_TRACKING
+
+// -------------------------------------
 
 // Fast memory allocation
-#define sus_fmalloc(size) (SUS_LPMEMORY)HeapAlloc(GetProcessHeap(), 0, size)
+#define sus_fmalloc(size) sus_malloc(size)
 // Fast allocating a memory array
-#define sus_fcalloc(count, size) (SUS_LPMEMORY)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, (size) * (count))
+#define sus_fcalloc(count, size) sus_calloc(count, size)
 // Fast memory reallocation
-#define sus_frealloc(block, newSize) (SUS_LPMEMORY)HeapReAlloc(GetProcessHeap(), 0, block, newSize)
+#define sus_frealloc(block, newSize) sus_realloc(block, newSize)
 
 //////////////////////////////////////////////////////////////////
 //					Basic memory operations						//
 //////////////////////////////////////////////////////////////////
 
+// Select the instruction set of the memory operations\return The selected set
+SUS_MEMORY_ISA SUSAPI sus_memselect(
+	_In_ SUS_MEMORY_ISA isa
+);
+// Copy a block larger than SUS_MEMORY_INLINE_SIZE bytes
+sus_lpbyte_t SUSAPI sus_memcpyLarge(
+	_Out_writes_bytes_all_(size) sus_lpbyte_t buff,
+	_In_reads_bytes_(size) CONST sus_lpbyte_t source,
+	_In_ SIZE_T size
+);
+// Copy an overlapping block larger than SUS_MEMORY_INLINE_SIZE bytes
+sus_lpbyte_t SUSAPI sus_memmoveLarge(
+	_Out_writes_bytes_all_(size) sus_lpbyte_t buff,
+	_In_reads_bytes_(size) CONST sus_lpbyte_t source,
+	_In_ SIZE_T size
+);
+// Initialize a block larger than SUS_MEMORY_INLINE_SIZE bytes
+VOID SUSAPI sus_memsetLarge(
+	_Out_writes_bytes_all_(size) sus_lpbyte_t data,
+	_In_ BYTE value,
+	_In_ SIZE_T size
+);
+// Compare blocks larger than SUS_MEMORY_INLINE_SIZE bytes
+BOOL SUSAPI sus_memcmpLarge(
+	_In_bytecount_(size) sus_lpbyte_t lpBuf1,
+	_In_bytecount_(size) sus_lpbyte_t lpBuf2,
+	_In_ SIZE_T size
+);
+// Check a block larger than SUS_MEMORY_INLINE_SIZE bytes for zeros
+BOOL SUSAPI sus_memiszeroLarge(
+	_In_bytecount_(size) sus_lpbyte_t lpBuff,
+	_In_ SIZE_T size
+);
+
+// Check whether sus_memfind supports the element size
+#define sus_memfindable(size) ((size) == 1 || (size) == 2 || (size) == 4 || (size) == 8 || (size) == 16)
+// Find the first element equal to the key in an array of 1, 2, 4, 8 or 16-byte elements\return The index of the element or (SIZE_T)-1
+SIZE_T SUSAPI sus_memfind(
+	_In_reads_bytes_(count * size) sus_lpbyte_t data,
+	_In_ SIZE_T count,
+	_In_reads_bytes_(size) sus_lpbyte_t key,
+	_In_ SIZE_T size
+);
+
+// -------------------------------------
+
 // Initialize a memory block
 SUS_INLINE VOID SUSAPI sus_memset(
 	_Out_writes_bytes_all_(size) sus_lpbyte_t data,
@@ -61,15 +254,31 @@ SUS_INLINE VOID SUSAPI sus_memset(
 	_In_ SIZE_T size)
 {
 	SUS_ASSERT(data);
-	__stosb((LPBYTE)data, (BYTE)value, size);
+	if (size > SUS_MEMORY_INLINE_SIZE) {
+		sus_memsetLarge(data, value, size);
+		return;
+	}
+	sus_u64_t v = (sus_u64_t)value * 0x0101010101010101ull;
+	if (size >= 8) {
+		*(sus_unaligned64_t*)data = v;
+		*(sus_unaligned64_t*)(data + size - 8) = v;
+	}
+	else if (size >= 4) {
+		*(sus_unaligned32_t*)data = (sus_u32_t)v;
+		*(sus_unaligned32_t*)(data + size - 4) = (sus_u32_t)v;
+	}
+	else if (size) {
+		data[0] = value;
+		data[size >> 1] = value;
+		data[size - 1] = value;
+	}
 }
 // Initialize a memory block with zeros
 SUS_INLINE VOID SUSAPI sus_zeromem(
 	_Out_writes_bytes_all_(size) sus_lpbyte_t data,
 	_In_ SIZE_T size)
 {
-	SUS_ASSERT(data);
-	__stosb((LPBYTE)data, 0, size);
+	sus_memset(data, 0, size);
 }
 // Comparing memory blocks
 SUS_INLINE BOOL SUSAPI sus_memcmp(
@@ -78,7 +287,10 @@ SUS_INLINE BOOL SUSAPI sus_memcmp(
 	_In_ SIZE_T size)
 {
 	SUS_ASSERT(lpBuf1 && lpBuf2);
-	return RtlCompareMemory((LPBYTE)lpBuf1, (LPBYTE)lpBuf2, size) == size ? TRUE : FALSE;
+	if (size > SUS_MEMORY_INLINE_SIZE) return sus_memcmpLarge(lpBuf1, lpBuf2, size);
+	if (size >= 8) return !((*(sus_unaligned64_t*)lpBuf1 ^ *(sus_unaligned64_t*)lpBuf2) | (*(sus_unaligned64_t*)(lpBuf1 + size - 8) ^ *(sus_unaligned64_t*)(lpBuf2 + size - 8)));
+	if (size >= 4) return !((*(sus_unaligned32_t*)lpBuf1 ^ *(sus_unaligned32_t*)lpBuf2) | (*(sus_unaligned32_t*)(lpBuf1 + size - 4) ^ *(sus_unaligned32_t*)(lpBuf2 + size - 4)));
+	return !size || (lpBuf1[0] == lpBuf2[0] && lpBuf1[size >> 1] == lpBuf2[size >> 1] && lpBuf1[size - 1] == lpBuf2[size - 1]);
 }
 // Comparing memory blocks
 SUS_INLINE BOOL SUSAPI sus_memiszero(
@@ -86,7 +298,37 @@ SUS_INLINE BOOL SUSAPI sus_memiszero(
 	_In_ SIZE_T size)
 {
 	SUS_ASSERT(lpBuff && size);
-	return (BOOL)RtlIsZeroMemory((LPBYTE)lpBuff, size);
+	if (size > SUS_MEMORY_INLINE_SIZE) return sus_memiszeroLarge(lpBuff, size);
+	if (size >= 8) return !(*(sus_unaligned64_t*)lpBuff | *(sus_unaligned64_t*)(lpBuff + size - 8));
+	if (size >= 4) return !(*(sus_unaligned32_t*)lpBuff | *(sus_unaligned32_t*)(lpBuff + size - 4));
+	return !(lpBuff[0] | lpBuff[size >> 1] | lpBuff[size - 1]);
+}
+// Copy the memory
+SUS_INLINE sus_lpbyte_t SUSAPI sus_memmove(
+	_Out_writes_bytes_all_(size) sus_lpbyte_t buff,
+	_In_reads_bytes_(size) CONST sus_lpbyte_t source,
+	_In_ SIZE_T size)
+{
+	SUS_ASSERT(buff != NULL && source != NULL);
+	if (size > SUS_MEMORY_INLINE_SIZE) return sus_memmoveLarge(buff, source, size);
+	// Both ends are loaded before the stores, so overlapping blocks are copied correctly
+	if (size >= 8) {
+		sus_u64_t head = *(sus_unaligned64_t*)source, tail = *(sus_unaligned64_t*)(source + size - 8);
+		*(sus_unaligned64_t*)buff = head;
+		*(sus_unaligned64_t*)(buff + size - 8) = tail;
+	}
+	else if (size >= 4) {
+		sus_u32_t head = *(sus_unaligned32_t*)source, tail = *(sus_unaligned32_t*)(source + size - 4);
+		*(sus_unaligned32_t*)buff = head;
+		*(sus_unaligned32_t*)(buff + size - 4) = tail;
+	}
+	else if (size) {
+		BYTE head = source[0], middle = source[size >> 1], tail = source[size - 1];
+		buff[0] = head;
+		buff[size >> 1] = middle;
+		buff[size - 1] = tail;
+	}
+	return buff;
 }
 // Copy the memory
 SUS_INLINE sus_lpbyte_t SUSAPI sus_memcpy(
@@ -95,8 +337,8 @@ SUS_INLINE sus_lpbyte_t SUSAPI sus_memcpy(
 	_In_ SIZE_T size)
 {
 	SUS_ASSERT(buff && source && !(buff > source && buff < source + size));
-	__movsb((LPBYTE)buff, (LPBYTE)source, size);
-	return buff;
+	if (size > SUS_MEMORY_INLINE_SIZE) return sus_memcpyLarge(buff, source, size);
+	return sus_memmove(buff, source, size);
 }
 // Copy the memory
 SUS_INLINE sus_lpword_t SUSAPI sus_wmemcpy(
@@ -105,18 +347,7 @@ SUS_INLINE sus_lpword_t SUSAPI sus_wmemcpy(
 	_In_ SIZE_T count)
 {
 	SUS_ASSERT(buff && source && !(buff > source && buff < source + count));
-	__movsw((LPWORD)buff, (LPWORD)source, count);
-	return buff;
-}
-// Copy the memory
-SUS_INLINE sus_lpbyte_t SUSAPI sus_memmove(
-	_Out_writes_bytes_all_(size) sus_lpbyte_t buff,
-	_In_reads_bytes_(size) CONST sus_lpbyte_t source,
-	_In_ SIZE_T size)
-{
-	SUS_ASSERT(buff != NULL && source != NULL);
-	if (buff > source && buff < source + size) for (SIZE_T i = size; i > 0; --i) buff[i - 1] = source[i - 1];
-	else __movsb((LPBYTE)buff, (LPBYTE)source, size);
+	sus_memcpy((sus_lpbyte_t)buff, (sus_lpbyte_t)source, count * sizeof(WCHAR));
 	return buff;
 }
 
@@ -180,6 +411,74 @@ SUS_INLINE VOID SUSAPI sus_wcsfree(_In_ LPWSTR str) {
 	sus_free(str);
 }
 
+//////////////////////////////////////////////////////////////////
+//						Shared byte slices						//
+//////////////////////////////////////////////////////////////////
+
+/*
+* SUS_BYTES is a slice of a reference-counted memory block.
+* The block is filled by its creator and is immutable after it is published
+* (retained or passed on), so slices can be shared between threads and layers without copying.
+* A slice without a block borrows foreign memory and does not own it.
+* The block always has a null byte after its data.
+*/
+
+// Reference-counted memory block
+typedef struct sus_bytes_block {
+	volatile LONG	refCount;	// Number of references to the block
+	SIZE_T			size;		// Data size in bytes
+	sus_byte_t		data[];		// Data (+ null terminator)
+} SUS_BYTES_BLOCK, *SUS_LPBYTES_BLOCK;
+// Slice of the memory block
+typedef struct sus_bytes {
+	LPBYTE				data;	// Start of the slice
+	SIZE_T				size;	// Slice size in bytes
+	SUS_LPBYTES_BLOCK	block;	// Owner block (NULL - borrowed memory)
+} SUS_BYTES, *SUS_LPBYTES;
+
+// Create a new block of bytes (the data is writable until the block is published)
+SUS_BYTES SUSAPI susNewBytes(
+	_In_ SIZE_T size
+);
+// Copy the data to a new block of bytes
+SUS_BYTES SUSAPI susBytesCopy(
+	_In_ SUS_DATAVIEW data
+);
+// Change the size of an unpublished block of bytes
+BOOL SUSAPI susBytesResize(
+	_Inout_ SUS_LPBYTES bytes,
+	_In_ SIZE_T size
+);
+
+// Borrow foreign memory as bytes
+#define susBytesBorrow(data_, size_) (SUS_BYTES) { .data = (LPBYTE)(data_), .size = (SIZE_T)(size_), .block = NULL }
+// Get the view of the bytes
+#define susBytesView(bytes) susDataView((bytes).data, (bytes).size)
+// Check whether the bytes are valid
+#define susBytesIsValid(bytes) ((bytes).data != NULL)
+// Add a reference to the bytes
+SUS_INLINE SUS_BYTES SUSAPI susBytesRetain(_In_ SUS_BYTES bytes) {
+	if (bytes.block) InterlockedIncrement(&bytes.block->refCount);
+	return bytes;
+}
+// Release a reference to the bytes
+SUS_INLINE VOID SUSAPI susBytesRelease(_Inout_ SUS_LPBYTES bytes) {
+	SUS_ASSERT(bytes);
+	if (bytes->block && !InterlockedDecrement(&bytes->block->refCount)) sus_free(bytes->block);
+	*bytes = (SUS_BYTES) { 0 };
+}
+// Get a slice of the bytes\return A new reference to the block
+SUS_INLINE SUS_BYTES SUSAPI susBytesSlice(_In_ SUS_BYTES bytes, _In_ SIZE_T offset, _In_ SIZE_T size) {
+	SUS_ASSERT(offset <= bytes.size && size <= bytes.size - offset);
+	bytes.data += offset;
+	bytes.size = size;
+	return susBytesRetain(bytes);
+}
+// Check whether the bytes are followed by a null terminator
+SUS_INLINE BOOL SUSAPI susBytesIsTerminated(_In_ SUS_BYTES bytes) {
+	return bytes.block && !bytes.data[bytes.size];
+}
+
 //////////////////////////////////////////////////////////////////
 //					Dynamic virtual memory						//
 //////////////////////////////////////////////////////////////////
@@ -209,6 +508,267 @@ SUS_LPMEMORY SUSAPI sus_vmallocEx(
 
 #define sus_vfree(block) VirtualFree(block, 0, MEM_RELEASE)
 
+//////////////////////////////////////////////////////////////////
+//						Memory allocators						//
+//////////////////////////////////////////////////////////////////
+
+typedef struct sus_allocator SUS_ALLOCATOR, *SUS_LPALLOCATOR;
+
+// Allocate a zero-initialized block
+typedef SUS_LPMEMORY(SUSAPI* SUS_ALLOCATOR_ALLOCATE)(_Inout_ SUS_LPALLOCATOR allocator, _In_ SIZE_T size);
+// Change the size of the block while keeping its contents
+typedef SUS_LPMEMORY(SUSAPI* SUS_ALLOCATOR_REALLOCATE)(_Inout_ SUS_LPALLOCATOR allocator, _In_opt_ SUS_LPMEMORY block, _In_ SIZE_T oldSize, _In_ SIZE_T newSize);
+// Return the block to the allocator
+typedef VOID(SUSAPI* SUS_ALLOCATOR_RELEASE)(_Inout_ SUS_LPALLOCATOR allocator, _In_ SUS_LPMEMORY block, _In_ SIZE_T size);
+
+// Memory allocator interface
+struct sus_allocator {
+	SUS_ALLOCATOR_ALLOCATE		allocate;	// Allocate a block
+	SUS_ALLOCATOR_REALLOCATE	reallocate;	// Resize a block
+	SUS_ALLOCATOR_RELEASE		release;	// Free a block
+};
+
+// Allocate memory from the allocator (NULL - the process heap)
+SUS_INLINE SUS_LPMEMORY SUSAPI susAllocatorAlloc(_Inout_opt_ SUS_LPALLOCATOR allocator, _In_ SIZE_T size) {
+	return allocator ? allocator->allocate(allocator, size) : sus_zalloc(size);
+}
+// Reallocate memory from the allocator (NULL - the process heap)
+SUS_INLINE SUS_LPMEMORY SUSAPI susAllocatorRealloc(_Inout_opt_ SUS_LPALLOCATOR allocator, _In_opt_ SUS_LPMEMORY block, _In_ SIZE_T oldSize, _In_ SIZE_T newSize) {
+	return allocator ? allocator->reallocate(allocator, block, oldSize, newSize) : sus_realloc(block, newSize);
+}
+// Free the memory of the allocator (NULL - the process heap)
+SUS_INLINE VOID SUSAPI susAllocatorFree(_Inout_opt_ SUS_LPALLOCATOR allocator, _In_ SUS_LPMEMORY block, _In_ SIZE_T size) {
+	if (allocator) allocator->release(allocator, block, size);
+	else sus_free(block);
+}
+
+// Maximum number of the shared aligned allocators
+#define SUS_ALIGNED_ALLOCATOR_COUNT 32
+
+// Heap allocator that aligns the address block + offset
+typedef struct sus_aligned_allocator {
+	SUS_ALLOCATOR	_PARENT_;	// Allocator interface
+	SIZE_T			alignment;	// Alignment (a power of two)
+	SIZE_T			offset;		// Offset of the aligned address in the block
+} SUS_ALIGNED_ALLOCATOR, *SUS_LPALIGNED_ALLOCATOR;
+
+// Get the shared heap allocator that aligns the address block + offset
+SUS_LPALLOCATOR SUSAPI susAlignedAllocator(
+	_In_ SIZE_T alignment,
+	_In_ SIZE_T offset
+);
+
+//////////////////////////////////////////////////////////////////
+//						Arena allocator							//
+//////////////////////////////////////////////////////////////////
+
+// Default size of the arena chunk
+#define SUS_ARENA_CHUNK_SIZE 0x10000
+// Alignment of the arena blocks
+#define SUS_ARENA_ALIGNMENT MEMORY_ALLOCATION_ALIGNMENT
+
+// Arena memory chunk
+typedef struct sus_arena_chunk {
+	struct sus_arena_chunk*	prev;	// Previous chunk
+	SIZE_T					size;	// Chunk capacity in bytes
+	SIZE_T					offset;	// Occupied size in bytes
+	sus_byte_t				data[];	// Chunk data
+} SUS_ARENA_CHUNK, *SUS_LPARENA_CHUNK;
+// Arena flags
+typedef enum sus_arena_flags {
+	SUS_ARENA_FLAG_NONE		= 0,
+	SUS_ARENA_FLAG_VIRTUAL	= 1 << 0	// Chunks are allocated in virtual memory
+} SUS_ARENA_FLAGS;
+// Linear memory allocator
+typedef struct sus_arena {
+	SUS_ALLOCATOR		_PARENT_;	// Allocator interface
+	SUS_LPARENA_CHUNK	chunk;		// Current chunk
+	SUS_LPARENA_CHUNK	spare;		// Released chunks for reuse
+	SUS_LPMEMORY		last;		// The last allocated block
+	SIZE_T				chunkSize;	// Size of the new chunks
+	SUS_ARENA_FLAGS		flags;		// Arena flags
+} SUS_ARENA, *SUS_LPARENA;
+// Position in the arena
+typedef struct sus_arena_mark {
+	SUS_LPARENA_CHUNK	chunk;		// Current chunk
+	SIZE_T				offset;		// Occupied size of the chunk
+} SUS_ARENA_MARK;
+
+// Create an arena
+SUS_ARENA SUSAPI susArenaSetupEx(
+	_In_opt_ SIZE_T chunkSize,
+	_In_ SUS_ARENA_FLAGS flags
+);
+// Create an arena
+#define susArenaSetup() susArenaSetupEx(0, SUS_ARENA_FLAG_NONE)
+// Free all arena memory
+VOID SUSAPI susArenaCleanup(
+	_Inout_ SUS_LPARENA arena
+);
+
+// Allocate a block in the arena
+SUS_LPMEMORY SUSAPI susArenaAlloc(
+	_Inout_ SUS_LPARENA arena,
+	_In_ SIZE_T size
+);
+// Change the size of the block (the last block grows in place)
+SUS_LPMEMORY SUSAPI susArenaRealloc(
+	_Inout_ SUS_LPARENA arena,
+	_In_opt_ SUS_LPMEMORY block,
+	_In_ SIZE_T oldSize,
+	_In_ SIZE_T newSize
+);
+// Free the block (only the last block is returned to the arena)
+VOID SUSAPI susArenaFree(
+	_Inout_ SUS_LPARENA arena,
+	_In_ SUS_LPMEMORY block
+);
+
+// Get the current position in the arena
+SUS_INLINE SUS_ARENA_MARK SUSAPI susArenaMark(_In_ SUS_LPARENA arena) {
+	SUS_ASSERT(arena);
+	return (SUS_ARENA_MARK) { .chunk = arena->chunk, .offset = arena->chunk ? arena->chunk->offset : 0 };
+}
+// Free all blocks allocated after the mark
+VOID SUSAPI susArenaRewind(
+	_Inout_ SUS_LPARENA arena,
+	_In_ SUS_ARENA_MARK mark
+);
+// Free all arena blocks while keeping the chunks for reuse
+SUS_INLINE VOID SUSAPI susArenaReset(_Inout_ SUS_LPARENA arena) {
+	susArenaRewind(arena, (SUS_ARENA_MARK) { 0 });
+}
+// Copy a string to the arena
+SUS_INLINE LPSTR SUSAPI susArenaStrdup(_Inout_ SUS_LPARENA arena, _In_ LPCSTR str) {
+	SUS_ASSERT(str);
+	INT count = lstrlenA(str) + 1;
+	sus_lpbyte_t buff = susArenaAlloc(arena, count * sizeof(CHAR));
+	return buff ? (LPSTR)sus_memcpy(buff, (sus_lpbyte_t)str, count) : NULL;
+}
+
+//////////////////////////////////////////////////////////////////
+//						Pool allocator							//
+//////////////////////////////////////////////////////////////////
+
+// Default size of the pool slab
+#define SUS_POOL_SLAB_SIZE 0x1000
+// Minimum number of objects in the pool slab
+#define SUS_POOL_SLAB_MIN_OBJECTS 8
+// Alignment of the pool objects
+#define SUS_POOL_ALIGNMENT MEMORY_ALLOCATION_ALIGNMENT
+
+// Pool memory slab
+typedef struct sus_pool_slab {
+	struct sus_pool_slab*	next;	// Next slab
+	sus_byte_t				data[];	// Slab objects
+} SUS_POOL_SLAB, *SUS_LPPOOL_SLAB;
+// Pool flags
+typedef enum sus_pool_flags {
+	SUS_POOL_FLAG_NONE			= 0,
+	SUS_POOL_FLAG_THREAD_AFFINE	= 1 << 0	// The pool is used by the owner thread only and is not locked
+} SUS_POOL_FLAGS;
+// Allocator of fixed-size objects
+typedef struct sus_pool {
+	SUS_ALLOCATOR		_PARENT_;	// Allocator interface
+	SUS_LPPOOL_SLAB		slabs;		// Allocated slabs
+	SUS_LPMEMORY		freeList;	// Released objects
+	sus_lpbyte_t		cursor;		// The next object of the current slab
+	sus_lpbyte_t		end;		// The end of the current slab
+	SIZE_T				objectSize;	// Object size in bytes
+	SIZE_T				slabSize;	// Slab size in bytes
+	SUS_POOL_FLAGS		flags;		// Pool flags
+	DWORD				owner;		// The owner thread
+	SRWLOCK				lock;		// Lock of the shared pool
+} SUS_POOL, *SUS_LPPOOL;
+
+// Create a pool of objects
+SUS_POOL SUSAPI susPoolSetupEx(
+	_In_ SIZE_T objectSize,
+	_In_opt_ SIZE_T slabSize,
+	_In_ SUS_POOL_FLAGS flags
+);
+// Create a pool of objects
+#define susPoolSetup(objectSize) susPoolSetupEx(objectSize, 0, SUS_POOL_FLAG_NONE)
+// Free all pool objects at once (the pool stays usable)
+VOID SUSAPI susPoolCleanup(
+	_Inout_ SUS_LPPOOL pool
+);
+
+// Allocate an object in the pool
+SUS_LPMEMORY SUSAPI susPoolAlloc(
+	_Inout_ SUS_LPPOOL pool
+);
+// Return the object to the pool
+VOID SUSAPI susPoolFree(
+	_Inout_ SUS_LPPOOL pool,
+	_In_ SUS_LPMEMORY block
+);
+
+// Create a pool in the heap
+SUS_LPPOOL SUSAPI susNewPool(
+	_In_ SIZE_T objectSize,
+	_In_ SUS_POOL_FLAGS flags
+);
+// Delete a pool from the heap
+VOID SUSAPI susPoolDestroy(
+	_In_ SUS_LPPOOL pool
+);
+
+//////////////////////////////////////////////////////////////////
+//					Virtual memory region						//
+//////////////////////////////////////////////////////////////////
+
+// Granularity of the region commit
+#define SUS_VREGION_COMMIT_SIZE 0x10000
+
+// Region flags
+typedef enum sus_vregion_flags {
+	SUS_VREGION_FLAG_NONE			= 0,
+	SUS_VREGION_FLAG_LARGE_PAGES	= 1 << 0,	// Use large pages if the system allows it (the whole region is committed at once)
+	SUS_VREGION_FLAG_DECOMMIT		= 1 << 1,	// Return the pages to the system when the block shrinks
+	SUS_VREGION_FLAG_EMBEDDED		= 1 << 2	// The region is stored in its own first page and is released with the block
+} SUS_VREGION_FLAGS;
+// Reserved address range with the pages committed on demand
+typedef struct sus_vregion {
+	SUS_ALLOCATOR		_PARENT_;	// Allocator interface (a single block that grows in place)
+	sus_lpbyte_t		base;		// Start of the reserved range
+	sus_lpbyte_t		data;		// Start of the block
+	SIZE_T				reserved;	// Reserved bytes
+	SIZE_T				committed;	// Committed bytes from the start of the range
+	SIZE_T				size;		// Size of the allocated block
+	SUS_VREGION_FLAGS	flags;		// Region flags
+} SUS_VREGION, *SUS_LPVREGION;
+
+// Reserve a region of the address space\return region.base == NULL - failure
+SUS_VREGION SUSAPI susVRegionSetup(
+	_In_ SIZE_T reserve,
+	_In_ SUS_VREGION_FLAGS flags
+);
+// Release the region
+VOID SUSAPI susVRegionCleanup(
+	_Inout_ SUS_LPVREGION region
+);
+// Make the first bytes of the region block accessible
+BOOL SUSAPI susVRegionCommit(
+	_Inout_ SUS_LPVREGION region,
+	_In_ SIZE_T size
+);
+// Return the pages of the region block beyond the size to the system
+VOID SUSAPI susVRegionDecommit(
+	_Inout_ SUS_LPVREGION region,
+	_In_ SIZE_T size
+);
+
+// Create a region stored in its own first page
+SUS_LPVREGION SUSAPI susNewVRegion(
+	_In_ SIZE_T reserve,
+	_In_ SUS_VREGION_FLAGS flags
+);
+// Delete a region stored in its own first page
+VOID SUSAPI susVRegionDestroy(
+	_In_ SUS_LPVREGION region
+);
+
 #ifdef __cplusplus
 }
 #endif // !__cplusplus
@@ -5,8 +5,10 @@
 
 #include "thrprocessapi.h"
 #include "buffer.h"
+#include "chain.h"
 #include "vector.h"
 #include "hashtable.h"
+#include "atom.h"
 
 // -------------------------------------------------------------------------------------------------------------
 
@@ -69,7 +71,7 @@ typedef struct sus_socket {
 	SUS_SOCKET_HANDLER	handler;	// Socket handler function
 	SUS_SOCKET_BUFFER	buffers;	// Socket Read/Write buffers
 	SUS_HASHMAP			timers;		// UINT -> SUS_SOCKET_TIMER
-	SUS_HASHMAP			properties;	// Additional properties of a socket with userData\param LPSTR -> SUS_USERDATA
+	SUS_HASHMAP			properties;	// Additional properties of a socket with userData\param SUS_ATOM -> SUS_USERDATA
 	SUS_SOCKET_ADDRESS	address;	// Address socket
 	SUS_USERDATA		userData;	// User data
 } SUS_SOCKET, *SUS_LPSOCKET;
@@ -190,6 +192,17 @@ SUS_USERDATA SUSAPI susSocketGetProperty(
 	_In_ SUS_LPSOCKET sock,
 	_In_ LPCSTR key
 );
+// Set a property for a socket by the atom key
+BOOL SUSAPI susSocketSetPropertyAtom(
+	_Inout_ SUS_LPSOCKET sock,
+	_In_ SUS_ATOM key,
+	_In_ SUS_USERDATA property
+);
+// Get a property from a socket by the atom key
+SUS_USERDATA SUSAPI susSocketGetPropertyAtom(
+	_In_ SUS_LPSOCKET sock,
+	_In_ SUS_ATOM key
+);
 
 // -----------------------------------------------
 
@@ -212,25 +225,35 @@ sus_size_t SUSAPI susSocketFlush(
 SUS_FORCEINLINE BOOL SUSAPI susSocketHasSendData(_Inout_ SUS_LPSOCKET sock)
 {
 	SUS_ASSERT(sock && sock->buffers.writeBuffer);
-	return sock->buffers.writeBuffer->size ? TRUE : FALSE;
+	return susBufferReadSize(sock->buffers.writeBuffer) ? TRUE : FALSE;
 }
 // Send data to the socket (_Null_terminated_)
 SUS_FORCEINLINE BOOL SUSAPI susSocketWrite(_Inout_ SUS_LPSOCKET sock, _In_bytecount_(size) CONST sus_lpbyte_t data, _In_ sus_size_t size)
 {
 	SUS_PRINTDL("Socket write of %d bytes", size);
 	SUS_ASSERT(sock && sock->buffers.writeBuffer && data && size && size < SUS_SOCKET_MAX_MESSAGE_SIZE);
-	return susBufferPush(&sock->buffers.writeBuffer, data, (sus_size32_t)size) ? TRUE : FALSE;
+	return susBufferPush(&sock->buffers.writeBuffer, data, (sus_csize_t)size) ? TRUE : FALSE;
+}
+// Send the bytes to the socket
+SUS_FORCEINLINE BOOL SUSAPI susSocketWriteBytes(_Inout_ SUS_LPSOCKET sock, _In_ SUS_BYTES bytes) {
+	return susSocketWrite(sock, bytes.data, bytes.size);
 }
 // Send text to the socket
 SUS_FORCEINLINE BOOL SUSAPI susSocketWriteText(_Inout_ SUS_LPSOCKET sock, _In_ LPCSTR text) {
-	sus_size_t size = (sus_size_t)(sus_strlen(text) * sizeof(CHAR) + 2);
-	SUS_OBJECT tmp = sus_malloc(size);
-	if (!tmp) return FALSE;
-	sus_memcpy(tmp, (sus_lpbyte_t)text, size - 1);
-	BOOL res = susSocketWrite(sock, tmp, size);
-	sus_free(tmp);
-	return res;
+	SUS_ASSERT(sock && sock->buffers.writeBuffer && text);
+	sus_size_t size = (sus_size_t)sus_strlen(text) * sizeof(CHAR);
+	SUS_ASSERT(size + 2 < SUS_SOCKET_MAX_MESSAGE_SIZE);
+	sus_lpbyte_t buff = susBufferPush(&sock->buffers.writeBuffer, NULL, (sus_csize_t)size + 2);
+	if (!buff) return FALSE;
+	sus_memcpy(buff, (sus_lpbyte_t)text, size);
+	buff[size] = buff[size + 1] = 0;
+	return TRUE;
 }
+// Send the data of the chain to the socket
+BOOL SUSAPI susSocketWriteChain(
+	_Inout_ SUS_LPSOCKET sock,
+	_In_ SUS_LPCHAIN chain
+);
 // Send text to the socket
 SUS_FORCEINLINE BOOL SUSAPI susSocketWriteWText(_Inout_ SUS_LPSOCKET sock, _In_ LPCWSTR text) {
 	return susSocketWrite(sock, (sus_lpbyte_t)text, ((sus_size_t)sus_wcslen(text)) * sizeof(WCHAR) + 2);
@@ -0,0 +1,221 @@
+// tree.h
+//
+#ifndef _SUS_TREE_
+#define _SUS_TREE_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // !__cplusplus
+
+#include "memory.h"
+#pragma warning(push)
+#pragma warning(disable: 4200)
+
+/*
+* An ordered map is a B+tree: all the key-value pairs are stored in the leaves,
+* the leaves are linked in the key order, and the inner nodes keep only the keys
+* that route the search. The nodes are wide (SUS_TREE_NODE_SIZE bytes), and the keys
+* of a node are stored in one array, so a search reads a few contiguous blocks.
+* The full nodes are split on the way down on the insertion, the underloaded nodes
+* borrow from or merge with a sibling on the way up on the removal.
+*/
+
+// =======================================================================================
+
+// Callback function for the key ordering (\return <0 if key1 < key2, 0 if key1 == key2, >0 if key1 > key2)
+typedef sus_int_t(SUSAPI* SUS_TREE_CMP_CALLBACK)(SUS_OBJECT key1, SUS_OBJECT key2, SIZE_T size);
+
+// Default key ordering (the keys of 1, 2, 4 and 8 bytes are unsigned numbers, the other keys are compared bytewise)
+SUS_INLINE sus_int_t SUSAPI susDefTreeCmpKeys(SUS_OBJECT key1, SUS_OBJECT key2, SIZE_T size) {
+	SUS_ASSERT(key1 && key2 && size);
+	switch (size) {
+	case 1: return (sus_int_t)*(sus_u8_t*)key1 - (sus_int_t)*(sus_u8_t*)key2;
+	case 2: return (sus_int_t)*(sus_u16_t*)key1 - (sus_int_t)*(sus_u16_t*)key2;
+	case 4: return (*(sus_u32_t*)key1 > *(sus_u32_t*)key2) - (*(sus_u32_t*)key1 < *(sus_u32_t*)key2);
+	case 8: return (*(sus_u64_t*)key1 > *(sus_u64_t*)key2) - (*(sus_u64_t*)key1 < *(sus_u64_t*)key2);
+	}
+	for (SIZE_T i = 0; i < size; i++) {
+		if (((LPBYTE)key1)[i] != ((LPBYTE)key2)[i]) return (sus_int_t)((LPBYTE)key1)[i] - (sus_int_t)((LPBYTE)key2)[i];
+	}
+	return 0;
+}
+// Key ordering of the signed numbers of 1, 2, 4 and 8 bytes
+SUS_INLINE sus_int_t SUSAPI susDefTreeCmpIntKeys(SUS_OBJECT key1, SUS_OBJECT key2, SIZE_T size) {
+	SUS_ASSERT(key1 && key2 && (size == 1 || size == 2 || size == 4 || size == 8));
+	switch (size) {
+	case 1: return (sus_int_t)*(sus_i8_t*)key1 - (sus_int_t)*(sus_i8_t*)key2;
+	case 2: return (sus_int_t)*(sus_i16_t*)key1 - (sus_int_t)*(sus_i16_t*)key2;
+	case 4: return (*(sus_i32_t*)key1 > *(sus_i32_t*)key2) - (*(sus_i32_t*)key1 < *(sus_i32_t*)key2);
+	default: return (*(sus_i64_t*)key1 > *(sus_i64_t*)key2) - (*(sus_i64_t*)key1 < *(sus_i64_t*)key2);
+	}
+}
+// Key ordering of the strings (ordinal, so the keys with a common prefix are adjacent)
+SUS_INLINE sus_int_t SUSAPI susDefTreeCmpStringKeysA(SUS_OBJECT key1, SUS_OBJECT key2, SIZE_T size) {
+	SUS_ASSERT(key1 && key2 && size == sizeof(LPCSTR));
+	UNREFERENCED_PARAMETER(size);
+	const BYTE* str1 = *(const BYTE**)key1, *str2 = *(const BYTE**)key2;
+	while (*str1 && *str1 == *str2) { str1++; str2++; }
+	return (sus_int_t)*str1 - (sus_int_t)*str2;
+}
+// Key ordering of the strings (ordinal, so the keys with a common prefix are adjacent)
+SUS_INLINE sus_int_t SUSAPI susDefTreeCmpStringKeysW(SUS_OBJECT key1, SUS_OBJECT key2, SIZE_T size) {
+	SUS_ASSERT(key1 && key2 && size == sizeof(LPCWSTR));
+	UNREFERENCED_PARAMETER(size);
+	LPCWSTR str1 = *(LPCWSTR*)key1, str2 = *(LPCWSTR*)key2;
+	while (*str1 && *str1 == *str2) { str1++; str2++; }
+	return (sus_int_t)*str1 - (sus_int_t)*str2;
+}
+
+// =======================================================================================
+
+// Size of the tree node in bytes (the nodes of the large keys are enlarged to SUS_TREE_MIN_ORDER keys)
+#define SUS_TREE_NODE_SIZE 1024
+// Minimum number of the keys in a full node
+#define SUS_TREE_MIN_ORDER 4
+// Maximum height of the tree
+#define SUS_TREE_MAX_HEIGHT 32
+
+// -------------------------------------------------------------------
+
+// Tree node (the keys are followed by the values in a leaf and by the children in an inner node)
+typedef struct sus_tree_node {
+	DWORD					count;	// Number of the keys
+	BOOL					leaf;	// The node is a leaf
+	struct sus_tree_node*	prev;	// The previous leaf
+	struct sus_tree_node*	next;	// The next leaf
+	SUS_ALIGNAS(16) sus_byte_t data[];	// Keys followed by the values or the children
+} SUS_TREE_NODE, *SUS_LPTREE_NODE;
+
+// Ordered map
+typedef struct sus_tree {
+	SUS_LPTREE_NODE			root;			// Root node (NULL - the tree is empty)
+	SUS_TREE_CMP_CALLBACK	cmpKeys;		// Key ordering function
+	DWORD					keySize;		// Key size in bytes
+	DWORD					valueSize;		// Value size in bytes
+	DWORD					count;			// Number of the key-value pairs
+	DWORD					height;			// Number of the node levels
+	DWORD					leafCapacity;	// Maximum number of the keys in a leaf
+	DWORD					innerCapacity;	// Maximum number of the keys in an inner node
+} SUS_TREE, *SUS_LPTREE;
+
+// Get the key of the node
+#define susTreeNodeKey(tree, node, i) ((SUS_OBJECT)((node)->data + (SIZE_T)(i) * (tree)->keySize))
+// Get the value of the leaf
+#define susTreeLeafValue(tree, node, i) ((SUS_OBJECT)((node)->data + (SIZE_T)(tree)->leafCapacity * (tree)->keySize + (SIZE_T)(i) * (tree)->valueSize))
+// Get the children of the inner node
+#define susTreeNodeChildren(tree, node) ((SUS_LPTREE_NODE*)((node)->data + SUS_ALIGN((SIZE_T)(tree)->innerCapacity * (tree)->keySize, sizeof(SUS_LPTREE_NODE))))
+
+// -------------------------------------------------------------------
+
+// Create an ordered map
+SUS_TREE SUSAPI susTreeSetupEx(
+	_In_ SIZE_T keySize,
+	_In_ SIZE_T valueSize,
+	_In_opt_ SUS_TREE_CMP_CALLBACK cmpKeys
+);
+// Create an ordered map
+#define susTreeSetup(keyType, valueType) susTreeSetupEx(sizeof(keyType), sizeof(valueType), NULL)
+// Create an ordered map of the string keys
+#define susStringTreeSetup(valueType) susTreeSetupEx(sizeof(LPCSTR), sizeof(valueType), susDefTreeCmpStringKeysA)
+// Create an ordered map of the string keys
+#define susWStringTreeSetup(valueType) susTreeSetupEx(sizeof(LPCWSTR), sizeof(valueType), susDefTreeCmpStringKeysW)
+// Remove all the key-value pairs (the tree stays usable)
+VOID SUSAPI susTreeCleanup(
+	_Inout_ SUS_LPTREE tree
+);
+// Fill an empty tree from the strictly ascending keys (values NULL - the values are zeroed)
+BOOL SUSAPI susTreeBulkLoad(
+	_Inout_ SUS_LPTREE tree,
+	_In_reads_bytes_(count * tree->keySize) const SUS_OBJECT keys,
+	_In_reads_bytes_opt_(count * tree->valueSize) const SUS_OBJECT values,
+	_In_ DWORD count
+);
+
+// -------------------------------------------------------------------
+
+// Get the value by key (\return NULL if the key is not found)
+SUS_OBJECT SUSAPI susTreeGet(
+	_In_ const SUS_LPTREE tree,
+	_In_bytecount_(tree->keySize) const SUS_OBJECT key
+);
+// Check if the tree contains the key
+#define susTreeContains(tree, key) (susTreeGet(tree, key) != NULL)
+// Add or change a value (\return the value in the tree or NULL if there is not enough memory)
+SUS_OBJECT SUSAPI susTreeInsert(
+	_Inout_ SUS_LPTREE tree,
+	_In_bytecount_(tree->keySize) const SUS_OBJECT key,
+	_In_opt_bytecount_(tree->valueSize) const SUS_OBJECT value
+);
+// Delete a key-value pair (\return FALSE if the key is not found)
+BOOL SUSAPI susTreeRemove(
+	_Inout_ SUS_LPTREE tree,
+	_In_bytecount_(tree->keySize) const SUS_OBJECT key
+);
+
+// -------------------------------------------------------------------
+
+// Position in the ordered map (the cursors are invalidated by the insertion and the removal)
+typedef struct sus_tree_cursor {
+	SUS_LPTREE			tree;	// The tree of the cursor
+	SUS_LPTREE_NODE		node;	// The leaf of the current pair (NULL - behind the last pair)
+	DWORD				index;	// Index of the current pair in the leaf
+} SUS_TREE_CURSOR, *SUS_LPTREE_CURSOR;
+
+// Get the cursor to the first pair
+SUS_TREE_CURSOR SUSAPI susTreeFirst(
+	_In_ const SUS_LPTREE tree
+);
+// Get the cursor to the last pair
+SUS_TREE_CURSOR SUSAPI susTreeLast(
+	_In_ const SUS_LPTREE tree
+);
+// Get the cursor to the first pair with the key not less than the key
+SUS_TREE_CURSOR SUSAPI susTreeLowerBound(
+	_In_ const SUS_LPTREE tree,
+	_In_bytecount_(tree->keySize) const SUS_OBJECT key
+);
+// Get the cursor to the first pair with the key greater than the key
+SUS_TREE_CURSOR SUSAPI susTreeUpperBound(
+	_In_ const SUS_LPTREE tree,
+	_In_bytecount_(tree->keySize) const SUS_OBJECT key
+);
+// Go to the next pair (\return FALSE if the cursor is behind the last pair)
+BOOL SUSAPI susTreeCursorNext(
+	_Inout_ SUS_LPTREE_CURSOR cursor
+);
+// Go to the previous pair (\return FALSE if there is no previous pair, the cursor is not moved then)
+BOOL SUSAPI susTreeCursorPrev(
+	_Inout_ SUS_LPTREE_CURSOR cursor
+);
+
+// Check whether the cursor points to a pair
+#define susTreeCursorValid(cursor) ((cursor).node != NULL)
+// Get the key of the cursor
+SUS_INLINE SUS_OBJECT SUSAPI susTreeCursorKey(SUS_TREE_CURSOR cursor) {
+	SUS_ASSERT(cursor.node);
+	return susTreeNodeKey(cursor.tree, cursor.node, cursor.index);
+}
+// Get the value of the cursor
+SUS_INLINE SUS_OBJECT SUSAPI susTreeCursorValue(SUS_TREE_CURSOR cursor) {
+	SUS_ASSERT(cursor.node);
+	return susTreeLeafValue(cursor.tree, cursor.node, cursor.index);
+}
+// Check whether the cursor points to a pair with the key less than the high key (NULL - no limit)
+SUS_INLINE BOOL SUSAPI susTreeCursorBefore(SUS_TREE_CURSOR cursor, const SUS_OBJECT high) {
+	return cursor.node && (!high || cursor.tree->cmpKeys(susTreeCursorKey(cursor), high, cursor.tree->keySize) < 0);
+}
+
+// Iterate over all the pairs in the key order
+#define susTreeForeach(tree, c) for (SUS_TREE_CURSOR c = susTreeFirst(tree); susTreeCursorValid(c); susTreeCursorNext(&c))
+// Iterate over the pairs with the keys from the low key (inclusive) to the high key (exclusive, NULL - no limit)
+#define susTreeForeachRange(tree, c, low, high) for (SUS_TREE_CURSOR c = susTreeLowerBound(tree, low); susTreeCursorBefore(c, high); susTreeCursorNext(&c))
+
+// =======================================================================================
+
+#pragma warning(pop)
+
+#ifdef __cplusplus
+}
+#endif // !__cplusplus
+
+#endif // !_SUS_TREE_
@@ -17,10 +17,13 @@
 #define SUS_VECTOR_TRANSFER_SIZE 12
 // Dynamic array
 typedef struct sus_vector {
-	sus_uint_t	length;		// Length of the array
-	sus_uint_t	capacity;	// Vector capacity in elements
+	sus_csize_t	length;		// Length of the array
+	sus_csize_t	capacity;	// Vector capacity in elements
 	sus_size_t	itemSize;	// The size of the element in bytes
-	sus_byte_t	data[];		// Array data
+	SUS_LPALLOCATOR	allocator;	// Memory allocator (NULL - process heap)
+	sus_u16_t	policy;		// Growth policy (SUS_GROWTH_POLICY)
+	sus_u16_t	underload;	// Underloaded removals counter (hysteresis policy)
+	SUS_ALIGNAS(MEMORY_ALLOCATION_ALIGNMENT) sus_byte_t data[];	// Array data
 } SUS_VECTOR_STRUCT, *SUS_VECTOR, **SUS_LPVECTOR;
 
 // -------------------------------------
@@ -29,39 +32,96 @@ typedef struct sus_vector {
 SUS_VECTOR SUSAPI susNewVectorEx(_In_ sus_size_t itemSize);
 //
 #define susNewVector(type) susNewVectorEx(sizeof(type))
+// Create a new vector with the aligned data (alignment - a power of two, up to MEMORY_ALLOCATION_ALIGNMENT has no effect)
+SUS_VECTOR SUSAPI susNewVectorAlignedEx(_In_ sus_size_t itemSize, _In_ SIZE_T alignment);
+// Create a new vector with the data aligned to the cache line
+#define susNewVectorAligned(type) susNewVectorAlignedEx(sizeof(type), SUS_MEMORY_CACHE_LINE)
+// Create a new vector in the allocator memory
+SUS_VECTOR SUSAPI susNewVectorAllocator(_In_ sus_size_t itemSize, _In_opt_ SUS_LPALLOCATOR allocator);
+// Create a new vector in the arena
+#define susNewVectorArena(arena, type) susNewVectorAllocator(sizeof(type), &(arena)->super)
+// Create a new vector that grows in place inside a reserved region (the vector pointer never changes)
+SUS_VECTOR SUSAPI susNewVectorRegionEx(_In_ sus_size_t itemSize, _In_ SIZE_T maxCount, _In_ SUS_VREGION_FLAGS flags);
+// Create a new vector that grows in place inside a reserved region
+#define susNewVectorRegion(type, maxCount) susNewVectorRegionEx(sizeof(type), maxCount, SUS_VREGION_FLAG_NONE)
 // Delete a vector
 VOID SUSAPI susVectorDestroy(_In_ SUS_VECTOR vector);
 // Apply changes to the vector
 BOOL SUSAPI susVectorFlush(_Inout_ SUS_LPVECTOR vector);
+// Set the growth policy of the vector
+#define susVectorSetPolicy(vector, growthPolicy) ((vector)->policy = (sus_u16_t)(growthPolicy), (vector)->underload = 0)
+// Guarantee the space for the specified number of elements after the end of the array
+BOOL SUSAPI susVectorReserve(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t reserve);
+// Shrink the capacity of the vector to its length
+BOOL SUSAPI susVectorShrinkToFit(_Inout_ SUS_LPVECTOR lpVector);
 
 // -------------------------------------
 
 // Insert elements into an array
-SUS_LPMEMORY SUSAPI susVectorInsertArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_uint_t count);
+SUS_LPMEMORY SUSAPI susVectorInsertArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_csize_t count);
 // Set the value of the array elements
-SUS_LPMEMORY SUSAPI susVectorSetArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_uint_t count);
+SUS_LPMEMORY SUSAPI susVectorSetArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_csize_t count);
 // Remove elements from an array
-BOOL SUSAPI susVectorEraseArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i, _In_ sus_uint_t count);
+BOOL SUSAPI susVectorEraseArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i, _In_ sus_csize_t count);
 // Swap the elements in the array
-BOOL SUSAPI susVectorSwap(_In_ SUS_VECTOR vector, _In_ sus_uint_t from, _In_ sus_uint_t to);
+BOOL SUSAPI susVectorSwap(_In_ SUS_VECTOR vector, _In_ sus_csize_t from, _In_ sus_csize_t to);
 // Swap places and delete
-BOOL SUSAPI susVectorSwapErase(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i);
+BOOL SUSAPI susVectorSwapErase(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i);
+// Compress the array according to its policy
+BOOL SUSAPI susVectorCompress(_Inout_ SUS_LPVECTOR lpVector);
+// Check whether the array is underloaded according to its policy
+#define susVectorShouldCompress(vector) susGrowthPolicyIsUnderloaded((vector)->policy, (vector)->length, (vector)->capacity, SUS_VECTOR_CAPACITY)
 
 // The function for 'indexOf' operation
-typedef BOOL(SUSAPI* SUS_VECTOR_INDEXOF_FUNC)(_In_ SUS_VECTOR vector, _In_ sus_uint_t current, _In_ SUS_OBJECT target);
-// Find an element in an array starting from the beginning
-sus_int_t SUSAPI susVectorIndexOf(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_opt_ SUS_VECTOR_INDEXOF_FUNC func);
-// Find an array element starting from the end
-sus_int_t SUSAPI susVectorLastIndexOf(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_opt_ SUS_VECTOR_INDEXOF_FUNC func);
+typedef BOOL(SUSAPI* SUS_VECTOR_INDEXOF_FUNC)(_In_ SUS_VECTOR vector, _In_ sus_csize_t current, _In_ SUS_OBJECT target);
+// Find an element in an array starting from the beginning (without the function the elements of 1, 2, 4, 8 and 16 bytes are compared with SIMD)\return SUS_CSIZE_MAX if the element is not found
+sus_csize_t SUSAPI susVectorIndexOf(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_opt_ SUS_VECTOR_INDEXOF_FUNC func);
+// Find an array element starting from the end\return SUS_CSIZE_MAX if the element is not found
+sus_csize_t SUSAPI susVectorLastIndexOf(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_opt_ SUS_VECTOR_INDEXOF_FUNC func);
+
+// -------------------------------------
+
+// Number of elements below which the sorts switch to the insertion sort
+#define SUS_VECTOR_INSERTION_SORT_THRESHOLD 16
+
+// The function for comparing the elements (\return <0 if a < b, 0 if a == b, >0 if a > b)
+typedef sus_int_t(SUSAPI* SUS_VECTOR_COMPARE_FUNC)(_In_ SUS_LPMEMORY a, _In_ SUS_LPMEMORY b);
+// The function for getting the sort key of the element (the keys are compared as unsigned numbers)
+typedef sus_u64_t(SUSAPI* SUS_VECTOR_KEY_FUNC)(_In_ SUS_LPMEMORY item);
+
+// Sort the array (introsort, the order of the equal elements is not preserved)
+VOID SUSAPI susVectorSort(_Inout_ SUS_VECTOR vector, _In_ SUS_VECTOR_COMPARE_FUNC cmp);
+// Sort the array keeping the order of the equal elements (merge sort, uses a temporary copy of the array)
+BOOL SUSAPI susVectorStableSort(_Inout_ SUS_VECTOR vector, _In_ SUS_VECTOR_COMPARE_FUNC cmp);
+// Sort an array of sus_u32_t (LSD radix sort, stable)
+BOOL SUSAPI susVectorRadixSort32(_Inout_ SUS_VECTOR vector);
+// Sort an array of sus_u64_t (LSD radix sort, stable)
+BOOL SUSAPI susVectorRadixSort64(_Inout_ SUS_VECTOR vector);
+// Sort the array by the element keys (LSD radix sort, stable, the key is taken once per element)
+BOOL SUSAPI susVectorRadixSortBy(_Inout_ SUS_VECTOR vector, _In_ SUS_VECTOR_KEY_FUNC key);
+
+// Find the first element that is not less than the value in a sorted array (\return length if there is no such element)
+sus_csize_t SUSAPI susVectorLowerBound(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_ SUS_VECTOR_COMPARE_FUNC cmp);
+// Find the first element that is greater than the value in a sorted array (\return length if there is no such element)
+sus_csize_t SUSAPI susVectorUpperBound(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_ SUS_VECTOR_COMPARE_FUNC cmp);
+// Find an element in a sorted array (\return SUS_CSIZE_MAX if the element is not found)
+sus_csize_t SUSAPI susVectorBinarySearch(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_ SUS_VECTOR_COMPARE_FUNC cmp);
+
+// Get the depth limit of the introsort recursion
+SUS_INLINE sus_csize_t SUSAPI susVectorSortDepth(_In_ sus_csize_t count) {
+	sus_csize_t depth = 0;
+	while (count >>= 1) depth += 2;
+	return depth;
+}
 
 // -------------------------------------
 
 // Set an element to an array
-SUS_INLINE SUS_LPMEMORY SUSAPI susVectorInsert(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i, _In_opt_ SUS_LPMEMORY data) { return susVectorInsertArray(lpVector, i, data, 1); }
+SUS_INLINE SUS_LPMEMORY SUSAPI susVectorInsert(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i, _In_opt_ SUS_LPMEMORY data) { return susVectorInsertArray(lpVector, i, data, 1); }
 // Delete an element from an array
-SUS_INLINE BOOL SUSAPI susVectorErase(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i) { return susVectorEraseArray(lpVector, i, 1); }
+SUS_INLINE BOOL SUSAPI susVectorErase(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i) { return susVectorEraseArray(lpVector, i, 1); }
 // 
-SUS_INLINE SUS_LPMEMORY SUSAPI susVectorSet(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i, _In_opt_ SUS_LPMEMORY data) { return susVectorSetArray(lpVector, i, data, 1); }
+SUS_INLINE SUS_LPMEMORY SUSAPI susVectorSet(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i, _In_opt_ SUS_LPMEMORY data) { return susVectorSetArray(lpVector, i, data, 1); }
 
 // -------------------------------------
 
@@ -81,12 +141,264 @@ SUS_INLINE BOOL SUSAPI susVectorShift(_Inout_ SUS_LPVECTOR lpVector) { SUS_ASSER
 #define susVectorAt(vector, i) ((SUS_LPMEMORY)((vector)->data + (i) * (vector)->itemSize))
 // Get the array data
 #define susVectorGet(vector, i, type) (*(type*)susVectorAt(vector, i))
-// Get the array data
-#define susVectorContains(vector, value, func) ((BOOL)(susVectorIndexOf(vector, value, func) ? TRUE : FALSE))
+// Check the presence of an element in the array
+#define susVectorContains(vector, value, func) ((BOOL)(susVectorIndexOf(vector, value, func) != SUS_CSIZE_MAX))
 // Walk through the array
-#define susVecForeach(i, vector) for (sus_uint_t i = 0; i < (vector)->length; i++)
+#define susVecForeach(i, vector) for (sus_csize_t i = 0; i < (vector)->length; i++)
 // Walk through the array revers
-#define susVecForeachReverse(i, vector) for (sus_int_t i = (vector)->length - 1; i >= 0; i--)
+#define susVecForeachReverse(i, vector) for (sus_csize_t i = (vector)->length; i-- > 0;)
+
+// -------------------------------------
+
+/*
+* Small vector - an array that keeps the first elements inside the owning structure.
+* The elements stay in the inline storage until their number exceeds it,
+* only then they are moved to a block of the allocator. The inline storage is addressed
+* by the offset from the header, so the owning structure can be moved by value
+* (after that the old copy must not be used).
+* Example:
+*	typedef struct { SUS_SMALL_VECTOR_OF(SUS_ENTITY, 4) children; } NODE;
+*	NODE node;
+*	susSmallVectorSetup(&node.children);
+*	susSmallVectorPush(&node.children.super, &entity);
+*	susSmallVectorCleanup(&node.children.super);
+*/
+
+// Small vector header
+typedef struct sus_small_vector {
+	sus_uint_t		length;			// Length of the array
+	sus_uint_t		capacity;		// Current capacity in elements
+	sus_uint_t		itemSize;		// The size of the element in bytes
+	sus_u16_t		inlineCapacity;	// Number of the elements in the inline storage
+	sus_u16_t		inlineOffset;	// Offset of the inline storage from the header
+	sus_lpbyte_t	heap;			// Moved out elements (NULL - the elements are inline)
+	SUS_LPALLOCATOR	allocator;		// Memory allocator of the moved out elements (NULL - process heap)
+} SUS_SMALL_VECTOR_STRUCT, *SUS_SMALL_VECTOR;
+
+// Declare a small vector with the inline storage for N elements of the type T
+#define SUS_SMALL_VECTOR_OF(T, N) struct { SUS_SMALL_VECTOR_STRUCT _PARENT_; T inlineData[N]; }
+// Initialize a declared small vector
+#define susSmallVectorSetup(vector) susSmallVectorInit(&(vector)->super, sizeof(*(vector)->inlineData), SUS_COUNT_OF((vector)->inlineData), (sus_u16_t)((sus_lpbyte_t)(vector)->inlineData - (sus_lpbyte_t)(vector)), NULL)
+
+// Initialize a small vector header (inlineOffset - offset of the inline storage from the header)
+SUS_INLINE VOID SUSAPI susSmallVectorInit(_Out_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t itemSize, _In_ sus_uint_t inlineCapacity, _In_ sus_u16_t inlineOffset, _In_opt_ SUS_LPALLOCATOR allocator) {
+	SUS_ASSERT(vector && itemSize && inlineOffset >= sizeof(SUS_SMALL_VECTOR_STRUCT));
+	vector->length = 0;
+	vector->capacity = inlineCapacity;
+	vector->itemSize = itemSize;
+	vector->inlineCapacity = (sus_u16_t)inlineCapacity;
+	vector->inlineOffset = inlineOffset;
+	vector->heap = NULL;
+	vector->allocator = allocator;
+}
+// Free the moved out elements of a small vector
+SUS_INLINE VOID SUSAPI susSmallVectorCleanup(_Inout_ SUS_SMALL_VECTOR vector) {
+	SUS_ASSERT(vector);
+	if (vector->heap) susAllocatorFree(vector->allocator, vector->heap, (SIZE_T)vector->capacity * vector->itemSize);
+	vector->heap = NULL;
+	vector->length = 0;
+	vector->capacity = vector->inlineCapacity;
+}
+// Guarantee the space for the specified number of elements after the end of the array
+BOOL SUSAPI susSmallVectorReserve(_Inout_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t reserve);
+// Shrink the capacity of the vector to its length (the elements return to the inline storage if they fit)
+BOOL SUSAPI susSmallVectorShrinkToFit(_Inout_ SUS_SMALL_VECTOR vector);
+// Insert elements into an array
+SUS_LPMEMORY SUSAPI susSmallVectorInsertArray(_Inout_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_uint_t count);
+// Remove elements from an array (the capacity is kept)
+VOID SUSAPI susSmallVectorEraseArray(_Inout_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t i, _In_ sus_uint_t count);
+// Find an element in an array (\return SUS_CSIZE_MAX if the element is not found)
+sus_csize_t SUSAPI susSmallVectorIndexOf(_In_ SUS_SMALL_VECTOR vector, _In_ SUS_LPMEMORY value);
+
+// Get a pointer to the array data
+#define susSmallVectorData(vector) ((vector)->heap ? (vector)->heap : (sus_lpbyte_t)(vector) + (vector)->inlineOffset)
+// Get a pointer to the array element
+#define susSmallVectorAt(vector, i) ((SUS_LPMEMORY)(susSmallVectorData(vector) + (SIZE_T)(i) * (vector)->itemSize))
+// Get the array element
+#define susSmallVectorGet(vector, i, type) (*(type*)susSmallVectorAt(vector, i))
+// Check whether the elements are in the inline storage
+#define susSmallVectorIsInline(vector) (!(vector)->heap)
+// Check the presence of an element in the array
+#define susSmallVectorContains(vector, value) ((BOOL)(susSmallVectorIndexOf(vector, value) != SUS_CSIZE_MAX))
+// Walk through the array
+#define susSmallVectorForeach(i, vector) for (sus_uint_t i = 0; i < (vector)->length; i++)
+
+// Insert an element at the end of the array
+SUS_INLINE SUS_LPMEMORY SUSAPI susSmallVectorPush(_Inout_ SUS_SMALL_VECTOR vector, _In_opt_ SUS_LPMEMORY data) {
+	SUS_ASSERT(vector);
+	if (vector->length == vector->capacity) return susSmallVectorInsertArray(vector, vector->length, data, 1);
+	sus_lpbyte_t item = susSmallVectorAt(vector, vector->length++);
+	if (data) sus_memcpy(item, data, vector->itemSize);
+	else sus_zeromem(item, vector->itemSize);
+	return item;
+}
+// Delete an element from the end of the array (value - receives the element)
+SUS_INLINE VOID SUSAPI susSmallVectorPop(_Inout_ SUS_SMALL_VECTOR vector, _Out_opt_ SUS_LPMEMORY value) {
+	SUS_ASSERT(vector && vector->length);
+	vector->length--;
+	if (value) sus_memcpy(value, susSmallVectorAt(vector, vector->length), vector->itemSize);
+}
+// Replace the element with the last one
+SUS_INLINE VOID SUSAPI susSmallVectorSwapErase(_Inout_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t i) {
+	SUS_ASSERT(vector && i < vector->length);
+	if (i != --vector->length) sus_memcpy(susSmallVectorAt(vector, i), susSmallVectorAt(vector, vector->length), vector->itemSize);
+}
+// Delete an element from an array
+SUS_INLINE VOID SUSAPI susSmallVectorErase(_Inout_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t i) { susSmallVectorEraseArray(vector, i, 1); }
+
+// -------------------------------------
+
+/*
+* Typed vector generator.
+* SUS_DECLARE_VECTOR(Name, T) generates inline functions over an ordinary SUS_VECTOR
+* with the elements of type T, so the element size is a compile-time constant:
+*	Name##New()						- create a vector of T
+*	Name##Data(vector)				- T* array data
+*	Name##At(vector, i)				- T* element
+*	Name##Push(lpVector, value)		- append an element (NULL - failure)
+*	Name##Pop(lpVector)				- remove and return the last element
+*	Name##SwapErase(lpVector, i)	- replace the element with the last one
+*	Name##IndexOf(vector, value)	- find an element (SUS_CSIZE_MAX - not found)
+*	Name##Contains(vector, value)	- check the presence of an element
+* The growth and the compression follow the policy of the vector (susVectorSetPolicy).
+* Example:
+*	SUS_DECLARE_VECTOR(susIntVector, INT)
+*	SUS_VECTOR numbers = susIntVectorNew();
+*	susIntVectorPush(&numbers, 5);
+*/
+#define SUS_DECLARE_VECTOR(Name, T) \
+	SUS_INLINE SUS_VECTOR SUSAPI Name##New() { \
+		return susNewVectorEx(sizeof(T)); \
+	} \
+	SUS_INLINE T* SUSAPI Name##Data(_In_ SUS_VECTOR vector) { \
+		SUS_ASSERT(vector && vector->itemSize == sizeof(T)); \
+		return (T*)vector->data; \
+	} \
+	SUS_INLINE T* SUSAPI Name##At(_In_ SUS_VECTOR vector, _In_ sus_csize_t i) { \
+		SUS_ASSERT(vector && vector->itemSize == sizeof(T) && i < vector->length); \
+		return (T*)vector->data + i; \
+	} \
+	SUS_INLINE T* SUSAPI Name##Push(_Inout_ SUS_LPVECTOR lpVector, _In_ T value) { \
+		SUS_ASSERT(lpVector && *lpVector && (*lpVector)->itemSize == sizeof(T)); \
+		SUS_VECTOR vector = *lpVector; \
+		if (vector->length == vector->capacity) return (T*)susVectorInsertArray(lpVector, vector->length, &value, 1); \
+		((T*)vector->data)[vector->length] = value; \
+		return (T*)vector->data + vector->length++; \
+	} \
+	SUS_INLINE T SUSAPI Name##Pop(_Inout_ SUS_LPVECTOR lpVector) { \
+		SUS_ASSERT(lpVector && *lpVector && (*lpVector)->itemSize == sizeof(T) && (*lpVector)->length); \
+		SUS_VECTOR vector = *lpVector; \
+		T value = ((T*)vector->data)[--vector->length]; \
+		if (susVectorShouldCompress(vector)) susVectorCompress(lpVector); \
+		return value; \
+	} \
+	SUS_INLINE BOOL SUSAPI Name##SwapErase(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i) { \
+		SUS_ASSERT(lpVector && *lpVector && (*lpVector)->itemSize == sizeof(T) && i < (*lpVector)->length); \
+		SUS_VECTOR vector = *lpVector; \
+		((T*)vector->data)[i] = ((T*)vector->data)[--vector->length]; \
+		return susVectorShouldCompress(vector) ? susVectorCompress(lpVector) : TRUE; \
+	} \
+	SUS_INLINE sus_csize_t SUSAPI Name##IndexOf(_In_ SUS_VECTOR vector, _In_ T value) { \
+		SUS_ASSERT(vector && vector->itemSize == sizeof(T)); \
+		if (sus_memfindable(sizeof(T))) { \
+			SIZE_T i = sus_memfind(vector->data, vector->length, (sus_lpbyte_t)&value, sizeof(T)); \
+			return i != (SIZE_T)-1 ? (sus_csize_t)i : SUS_CSIZE_MAX; \
+		} \
+		T* data = (T*)vector->data; \
+		for (sus_csize_t i = 0; i < vector->length; i++) if (sus_memcmp((sus_lpbyte_t)(data + i), (sus_lpbyte_t)&value, sizeof(T))) return i; \
+		return SUS_CSIZE_MAX; \
+	} \
+	SUS_INLINE BOOL SUSAPI Name##Contains(_In_ SUS_VECTOR vector, _In_ T value) { \
+		return Name##IndexOf(vector, value) != SUS_CSIZE_MAX; \
+	}
+
+/*
+* Typed sort generator.
+* SUS_DECLARE_VECTOR_SORT(Name, T, LESS) generates the introsort and the binary search
+* over a vector of T with the comparison inlined, LESS(a, b) is an expression over two values of T:
+*	Name##Sort(vector)						- sort the array
+*	Name##LowerBound(vector, value)			- first element not less than the value
+*	Name##UpperBound(vector, value)			- first element greater than the value
+*	Name##BinarySearch(vector, value)		- find an element (SUS_CSIZE_MAX - not found)
+* Example:
+*	#define susIntLess(a, b) ((a) < (b))
+*	SUS_DECLARE_VECTOR_SORT(susIntVector, INT, susIntLess)
+*	susIntVectorSort(numbers);
+*/
+#define SUS_DECLARE_VECTOR_SORT(Name, T, LESS) \
+	SUS_INLINE VOID SUSAPI Name##SiftDown(_Inout_ T* data, _In_ sus_csize_t root, _In_ sus_csize_t count) { \
+		T value = data[root]; \
+		for (sus_csize_t child; (child = root * 2 + 1) < count; root = child) { \
+			if (child + 1 < count && LESS(data[child], data[child + 1])) child++; \
+			if (!LESS(value, data[child])) break; \
+			data[root] = data[child]; \
+		} \
+		data[root] = value; \
+	} \
+	SUS_INLINE VOID SUSAPI Name##SortRange(_Inout_ T* data, _In_ sus_csize_t count, _In_ sus_csize_t depth) { \
+		T tmp; \
+		while (count > SUS_VECTOR_INSERTION_SORT_THRESHOLD) { \
+			if (!depth--) { \
+				for (sus_csize_t i = count / 2; i--;) Name##SiftDown(data, i, count); \
+				for (sus_csize_t i = count; --i;) { tmp = data[0]; data[0] = data[i]; data[i] = tmp; Name##SiftDown(data, 0, i); } \
+				return; \
+			} \
+			sus_csize_t mid = count / 2, hi = count - 1; \
+			if (LESS(data[mid], data[0])) { tmp = data[mid]; data[mid] = data[0]; data[0] = tmp; } \
+			if (LESS(data[hi], data[mid])) { \
+				tmp = data[hi]; data[hi] = data[mid]; data[mid] = tmp; \
+				if (LESS(data[mid], data[0])) { tmp = data[mid]; data[mid] = data[0]; data[0] = tmp; } \
+			} \
+			tmp = data[mid]; data[mid] = data[0]; data[0] = tmp; \
+			T pivot = data[0]; \
+			sus_csize_t i = 1, j = hi; \
+			for (;;) { \
+				while (LESS(data[i], pivot)) i++; \
+				while (LESS(pivot, data[j])) j--; \
+				if (i >= j) break; \
+				tmp = data[i]; data[i++] = data[j]; data[j--] = tmp; \
+			} \
+			data[0] = data[j]; data[j] = pivot; \
+			if (j < count - j - 1) { Name##SortRange(data, j, depth); data += j + 1; count -= j + 1; } \
+			else { Name##SortRange(data + j + 1, count - j - 1, depth); count = j; } \
+		} \
+		for (sus_csize_t i = 1; i < count; i++) { \
+			sus_csize_t j = i; \
+			tmp = data[i]; \
+			for (; j && LESS(tmp, data[j - 1]); j--) data[j] = data[j - 1]; \
+			data[j] = tmp; \
+		} \
+	} \
+	SUS_INLINE VOID SUSAPI Name##Sort(_Inout_ SUS_VECTOR vector) { \
+		SUS_ASSERT(vector && vector->itemSize == sizeof(T)); \
+		Name##SortRange((T*)vector->data, vector->length, susVectorSortDepth(vector->length)); \
+	} \
+	SUS_INLINE sus_csize_t SUSAPI Name##LowerBound(_In_ SUS_VECTOR vector, _In_ T value) { \
+		SUS_ASSERT(vector && vector->itemSize == sizeof(T)); \
+		T* data = (T*)vector->data; \
+		sus_csize_t first = 0, count = vector->length; \
+		while (count) { \
+			sus_csize_t half = count / 2; \
+			if (LESS(data[first + half], value)) { first += half + 1; count -= half + 1; } \
+			else count = half; \
+		} \
+		return first; \
+	} \
+	SUS_INLINE sus_csize_t SUSAPI Name##UpperBound(_In_ SUS_VECTOR vector, _In_ T value) { \
+		SUS_ASSERT(vector && vector->itemSize == sizeof(T)); \
+		T* data = (T*)vector->data; \
+		sus_csize_t first = 0, count = vector->length; \
+		while (count) { \
+			sus_csize_t half = count / 2; \
+			if (!LESS(value, data[first + half])) { first += half + 1; count -= half + 1; } \
+			else count = half; \
+		} \
+		return first; \
+	} \
+	SUS_INLINE sus_csize_t SUSAPI Name##BinarySearch(_In_ SUS_VECTOR vector, _In_ T value) { \
+		sus_csize_t i = Name##LowerBound(vector, value); \
+		return i < vector->length && !LESS(value, ((T*)vector->data)[i]) ? i : SUS_CSIZE_MAX; \
+	}
 
 // -------------------------------------
 
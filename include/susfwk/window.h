@@ -931,7 +931,7 @@ SUS_RESULT SUSAPI FrameHandler(SUS_FRAME frame, SUS_WINMSG msg, SUS_PARAM param)
 	switch (msg)
 	{
 	case SUS_WINMSG_CREATE: {
-		susWindowSetData(frame, sus_malloc(sizeof(MAIN_WINDOW_STRUCT)));
+		susWindowSetData(frame, sus_zalloc(sizeof(MAIN_WINDOW_STRUCT)));
 		SUS_ASSERT(susWindowGetData(frame));
 		susWindowSetCloseOperation(frame, SUS_WINDOW_EXIT_ON_CLOSE);
 		SUS_WIDGET panel = susNewPanel(frame, PanelHandler);
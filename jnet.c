@@ -1,5 +1,6 @@
 // jnet.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_NET
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/json.h"
@@ -12,7 +13,7 @@
 SUS_JNET SUSAPI susNewJnet()
 {
 	SUS_PRINTDL("Initializing the JNET protocol on a socket");
-	SUS_JNET jnet = sus_malloc(sizeof(SUS_JNET_STRUCT));
+	SUS_JNET jnet = sus_zalloc(sizeof(SUS_JNET_STRUCT));
 	if (!jnet) return NULL;
 	return jnet;
 }
@@ -97,11 +98,11 @@ LRESULT SUSAPI susJnetSocketHandler(_In_ SUS_LPSOCKET sock, _In_ SUS_SOCKET_MESS
 BOOL SUSAPI susJnetSend(_Inout_ SUS_LPSOCKET sock, _In_ SUS_JSON json)
 {
 	SUS_ASSERT(sock);
-	LPSTR jsonText = susJsonStringify(json);
-	if (!jsonText) return FALSE;
-	susSocketWriteText(sock, jsonText);
-	sus_strfree(jsonText);
-	return TRUE;
+	SUS_CHAIN chain = susChainSetup();
+	// The message ends with a pair of null characters
+	BOOL result = susJsonStringifyChain(json, &chain) && susChainAppend(&chain, (sus_lpbyte_t)"\0\0", 2) && susSocketWriteChain(sock, &chain);
+	susChainCleanup(&chain);
+	return result;
 }
 
 // Create a JNET request
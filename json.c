@@ -1,11 +1,14 @@
 // json.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_JSON
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/memory.h"
 #include "include/susfwk/buffer.h"
+#include "include/susfwk/chain.h"
 #include "include/susfwk/vector.h"
 #include "include/susfwk/hashtable.h"
+#include "include/susfwk/atom.h"
 #include "include/susfwk/math.h"
 #include "include/susfwk/json.h"
 
@@ -13,6 +16,21 @@
 
 // -----------------------------------------------
 
+// Copy the key to the object memory
+static LPSTR SUSAPI susJsonKeyCopy(_In_ SUS_HASHMAP object, _In_ LPCSTR key) {
+	SUS_ASSERT(object && key);
+	if (susMapIsAtomKeys(object)) return (LPSTR)susAtom(key);
+	INT count = lstrlenA(key) + 1;
+	sus_lpbyte_t buff = susAllocatorAlloc(object->allocator, count * sizeof(CHAR));
+	return buff ? (LPSTR)sus_memcpy(buff, (sus_lpbyte_t)key, count * sizeof(CHAR)) : NULL;
+}
+// Free the object key
+static VOID SUSAPI susJsonKeyFree(_In_ SUS_HASHMAP object, _In_ LPSTR key) {
+	SUS_ASSERT(object && key);
+	if (susMapIsAtomKeys(object)) return;
+	susAllocatorFree(object->allocator, key, (lstrlenA(key) + 1) * sizeof(CHAR));
+}
+
 // Delete a json object
 VOID SUSAPI susJsonDestroy(_Inout_ SUS_LPJSON json) {
 	SUS_PRINTDL("Deleting a json object");
@@ -30,7 +48,7 @@ VOID SUSAPI susJsonDestroy(_Inout_ SUS_LPJSON json) {
 	} break;
 	case SUS_JSON_TYPE_OBJECT: {
 		susMapForeach(json->value.object, i) {
-			sus_strfree(*(LPSTR*)susMapIterKey(i));
+			susJsonKeyFree(json->value.object, *(LPSTR*)susMapIterKey(i));
 			susJsonDestroy((SUS_LPJSON)susMapIterValue(i));
 		}
 		susMapDestroy(json->value.object);
@@ -59,7 +77,7 @@ SUS_JSON SUSAPI susJsonCopy(_In_ SUS_JSON json)
 		}
 	} break;
 	case SUS_JSON_TYPE_OBJECT: {
-		jsonCopy = susJsonObject();
+		jsonCopy = susMapIsAtomKeys(json.value.object) ? susJsonAtomObject() : susJsonObject();
 		susMapForeach(json.value.object, i) {
 			susJsonObjectSet(&jsonCopy, *(LPSTR*)susMapIterKey(i), susJsonCopy(*(SUS_LPJSON)susMapIterValue(i)));
 		}
@@ -74,76 +92,85 @@ SUS_JSON SUSAPI susJsonCopy(_In_ SUS_JSON json)
 // -----------------------------------------------
 
 // Convert json string to string
-static VOID SUSAPI susJsonStringStringify(_In_ LPCSTR str, _Inout_ SUS_LPBUFFER pBuffer) {
-	SUS_ASSERT(pBuffer && *pBuffer);
-	susBufferPush(pBuffer, (sus_lpbyte_t)"\"", 1);
+static BOOL SUSAPI susJsonStringStringify(_In_ LPCSTR str, _Inout_ SUS_LPCHAIN chain) {
+	SUS_ASSERT(chain);
 	LPSTR buff = sus_malloc((sus_size_t)sus_escapeA(NULL, str) * sizeof(CHAR) + sizeof("\"\""));
-	if (!buff) return;
+	if (!buff) return FALSE;
 	sus_escapeA(buff, str);
-	susBufferPush(pBuffer, (sus_lpbyte_t)buff, lstrlenA(buff) * sizeof(CHAR));
-	susBufferPush(pBuffer, (sus_lpbyte_t)"\"", 1);
+	BOOL ok = susChainAppend(chain, (sus_lpbyte_t)"\"", 1) &&
+		susChainAppend(chain, (sus_lpbyte_t)buff, lstrlenA(buff) * sizeof(CHAR)) &&
+		susChainAppend(chain, (sus_lpbyte_t)"\"", 1);
 	sus_free(buff);
+	return ok;
 }
-// Convert Json to a string recursively
-static VOID SUSAPI susJsonStringifyRecursively(_In_ SUS_LPJSON json, _Inout_ SUS_LPBUFFER pBuffer)
+// Convert Json to a string recursively (\return FALSE at the first failed allocation)
+static BOOL SUSAPI susJsonStringifyRecursively(_In_ SUS_LPJSON json, _Inout_ SUS_LPCHAIN chain)
 {
-	SUS_ASSERT(pBuffer && *pBuffer);
+	SUS_ASSERT(chain);
 	switch (json->type)
 	{
 	case SUS_JSON_TYPE_STRING_VIEW:
-	case SUS_JSON_TYPE_STRING: {
-		susJsonStringStringify(json->value.str, pBuffer);
-	} break;
+	case SUS_JSON_TYPE_STRING: return susJsonStringStringify(json->value.str, chain);
 	case SUS_JSON_TYPE_NUMBER: {
 		CHAR buff[32];
 		sus_ftoa(buff, json->value.number, 6);
-		susBufferPush(pBuffer, (sus_lpbyte_t)buff, lstrlenA(buff) * sizeof(CHAR));
-	} break;
+		return susChainAppend(chain, (sus_lpbyte_t)buff, lstrlenA(buff) * sizeof(CHAR));
+	}
 	case SUS_JSON_TYPE_BOOLEAN: {
-		if (json->value.boolean) susBufferPush(pBuffer, (sus_lpbyte_t)"true", 4);
-		else susBufferPush(pBuffer, (sus_lpbyte_t)"false", 5);
-	} break;
+		if (json->value.boolean) return susChainAppend(chain, (sus_lpbyte_t)"true", 4);
+		return susChainAppend(chain, (sus_lpbyte_t)"false", 5);
+	}
 	case SUS_JSON_TYPE_ARRAY: {
-		susBufferPush(pBuffer, (sus_lpbyte_t)"[", sizeof(CHAR));
+		if (!susChainAppend(chain, (sus_lpbyte_t)"[", sizeof(CHAR))) return FALSE;
 		susVecForeach(i, json->value.array) {
 			SUS_LPJSON obj = (SUS_LPJSON)susVectorAt(json->value.array, i);
 			if (!obj) continue;
-			susJsonStringifyRecursively(obj, pBuffer);
-			if (i < json->value.array->length - 1) susBufferPush(pBuffer, (sus_lpbyte_t)", ", 2);
+			if (!susJsonStringifyRecursively(obj, chain)) return FALSE;
+			if (i < json->value.array->length - 1 && !susChainAppend(chain, (sus_lpbyte_t)", ", 2)) return FALSE;
 		}
-		susBufferPush(pBuffer, (sus_lpbyte_t)"]", sizeof(CHAR));
-	} break;
+		return susChainAppend(chain, (sus_lpbyte_t)"]", sizeof(CHAR));
+	}
 	case SUS_JSON_TYPE_OBJECT: {
-		susBufferPush(pBuffer, (sus_lpbyte_t)"{", sizeof(CHAR));
+		if (!susChainAppend(chain, (sus_lpbyte_t)"{", sizeof(CHAR))) return FALSE;
 		susMapForeach(json->value.object, i) {
-			susJsonStringStringify(*(LPSTR*)susMapIterKey(i), pBuffer);
-			susBufferPush(pBuffer, (sus_lpbyte_t)": ", 2);
+			if (!susJsonStringStringify(*(LPSTR*)susMapIterKey(i), chain)) return FALSE;
+			if (!susChainAppend(chain, (sus_lpbyte_t)": ", 2)) return FALSE;
 			SUS_LPJSON obj = susMapIterValue(i);
-			susJsonStringifyRecursively(obj, pBuffer);
-			if (i.count < json->value.object->count - 1) susBufferPush(pBuffer, (sus_lpbyte_t)", ", 2);
+			if (!susJsonStringifyRecursively(obj, chain)) return FALSE;
+			if (i.count < json->value.object->count - 1 && !susChainAppend(chain, (sus_lpbyte_t)", ", 2)) return FALSE;
 		}
-		susBufferPush(pBuffer, (sus_lpbyte_t)"}", sizeof(CHAR));
-	} break;
-	default: {
-		susBufferPush(pBuffer, (sus_lpbyte_t)"null", sizeof("null") - sizeof(CHAR));
-	} break;
+		return susChainAppend(chain, (sus_lpbyte_t)"}", sizeof(CHAR));
+	}
+	default: return susChainAppend(chain, (sus_lpbyte_t)"null", sizeof("null") - sizeof(CHAR));
 	}
 }
+// Convert json to a string at the end of the chain
+BOOL SUSAPI susJsonStringifyChain(_In_ SUS_JSON json, _Inout_ SUS_LPCHAIN chain)
+{
+	SUS_PRINTDL("Converting a json object to a string");
+	SUS_ASSERT(chain);
+	if (!susJsonStringifyRecursively(&json, chain)) {
+		SUS_PRINTDE("Couldn't convert the json object to a string");
+		return FALSE;
+	}
+	return TRUE;
+}
 // Convert json to string
 LPSTR SUSAPI susJsonStringify(_In_ SUS_JSON json)
 {
-	SUS_PRINTDL("Converting a json object to a string");
-	SUS_BUFFER buffer = susNewBuffer(256);
-	if (!buffer) return NULL;
-	susJsonStringifyRecursively(&json, &buffer);
-	susBufferPush(&buffer, (sus_lpbyte_t)"\0", sizeof(CHAR));
-	LPSTR stringify = sus_strdup((LPSTR)buffer->data);
-	susBufferDestroy(buffer);
+	SUS_CHAIN chain = susChainSetup();
+	if (!susJsonStringifyChain(json, &chain)) {
+		susChainCleanup(&chain);
+		return NULL;
+	}
+	LPSTR stringify = sus_malloc(chain.size + sizeof(CHAR));
+	if (stringify) stringify[susChainRead(&chain, (sus_lpbyte_t)stringify, chain.size)] = '\0';
+	susChainCleanup(&chain);
 	return stringify;
 }
 
 // Convert json string to string
-static LPSTR SUSAPI susJsonStringParse(_Inout_ LPSTR* text) {
+static LPSTR SUSAPI susJsonStringParse(_Inout_ LPSTR* text, _Inout_opt_ SUS_LPALLOCATOR allocator) {
 	SUS_ASSERT(text && *text && **text == '"');
 	LPSTR end = sus_strchr(++(*text), '"');
 	while (end && *(end - 1) == '\\' && *(end - 2) != '\\') end = sus_strchr(end + 1, '"');
@@ -151,20 +178,28 @@ static LPSTR SUSAPI susJsonStringParse(_Inout_ LPSTR* text) {
 		susErrorPush(SUS_ERROR_SYNTAX_ERROR, SUS_ERROR_TYPE_PARSER);
 		return NULL;
 	}
-	*end = '\0';
-	LPSTR buff = sus_malloc((sus_size_t)sus_unescapeA(NULL, *text) + 1);
+	DWORD count = (DWORD)(end - *text);
+	LPSTR buff = susAllocatorAlloc(allocator, (sus_size_t)sus_unescapeExA(NULL, *text, count) + 1);
 	if (!buff) {
-		*end = '"';
 		susErrorPush(SUS_ERROR_SYNTAX_ERROR, SUS_ERROR_TYPE_PARSER);
 		return NULL;
 	}
-	sus_unescapeA(buff, *text);
-	*end = '"';
+	sus_unescapeExA(buff, *text, count);
 	*text = end + 1;
 	return buff;
 }
+// Parse the object key
+static LPSTR SUSAPI susJsonKeyParse(_Inout_ LPSTR* text, _In_ SUS_HASHMAP object) {
+	SUS_ASSERT(object);
+	LPSTR key = susJsonStringParse(text, object->allocator);
+	if (!key || !susMapIsAtomKeys(object)) return key;
+	INT length = lstrlenA(key);
+	SUS_ATOM atom = susAtomEx(key, length);
+	susAllocatorFree(object->allocator, key, (length + 1) * sizeof(CHAR));
+	return (LPSTR)atom;
+}
 // Convert string to json
-static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text)
+static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text, _Inout_opt_ SUS_LPALLOCATOR allocator, _In_ SUS_JSON_PARSE_FLAGS flags)
 {
 	SUS_ASSERT(text);
 	sus_trimlA(text);
@@ -173,9 +208,8 @@ static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text)
 	switch (*(*text))
 	{
 	case '"': {
-		LPSTR str = susJsonStringParse(text);
-		json = susJsonString(str);
-		sus_strfree(str);
+		LPSTR str = susJsonStringParse(text, allocator);
+		if (str) json = (SUS_JSON) { .type = allocator ? SUS_JSON_TYPE_STRING_VIEW : SUS_JSON_TYPE_STRING, .value.str = str };
 	} break;
 	case 't':
 	case 'f': {
@@ -193,7 +227,7 @@ static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text)
 		}
 	}  break;
 	case '{': {
-		json = susJsonObject();
+		json = flags & SUS_JSON_PARSE_FLAG_ATOM_KEYS ? susJsonAtomObjectEx(allocator) : susJsonObjectEx(allocator);
 		(*text)++;
 		while (**text && **text != '}') {
 			sus_trimlA(text);
@@ -204,10 +238,10 @@ static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text)
 				json = susJsonNull();
 				break;
 			}
-			LPSTR key = susJsonStringParse(text);
-			if (susErrorPeek().code == SUS_ERROR_SYNTAX_ERROR) {
+			LPSTR key = susJsonKeyParse(text, json.value.object);
+			if (!key || susErrorPeek().code == SUS_ERROR_SYNTAX_ERROR) {
+				if (key) susJsonKeyFree(json.value.object, key);
 				susJsonDestroy(&json);
-				sus_strfree(key);
 				json = susJsonNull();
 				break;
 			}
@@ -215,14 +249,23 @@ static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text)
 			if (**text != ':') {
 				SUS_PRINTDE("Does not match the json format");
 				susErrorPush(SUS_ERROR_SYNTAX_ERROR, SUS_ERROR_TYPE_PARSER);
+				susJsonKeyFree(json.value.object, key);
 				susJsonDestroy(&json);
-				sus_strfree(key);
 				json = susJsonNull();
 				break;
 			}
 			(*text)++;
-			susJsonObjectSet(&json, key, susParseJsonValue(text));
-			sus_strfree(key);
+			SUS_JSON value = susParseJsonValue(text, allocator, flags);
+			SUS_LPJSON slot = susMapGet(json.value.object, &key);
+			if (slot) {
+				susJsonKeyFree(json.value.object, key);
+				susJsonDestroy(slot);
+				*slot = value;
+			}
+			else if (!susMapAdd(&json.value.object, &key, &value)) {
+				susJsonKeyFree(json.value.object, key);
+				susJsonDestroy(&value);
+			}
 			sus_trimlA(text);
 			if (**text == ',') {
 				(*text)++;
@@ -231,10 +274,11 @@ static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text)
 		(*text)++;
 	} break;
 	case '[': {
-		json = susJsonArray();
+		json = susJsonArrayEx(allocator);
 		(*text)++;
 		while (**text && **text != ']') {
-			susJsonArrayPush(&json, susParseJsonValue(text));
+			SUS_JSON value = susParseJsonValue(text, allocator, flags);
+			if (!susVectorPush(&json.value.array, &value)) susJsonDestroy(&value);
 			if (susErrorPeek().code == SUS_ERROR_SYNTAX_ERROR) {
 				susJsonDestroy(&json);
 				json = susJsonNull();
@@ -258,6 +302,7 @@ static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text)
 	default: {
 		if (sus_isdigitA(**text) || **text == '-') {
 			json = susJsonNumber(sus_atof(*text, text));
+			break;
 		}
 		susErrorPush(SUS_ERROR_SYNTAX_ERROR, SUS_ERROR_TYPE_PARSER);
 		(*text)++;
@@ -265,17 +310,32 @@ static SUS_JSON SUSAPI susParseJsonValue(_In_ LPSTR* text)
 	}
 	return json;
 }
-#pragma warning(suppress: 6101)
-// Convert string to json
-SUS_JSON SUSAPI susJsonParse(_In_ LPCSTR text)
+// Convert string to json in the allocator memory
+SUS_JSON SUSAPI susJsonParseEx(_In_ LPCSTR text, _Inout_opt_ SUS_LPALLOCATOR allocator, _In_ SUS_JSON_PARSE_FLAGS flags)
 {
 	SUS_PRINTDL("parsing a string in json format");
 	SUS_ASSERT(text);
-	LPSTR str = sus_strdup(text);
-	if (!str) return susJsonNull();
-	LPSTR ctx = str;
-	SUS_JSON json = susParseJsonValue(&ctx);
-	sus_strfree(str);
+	LPSTR ctx = (LPSTR)text;
+	return susParseJsonValue(&ctx, allocator, flags);
+}
+// Convert string to json
+SUS_JSON SUSAPI susJsonParse(_In_ LPCSTR text) {
+	return susJsonParseEx(text, NULL, SUS_JSON_PARSE_FLAG_NONE);
+}
+// Convert string to json in the arena
+SUS_JSON SUSAPI susJsonParseArena(_In_ LPCSTR text, _Inout_ SUS_LPARENA arena) {
+	SUS_ASSERT(arena);
+	return susJsonParseEx(text, &arena->super, SUS_JSON_PARSE_FLAG_NONE);
+}
+// Convert bytes to json
+SUS_JSON SUSAPI susJsonParseBytes(_In_ SUS_BYTES bytes, _In_ SUS_JSON_PARSE_FLAGS flags)
+{
+	if (!bytes.data || !bytes.size) return susJsonNull();
+	if (susBytesIsTerminated(bytes)) return susJsonParseEx((LPCSTR)bytes.data, NULL, flags);
+	SUS_BYTES text = susBytesCopy(susBytesView(bytes));
+	if (!text.data) return susJsonNull();
+	SUS_JSON json = susJsonParseEx((LPCSTR)text.data, NULL, flags);
+	susBytesRelease(&text);
 	return json;
 }
 
@@ -332,23 +392,37 @@ SUS_LPJSON SUSAPI susJsonObjectSet(_Inout_ SUS_LPJSON obj, _In_ LPCSTR key, _In_
 	SUS_LPJSON json = susJsonObjectGet(*obj, key);
 	if (json) susJsonDestroy(json);
 	else {
-		key = sus_strdup(key);
+		key = susJsonKeyCopy(obj->value.object, key);
+		if (!key) return NULL;
 		json = susMapAdd(&obj->value.object, &key, NULL);
-		if (!json) { sus_strfree((LPSTR)key); return NULL; }
+		if (!json) { susJsonKeyFree(obj->value.object, (LPSTR)key); return NULL; }
 	}
 	*json = susJsonCopy(value);
 	return json;
 }
+// Set a value for an object by the atom key
+SUS_LPJSON SUSAPI susJsonObjectSetAtom(_Inout_ SUS_LPJSON obj, _In_ SUS_ATOM key, _In_ SUS_JSON value)
+{
+	SUS_ASSERT(obj && key);
+	if (obj->type != SUS_JSON_TYPE_OBJECT || !obj->value.object) { susJsonDestroy(obj); *obj = susJsonAtomObject(); }
+	SUS_ASSERT(susMapIsAtomKeys(obj->value.object));
+	SUS_LPJSON json = susMapGet(obj->value.object, &key);
+	if (json) susJsonDestroy(json);
+	else if (!(json = susMapAdd(&obj->value.object, &key, NULL))) return NULL;
+	*json = susJsonCopy(value);
+	return json;
+}
 // Delete an object value
 VOID SUSAPI susJsonObjectRemove(_Inout_ SUS_LPJSON obj, _In_ LPCSTR key)
 {
 	SUS_ASSERT(obj && obj->type == SUS_JSON_TYPE_OBJECT && obj->value.object && key && susJsonObjectGet(*obj, key));
+	if (susMapIsAtomKeys(obj->value.object)) key = susAtomFind(key);
 	SUS_OBJECT entry = susMapGetEntry(obj->value.object, &key);
 	SUS_LPJSON value = susMapValue(obj->value.object, entry);
 	susJsonDestroy(value);
 	LPSTR keyCopy = *(LPSTR*)susMapKey(obj->value.object, entry);
 	susMapRemove(&obj->value.object, &keyCopy);
-	sus_strfree(keyCopy);
+	susJsonKeyFree(obj->value.object, keyCopy);
 }
 
 // -----------------------------------------------
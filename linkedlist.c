@@ -1,5 +1,6 @@
 // linkedlist.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_LIST
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/memory.h"
@@ -9,11 +10,10 @@
 
 // -------------------------------------------------------------------
 
-// Insert a node between the nodes
-SUS_LIST_NODE SUSAPI susListNodeInsert(_Inout_opt_ SUS_LIST_NODE parent, _Inout_opt_ SUS_LIST_NODE next, _In_opt_ SUS_LPMEMORY value, _In_ SIZE_T size)
+// Link the node between the nodes
+static SUS_LIST_NODE SUSAPI susListNodeLink(_Inout_ SUS_LIST_NODE node, _Inout_opt_ SUS_LIST_NODE parent, _Inout_opt_ SUS_LIST_NODE next, _In_opt_ SUS_LPMEMORY value, _In_ SIZE_T size)
 {
-	SUS_LIST_NODE node = sus_calloc(1, sizeof(SUS_LIST_NODE_STRUCT) + size);
-	if (!node) return NULL;
+	SUS_ASSERT(node);
 	if (parent) parent->next = node;
 	node->prev = parent;
 	if (next) next->prev = node;
@@ -21,13 +21,26 @@ SUS_LIST_NODE SUSAPI susListNodeInsert(_Inout_opt_ SUS_LIST_NODE parent, _Inout_
 	if (value) sus_memcpy(node->value, value, size);
 	return node;
 }
-// Delete a node
-SUS_LIST_NODE SUSAPI susListNodeErase(_Inout_ SUS_LIST_NODE node)
+// Unlink the node from the neighboring nodes
+static SUS_LIST_NODE SUSAPI susListNodeUnlink(_Inout_ SUS_LIST_NODE node)
 {
 	SUS_ASSERT(node);
 	if (node->prev) node->prev->next = node->next;
 	if (node->next) node->next->prev = node->prev;
-	SUS_LIST_NODE parent = node->prev ? node->prev : node->next;
+	return node->prev ? node->prev : node->next;
+}
+// Insert a node between the nodes
+SUS_LIST_NODE SUSAPI susListNodeInsert(_Inout_opt_ SUS_LIST_NODE parent, _Inout_opt_ SUS_LIST_NODE next, _In_opt_ SUS_LPMEMORY value, _In_ SIZE_T size)
+{
+	SUS_LIST_NODE node = sus_calloc(1, sizeof(SUS_LIST_NODE_STRUCT) + size);
+	if (!node) return NULL;
+	return susListNodeLink(node, parent, next, value, size);
+}
+// Delete a node
+SUS_LIST_NODE SUSAPI susListNodeErase(_Inout_ SUS_LIST_NODE node)
+{
+	SUS_ASSERT(node);
+	SUS_LIST_NODE parent = susListNodeUnlink(node);
 	sus_free(node);
 	return parent;
 }
@@ -46,11 +59,25 @@ SUS_LIST SUSAPI susListSetupEx(_In_ sus_size32_t typeSize)
 	list.valueSize = typeSize;
 	return list;
 }
+// Create a list structure with a node pool
+SUS_LIST SUSAPI susListSetupPoolEx(_In_ sus_size32_t typeSize)
+{
+	SUS_LIST list = susListSetupEx(typeSize);
+	list.pool = susNewPool(sizeof(SUS_LIST_NODE_STRUCT) + typeSize, SUS_POOL_FLAG_NONE);
+	return list;
+}
 // Clear the list
 VOID SUSAPI susListCleanup(_Inout_ SUS_LPLIST list)
 {
 	SUS_PRINTDL("Clearing the list");
 	SUS_ASSERT(list);
+	if (list->pool) {
+		susPoolDestroy(list->pool);
+		list->pool = NULL;
+		list->head = list->tail = NULL;
+		list->count = 0;
+		return;
+	}
 	while (list->head) {
 		susListErase(list, list->head);
 	}
@@ -62,7 +89,13 @@ VOID SUSAPI susListCleanup(_Inout_ SUS_LPLIST list)
 SUS_LIST_NODE SUSAPI susListInsert(_Inout_ SUS_LPLIST list, _In_opt_ SUS_LIST_NODE before, _In_opt_ SUS_LPMEMORY value)
 {
 	SUS_ASSERT(list);
-	SUS_LIST_NODE node = susListNodeInsert(before ? before->prev : list->tail, before, value, list->valueSize);
+	SUS_LIST_NODE parent = before ? before->prev : list->tail;
+	SUS_LIST_NODE node = NULL;
+	if (list->pool) {
+		node = susPoolAlloc(list->pool);
+		if (node) susListNodeLink(node, parent, before, value, list->valueSize);
+	}
+	else node = susListNodeInsert(parent, before, value, list->valueSize);
 	if (!node) return NULL;
 	if (!node->prev) list->head = node;
 	if (!node->next) list->tail = node;
@@ -73,11 +106,17 @@ SUS_LIST_NODE SUSAPI susListInsert(_Inout_ SUS_LPLIST list, _In_opt_ SUS_LIST_NO
 VOID SUSAPI susListErase(_Inout_ SUS_LPLIST list, _In_ SUS_LIST_NODE node)
 {
 	SUS_ASSERT(list && node);
-	node = susListNodeErase(node);
+	if (list->pool) {
+		SUS_LIST_NODE parent = susListNodeUnlink(node);
+		susPoolFree(list->pool, node);
+		node = parent;
+	}
+	else node = susListNodeErase(node);
 	if (node) {
 		if (!node->prev) list->head = node;
 		if (!node->next) list->tail = node;
 	}
+	else list->head = list->tail = NULL;
 	list->count--;
 }
 // Move the node by the specified number
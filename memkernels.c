@@ -0,0 +1,610 @@
+// memkernels.c
+//
+#include "include/susfwk/memkernels.h"
+
+// The file is compiled without the framework headers
+#ifndef SUS_FORCEINLINE
+#ifdef _MSC_VER
+#define SUS_FORCEINLINE __forceinline
+#else
+#define SUS_FORCEINLINE inline __attribute__((always_inline))
+#endif // !_MSC_VER
+#endif // !SUS_FORCEINLINE
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SUS_MEMORY_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif // !_MSC_VER
+#endif // !SUS_MEMORY_X86
+
+// Compile the function for the instruction set
+#if defined(__GNUC__) || defined(__clang__)
+#define SUS_MEMORY_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SUS_MEMORY_TARGET(isa)
+#endif // !__GNUC__
+
+// -------------------------------------
+
+// Copy the memory forward word by word
+static char* SUSAPI susMemcpyPortable(char* buff, char* source, size_t size)
+{
+	unsigned long long tail = *(sus_unaligned64_t*)(source + size - 8);
+	for (size_t i = 0; i < size - 8; i += 8) *(sus_unaligned64_t*)(buff + i) = *(sus_unaligned64_t*)(source + i);
+	*(sus_unaligned64_t*)(buff + size - 8) = tail;
+	return buff;
+}
+// Copy the overlapping memory word by word
+static char* SUSAPI susMemmovePortable(char* buff, char* source, size_t size)
+{
+	if ((size_t)buff - (size_t)source >= size) return susMemcpyPortable(buff, source, size);
+	unsigned long long head = *(sus_unaligned64_t*)source;
+	for (size_t i = size; i > 8; i -= 8) *(sus_unaligned64_t*)(buff + i - 8) = *(sus_unaligned64_t*)(source + i - 8);
+	*(sus_unaligned64_t*)buff = head;
+	return buff;
+}
+// Initialize the memory word by word
+static void SUSAPI susMemsetPortable(char* data, unsigned char value, size_t size)
+{
+	unsigned long long v = (unsigned long long)value * 0x0101010101010101ull;
+	for (size_t i = 0; i < size - 8; i += 8) *(sus_unaligned64_t*)(data + i) = v;
+	*(sus_unaligned64_t*)(data + size - 8) = v;
+}
+// Compare the memory word by word
+static int SUSAPI susMemcmpPortable(char* lpBuf1, char* lpBuf2, size_t size)
+{
+	for (size_t i = 0; i < size - 8; i += 8) {
+		if (*(sus_unaligned64_t*)(lpBuf1 + i) != *(sus_unaligned64_t*)(lpBuf2 + i)) return 0;
+	}
+	return *(sus_unaligned64_t*)(lpBuf1 + size - 8) == *(sus_unaligned64_t*)(lpBuf2 + size - 8);
+}
+// Check the memory for zeros word by word
+static int SUSAPI susMemiszeroPortable(char* lpBuff, size_t size)
+{
+	for (size_t i = 0; i < size - 8; i += 8) {
+		if (*(sus_unaligned64_t*)(lpBuff + i)) return 0;
+	}
+	return !*(sus_unaligned64_t*)(lpBuff + size - 8);
+}
+// Compare an element of 1, 2, 4, 8 or 16 bytes with the key
+static SUS_FORCEINLINE int SUSAPI susMemfindEqual(char* item, char* key, size_t size)
+{
+	switch (size) {
+	case 1: return *item == *key;
+	case 2: return *(sus_unaligned16_t*)item == *(sus_unaligned16_t*)key;
+	case 4: return *(sus_unaligned32_t*)item == *(sus_unaligned32_t*)key;
+	case 8: return *(sus_unaligned64_t*)item == *(sus_unaligned64_t*)key;
+	default: return *(sus_unaligned64_t*)item == *(sus_unaligned64_t*)key && *(sus_unaligned64_t*)(item + 8) == *(sus_unaligned64_t*)(key + 8);
+	}
+}
+// Find the element starting from the index element by element
+static SUS_FORCEINLINE size_t SUSAPI susMemfindPortableEx(char* data, size_t i, size_t count, char* key, size_t size)
+{
+	for (; i < count; i++) {
+		if (susMemfindEqual(data + i * size, key, size)) return i;
+	}
+	return (size_t)-1;
+}
+// Find the element element by element
+static size_t SUSAPI susMemfindPortable(char* data, size_t count, char* key, size_t size)
+{
+	// The constant sizes let the compiler specialize the loop
+	switch (size) {
+	case 1: return susMemfindPortableEx(data, 0, count, key, 1);
+	case 2: return susMemfindPortableEx(data, 0, count, key, 2);
+	case 4: return susMemfindPortableEx(data, 0, count, key, 4);
+	case 8: return susMemfindPortableEx(data, 0, count, key, 8);
+	default: return susMemfindPortableEx(data, 0, count, key, 16);
+	}
+}
+
+#ifdef SUS_MEMORY_X86
+
+// -------------------------------------
+
+// Copy the memory in 16-byte vectors (the ends are loaded first, so overlapping forward copies are safe)
+static SUS_FORCEINLINE char* SUSAPI susMemcpySse2Ex(char* buff, char* source, size_t size, int stream)
+{
+	__m128i head = _mm_loadu_si128((const __m128i*)source);
+	__m128i tail = _mm_loadu_si128((const __m128i*)(source + size - 16));
+	if (size <= 32) {
+		_mm_storeu_si128((__m128i*)buff, head);
+		_mm_storeu_si128((__m128i*)(buff + size - 16), tail);
+		return buff;
+	}
+	if (size <= 64) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(source + 16));
+		__m128i b = _mm_loadu_si128((const __m128i*)(source + size - 32));
+		_mm_storeu_si128((__m128i*)buff, head);
+		_mm_storeu_si128((__m128i*)(buff + 16), a);
+		_mm_storeu_si128((__m128i*)(buff + size - 32), b);
+		_mm_storeu_si128((__m128i*)(buff + size - 16), tail);
+		return buff;
+	}
+	size_t i = 16 - ((size_t)buff & 15);
+	if (stream) {
+		for (; i + 64 <= size - 16; i += 64) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(source + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(source + i + 16));
+			__m128i c = _mm_loadu_si128((const __m128i*)(source + i + 32));
+			__m128i d = _mm_loadu_si128((const __m128i*)(source + i + 48));
+			_mm_stream_si128((__m128i*)(buff + i), a);
+			_mm_stream_si128((__m128i*)(buff + i + 16), b);
+			_mm_stream_si128((__m128i*)(buff + i + 32), c);
+			_mm_stream_si128((__m128i*)(buff + i + 48), d);
+		}
+		_mm_sfence();
+	}
+	for (; i + 64 <= size - 16; i += 64) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(source + i + 16));
+		__m128i c = _mm_loadu_si128((const __m128i*)(source + i + 32));
+		__m128i d = _mm_loadu_si128((const __m128i*)(source + i + 48));
+		_mm_store_si128((__m128i*)(buff + i), a);
+		_mm_store_si128((__m128i*)(buff + i + 16), b);
+		_mm_store_si128((__m128i*)(buff + i + 32), c);
+		_mm_store_si128((__m128i*)(buff + i + 48), d);
+	}
+	for (; i < size - 16; i += 16) _mm_store_si128((__m128i*)(buff + i), _mm_loadu_si128((const __m128i*)(source + i)));
+	_mm_storeu_si128((__m128i*)buff, head);
+	_mm_storeu_si128((__m128i*)(buff + size - 16), tail);
+	return buff;
+}
+// Copy the memory in 16-byte vectors
+static char* SUSAPI susMemcpySse2(char* buff, char* source, size_t size) {
+	return susMemcpySse2Ex(buff, source, size, size >= SUS_MEMORY_STREAM_SIZE);
+}
+// Copy the overlapping memory in 16-byte vectors
+static char* SUSAPI susMemmoveSse2(char* buff, char* source, size_t size)
+{
+	if ((size_t)buff - (size_t)source >= size || size <= 64) return susMemcpySse2Ex(buff, source, size, 0);
+	__m128i head = _mm_loadu_si128((const __m128i*)source);
+	__m128i tail = _mm_loadu_si128((const __m128i*)(source + size - 16));
+	size_t i = size - (((size_t)(buff + size) & 15) ? ((size_t)(buff + size) & 15) : 16);
+	for (; i >= 64 + 16; ) {
+		i -= 64;
+		__m128i a = _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(source + i + 16));
+		__m128i c = _mm_loadu_si128((const __m128i*)(source + i + 32));
+		__m128i d = _mm_loadu_si128((const __m128i*)(source + i + 48));
+		_mm_store_si128((__m128i*)(buff + i + 48), d);
+		_mm_store_si128((__m128i*)(buff + i + 32), c);
+		_mm_store_si128((__m128i*)(buff + i + 16), b);
+		_mm_store_si128((__m128i*)(buff + i), a);
+	}
+	while (i > 16) {
+		i -= 16;
+		_mm_store_si128((__m128i*)(buff + i), _mm_loadu_si128((const __m128i*)(source + i)));
+	}
+	_mm_storeu_si128((__m128i*)(buff + size - 16), tail);
+	_mm_storeu_si128((__m128i*)buff, head);
+	return buff;
+}
+// Initialize the memory in 16-byte vectors
+static void SUSAPI susMemsetSse2(char* data, unsigned char value, size_t size)
+{
+	__m128i v = _mm_set1_epi8((char)value);
+	_mm_storeu_si128((__m128i*)data, v);
+	_mm_storeu_si128((__m128i*)(data + size - 16), v);
+	if (size <= 32) return;
+	size_t i = 16 - ((size_t)data & 15);
+	if (size >= SUS_MEMORY_STREAM_SIZE) {
+		for (; i + 64 <= size - 16; i += 64) {
+			_mm_stream_si128((__m128i*)(data + i), v);
+			_mm_stream_si128((__m128i*)(data + i + 16), v);
+			_mm_stream_si128((__m128i*)(data + i + 32), v);
+			_mm_stream_si128((__m128i*)(data + i + 48), v);
+		}
+		_mm_sfence();
+	}
+	for (; i + 64 <= size - 16; i += 64) {
+		_mm_store_si128((__m128i*)(data + i), v);
+		_mm_store_si128((__m128i*)(data + i + 16), v);
+		_mm_store_si128((__m128i*)(data + i + 32), v);
+		_mm_store_si128((__m128i*)(data + i + 48), v);
+	}
+	for (; i < size - 16; i += 16) _mm_store_si128((__m128i*)(data + i), v);
+}
+// Compare the memory in 16-byte vectors
+static int SUSAPI susMemcmpSse2(char* lpBuf1, char* lpBuf2, size_t size)
+{
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		__m128i a = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(lpBuf1 + i)), _mm_loadu_si128((const __m128i*)(lpBuf2 + i)));
+		__m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(lpBuf1 + i + 16)), _mm_loadu_si128((const __m128i*)(lpBuf2 + i + 16)));
+		__m128i c = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(lpBuf1 + i + 32)), _mm_loadu_si128((const __m128i*)(lpBuf2 + i + 32)));
+		__m128i d = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(lpBuf1 + i + 48)), _mm_loadu_si128((const __m128i*)(lpBuf2 + i + 48)));
+		__m128i x = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128())) != 0xFFFF) return 0;
+	}
+	for (; i + 16 < size; i += 16) {
+		__m128i x = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(lpBuf1 + i)), _mm_loadu_si128((const __m128i*)(lpBuf2 + i)));
+		if (_mm_movemask_epi8(x) != 0xFFFF) return 0;
+	}
+	__m128i x = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(lpBuf1 + size - 16)), _mm_loadu_si128((const __m128i*)(lpBuf2 + size - 16)));
+	return _mm_movemask_epi8(x) == 0xFFFF;
+}
+// Check the memory for zeros in 16-byte vectors
+static int SUSAPI susMemiszeroSse2(char* lpBuff, size_t size)
+{
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		__m128i x = _mm_or_si128(
+			_mm_or_si128(_mm_loadu_si128((const __m128i*)(lpBuff + i)), _mm_loadu_si128((const __m128i*)(lpBuff + i + 16))),
+			_mm_or_si128(_mm_loadu_si128((const __m128i*)(lpBuff + i + 32)), _mm_loadu_si128((const __m128i*)(lpBuff + i + 48))));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128())) != 0xFFFF) return 0;
+	}
+	for (; i + 16 < size; i += 16) {
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(lpBuff + i)), _mm_setzero_si128())) != 0xFFFF) return 0;
+	}
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(lpBuff + size - 16)), _mm_setzero_si128())) == 0xFFFF;
+}
+// Compare 16 bytes of the elements with the key (all the bytes of the equal elements are set)
+static SUS_FORCEINLINE __m128i SUSAPI susMemfindMatchSse2(__m128i x, __m128i key, size_t size)
+{
+	switch (size) {
+	case 1: return _mm_cmpeq_epi8(x, key);
+	case 2: return _mm_cmpeq_epi16(x, key);
+	case 4: return _mm_cmpeq_epi32(x, key);
+	case 8: {
+		__m128i eq = _mm_cmpeq_epi32(x, key);
+		return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+	default: {
+		__m128i eq = _mm_cmpeq_epi32(x, key);
+		eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+	}
+}
+// Fill a vector with the key
+static SUS_FORCEINLINE __m128i SUSAPI susMemfindKeySse2(char* key, size_t size)
+{
+	switch (size) {
+	case 1: return _mm_set1_epi8((char)*key);
+	case 2: return _mm_set1_epi16((short)*(sus_unaligned16_t*)key);
+	case 4: return _mm_set1_epi32((int)*(sus_unaligned32_t*)key);
+	case 8: {
+		__m128i k = _mm_loadl_epi64((const __m128i*)key);
+		return _mm_unpacklo_epi64(k, k);
+	}
+	default: return _mm_loadu_si128((const __m128i*)key);
+	}
+}
+// Get the index of the first set bit of the mask
+static SUS_FORCEINLINE size_t SUSAPI susMemfindFirst(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long k;
+	_BitScanForward(&k, mask);
+	return k;
+#else
+	return (size_t)__builtin_ctz(mask);
+#endif // !_MSC_VER
+}
+// Find the element in 16-byte vectors
+static SUS_FORCEINLINE size_t SUSAPI susMemfindSse2Ex(char* data, size_t count, char* key, size_t size)
+{
+	__m128i k = susMemfindKeySse2(key, size);
+	size_t bytes = count * size, i = 0;
+	for (; i + 64 <= bytes; i += 64) {
+		__m128i a = susMemfindMatchSse2(_mm_loadu_si128((const __m128i*)(data + i)), k, size);
+		__m128i b = susMemfindMatchSse2(_mm_loadu_si128((const __m128i*)(data + i + 16)), k, size);
+		__m128i c = susMemfindMatchSse2(_mm_loadu_si128((const __m128i*)(data + i + 32)), k, size);
+		__m128i d = susMemfindMatchSse2(_mm_loadu_si128((const __m128i*)(data + i + 48)), k, size);
+		if (!_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)))) continue;
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(a) | ((unsigned int)_mm_movemask_epi8(b) << 16);
+		if (mask) return (i + susMemfindFirst(mask)) / size;
+		mask = (unsigned int)_mm_movemask_epi8(c) | ((unsigned int)_mm_movemask_epi8(d) << 16);
+		return (i + 32 + susMemfindFirst(mask)) / size;
+	}
+	for (; i + 16 <= bytes; i += 16) {
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(susMemfindMatchSse2(_mm_loadu_si128((const __m128i*)(data + i)), k, size));
+		if (mask) return (i + susMemfindFirst(mask)) / size;
+	}
+	return susMemfindPortableEx(data, i / size, count, key, size);
+}
+// Find the element in 16-byte vectors
+static size_t SUSAPI susMemfindSse2(char* data, size_t count, char* key, size_t size)
+{
+	switch (size) {
+	case 1: return susMemfindSse2Ex(data, count, key, 1);
+	case 2: return susMemfindSse2Ex(data, count, key, 2);
+	case 4: return susMemfindSse2Ex(data, count, key, 4);
+	case 8: return susMemfindSse2Ex(data, count, key, 8);
+	default: return susMemfindSse2Ex(data, count, key, 16);
+	}
+}
+
+// -------------------------------------
+
+// Copy the memory in 32-byte vectors (the ends are loaded first, so overlapping forward copies are safe)
+static SUS_MEMORY_TARGET("avx2") char* SUSAPI susMemcpyAvx2Ex(char* buff, char* source, size_t size, int stream)
+{
+	if (size <= 32) return susMemcpySse2Ex(buff, source, size, 0);
+	__m256i head = _mm256_loadu_si256((const __m256i*)source);
+	__m256i tail = _mm256_loadu_si256((const __m256i*)(source + size - 32));
+	if (size <= 64) {
+		_mm256_storeu_si256((__m256i*)buff, head);
+		_mm256_storeu_si256((__m256i*)(buff + size - 32), tail);
+		_mm256_zeroupper();
+		return buff;
+	}
+	if (size <= 128) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(source + 32));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(source + size - 64));
+		_mm256_storeu_si256((__m256i*)buff, head);
+		_mm256_storeu_si256((__m256i*)(buff + 32), a);
+		_mm256_storeu_si256((__m256i*)(buff + size - 64), b);
+		_mm256_storeu_si256((__m256i*)(buff + size - 32), tail);
+		_mm256_zeroupper();
+		return buff;
+	}
+	size_t i = 32 - ((size_t)buff & 31);
+	if (stream) {
+		for (; i + 128 <= size - 32; i += 128) {
+			__m256i a = _mm256_loadu_si256((const __m256i*)(source + i));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(source + i + 32));
+			__m256i c = _mm256_loadu_si256((const __m256i*)(source + i + 64));
+			__m256i d = _mm256_loadu_si256((const __m256i*)(source + i + 96));
+			_mm256_stream_si256((__m256i*)(buff + i), a);
+			_mm256_stream_si256((__m256i*)(buff + i + 32), b);
+			_mm256_stream_si256((__m256i*)(buff + i + 64), c);
+			_mm256_stream_si256((__m256i*)(buff + i + 96), d);
+		}
+		_mm_sfence();
+	}
+	for (; i + 128 <= size - 32; i += 128) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(source + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(source + i + 32));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(source + i + 64));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(source + i + 96));
+		_mm256_store_si256((__m256i*)(buff + i), a);
+		_mm256_store_si256((__m256i*)(buff + i + 32), b);
+		_mm256_store_si256((__m256i*)(buff + i + 64), c);
+		_mm256_store_si256((__m256i*)(buff + i + 96), d);
+	}
+	for (; i < size - 32; i += 32) _mm256_store_si256((__m256i*)(buff + i), _mm256_loadu_si256((const __m256i*)(source + i)));
+	_mm256_storeu_si256((__m256i*)buff, head);
+	_mm256_storeu_si256((__m256i*)(buff + size - 32), tail);
+	_mm256_zeroupper();
+	return buff;
+}
+// Copy the memory in 32-byte vectors
+static SUS_MEMORY_TARGET("avx2") char* SUSAPI susMemcpyAvx2(char* buff, char* source, size_t size) {
+	return susMemcpyAvx2Ex(buff, source, size, size >= SUS_MEMORY_STREAM_SIZE);
+}
+// Copy the overlapping memory in 32-byte vectors
+static SUS_MEMORY_TARGET("avx2") char* SUSAPI susMemmoveAvx2(char* buff, char* source, size_t size)
+{
+	if ((size_t)buff - (size_t)source >= size || size <= 128) return susMemcpyAvx2Ex(buff, source, size, 0);
+	__m256i head = _mm256_loadu_si256((const __m256i*)source);
+	__m256i tail = _mm256_loadu_si256((const __m256i*)(source + size - 32));
+	size_t i = size - (((size_t)(buff + size) & 31) ? ((size_t)(buff + size) & 31) : 32);
+	for (; i >= 128 + 32; ) {
+		i -= 128;
+		__m256i a = _mm256_loadu_si256((const __m256i*)(source + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(source + i + 32));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(source + i + 64));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(source + i + 96));
+		_mm256_store_si256((__m256i*)(buff + i + 96), d);
+		_mm256_store_si256((__m256i*)(buff + i + 64), c);
+		_mm256_store_si256((__m256i*)(buff + i + 32), b);
+		_mm256_store_si256((__m256i*)(buff + i), a);
+	}
+	while (i > 32) {
+		i -= 32;
+		_mm256_store_si256((__m256i*)(buff + i), _mm256_loadu_si256((const __m256i*)(source + i)));
+	}
+	_mm256_storeu_si256((__m256i*)(buff + size - 32), tail);
+	_mm256_storeu_si256((__m256i*)buff, head);
+	_mm256_zeroupper();
+	return buff;
+}
+// Initialize the memory in 32-byte vectors
+static SUS_MEMORY_TARGET("avx2") void SUSAPI susMemsetAvx2(char* data, unsigned char value, size_t size)
+{
+	if (size <= 32) {
+		susMemsetSse2(data, value, size);
+		return;
+	}
+	__m256i v = _mm256_set1_epi8((char)value);
+	_mm256_storeu_si256((__m256i*)data, v);
+	_mm256_storeu_si256((__m256i*)(data + size - 32), v);
+	size_t i = 32 - ((size_t)data & 31);
+	if (size >= SUS_MEMORY_STREAM_SIZE) {
+		for (; i + 128 <= size - 32; i += 128) {
+			_mm256_stream_si256((__m256i*)(data + i), v);
+			_mm256_stream_si256((__m256i*)(data + i + 32), v);
+			_mm256_stream_si256((__m256i*)(data + i + 64), v);
+			_mm256_stream_si256((__m256i*)(data + i + 96), v);
+		}
+		_mm_sfence();
+	}
+	for (; i + 128 <= size - 32; i += 128) {
+		_mm256_store_si256((__m256i*)(data + i), v);
+		_mm256_store_si256((__m256i*)(data + i + 32), v);
+		_mm256_store_si256((__m256i*)(data + i + 64), v);
+		_mm256_store_si256((__m256i*)(data + i + 96), v);
+	}
+	for (; i < size - 32; i += 32) _mm256_store_si256((__m256i*)(data + i), v);
+	_mm256_zeroupper();
+}
+// Compare the memory in 32-byte vectors
+static SUS_MEMORY_TARGET("avx2") int SUSAPI susMemcmpAvx2(char* lpBuf1, char* lpBuf2, size_t size)
+{
+	if (size <= 32) return susMemcmpSse2(lpBuf1, lpBuf2, size);
+	int equal = 1;
+	size_t i = 0;
+	for (; i + 128 <= size && equal; i += 128) {
+		__m256i a = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(lpBuf1 + i)), _mm256_loadu_si256((const __m256i*)(lpBuf2 + i)));
+		__m256i b = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(lpBuf1 + i + 32)), _mm256_loadu_si256((const __m256i*)(lpBuf2 + i + 32)));
+		__m256i c = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(lpBuf1 + i + 64)), _mm256_loadu_si256((const __m256i*)(lpBuf2 + i + 64)));
+		__m256i d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(lpBuf1 + i + 96)), _mm256_loadu_si256((const __m256i*)(lpBuf2 + i + 96)));
+		__m256i x = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+		equal = _mm256_testz_si256(x, x);
+	}
+	for (; i + 32 < size && equal; i += 32) {
+		__m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(lpBuf1 + i)), _mm256_loadu_si256((const __m256i*)(lpBuf2 + i)));
+		equal = _mm256_testz_si256(x, x);
+	}
+	if (equal) {
+		__m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(lpBuf1 + size - 32)), _mm256_loadu_si256((const __m256i*)(lpBuf2 + size - 32)));
+		equal = _mm256_testz_si256(x, x);
+	}
+	_mm256_zeroupper();
+	return equal;
+}
+// Check the memory for zeros in 32-byte vectors
+static SUS_MEMORY_TARGET("avx2") int SUSAPI susMemiszeroAvx2(char* lpBuff, size_t size)
+{
+	if (size <= 32) return susMemiszeroSse2(lpBuff, size);
+	int zero = 1;
+	size_t i = 0;
+	for (; i + 128 <= size && zero; i += 128) {
+		__m256i x = _mm256_or_si256(
+			_mm256_or_si256(_mm256_loadu_si256((const __m256i*)(lpBuff + i)), _mm256_loadu_si256((const __m256i*)(lpBuff + i + 32))),
+			_mm256_or_si256(_mm256_loadu_si256((const __m256i*)(lpBuff + i + 64)), _mm256_loadu_si256((const __m256i*)(lpBuff + i + 96))));
+		zero = _mm256_testz_si256(x, x);
+	}
+	for (; i + 32 < size && zero; i += 32) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(lpBuff + i));
+		zero = _mm256_testz_si256(x, x);
+	}
+	if (zero) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(lpBuff + size - 32));
+		zero = _mm256_testz_si256(x, x);
+	}
+	_mm256_zeroupper();
+	return zero;
+}
+// Compare 32 bytes of the elements with the key (all the bytes of the equal elements are set)
+static SUS_FORCEINLINE SUS_MEMORY_TARGET("avx2") __m256i SUSAPI susMemfindMatchAvx2(__m256i x, __m256i key, size_t size)
+{
+	switch (size) {
+	case 1: return _mm256_cmpeq_epi8(x, key);
+	case 2: return _mm256_cmpeq_epi16(x, key);
+	case 4: return _mm256_cmpeq_epi32(x, key);
+	case 8: return _mm256_cmpeq_epi64(x, key);
+	default: {
+		__m256i eq = _mm256_cmpeq_epi64(x, key);
+		return _mm256_and_si256(eq, _mm256_shuffle_epi32(eq, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+	}
+}
+// Fill a vector with the key
+static SUS_FORCEINLINE SUS_MEMORY_TARGET("avx2") __m256i SUSAPI susMemfindKeyAvx2(char* key, size_t size)
+{
+	switch (size) {
+	case 1: return _mm256_set1_epi8((char)*key);
+	case 2: return _mm256_set1_epi16((short)*(sus_unaligned16_t*)key);
+	case 4: return _mm256_set1_epi32((int)*(sus_unaligned32_t*)key);
+	case 8: return _mm256_set1_epi64x((long long)*(sus_unaligned64_t*)key);
+	default: return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)key));
+	}
+}
+// Find the element in 32-byte vectors
+static SUS_FORCEINLINE SUS_MEMORY_TARGET("avx2") size_t SUSAPI susMemfindAvx2Ex(char* data, size_t count, char* key, size_t size)
+{
+	__m256i k = susMemfindKeyAvx2(key, size);
+	size_t bytes = count * size, i = 0, result = (size_t)-1;
+	for (; i + 128 <= bytes; i += 128) {
+		__m256i a = susMemfindMatchAvx2(_mm256_loadu_si256((const __m256i*)(data + i)), k, size);
+		__m256i b = susMemfindMatchAvx2(_mm256_loadu_si256((const __m256i*)(data + i + 32)), k, size);
+		__m256i c = susMemfindMatchAvx2(_mm256_loadu_si256((const __m256i*)(data + i + 64)), k, size);
+		__m256i d = susMemfindMatchAvx2(_mm256_loadu_si256((const __m256i*)(data + i + 96)), k, size);
+		__m256i x = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+		if (_mm256_testz_si256(x, x)) continue;
+		unsigned int mask;
+		if ((mask = (unsigned int)_mm256_movemask_epi8(a))) result = (i + susMemfindFirst(mask)) / size;
+		else if ((mask = (unsigned int)_mm256_movemask_epi8(b))) result = (i + 32 + susMemfindFirst(mask)) / size;
+		else if ((mask = (unsigned int)_mm256_movemask_epi8(c))) result = (i + 64 + susMemfindFirst(mask)) / size;
+		else result = (i + 96 + susMemfindFirst((unsigned int)_mm256_movemask_epi8(d))) / size;
+		break;
+	}
+	for (; result == (size_t)-1 && i + 32 <= bytes; i += 32) {
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(susMemfindMatchAvx2(_mm256_loadu_si256((const __m256i*)(data + i)), k, size));
+		if (mask) result = (i + susMemfindFirst(mask)) / size;
+	}
+	_mm256_zeroupper();
+	if (result != (size_t)-1) return result;
+	result = susMemfindSse2Ex(data + i, (bytes - i) / size, key, size);
+	return result != (size_t)-1 ? result + i / size : result;
+}
+// Find the element in 32-byte vectors
+static SUS_MEMORY_TARGET("avx2") size_t SUSAPI susMemfindAvx2(char* data, size_t count, char* key, size_t size)
+{
+	switch (size) {
+	case 1: return susMemfindAvx2Ex(data, count, key, 1);
+	case 2: return susMemfindAvx2Ex(data, count, key, 2);
+	case 4: return susMemfindAvx2Ex(data, count, key, 4);
+	case 8: return susMemfindAvx2Ex(data, count, key, 8);
+	default: return susMemfindAvx2Ex(data, count, key, 16);
+	}
+}
+
+// -------------------------------------
+
+// Get the processor information
+static SUS_FORCEINLINE void SUSAPI susMemoryCpuid(int info[4], int leaf)
+{
+#ifdef _MSC_VER
+	__cpuidex(info, leaf, 0);
+#else
+	__cpuid_count(leaf, 0, info[0], info[1], info[2], info[3]);
+#endif // !_MSC_VER
+}
+// Get the best instruction set supported by the processor
+SUS_MEMORY_ISA SUSAPI susMemoryDetectIsa(void)
+{
+	int info[4];
+	susMemoryCpuid(info, 0);
+	int maxLeaf = info[0];
+	susMemoryCpuid(info, 1);
+	if (!(info[3] & (1 << 26))) return SUS_MEMORY_ISA_PORTABLE;
+	// AVX requires the operating system to save the YMM registers
+	if (maxLeaf < 7 || !(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) return SUS_MEMORY_ISA_SSE2;
+#ifdef _MSC_VER
+	unsigned long long xcr0 = _xgetbv(0);
+#else
+	unsigned int xcr0lo, xcr0hi;
+	__asm__ volatile ("xgetbv" : "=a"(xcr0lo), "=d"(xcr0hi) : "c"(0));
+	unsigned long long xcr0 = ((unsigned long long)xcr0hi << 32) | xcr0lo;
+#endif // !_MSC_VER
+	if ((xcr0 & 6) != 6) return SUS_MEMORY_ISA_SSE2;
+	susMemoryCpuid(info, 7);
+	return (info[1] & (1 << 5)) ? SUS_MEMORY_ISA_AVX2 : SUS_MEMORY_ISA_SSE2;
+}
+
+#else
+
+// Get the best instruction set supported by the processor
+SUS_MEMORY_ISA SUSAPI susMemoryDetectIsa(void) {
+	return SUS_MEMORY_ISA_PORTABLE;
+}
+
+#endif // !SUS_MEMORY_X86
+
+// -------------------------------------
+
+// Kernels of the instruction sets
+static const SUS_MEMORY_KERNELS SUSMemoryIsaKernels[] = {
+	[SUS_MEMORY_ISA_PORTABLE] = { susMemcpyPortable, susMemmovePortable, susMemsetPortable, susMemcmpPortable, susMemiszeroPortable, susMemfindPortable },
+#ifdef SUS_MEMORY_X86
+	[SUS_MEMORY_ISA_SSE2] = { susMemcpySse2, susMemmoveSse2, susMemsetSse2, susMemcmpSse2, susMemiszeroSse2, susMemfindSse2 },
+	[SUS_MEMORY_ISA_AVX2] = { susMemcpyAvx2, susMemmoveAvx2, susMemsetAvx2, susMemcmpAvx2, susMemiszeroAvx2, susMemfindAvx2 }
+#endif // !SUS_MEMORY_X86
+};
+
+// Get the kernels of the instruction set
+const SUS_MEMORY_KERNELS* SUSAPI susMemoryGetKernels(SUS_MEMORY_ISA isa)
+{
+	if (isa <= SUS_MEMORY_ISA_AUTO || (size_t)isa >= sizeof(SUSMemoryIsaKernels) / sizeof(*SUSMemoryIsaKernels)) return NULL;
+	return SUSMemoryIsaKernels[isa].copy ? &SUSMemoryIsaKernels[isa] : NULL;
+}
+
+// -------------------------------------
@@ -4,41 +4,323 @@
 #include "include/susfwk/core.h"
 #include "include/susfwk/memory.h"
 
+#ifdef SUS_MEMORY_TRACKING
+// The allocator itself is not tracked
+#undef sus_malloc
+#undef sus_zalloc
+#undef sus_realloc
+// Remove the block from the tracking table
+static VOID SUSAPI susMemoryUntrack(_In_ SUS_LPMEMORY block);
+#endif // !SUS_MEMORY_TRACKING
+
 //////////////////////////////////////////////////////////////////
 //					Dynamic memory in heaps						//
 //////////////////////////////////////////////////////////////////
 
-// Allocate memory to the heap
+// Size of the virtual memory page
+#define SUS_MALLOC_PAGE_SIZE 0x1000
+// Number of size classes
+#define SUS_MALLOC_CLASS_COUNT 32
+// Size of the span header
+#define SUS_MALLOC_SPAN_HEADER 16
+// Size of the large block header
+#define SUS_MALLOC_LARGE_HEADER 16
+// Number of bits of the user address space
+#ifdef _WIN64
+#define SUS_MALLOC_ADDRESS_BITS 47
+#else
+#define SUS_MALLOC_ADDRESS_BITS 32
+#endif // !_WIN64
+// Number of bits of the page map leaf
+#define SUS_MALLOC_LEAF_BITS 16
+// Number of bits of the page map root
+#define SUS_MALLOC_ROOT_BITS (SUS_MALLOC_ADDRESS_BITS - 16 - SUS_MALLOC_LEAF_BITS)
+
+// Type of the memory owning the address
+typedef enum sus_malloc_kind {
+	SUS_MALLOC_KIND_HEAP,	// The block belongs to the process heap
+	SUS_MALLOC_KIND_SPAN,	// The block belongs to the size class span
+	SUS_MALLOC_KIND_LARGE	// The block is allocated directly in virtual memory
+} SUS_MALLOC_KIND;
+// Header of the size class span
+typedef struct sus_malloc_span {
+	DWORD sizeClass;		// Span size class
+} SUS_MALLOC_SPAN, *SUS_LPMALLOC_SPAN;
+// Header of the large block
+typedef struct sus_malloc_large {
+	SIZE_T reserved;		// Reserved size in bytes
+	SIZE_T committed;		// Committed size in bytes
+} SUS_MALLOC_LARGE, *SUS_LPMALLOC_LARGE;
+// Shared depot of the size class
+typedef struct SUS_CACHE_ALIGN sus_malloc_depot {
+	SRWLOCK			lock;		// Depot lock
+	SUS_LPMEMORY	freeList;	// Released blocks
+	sus_lpbyte_t	cursor;		// The next block of the current span
+	sus_lpbyte_t	end;		// The end of the current span
+} SUS_MALLOC_DEPOT, *SUS_LPMALLOC_DEPOT;
+// Cache of the thread
+typedef struct sus_malloc_cache {
+	SUS_LPMEMORY	lists[SUS_MALLOC_CLASS_COUNT];	// Free blocks of the size classes
+	sus_uint_t		counts[SUS_MALLOC_CLASS_COUNT];	// Number of free blocks
+	BOOL			registered;						// The cache is flushed at the thread exit
+} SUS_MALLOC_CACHE, *SUS_LPMALLOC_CACHE;
+
+// Owners of the address space regions
+static sus_lpbyte_t SUSMallocPageMap[(SIZE_T)1 << SUS_MALLOC_ROOT_BITS] = { 0 };
+// Depots of the size classes
+static SUS_MALLOC_DEPOT SUSMallocDepots[SUS_MALLOC_CLASS_COUNT] = { 0 };
+// Thread cache
+static SUS_THREAD_LOCAL SUS_MALLOC_CACHE SUSMallocCache = { 0 };
+// Initialization of the thread exit callback
+static INIT_ONCE SUSMallocInitOnce = INIT_ONCE_STATIC_INIT;
+// Fiber local storage index for the thread exit callback
+static DWORD SUSMallocFlsIndex = FLS_OUT_OF_INDEXES;
+
+// -------------------------------------
+
+// Get the size class of the block
+static SUS_FORCEINLINE DWORD SUSAPI susMallocClassOf(_In_ SIZE_T size) {
+	if (size <= 128) return size ? (DWORD)((size + 15) >> 4) - 1 : 0;
+	DWORD k;
+#ifdef _WIN64
+	_BitScanReverse64(&k, (DWORD64)(size - 1));
+#else
+	_BitScanReverse(&k, (DWORD)(size - 1));
+#endif // !_WIN64
+	return 8 + (k - 7) * 4 + (DWORD)(((size - 1) - ((SIZE_T)1 << k)) >> (k - 2));
+}
+// Get the size of the size class blocks
+static SUS_FORCEINLINE SIZE_T SUSAPI susMallocClassSize(_In_ DWORD sizeClass) {
+	if (sizeClass < 8) return ((SIZE_T)sizeClass + 1) << 4;
+	DWORD k = 7 + ((sizeClass - 8) >> 2);
+	return ((SIZE_T)1 << k) + (((SIZE_T)(sizeClass - 8) & 3) + 1) * ((SIZE_T)1 << (k - 2));
+}
+// Get the number of blocks moved between the thread cache and the depot
+static SUS_FORCEINLINE sus_uint_t SUSAPI susMallocBatchSize(_In_ DWORD sizeClass) {
+	return (sus_uint_t)max(4, min(64, 0x4000 / susMallocClassSize(sizeClass)));
+}
+
+// Get the owner of the address
+static SUS_FORCEINLINE SUS_MALLOC_KIND SUSAPI susMallocKindOf(_In_ SUS_LPMEMORY block) {
+	ULONG_PTR index = (ULONG_PTR)block >> 16;
+	if (index >> (SUS_MALLOC_ROOT_BITS + SUS_MALLOC_LEAF_BITS)) return SUS_MALLOC_KIND_HEAP;
+	sus_lpbyte_t leaf = SUSMallocPageMap[index >> SUS_MALLOC_LEAF_BITS];
+	return leaf ? (SUS_MALLOC_KIND)leaf[index & (((ULONG_PTR)1 << SUS_MALLOC_LEAF_BITS) - 1)] : SUS_MALLOC_KIND_HEAP;
+}
+// Set the owner of the 64 KB address space region
+static BOOL SUSAPI susMallocSetKind(_In_ SUS_LPMEMORY region, _In_ SUS_MALLOC_KIND kind)
+{
+	ULONG_PTR index = (ULONG_PTR)region >> 16;
+	sus_lpbyte_t* lpLeaf = &SUSMallocPageMap[index >> SUS_MALLOC_LEAF_BITS];
+	if (!*lpLeaf) {
+		sus_lpbyte_t leaf = VirtualAlloc(NULL, (SIZE_T)1 << SUS_MALLOC_LEAF_BITS, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (!leaf) return FALSE;
+		if (InterlockedCompareExchangePointer((PVOID volatile*)lpLeaf, leaf, NULL)) VirtualFree(leaf, 0, MEM_RELEASE);
+	}
+	(*lpLeaf)[index & (((ULONG_PTR)1 << SUS_MALLOC_LEAF_BITS) - 1)] = (sus_byte_t)kind;
+	return TRUE;
+}
+
+// -------------------------------------
+
+// Take blocks of the size class from the depot
+static SUS_LPMEMORY SUSAPI susMallocDepotTake(_In_ DWORD sizeClass, _In_ sus_uint_t count, _Out_ sus_uint_t* taken)
+{
+	SUS_LPMALLOC_DEPOT depot = &SUSMallocDepots[sizeClass];
+	SIZE_T size = susMallocClassSize(sizeClass);
+	SUS_LPMEMORY list = NULL;
+	*taken = 0;
+	AcquireSRWLockExclusive(&depot->lock);
+	while (*taken < count && depot->freeList) {
+		SUS_LPMEMORY block = depot->freeList;
+		depot->freeList = *(SUS_LPMEMORY*)block;
+		*(SUS_LPMEMORY*)block = list;
+		list = block;
+		(*taken)++;
+	}
+	while (*taken < count) {
+		if (!depot->cursor || depot->cursor + size > depot->end) {
+			SUS_LPMALLOC_SPAN span = VirtualAlloc(NULL, SUS_MALLOC_SPAN_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (!span) break;
+			if (!susMallocSetKind(span, SUS_MALLOC_KIND_SPAN)) {
+				VirtualFree(span, 0, MEM_RELEASE);
+				break;
+			}
+			span->sizeClass = sizeClass;
+			depot->cursor = (sus_lpbyte_t)span + SUS_MALLOC_SPAN_HEADER;
+			depot->end = (sus_lpbyte_t)span + SUS_MALLOC_SPAN_SIZE;
+		}
+		*(SUS_LPMEMORY*)depot->cursor = list;
+		list = depot->cursor;
+		depot->cursor += size;
+		(*taken)++;
+	}
+	ReleaseSRWLockExclusive(&depot->lock);
+	return list;
+}
+// Return a list of blocks of the size class to the depot
+static VOID SUSAPI susMallocDepotPut(_In_ DWORD sizeClass, _In_ SUS_LPMEMORY head, _In_ SUS_LPMEMORY tail)
+{
+	SUS_LPMALLOC_DEPOT depot = &SUSMallocDepots[sizeClass];
+	AcquireSRWLockExclusive(&depot->lock);
+	*(SUS_LPMEMORY*)tail = depot->freeList;
+	depot->freeList = head;
+	ReleaseSRWLockExclusive(&depot->lock);
+}
+// Move blocks from the thread cache to the depot
+static VOID SUSAPI susMallocCacheFlush(_Inout_ SUS_LPMALLOC_CACHE cache, _In_ DWORD sizeClass, _In_ sus_uint_t count)
+{
+	SUS_LPMEMORY head = cache->lists[sizeClass];
+	if (!head || !count) return;
+	SUS_LPMEMORY tail = head;
+	sus_uint_t moved = 1;
+	for (; moved < count && *(SUS_LPMEMORY*)tail; moved++) tail = *(SUS_LPMEMORY*)tail;
+	cache->lists[sizeClass] = *(SUS_LPMEMORY*)tail;
+	cache->counts[sizeClass] -= moved;
+	susMallocDepotPut(sizeClass, head, tail);
+}
+// Return the thread cache to the depot at the thread exit
+static VOID NTAPI susMallocThreadExit(_In_ PVOID data)
+{
+	SUS_LPMALLOC_CACHE cache = (SUS_LPMALLOC_CACHE)data;
+	if (!cache) return;
+	for (DWORD i = 0; i < SUS_MALLOC_CLASS_COUNT; i++) susMallocCacheFlush(cache, i, cache->counts[i]);
+	cache->registered = FALSE;
+}
+// Register the thread exit callback
+static BOOL CALLBACK susMallocInit(_Inout_ PINIT_ONCE initOnce, _Inout_opt_ PVOID param, _Out_opt_ PVOID* context)
+{
+	UNREFERENCED_PARAMETER(initOnce);
+	UNREFERENCED_PARAMETER(param);
+	UNREFERENCED_PARAMETER(context);
+	SUSMallocFlsIndex = FlsAlloc(susMallocThreadExit);
+	return TRUE;
+}
+// Flush the thread cache at the thread exit
+static VOID SUSAPI susMallocCacheRegister(_Inout_ SUS_LPMALLOC_CACHE cache)
+{
+	InitOnceExecuteOnce(&SUSMallocInitOnce, susMallocInit, NULL, NULL);
+	if (SUSMallocFlsIndex != FLS_OUT_OF_INDEXES) FlsSetValue(SUSMallocFlsIndex, cache);
+	cache->registered = TRUE;
+}
+// Refill the thread cache and allocate a block
+static SUS_LPMEMORY SUSAPI susMallocRefill(_Inout_ SUS_LPMALLOC_CACHE cache, _In_ DWORD sizeClass)
+{
+	if (!cache->registered) susMallocCacheRegister(cache);
+	sus_uint_t taken;
+	SUS_LPMEMORY list = susMallocDepotTake(sizeClass, susMallocBatchSize(sizeClass), &taken);
+	if (!list) return NULL;
+	cache->lists[sizeClass] = *(SUS_LPMEMORY*)list;
+	cache->counts[sizeClass] += taken - 1;
+	return list;
+}
+
+// -------------------------------------
+
+// Allocate a block in virtual memory
+static SUS_LPMEMORY SUSAPI susMallocLarge(_In_ SIZE_T size)
+{
+	SUS_PRINTDL("Allocating %d bytes in virtual memory", size);
+	SIZE_T reserved = SUS_ALIGN(size + SUS_MALLOC_LARGE_HEADER, SUS_MALLOC_SPAN_SIZE);
+	SIZE_T committed = SUS_ALIGN(size + SUS_MALLOC_LARGE_HEADER, SUS_MALLOC_PAGE_SIZE);
+	SUS_LPMALLOC_LARGE large = VirtualAlloc(NULL, reserved, MEM_RESERVE, PAGE_READWRITE);
+	if (!large) return NULL;
+	if (!VirtualAlloc(large, committed, MEM_COMMIT, PAGE_READWRITE) || !susMallocSetKind(large, SUS_MALLOC_KIND_LARGE)) {
+		VirtualFree(large, 0, MEM_RELEASE);
+		return NULL;
+	}
+	large->reserved = reserved;
+	large->committed = committed;
+	return (sus_lpbyte_t)large + SUS_MALLOC_LARGE_HEADER;
+}
+// Allocate a block
+static SUS_LPMEMORY SUSAPI susMallocEx(_In_ SIZE_T size, _In_ BOOL zero)
+{
+	if (size <= SUS_MALLOC_SMALL_SIZE) {
+		DWORD sizeClass = susMallocClassOf(size);
+		SUS_LPMALLOC_CACHE cache = &SUSMallocCache;
+		sus_lpbyte_t block = cache->lists[sizeClass];
+		if (block) {
+			cache->lists[sizeClass] = *(SUS_LPMEMORY*)block;
+			cache->counts[sizeClass]--;
+		}
+		else block = susMallocRefill(cache, sizeClass);
+		if (block && zero) sus_zeromem(block, susMallocClassSize(sizeClass));
+		return block;
+	}
+	if (size < SUS_MALLOC_LARGE_SIZE) return HeapAlloc(GetProcessHeap(), zero ? HEAP_ZERO_MEMORY : 0, size);
+	return susMallocLarge(size);
+}
+// Get the usable size of the block
+static SIZE_T SUSAPI susMallocSize(_In_ SUS_LPMEMORY block, _In_ SUS_MALLOC_KIND kind)
+{
+	switch (kind)
+	{
+	case SUS_MALLOC_KIND_SPAN:
+		return susMallocClassSize(((SUS_LPMALLOC_SPAN)((ULONG_PTR)block & ~((ULONG_PTR)SUS_MALLOC_SPAN_SIZE - 1)))->sizeClass);
+	case SUS_MALLOC_KIND_LARGE:
+		return ((SUS_LPMALLOC_LARGE)((sus_lpbyte_t)block - SUS_MALLOC_LARGE_HEADER))->committed - SUS_MALLOC_LARGE_HEADER;
+	default:
+		return HeapSize(GetProcessHeap(), 0, block);
+	}
+}
+
+// -------------------------------------
+
+// Allocate memory to the heap (the block is not initialized)
 SUS_LPMEMORY SUSAPI sus_malloc(_In_ SIZE_T size)
 {
-	SUS_PRINTDL("Allocating %d bytes of memory", size);
-#ifdef _DEBUG
-	if (size >= (SIZE_T)1 << 20) SUS_PRINTDW("The allocated block exceeds the memory heap limits, use sus_vmalloc!");
-#endif // ~_DEBUG
-	SUS_LPMEMORY hMem = NULL;
-	for (DWORD i = 0; i < SUS_NUMBER_ATTEMPTS_ALLOCATE_MEMORY; i++) {
-		hMem = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, size);
-		if (hMem) break;
-		SUS_PRINTDE("Couldn't allocate memory");
+	SUS_LPMEMORY block = susMallocEx(size, FALSE);
+	if (!block) {
+		SUS_PRINTDE("Couldn't allocate %d bytes of memory", size);
 		SUS_PRINTDC(GetLastError());
 		susErrorPushEx((SUS_ERROR) { .sev = SUS_ERROR_SEVERITY_CRITICAL, .type = SUS_ERROR_TYPE_MEMORY, .code = SUS_ERROR_SYSTEM_ERROR });
-		Sleep(10);
 	}
-	return hMem;
+	return block;
+}
+// Allocate zero-initialized memory to the heap
+SUS_LPMEMORY SUSAPI sus_zalloc(_In_ SIZE_T size)
+{
+	SUS_LPMEMORY block = susMallocEx(size, TRUE);
+	if (!block) {
+		SUS_PRINTDE("Couldn't allocate %d bytes of memory", size);
+		SUS_PRINTDC(GetLastError());
+		susErrorPushEx((SUS_ERROR) { .sev = SUS_ERROR_SEVERITY_CRITICAL, .type = SUS_ERROR_TYPE_MEMORY, .code = SUS_ERROR_SYSTEM_ERROR });
+	}
+	return block;
 }
 // Memory reallocation
 SUS_LPMEMORY SUSAPI sus_realloc(
 	_In_ SUS_LPMEMORY block,
 	_In_ SIZE_T newSize)
 {
-	SUS_PRINTDL("Changing the memory block to %d bytes", newSize);
 	if (!block) return sus_malloc(newSize);
-	SIZE_T oldSize = HeapSize(GetProcessHeap(), 0, block);
-	SUS_LPMEMORY hMem = HeapReAlloc(GetProcessHeap(), 0, block, newSize);
-	if (hMem) {
-		SUS_PRINTDL("The block size has been successfully changed");
-		return hMem;
+	SUS_MALLOC_KIND kind = susMallocKindOf(block);
+	switch (kind)
+	{
+	case SUS_MALLOC_KIND_SPAN: {
+		SIZE_T size = susMallocSize(block, kind);
+		if (newSize <= size && (newSize > size / 2 || size <= 16)) return block;
+	} break;
+	case SUS_MALLOC_KIND_LARGE: {
+		SUS_LPMALLOC_LARGE large = (SUS_LPMALLOC_LARGE)((sus_lpbyte_t)block - SUS_MALLOC_LARGE_HEADER);
+		SIZE_T committed = SUS_ALIGN(newSize + SUS_MALLOC_LARGE_HEADER, SUS_MALLOC_PAGE_SIZE);
+		if (newSize >= SUS_MALLOC_LARGE_SIZE && committed <= large->reserved) {
+			if (committed > large->committed) {
+				if (!VirtualAlloc((sus_lpbyte_t)large + large->committed, committed - large->committed, MEM_COMMIT, PAGE_READWRITE)) break;
+				large->committed = committed;
+			}
+			return block;
+		}
+	} break;
+	default: {
+		if (newSize > SUS_MALLOC_SMALL_SIZE && newSize < SUS_MALLOC_LARGE_SIZE) {
+			SUS_LPMEMORY hMem = HeapReAlloc(GetProcessHeap(), 0, block, newSize);
+			if (hMem) return hMem;
+		}
+	} break;
 	}
+	SIZE_T oldSize = susMallocSize(block, kind);
 	SUS_LPMEMORY hNewMem = sus_malloc(newSize);
 	if (!hNewMem) return newSize <= oldSize ? block : NULL;
 	sus_memcpy(hNewMem, block, min(oldSize, newSize));
@@ -48,25 +330,428 @@ SUS_LPMEMORY SUSAPI sus_realloc(
 // Free a block of memory in the heap
 SUS_LPMEMORY SUSAPI sus_free(_In_ SUS_LPMEMORY block)
 {
-	SUS_PRINTDL("Freeing the memory block");
-	if (!HeapFree(GetProcessHeap(), 0, block)) {
-		SUS_PRINTDE("The memory block could not be released");
-		SUS_PRINTDC(GetLastError());
-		susErrorPushEx((SUS_ERROR) { .sev = SUS_ERROR_SEVERITY_CRITICAL, .type = SUS_ERROR_TYPE_MEMORY, .code = SUS_ERROR_SYSTEM_ERROR });
-		return block;
+	if (!block) return NULL;
+#ifdef SUS_MEMORY_TRACKING
+	susMemoryUntrack(block);
+#endif // !SUS_MEMORY_TRACKING
+	switch (susMallocKindOf(block))
+	{
+	case SUS_MALLOC_KIND_SPAN: {
+		DWORD sizeClass = ((SUS_LPMALLOC_SPAN)((ULONG_PTR)block & ~((ULONG_PTR)SUS_MALLOC_SPAN_SIZE - 1)))->sizeClass;
+		SUS_LPMALLOC_CACHE cache = &SUSMallocCache;
+		// A thread may only free the blocks allocated by the other threads
+		if (!cache->registered) susMallocCacheRegister(cache);
+		*(SUS_LPMEMORY*)block = cache->lists[sizeClass];
+		cache->lists[sizeClass] = block;
+		if (++cache->counts[sizeClass] > susMallocBatchSize(sizeClass) * 2) susMallocCacheFlush(cache, sizeClass, susMallocBatchSize(sizeClass));
+	} return NULL;
+	case SUS_MALLOC_KIND_LARGE: {
+		SUS_LPMEMORY large = (sus_lpbyte_t)block - SUS_MALLOC_LARGE_HEADER;
+		susMallocSetKind(large, SUS_MALLOC_KIND_HEAP);
+		if (!VirtualFree(large, 0, MEM_RELEASE)) break;
+	} return NULL;
+	default: {
+		if (!HeapFree(GetProcessHeap(), 0, block)) break;
+	} return NULL;
 	}
-	return NULL;
+	SUS_PRINTDE("The memory block could not be released");
+	SUS_PRINTDC(GetLastError());
+	susErrorPushEx((SUS_ERROR) { .sev = SUS_ERROR_SEVERITY_CRITICAL, .type = SUS_ERROR_TYPE_MEMORY, .code = SUS_ERROR_SYSTEM_ERROR });
+	return block;
+}
+// Return the blocks cached by the current thread to the shared depot
+VOID SUSAPI sus_mflush()
+{
+	SUS_LPMALLOC_CACHE cache = &SUSMallocCache;
+	for (DWORD i = 0; i < SUS_MALLOC_CLASS_COUNT; i++) susMallocCacheFlush(cache, i, cache->counts[i]);
+}
+// Allocate memory so that the address block + offset is aligned
+SUS_LPMEMORY SUSAPI sus_malloc_alignedEx(_In_ SIZE_T size, _In_ SIZE_T alignment, _In_ SIZE_T offset)
+{
+	SUS_ASSERT(alignment && !(alignment & (alignment - 1)));
+	alignment = max(alignment, sizeof(SUS_LPMEMORY));
+	sus_lpbyte_t raw = sus_malloc(size + alignment - 1 + sizeof(SUS_LPMEMORY));
+	if (!raw) return NULL;
+	sus_lpbyte_t block = (sus_lpbyte_t)SUS_ALIGN((ULONG_PTR)raw + sizeof(SUS_LPMEMORY) + offset, alignment) - offset;
+	((SUS_LPMEMORY*)block)[-1] = raw;
+	return block;
+}
+// Free the memory allocated with sus_malloc_aligned
+VOID SUSAPI sus_free_aligned(_In_opt_ SUS_LPMEMORY block)
+{
+	if (!block) return;
+	sus_free(((SUS_LPMEMORY*)block)[-1]);
 }
 // Create and initialize memory
 SUS_LPMEMORY SUSAPI sus_newmem(_In_ SIZE_T size, _In_opt_ SUS_OBJECT value)
 {
 	SUS_ASSERT(size);
 	SUS_LPMEMORY obj = sus_malloc(size);
+	if (!obj) return NULL;
 	if (value) sus_memcpy(obj, (sus_lpbyte_t)value, size);
 	else sus_zeromem(obj, size);
 	return obj;
 }
 
+#ifdef SUS_MEMORY_TRACKING
+
+//////////////////////////////////////////////////////////////////
+//					Allocation tracking							//
+//////////////////////////////////////////////////////////////////
+
+// Initial capacity of the live block table
+#define SUS_MEMORY_BLOCKS_INIT_COUNT 0x1000
+
+// Record of the live block
+typedef struct sus_memory_block {
+	SUS_LPMEMORY	block;	// Tracked block (NULL - free entry)
+	SIZE_T			size;	// Requested size
+	sus_uint_t		site;	// Index of the call site
+} SUS_MEMORY_BLOCK, *SUS_LPMEMORY_BLOCK;
+
+// Tracking state
+static struct sus_memory_tracker {
+	SRWLOCK				lock;									// Tracker lock
+	SUS_MEMORY_STATS	stats;									// Overall statistics
+	SUS_MEMORY_SITE		sites[SUS_MEMORY_SITE_COUNT];			// Call sites (open addressing, 0 - overflow site)
+	SUS_LPMEMORY_BLOCK	blocks;									// Live blocks (open addressing)
+	SIZE_T				capacity;								// Capacity of the live block table
+	SIZE_T				count;									// Number of the live blocks
+} SUSMemoryTracker = { .lock = SRWLOCK_INIT };
+
+// -------------------------------------
+
+// Get the hash of the block address
+static SUS_FORCEINLINE SIZE_T SUSAPI susMemoryBlockHash(_In_ SUS_LPMEMORY block) {
+	ULONG_PTR key = (ULONG_PTR)block >> 4;
+	return (SIZE_T)(key * (ULONG_PTR)0x9E3779B97F4A7C15ull);
+}
+// Get the histogram bucket of the size
+static SUS_FORCEINLINE DWORD SUSAPI susMemoryHistogramIndex(_In_ SIZE_T size) {
+	if (!size) return 0;
+	DWORD k;
+#ifdef _WIN64
+	_BitScanReverse64(&k, (DWORD64)size);
+#else
+	_BitScanReverse(&k, (DWORD)size);
+#endif // !_WIN64
+	return min(k, SUS_MEMORY_HISTOGRAM_SIZE - 1);
+}
+// Find or add the call site
+static sus_uint_t SUSAPI susMemorySiteGet(_In_ SUS_MEMORY_TAG tag, _In_ LPCSTR file, _In_ DWORD line)
+{
+	sus_uint_t i = (sus_uint_t)(((ULONG_PTR)file >> 3) * 31 + line * 17 + tag) % (SUS_MEMORY_SITE_COUNT - 1) + 1;
+	for (sus_uint_t probe = 1; probe < SUS_MEMORY_SITE_COUNT; probe++, i = i % (SUS_MEMORY_SITE_COUNT - 1) + 1) {
+		SUS_LPMEMORY_SITE site = &SUSMemoryTracker.sites[i];
+		if (!site->file) {
+			site->file = file;
+			site->line = line;
+			site->tag = tag;
+			SUSMemoryTracker.stats.sites++;
+			return i;
+		}
+		if (site->file == file && site->line == line && site->tag == tag) return i;
+	}
+	return 0;
+}
+// Grow the live block table
+static BOOL SUSAPI susMemoryBlocksGrow()
+{
+	SIZE_T capacity = SUSMemoryTracker.capacity ? SUSMemoryTracker.capacity * 2 : SUS_MEMORY_BLOCKS_INIT_COUNT;
+	SUS_LPMEMORY_BLOCK blocks = VirtualAlloc(NULL, capacity * sizeof(SUS_MEMORY_BLOCK), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (!blocks) return FALSE;
+	for (SIZE_T i = 0; i < SUSMemoryTracker.capacity; i++) {
+		SUS_LPMEMORY_BLOCK entry = &SUSMemoryTracker.blocks[i];
+		if (!entry->block) continue;
+		SIZE_T j = susMemoryBlockHash(entry->block) & (capacity - 1);
+		while (blocks[j].block) j = (j + 1) & (capacity - 1);
+		blocks[j] = *entry;
+	}
+	if (SUSMemoryTracker.blocks) VirtualFree(SUSMemoryTracker.blocks, 0, MEM_RELEASE);
+	SUSMemoryTracker.blocks = blocks;
+	SUSMemoryTracker.capacity = capacity;
+	return TRUE;
+}
+// Count the allocation
+static VOID SUSAPI susMemoryCountersAdd(_Inout_ SUS_LPMEMORY_COUNTERS counters, _In_ SIZE_T size)
+{
+	counters->allocations++;
+	counters->bytes += size;
+	counters->blocks++;
+	counters->live += size;
+	if (counters->live > counters->peak) counters->peak = counters->live;
+}
+// Count the release
+static VOID SUSAPI susMemoryCountersRemove(_Inout_ SUS_LPMEMORY_COUNTERS counters, _In_ SIZE_T size)
+{
+	counters->releases++;
+	counters->blocks--;
+	counters->live -= size;
+}
+// Add the block to the tracking table
+static VOID SUSAPI susMemoryTrack(_In_ SUS_LPMEMORY block, _In_ SIZE_T size, _In_ SUS_MEMORY_TAG tag, _In_ LPCSTR file, _In_ DWORD line)
+{
+	AcquireSRWLockExclusive(&SUSMemoryTracker.lock);
+	if ((SUSMemoryTracker.count + 1) * 4 > SUSMemoryTracker.capacity * 3 && !susMemoryBlocksGrow()) {
+		ReleaseSRWLockExclusive(&SUSMemoryTracker.lock);
+		SUS_PRINTDW("The allocation of %d bytes could not be tracked", size);
+		return;
+	}
+	sus_uint_t site = susMemorySiteGet(tag, file, line);
+	SIZE_T mask = SUSMemoryTracker.capacity - 1;
+	SIZE_T i = susMemoryBlockHash(block) & mask;
+	while (SUSMemoryTracker.blocks[i].block) i = (i + 1) & mask;
+	SUSMemoryTracker.blocks[i] = (SUS_MEMORY_BLOCK) { .block = block, .size = size, .site = site };
+	SUSMemoryTracker.count++;
+	susMemoryCountersAdd(&SUSMemoryTracker.sites[site].counters, size);
+	susMemoryCountersAdd(&SUSMemoryTracker.stats.tags[tag], size);
+	susMemoryCountersAdd(&SUSMemoryTracker.stats.total, size);
+	SUSMemoryTracker.stats.histogram[susMemoryHistogramIndex(size)]++;
+	ReleaseSRWLockExclusive(&SUSMemoryTracker.lock);
+}
+// Remove the block from the tracking table
+static VOID SUSAPI susMemoryUntrack(_In_ SUS_LPMEMORY block)
+{
+	AcquireSRWLockExclusive(&SUSMemoryTracker.lock);
+	if (!SUSMemoryTracker.count) {
+		ReleaseSRWLockExclusive(&SUSMemoryTracker.lock);
+		return;
+	}
+	SIZE_T mask = SUSMemoryTracker.capacity - 1;
+	SIZE_T i = susMemoryBlockHash(block) & mask;
+	while (SUSMemoryTracker.blocks[i].block && SUSMemoryTracker.blocks[i].block != block) i = (i + 1) & mask;
+	SUS_MEMORY_BLOCK entry = SUSMemoryTracker.blocks[i];
+	if (!entry.block) {
+		ReleaseSRWLockExclusive(&SUSMemoryTracker.lock);
+		return;
+	}
+	// Backward shift deletion keeps the probe chains without tombstones
+	for (SIZE_T j = (i + 1) & mask; SUSMemoryTracker.blocks[j].block; j = (j + 1) & mask) {
+		SIZE_T home = susMemoryBlockHash(SUSMemoryTracker.blocks[j].block) & mask;
+		if (((j - home) & mask) < ((j - i) & mask)) continue;
+		SUSMemoryTracker.blocks[i] = SUSMemoryTracker.blocks[j];
+		i = j;
+	}
+	SUSMemoryTracker.blocks[i].block = NULL;
+	SUSMemoryTracker.count--;
+	SUS_LPMEMORY_SITE site = &SUSMemoryTracker.sites[entry.site];
+	susMemoryCountersRemove(&site->counters, entry.size);
+	susMemoryCountersRemove(&SUSMemoryTracker.stats.tags[site->tag], entry.size);
+	susMemoryCountersRemove(&SUSMemoryTracker.stats.total, entry.size);
+	ReleaseSRWLockExclusive(&SUSMemoryTracker.lock);
+}
+
+// -------------------------------------
+
+// Allocate memory to the heap and record the call site
+SUS_LPMEMORY SUSAPI sus_mallocAt(_In_ SIZE_T size, _In_ SUS_MEMORY_TAG tag, _In_ LPCSTR file, _In_ DWORD line)
+{
+	SUS_LPMEMORY block = sus_malloc(size);
+	if (block) susMemoryTrack(block, size, tag, file, line);
+	return block;
+}
+// Allocate zero-initialized memory to the heap and record the call site
+SUS_LPMEMORY SUSAPI sus_zallocAt(_In_ SIZE_T size, _In_ SUS_MEMORY_TAG tag, _In_ LPCSTR file, _In_ DWORD line)
+{
+	SUS_LPMEMORY block = sus_zalloc(size);
+	if (block) susMemoryTrack(block, size, tag, file, line);
+	return block;
+}
+// Memory reallocation with the call site record
+SUS_LPMEMORY SUSAPI sus_reallocAt(_In_ SUS_LPMEMORY block, _In_ SIZE_T newSize, _In_ SUS_MEMORY_TAG tag, _In_ LPCSTR file, _In_ DWORD line)
+{
+	SUS_LPMEMORY newBlock = sus_realloc(block, newSize);
+	if (!newBlock) return NULL;
+	if (block) susMemoryUntrack(block);
+	susMemoryTrack(newBlock, newSize, tag, file, line);
+	return newBlock;
+}
+
+// -------------------------------------
+
+// Get a snapshot of the allocation statistics
+VOID SUSAPI susMemorySnapshot(_Out_ SUS_LPMEMORY_STATS stats)
+{
+	SUS_ASSERT(stats);
+	AcquireSRWLockShared(&SUSMemoryTracker.lock);
+	*stats = SUSMemoryTracker.stats;
+	ReleaseSRWLockShared(&SUSMemoryTracker.lock);
+}
+// Get the call sites with the most allocated bytes
+sus_uint_t SUSAPI susMemoryGetSites(_Out_writes_(count) SUS_LPMEMORY_SITE sites, _In_ sus_uint_t count)
+{
+	SUS_ASSERT(sites || !count);
+	sus_uint_t written = 0;
+	AcquireSRWLockShared(&SUSMemoryTracker.lock);
+	for (sus_uint_t i = 0; i < SUS_MEMORY_SITE_COUNT; i++) {
+		SUS_LPMEMORY_SITE site = &SUSMemoryTracker.sites[i];
+		if (!site->counters.allocations) continue;
+		sus_uint_t j = written < count ? written++ : count;
+		for (; j && sites[j - 1].counters.bytes < site->counters.bytes; j--) if (j < count) sites[j] = sites[j - 1];
+		if (j < count) sites[j] = *site;
+	}
+	ReleaseSRWLockShared(&SUSMemoryTracker.lock);
+	return written;
+}
+// Print the call site to the debugger
+static VOID SUSAPI susMemoryPrintSite(_In_ SUS_LPMEMORY_SITE site, _In_ BOOL live)
+{
+	static const LPCSTR tags[SUS_MEMORY_TAG_COUNT] = { "GENERAL", "VECTOR", "BUFFER", "MAP", "LIST", "JSON", "ECS", "NET" };
+	CHAR text[512];
+	if (live) sus_formattingA(text, "[memory] %s:%d [%s] %p live blocks, %p live bytes\n",
+		site->file ? site->file : "(other)", site->line, tags[site->tag], site->counters.blocks, site->counters.live);
+	else sus_formattingA(text, "[memory] %s:%d [%s] %p allocations, %p bytes, %p live bytes, %p peak bytes\n",
+		site->file ? site->file : "(other)", site->line, tags[site->tag], site->counters.allocations, site->counters.bytes, site->counters.live, site->counters.peak);
+	OutputDebugStringA(text);
+}
+// Print the call sites with the most allocated bytes to the debugger
+VOID SUSAPI susMemoryDumpSites(_In_ sus_uint_t count)
+{
+	SUS_LPMEMORY_SITE sites = VirtualAlloc(NULL, count * sizeof(SUS_MEMORY_SITE), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (!sites) return;
+	count = susMemoryGetSites(sites, count);
+	for (sus_uint_t i = 0; i < count; i++) susMemoryPrintSite(&sites[i], FALSE);
+	VirtualFree(sites, 0, MEM_RELEASE);
+}
+// Print the call sites of the live blocks to the debugger
+SIZE_T SUSAPI susMemoryDumpLeaks()
+{
+	AcquireSRWLockShared(&SUSMemoryTracker.lock);
+	SIZE_T blocks = SUSMemoryTracker.stats.total.blocks;
+	for (sus_uint_t i = 0; i < SUS_MEMORY_SITE_COUNT; i++) {
+		if (SUSMemoryTracker.sites[i].counters.blocks) susMemoryPrintSite(&SUSMemoryTracker.sites[i], TRUE);
+	}
+	ReleaseSRWLockShared(&SUSMemoryTracker.lock);
+	return blocks;
+}
+
+#endif // !SUS_MEMORY_TRACKING
+
+//////////////////////////////////////////////////////////////////
+//					Basic memory operations						//
+//////////////////////////////////////////////////////////////////
+
+// Copy the memory with the selected kernel
+static sus_lpbyte_t SUSAPI susMemcpyResolve(_Out_ sus_lpbyte_t buff, _In_ CONST sus_lpbyte_t source, _In_ size_t size);
+// Copy the overlapping memory with the selected kernel
+static sus_lpbyte_t SUSAPI susMemmoveResolve(_Out_ sus_lpbyte_t buff, _In_ CONST sus_lpbyte_t source, _In_ size_t size);
+// Initialize the memory with the selected kernel
+static VOID SUSAPI susMemsetResolve(_Out_ sus_lpbyte_t data, _In_ BYTE value, _In_ size_t size);
+// Compare the memory with the selected kernel
+static BOOL SUSAPI susMemcmpResolve(_In_ sus_lpbyte_t lpBuf1, _In_ sus_lpbyte_t lpBuf2, _In_ size_t size);
+// Check the memory for zeros with the selected kernel
+static BOOL SUSAPI susMemiszeroResolve(_In_ sus_lpbyte_t lpBuff, _In_ size_t size);
+// Find the element with the selected kernel
+static size_t SUSAPI susMemfindResolve(_In_ sus_lpbyte_t data, _In_ size_t count, _In_ sus_lpbyte_t key, _In_ size_t size);
+
+// Current kernels (resolved on the first call)
+static SUS_MEMORY_KERNELS SUSMemoryKernels = {
+	susMemcpyResolve, susMemmoveResolve, susMemsetResolve, susMemcmpResolve, susMemiszeroResolve, susMemfindResolve
+};
+
+// Select the instruction set of the memory operations
+SUS_MEMORY_ISA SUSAPI sus_memselect(_In_ SUS_MEMORY_ISA isa)
+{
+	SUS_MEMORY_ISA best = susMemoryDetectIsa();
+	if (isa == SUS_MEMORY_ISA_AUTO || isa > best) isa = best;
+	SUS_PRINTDL("Memory operations use the instruction set %d", isa);
+	SUSMemoryKernels = *susMemoryGetKernels(isa);
+	return isa;
+}
+
+static sus_lpbyte_t SUSAPI susMemcpyResolve(_Out_ sus_lpbyte_t buff, _In_ CONST sus_lpbyte_t source, _In_ size_t size) {
+	sus_memselect(SUS_MEMORY_ISA_AUTO);
+	return SUSMemoryKernels.copy(buff, source, size);
+}
+static sus_lpbyte_t SUSAPI susMemmoveResolve(_Out_ sus_lpbyte_t buff, _In_ CONST sus_lpbyte_t source, _In_ size_t size) {
+	sus_memselect(SUS_MEMORY_ISA_AUTO);
+	return SUSMemoryKernels.move(buff, source, size);
+}
+static VOID SUSAPI susMemsetResolve(_Out_ sus_lpbyte_t data, _In_ BYTE value, _In_ size_t size) {
+	sus_memselect(SUS_MEMORY_ISA_AUTO);
+	SUSMemoryKernels.set(data, value, size);
+}
+static BOOL SUSAPI susMemcmpResolve(_In_ sus_lpbyte_t lpBuf1, _In_ sus_lpbyte_t lpBuf2, _In_ size_t size) {
+	sus_memselect(SUS_MEMORY_ISA_AUTO);
+	return SUSMemoryKernels.compare(lpBuf1, lpBuf2, size);
+}
+static BOOL SUSAPI susMemiszeroResolve(_In_ sus_lpbyte_t lpBuff, _In_ size_t size) {
+	sus_memselect(SUS_MEMORY_ISA_AUTO);
+	return SUSMemoryKernels.iszero(lpBuff, size);
+}
+static size_t SUSAPI susMemfindResolve(_In_ sus_lpbyte_t data, _In_ size_t count, _In_ sus_lpbyte_t key, _In_ size_t size) {
+	sus_memselect(SUS_MEMORY_ISA_AUTO);
+	return SUSMemoryKernels.find(data, count, key, size);
+}
+
+// -------------------------------------
+
+// Copy a block larger than SUS_MEMORY_INLINE_SIZE bytes
+sus_lpbyte_t SUSAPI sus_memcpyLarge(_Out_writes_bytes_all_(size) sus_lpbyte_t buff, _In_reads_bytes_(size) CONST sus_lpbyte_t source, _In_ SIZE_T size) {
+	return SUSMemoryKernels.copy(buff, source, size);
+}
+// Copy an overlapping block larger than SUS_MEMORY_INLINE_SIZE bytes
+sus_lpbyte_t SUSAPI sus_memmoveLarge(_Out_writes_bytes_all_(size) sus_lpbyte_t buff, _In_reads_bytes_(size) CONST sus_lpbyte_t source, _In_ SIZE_T size) {
+	return SUSMemoryKernels.move(buff, source, size);
+}
+// Initialize a block larger than SUS_MEMORY_INLINE_SIZE bytes
+VOID SUSAPI sus_memsetLarge(_Out_writes_bytes_all_(size) sus_lpbyte_t data, _In_ BYTE value, _In_ SIZE_T size) {
+	SUSMemoryKernels.set(data, value, size);
+}
+// Compare blocks larger than SUS_MEMORY_INLINE_SIZE bytes
+BOOL SUSAPI sus_memcmpLarge(_In_bytecount_(size) sus_lpbyte_t lpBuf1, _In_bytecount_(size) sus_lpbyte_t lpBuf2, _In_ SIZE_T size) {
+	return SUSMemoryKernels.compare(lpBuf1, lpBuf2, size);
+}
+// Check a block larger than SUS_MEMORY_INLINE_SIZE bytes for zeros
+BOOL SUSAPI sus_memiszeroLarge(_In_bytecount_(size) sus_lpbyte_t lpBuff, _In_ SIZE_T size) {
+	return SUSMemoryKernels.iszero(lpBuff, size);
+}
+// Find the first element equal to the key in an array of 1, 2, 4, 8 or 16-byte elements
+SIZE_T SUSAPI sus_memfind(_In_reads_bytes_(count * size) sus_lpbyte_t data, _In_ SIZE_T count, _In_reads_bytes_(size) sus_lpbyte_t key, _In_ SIZE_T size) {
+	SUS_ASSERT(data && key && sus_memfindable(size));
+	return SUSMemoryKernels.find(data, count, key, size);
+}
+
+//////////////////////////////////////////////////////////////////
+//						Shared byte slices						//
+//////////////////////////////////////////////////////////////////
+
+// Create a new block of bytes
+SUS_BYTES SUSAPI susNewBytes(_In_ SIZE_T size)
+{
+	SUS_LPBYTES_BLOCK block = sus_malloc(sizeof(SUS_BYTES_BLOCK) + size + 1);
+	if (!block) return (SUS_BYTES) { 0 };
+	block->refCount = 1;
+	block->size = size;
+	block->data[size] = 0;
+	return (SUS_BYTES) { .data = block->data, .size = size, .block = block };
+}
+// Copy the data to a new block of bytes
+SUS_BYTES SUSAPI susBytesCopy(_In_ SUS_DATAVIEW data)
+{
+	SUS_ASSERT(data.data || !data.size);
+	SUS_BYTES bytes = susNewBytes(data.size);
+	if (bytes.data && data.size) sus_memcpy(bytes.data, data.data, data.size);
+	return bytes;
+}
+// Change the size of an unpublished block of bytes
+BOOL SUSAPI susBytesResize(_Inout_ SUS_LPBYTES bytes, _In_ SIZE_T size)
+{
+	SUS_ASSERT(bytes);
+	if (!bytes->block) {
+		SUS_ASSERT(!bytes->data);
+		*bytes = susNewBytes(size);
+		return bytes->data ? TRUE : FALSE;
+	}
+	SUS_ASSERT(bytes->block->refCount == 1 && bytes->data == bytes->block->data);
+	SUS_LPBYTES_BLOCK block = sus_realloc(bytes->block, sizeof(SUS_BYTES_BLOCK) + size + 1);
+	if (!block) return FALSE;
+	block->size = size;
+	block->data[size] = 0;
+	*bytes = (SUS_BYTES) { .data = block->data, .size = size, .block = block };
+	return TRUE;
+}
+
 //////////////////////////////////////////////////////////////////
 //					Dynamic virtual memory						//
 //////////////////////////////////////////////////////////////////
@@ -114,4 +799,544 @@ SUS_LPMEMORY SUSAPI sus_vmalloc(
 		return NULL;
 	}
 	return hMem;
-}
\ No newline at end of file
+}
+//////////////////////////////////////////////////////////////////
+//						Aligned allocator						//
+//////////////////////////////////////////////////////////////////
+
+// Shared aligned allocators
+static struct sus_aligned_allocators {
+	SRWLOCK					lock;									// Lock of the table
+	sus_uint_t				count;									// Number of the allocators
+	SUS_ALIGNED_ALLOCATOR	allocators[SUS_ALIGNED_ALLOCATOR_COUNT];	// Allocators
+} SUSAlignedAllocators = { .lock = SRWLOCK_INIT };
+
+// Allocator interface: allocate an aligned block
+static SUS_LPMEMORY SUSAPI susAlignedAllocatorAlloc(_Inout_ SUS_LPALLOCATOR allocator, _In_ SIZE_T size)
+{
+	SUS_LPALIGNED_ALLOCATOR aligned = (SUS_LPALIGNED_ALLOCATOR)allocator;
+	SUS_LPMEMORY block = sus_malloc_alignedEx(size, aligned->alignment, aligned->offset);
+	if (block) sus_zeromem(block, size);
+	return block;
+}
+// Allocator interface: resize an aligned block
+static SUS_LPMEMORY SUSAPI susAlignedAllocatorRealloc(_Inout_ SUS_LPALLOCATOR allocator, _In_opt_ SUS_LPMEMORY block, _In_ SIZE_T oldSize, _In_ SIZE_T newSize)
+{
+	SUS_LPALIGNED_ALLOCATOR aligned = (SUS_LPALIGNED_ALLOCATOR)allocator;
+	SUS_LPMEMORY newBlock = sus_malloc_alignedEx(newSize, aligned->alignment, aligned->offset);
+	if (!newBlock) return NULL;
+	if (block) {
+		sus_memcpy(newBlock, block, min(oldSize, newSize));
+		sus_free_aligned(block);
+	}
+	return newBlock;
+}
+// Allocator interface: free an aligned block
+static VOID SUSAPI susAlignedAllocatorFree(_Inout_ SUS_LPALLOCATOR allocator, _In_ SUS_LPMEMORY block, _In_ SIZE_T size)
+{
+	UNREFERENCED_PARAMETER(allocator);
+	UNREFERENCED_PARAMETER(size);
+	sus_free_aligned(block);
+}
+
+// Get the shared heap allocator that aligns the address block + offset
+SUS_LPALLOCATOR SUSAPI susAlignedAllocator(_In_ SIZE_T alignment, _In_ SIZE_T offset)
+{
+	SUS_ASSERT(alignment && !(alignment & (alignment - 1)));
+	SUS_LPALLOCATOR allocator = NULL;
+	AcquireSRWLockExclusive(&SUSAlignedAllocators.lock);
+	for (sus_uint_t i = 0; i < SUSAlignedAllocators.count; i++) {
+		SUS_LPALIGNED_ALLOCATOR aligned = &SUSAlignedAllocators.allocators[i];
+		if (aligned->alignment == alignment && aligned->offset == offset) {
+			allocator = &aligned->super;
+			break;
+		}
+	}
+	if (!allocator && SUSAlignedAllocators.count < SUS_ALIGNED_ALLOCATOR_COUNT) {
+		SUS_LPALIGNED_ALLOCATOR aligned = &SUSAlignedAllocators.allocators[SUSAlignedAllocators.count++];
+		*aligned = (SUS_ALIGNED_ALLOCATOR) {
+			.super = {
+				.allocate = susAlignedAllocatorAlloc,
+				.reallocate = susAlignedAllocatorRealloc,
+				.release = susAlignedAllocatorFree
+			},
+			.alignment = alignment,
+			.offset = offset
+		};
+		allocator = &aligned->super;
+	}
+	ReleaseSRWLockExclusive(&SUSAlignedAllocators.lock);
+	if (!allocator) {
+		SUS_PRINTDE("Too many aligned allocators");
+		susErrorPush(SUS_ERROR_STACK_OVERFLOW, SUS_ERROR_TYPE_MEMORY);
+	}
+	return allocator;
+}
+
+//////////////////////////////////////////////////////////////////
+//						Arena allocator							//
+//////////////////////////////////////////////////////////////////
+
+// Allocator interface: allocate a block
+static SUS_LPMEMORY SUSAPI susArenaAllocatorAlloc(_Inout_ SUS_LPALLOCATOR allocator, _In_ SIZE_T size) {
+	return susArenaAlloc((SUS_LPARENA)allocator, size);
+}
+// Allocator interface: resize a block
+static SUS_LPMEMORY SUSAPI susArenaAllocatorRealloc(_Inout_ SUS_LPALLOCATOR allocator, _In_opt_ SUS_LPMEMORY block, _In_ SIZE_T oldSize, _In_ SIZE_T newSize) {
+	return susArenaRealloc((SUS_LPARENA)allocator, block, oldSize, newSize);
+}
+// Allocator interface: free a block
+static VOID SUSAPI susArenaAllocatorFree(_Inout_ SUS_LPALLOCATOR allocator, _In_ SUS_LPMEMORY block, _In_ SIZE_T size) {
+	UNREFERENCED_PARAMETER(size);
+	susArenaFree((SUS_LPARENA)allocator, block);
+}
+
+// Create an arena
+SUS_ARENA SUSAPI susArenaSetupEx(_In_opt_ SIZE_T chunkSize, _In_ SUS_ARENA_FLAGS flags)
+{
+	SUS_PRINTDL("Creating a new arena");
+	SUS_ASSERT(!chunkSize || chunkSize > sizeof(SUS_ARENA_CHUNK));
+	return (SUS_ARENA) {
+		.super = {
+			.allocate = susArenaAllocatorAlloc,
+			.reallocate = susArenaAllocatorRealloc,
+			.release = susArenaAllocatorFree
+		},
+		.chunkSize = chunkSize ? chunkSize : SUS_ARENA_CHUNK_SIZE,
+		.flags = flags
+	};
+}
+// Free the chunk memory
+static VOID SUSAPI susArenaChunkDestroy(_In_ SUS_LPARENA arena, _In_ SUS_LPARENA_CHUNK chunk) {
+	if (arena->flags & SUS_ARENA_FLAG_VIRTUAL) sus_vfree(chunk);
+	else sus_free(chunk);
+}
+// Free all arena memory
+VOID SUSAPI susArenaCleanup(_Inout_ SUS_LPARENA arena)
+{
+	SUS_PRINTDL("Deleting an arena");
+	SUS_ASSERT(arena);
+	susArenaReset(arena);
+	while (arena->spare) {
+		SUS_LPARENA_CHUNK chunk = arena->spare;
+		arena->spare = chunk->prev;
+		susArenaChunkDestroy(arena, chunk);
+	}
+}
+
+// -------------------------------------
+
+// Get the aligned offset of the next block in the chunk
+static SUS_INLINE SIZE_T SUSAPI susArenaChunkAlign(_In_ SUS_LPARENA_CHUNK chunk) {
+	return (SIZE_T)(SUS_ALIGN((ULONG_PTR)chunk->data + chunk->offset, SUS_ARENA_ALIGNMENT) - (ULONG_PTR)chunk->data);
+}
+// Add a chunk that fits the block to the arena
+static SUS_LPARENA_CHUNK SUSAPI susArenaGrow(_Inout_ SUS_LPARENA arena, _In_ SIZE_T size)
+{
+	SIZE_T capacity = max(arena->chunkSize - sizeof(SUS_ARENA_CHUNK), size + SUS_ARENA_ALIGNMENT);
+	SUS_LPARENA_CHUNK chunk = NULL;
+	for (SUS_LPARENA_CHUNK* lpSpare = &arena->spare; *lpSpare; lpSpare = &(*lpSpare)->prev) {
+		if ((*lpSpare)->size >= capacity) {
+			chunk = *lpSpare;
+			*lpSpare = chunk->prev;
+			break;
+		}
+	}
+	if (!chunk) {
+		SUS_PRINTDL("Allocating a new arena chunk of %d bytes", capacity);
+		chunk = (arena->flags & SUS_ARENA_FLAG_VIRTUAL)
+			? sus_vmalloc(sizeof(SUS_ARENA_CHUNK) + capacity, SUS_MEMORY_PROTECT_READWRITE)
+			: sus_malloc(sizeof(SUS_ARENA_CHUNK) + capacity);
+		if (!chunk) return NULL;
+		chunk->size = capacity;
+	}
+	chunk->offset = 0;
+	chunk->prev = arena->chunk;
+	arena->chunk = chunk;
+	return chunk;
+}
+
+// Allocate a block in the arena
+SUS_LPMEMORY SUSAPI susArenaAlloc(_Inout_ SUS_LPARENA arena, _In_ SIZE_T size)
+{
+	SUS_ASSERT(arena);
+	SUS_LPARENA_CHUNK chunk = arena->chunk;
+	SIZE_T offset = chunk ? susArenaChunkAlign(chunk) : 0;
+	if (!chunk || offset + size > chunk->size) {
+		chunk = susArenaGrow(arena, size);
+		if (!chunk) return NULL;
+		offset = susArenaChunkAlign(chunk);
+	}
+	sus_lpbyte_t block = chunk->data + offset;
+	chunk->offset = offset + size;
+	if (size) sus_zeromem(block, size);
+	arena->last = block;
+	return block;
+}
+// Change the size of the block (the last block grows in place)
+SUS_LPMEMORY SUSAPI susArenaRealloc(_Inout_ SUS_LPARENA arena, _In_opt_ SUS_LPMEMORY block, _In_ SIZE_T oldSize, _In_ SIZE_T newSize)
+{
+	SUS_ASSERT(arena);
+	if (!block) return susArenaAlloc(arena, newSize);
+	SUS_LPARENA_CHUNK chunk = arena->chunk;
+	if (block == arena->last && (sus_lpbyte_t)block + newSize <= chunk->data + chunk->size) {
+		SIZE_T blockSize = (SIZE_T)(chunk->data + chunk->offset - (sus_lpbyte_t)block);
+		if (newSize > blockSize) sus_zeromem((sus_lpbyte_t)block + blockSize, newSize - blockSize);
+		chunk->offset = (SIZE_T)((sus_lpbyte_t)block - chunk->data) + newSize;
+		return block;
+	}
+	if (newSize <= oldSize) return block;
+	SUS_LPMEMORY newBlock = susArenaAlloc(arena, newSize);
+	if (!newBlock) return NULL;
+	sus_memcpy(newBlock, block, oldSize);
+	return newBlock;
+}
+// Free the block (only the last block is returned to the arena)
+VOID SUSAPI susArenaFree(_Inout_ SUS_LPARENA arena, _In_ SUS_LPMEMORY block)
+{
+	SUS_ASSERT(arena);
+	if (!block || block != arena->last) return;
+	arena->chunk->offset = (SIZE_T)((sus_lpbyte_t)block - arena->chunk->data);
+	arena->last = NULL;
+}
+// Free all blocks allocated after the mark
+VOID SUSAPI susArenaRewind(_Inout_ SUS_LPARENA arena, _In_ SUS_ARENA_MARK mark)
+{
+	SUS_ASSERT(arena);
+	while (arena->chunk != mark.chunk) {
+		SUS_LPARENA_CHUNK chunk = arena->chunk;
+		SUS_ASSERT(chunk);
+		arena->chunk = chunk->prev;
+		chunk->prev = arena->spare;
+		arena->spare = chunk;
+	}
+	if (arena->chunk) arena->chunk->offset = mark.offset;
+	arena->last = NULL;
+}
+
+//////////////////////////////////////////////////////////////////
+//						Pool allocator							//
+//////////////////////////////////////////////////////////////////
+
+// Lock the pool
+static SUS_INLINE VOID SUSAPI susPoolLock(_Inout_ SUS_LPPOOL pool) {
+	if (pool->flags & SUS_POOL_FLAG_THREAD_AFFINE) SUS_ASSERT(pool->owner == GetCurrentThreadId());
+	else AcquireSRWLockExclusive(&pool->lock);
+}
+// Unlock the pool
+static SUS_INLINE VOID SUSAPI susPoolUnlock(_Inout_ SUS_LPPOOL pool) {
+	if (!(pool->flags & SUS_POOL_FLAG_THREAD_AFFINE)) ReleaseSRWLockExclusive(&pool->lock);
+}
+
+// Allocator interface: allocate a block
+static SUS_LPMEMORY SUSAPI susPoolAllocatorAlloc(_Inout_ SUS_LPALLOCATOR allocator, _In_ SIZE_T size) {
+	SUS_LPPOOL pool = (SUS_LPPOOL)allocator;
+	return size <= pool->objectSize ? susPoolAlloc(pool) : sus_zalloc(size);
+}
+// Allocator interface: free a block
+static VOID SUSAPI susPoolAllocatorFree(_Inout_ SUS_LPALLOCATOR allocator, _In_ SUS_LPMEMORY block, _In_ SIZE_T size) {
+	SUS_LPPOOL pool = (SUS_LPPOOL)allocator;
+	if (size <= pool->objectSize) susPoolFree(pool, block);
+	else sus_free(block);
+}
+// Allocator interface: resize a block
+static SUS_LPMEMORY SUSAPI susPoolAllocatorRealloc(_Inout_ SUS_LPALLOCATOR allocator, _In_opt_ SUS_LPMEMORY block, _In_ SIZE_T oldSize, _In_ SIZE_T newSize)
+{
+	SUS_LPPOOL pool = (SUS_LPPOOL)allocator;
+	if (!block) return susPoolAllocatorAlloc(allocator, newSize);
+	if (oldSize > pool->objectSize && newSize > pool->objectSize) {
+		SUS_LPMEMORY newBlock = sus_realloc(block, newSize);
+		if (newBlock && newSize > oldSize) sus_zeromem((sus_lpbyte_t)newBlock + oldSize, newSize - oldSize);
+		return newBlock;
+	}
+	if (oldSize <= pool->objectSize && newSize <= pool->objectSize) {
+		if (newSize > oldSize) sus_zeromem((sus_lpbyte_t)block + oldSize, newSize - oldSize);
+		return block;
+	}
+	SUS_LPMEMORY newBlock = susPoolAllocatorAlloc(allocator, newSize);
+	if (!newBlock) return NULL;
+	sus_memcpy(newBlock, block, min(oldSize, newSize));
+	if (newSize > oldSize) sus_zeromem((sus_lpbyte_t)newBlock + oldSize, newSize - oldSize);
+	susPoolAllocatorFree(allocator, block, oldSize);
+	return newBlock;
+}
+
+// Create a pool of objects
+SUS_POOL SUSAPI susPoolSetupEx(_In_ SIZE_T objectSize, _In_opt_ SIZE_T slabSize, _In_ SUS_POOL_FLAGS flags)
+{
+	SUS_PRINTDL("Creating a pool of %d byte objects", objectSize);
+	SUS_ASSERT(objectSize);
+	objectSize = SUS_ALIGN(max(objectSize, sizeof(SUS_LPMEMORY)), SUS_POOL_ALIGNMENT);
+	slabSize = max(slabSize ? slabSize : SUS_POOL_SLAB_SIZE, sizeof(SUS_POOL_SLAB) + SUS_POOL_ALIGNMENT + objectSize * SUS_POOL_SLAB_MIN_OBJECTS);
+	return (SUS_POOL) {
+		.super = {
+			.allocate = susPoolAllocatorAlloc,
+			.reallocate = susPoolAllocatorRealloc,
+			.release = susPoolAllocatorFree
+		},
+		.objectSize = objectSize,
+		.slabSize = SUS_ALIGN(slabSize, SUS_POOL_SLAB_SIZE),
+		.flags = flags,
+		.owner = GetCurrentThreadId(),
+		.lock = SRWLOCK_INIT
+	};
+}
+// Free all pool objects at once (the pool stays usable)
+VOID SUSAPI susPoolCleanup(_Inout_ SUS_LPPOOL pool)
+{
+	SUS_PRINTDL("Freeing the pool objects");
+	SUS_ASSERT(pool);
+	susPoolLock(pool);
+	while (pool->slabs) {
+		SUS_LPPOOL_SLAB slab = pool->slabs;
+		pool->slabs = slab->next;
+		sus_free(slab);
+	}
+	pool->freeList = NULL;
+	pool->cursor = pool->end = NULL;
+	susPoolUnlock(pool);
+}
+
+// Allocate an object in the pool
+SUS_LPMEMORY SUSAPI susPoolAlloc(_Inout_ SUS_LPPOOL pool)
+{
+	SUS_ASSERT(pool);
+	susPoolLock(pool);
+	sus_lpbyte_t block = pool->freeList;
+	if (block) pool->freeList = *(SUS_LPMEMORY*)block;
+	else {
+		if (!pool->cursor || pool->cursor + pool->objectSize > pool->end) {
+			SUS_LPPOOL_SLAB slab = sus_malloc(pool->slabSize);
+			if (!slab) {
+				susPoolUnlock(pool);
+				return NULL;
+			}
+			slab->next = pool->slabs;
+			pool->slabs = slab;
+			pool->cursor = (sus_lpbyte_t)SUS_ALIGN((ULONG_PTR)slab->data, SUS_POOL_ALIGNMENT);
+			pool->end = (sus_lpbyte_t)slab + pool->slabSize;
+		}
+		block = pool->cursor;
+		pool->cursor += pool->objectSize;
+	}
+	susPoolUnlock(pool);
+	sus_zeromem(block, pool->objectSize);
+	return block;
+}
+// Return the object to the pool
+VOID SUSAPI susPoolFree(_Inout_ SUS_LPPOOL pool, _In_ SUS_LPMEMORY block)
+{
+	SUS_ASSERT(pool);
+	if (!block) return;
+	susPoolLock(pool);
+	*(SUS_LPMEMORY*)block = pool->freeList;
+	pool->freeList = block;
+	susPoolUnlock(pool);
+}
+
+// Create a pool in the heap
+SUS_LPPOOL SUSAPI susNewPool(_In_ SIZE_T objectSize, _In_ SUS_POOL_FLAGS flags)
+{
+	SUS_LPPOOL pool = sus_malloc(sizeof(SUS_POOL));
+	if (!pool) return NULL;
+	*pool = susPoolSetupEx(objectSize, 0, flags);
+	return pool;
+}
+// Delete a pool from the heap
+VOID SUSAPI susPoolDestroy(_In_ SUS_LPPOOL pool)
+{
+	SUS_ASSERT(pool);
+	susPoolCleanup(pool);
+	sus_free(pool);
+}
+
+//////////////////////////////////////////////////////////////////
+//					Virtual memory region						//
+//////////////////////////////////////////////////////////////////
+
+// Reserve the address range
+static SUS_LPMEMORY SUSAPI susVRegionReservePages(_Inout_ SIZE_T* size, _Inout_ SUS_VREGION_FLAGS* flags)
+{
+#ifdef _WIN32
+	if (*flags & SUS_VREGION_FLAG_LARGE_PAGES) {
+		SIZE_T largePage = GetLargePageMinimum();
+		if (largePage) {
+			SIZE_T largeSize = SUS_ALIGN(*size, largePage);
+			SUS_LPMEMORY base = VirtualAlloc(NULL, largeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (base) {
+				*size = largeSize;
+				return base;
+			}
+		}
+		SUS_PRINTDW("Large pages are not available, the region uses regular pages");
+		*flags &= ~SUS_VREGION_FLAG_LARGE_PAGES;
+	}
+	*size = SUS_ALIGN(*size, SUS_VREGION_COMMIT_SIZE);
+	return sus_vmallocEx(GetCurrentProcess(), NULL, *size, MEM_RESERVE, PAGE_READWRITE);
+#else
+	*size = SUS_ALIGN(*size, SUS_VREGION_COMMIT_SIZE);
+	SUS_LPMEMORY base = mmap(NULL, *size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED) return NULL;
+	if (*flags & SUS_VREGION_FLAG_LARGE_PAGES) madvise(base, *size, MADV_HUGEPAGE);
+	*flags &= ~SUS_VREGION_FLAG_LARGE_PAGES;
+	return base;
+#endif // !_WIN32
+}
+// Commit the pages of the range
+static BOOL SUSAPI susVRegionCommitPages(_In_ sus_lpbyte_t address, _In_ SIZE_T size)
+{
+#ifdef _WIN32
+	return sus_vmallocEx(GetCurrentProcess(), address, size, MEM_COMMIT, PAGE_READWRITE) ? TRUE : FALSE;
+#else
+	return mprotect(address, size, PROT_READ | PROT_WRITE) ? FALSE : TRUE;
+#endif // !_WIN32
+}
+// Decommit the pages of the range
+static VOID SUSAPI susVRegionDecommitPages(_In_ sus_lpbyte_t address, _In_ SIZE_T size)
+{
+#ifdef _WIN32
+	VirtualFree(address, size, MEM_DECOMMIT);
+#else
+	madvise(address, size, MADV_DONTNEED);
+	mprotect(address, size, PROT_NONE);
+#endif // !_WIN32
+}
+// Release the address range
+static VOID SUSAPI susVRegionReleasePages(_In_ sus_lpbyte_t address, _In_ SIZE_T size)
+{
+#ifdef _WIN32
+	UNREFERENCED_PARAMETER(size);
+	VirtualFree(address, 0, MEM_RELEASE);
+#else
+	munmap(address, size);
+#endif // !_WIN32
+}
+
+// -------------------------------------
+
+// Allocator interface: allocate the region block
+static SUS_LPMEMORY SUSAPI susVRegionAllocatorAlloc(_Inout_ SUS_LPALLOCATOR allocator, _In_ SIZE_T size)
+{
+	SUS_LPVREGION region = (SUS_LPVREGION)allocator;
+	if (region->size) {
+		SUS_PRINTDE("The region already contains a block");
+		susErrorPush(SUS_ERROR_INVALID_OPERATION, SUS_ERROR_TYPE_MEMORY);
+		return NULL;
+	}
+	if (!susVRegionCommit(region, size)) return NULL;
+	region->size = size;
+	return region->data;
+}
+// Allocator interface: resize the region block in place
+static SUS_LPMEMORY SUSAPI susVRegionAllocatorRealloc(_Inout_ SUS_LPALLOCATOR allocator, _In_opt_ SUS_LPMEMORY block, _In_ SIZE_T oldSize, _In_ SIZE_T newSize)
+{
+	UNREFERENCED_PARAMETER(oldSize);
+	SUS_LPVREGION region = (SUS_LPVREGION)allocator;
+	if (!block) return susVRegionAllocatorAlloc(allocator, newSize);
+	SUS_ASSERT(block == region->data);
+	if (newSize > region->size) {
+		if (!susVRegionCommit(region, newSize)) return NULL;
+	}
+	else if (region->flags & SUS_VREGION_FLAG_DECOMMIT) susVRegionDecommit(region, newSize);
+	region->size = newSize;
+	return block;
+}
+// Allocator interface: free the region block
+static VOID SUSAPI susVRegionAllocatorFree(_Inout_ SUS_LPALLOCATOR allocator, _In_ SUS_LPMEMORY block, _In_ SIZE_T size)
+{
+	UNREFERENCED_PARAMETER(size);
+	SUS_LPVREGION region = (SUS_LPVREGION)allocator;
+	if (!block) return;
+	SUS_ASSERT(block == region->data);
+	if (region->flags & SUS_VREGION_FLAG_EMBEDDED) {
+		susVRegionDestroy(region);
+		return;
+	}
+	// The pages are zeroed again when they are committed the next time
+	if (region->flags & SUS_VREGION_FLAG_LARGE_PAGES) sus_zeromem(region->data, region->size);
+	else susVRegionDecommit(region, 0);
+	region->size = 0;
+}
+
+// -------------------------------------
+
+// Reserve a region of the address space
+SUS_VREGION SUSAPI susVRegionSetup(_In_ SIZE_T reserve, _In_ SUS_VREGION_FLAGS flags)
+{
+	SUS_PRINTDL("Reserving a region of %d bytes", reserve);
+	SUS_ASSERT(reserve);
+	flags &= ~SUS_VREGION_FLAG_EMBEDDED;
+	sus_lpbyte_t base = susVRegionReservePages(&reserve, &flags);
+	if (!base) return (SUS_VREGION) { 0 };
+	return (SUS_VREGION) {
+		.super = {
+			.allocate = susVRegionAllocatorAlloc,
+			.reallocate = susVRegionAllocatorRealloc,
+			.release = susVRegionAllocatorFree
+		},
+		.base = base,
+		.data = base,
+		.reserved = reserve,
+		.committed = (flags & SUS_VREGION_FLAG_LARGE_PAGES) ? reserve : 0,
+		.flags = flags
+	};
+}
+// Release the region
+VOID SUSAPI susVRegionCleanup(_Inout_ SUS_LPVREGION region)
+{
+	SUS_PRINTDL("Releasing the region");
+	SUS_ASSERT(region);
+	if (!region->base) return;
+	susVRegionReleasePages(region->base, region->reserved);
+	region->base = region->data = NULL;
+	region->reserved = region->committed = region->size = 0;
+}
+// Make the first bytes of the region block accessible
+BOOL SUSAPI susVRegionCommit(_Inout_ SUS_LPVREGION region, _In_ SIZE_T size)
+{
+	SUS_ASSERT(region && region->base);
+	SIZE_T end = (SIZE_T)(region->data - region->base) + size;
+	if (end <= region->committed) return TRUE;
+	if (end > region->reserved) {
+		SUS_PRINTDE("The region of %d bytes is exhausted", region->reserved);
+		susErrorPush(SUS_ERROR_OUT_OF_MEMORY, SUS_ERROR_TYPE_MEMORY);
+		return FALSE;
+	}
+	SIZE_T committed = min(SUS_ALIGN(max(end, region->committed + region->committed / 2), SUS_VREGION_COMMIT_SIZE), region->reserved);
+	if (!susVRegionCommitPages(region->base + region->committed, committed - region->committed)) return FALSE;
+	region->committed = committed;
+	return TRUE;
+}
+// Return the pages of the region block beyond the size to the system
+VOID SUSAPI susVRegionDecommit(_Inout_ SUS_LPVREGION region, _In_ SIZE_T size)
+{
+	SUS_ASSERT(region && region->base);
+	if (region->flags & SUS_VREGION_FLAG_LARGE_PAGES) return;
+	SIZE_T committed = SUS_ALIGN((SIZE_T)(region->data - region->base) + size, SUS_VREGION_COMMIT_SIZE);
+	if (committed >= region->committed) return;
+	susVRegionDecommitPages(region->base + committed, region->committed - committed);
+	region->committed = committed;
+}
+
+// Create a region stored in its own first page
+SUS_LPVREGION SUSAPI susNewVRegion(_In_ SIZE_T reserve, _In_ SUS_VREGION_FLAGS flags)
+{
+	SIZE_T header = SUS_ALIGN(sizeof(SUS_VREGION), MEMORY_ALLOCATION_ALIGNMENT);
+	SUS_VREGION setup = susVRegionSetup(header + reserve, flags);
+	if (!setup.base) return NULL;
+	if (!susVRegionCommit(&setup, header)) {
+		susVRegionCleanup(&setup);
+		return NULL;
+	}
+	SUS_LPVREGION region = (SUS_LPVREGION)setup.base;
+	*region = setup;
+	region->data = region->base + header;
+	region->flags |= SUS_VREGION_FLAG_EMBEDDED;
+	return region;
+}
+// Delete a region stored in its own first page
+VOID SUSAPI susVRegionDestroy(_In_ SUS_LPVREGION region)
+{
+	SUS_ASSERT(region && (region->flags & SUS_VREGION_FLAG_EMBEDDED));
+	susVRegionReleasePages(region->base, region->reserved);
+}
@@ -1,13 +1,21 @@
 // network.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_NET
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/thrprocessapi.h"
 #include "include/susfwk/buffer.h"
+#include "include/susfwk/chain.h"
 #include "include/susfwk/vector.h"
 #include "include/susfwk/hashtable.h"
+#include "include/susfwk/atom.h"
 #include "include/susfwk/network.h"
 
+// Vector of the client poll descriptors
+SUS_DECLARE_VECTOR(susPollFdVector, WSAPOLLFD)
+// Vector of the client sockets
+SUS_DECLARE_VECTOR(susSocketVector, SUS_SOCKET)
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 //									Basic socket operations											//
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -99,7 +107,6 @@ static VOID SUSAPI susSocketCleanup(_Inout_ SUS_LPSOCKET sock)
 		sock->timers = NULL;
 	}
 	if (sock->properties) {
-		susMapForeach(sock->properties, i) sus_free(*(LPSTR*)susMapIterKey(i));
 		susMapDestroy(sock->properties);
 		sock->properties = NULL;
 	}
@@ -307,30 +314,41 @@ static VOID SUSAPI susSocketTimersStart(_In_ SUS_LPSOCKET sock) {
 
 // -----------------------------------------------
 
-// Set a property for a socket
-BOOL SUSAPI susSocketSetProperty(_Inout_ SUS_LPSOCKET sock, _In_ LPCSTR key, _In_ SUS_USERDATA property)
+// Set a property for a socket by the atom key
+BOOL SUSAPI susSocketSetPropertyAtom(_Inout_ SUS_LPSOCKET sock, _In_ SUS_ATOM key, _In_ SUS_USERDATA property)
 {
 	SUS_PRINTDL("Setting a new property - '%s'", key);
 	SUS_ASSERT(sock && key);
-	if (!sock->properties && !(sock->properties = susNewStringMap(SUS_USERDATA))) return FALSE;
-	if (susMapContains(sock->properties, (SUS_OBJECT)&key)) return susMapSet(&sock->properties, &key, &property) ? TRUE : FALSE;
-	key = sus_strdup(key);
-	if (!susMapAdd(&sock->properties, &key, &property)) {
+	if (!sock->properties && !(sock->properties = susNewAtomMap(SUS_USERDATA))) return FALSE;
+	if (!susMapSet(&sock->properties, &key, &property)) {
 		SUS_PRINTDE("Couldn't create property");
-		sus_strfree((LPSTR)key);
 		return FALSE;
 	}
 	return TRUE;
 }
-// Get a property from a socket
-SUS_USERDATA SUSAPI susSocketGetProperty(_In_ SUS_LPSOCKET sock, _In_ LPCSTR key)
+// Get a property from a socket by the atom key
+SUS_USERDATA SUSAPI susSocketGetPropertyAtom(_In_ SUS_LPSOCKET sock, _In_ SUS_ATOM key)
 {
-	SUS_PRINTDL("Getting socket properties - '%s'", key);
 	SUS_ASSERT(sock && key && sock->properties);
 	if (!sock->properties) return 0;
 	SUS_USERDATA* param = susMapGet(sock->properties, &key);
 	return param ? *param : 0;
 }
+// Set a property for a socket
+BOOL SUSAPI susSocketSetProperty(_Inout_ SUS_LPSOCKET sock, _In_ LPCSTR key, _In_ SUS_USERDATA property)
+{
+	SUS_ASSERT(sock && key);
+	SUS_ATOM atom = susAtom(key);
+	return atom ? susSocketSetPropertyAtom(sock, atom, property) : FALSE;
+}
+// Get a property from a socket
+SUS_USERDATA SUSAPI susSocketGetProperty(_In_ SUS_LPSOCKET sock, _In_ LPCSTR key)
+{
+	SUS_PRINTDL("Getting socket properties - '%s'", key);
+	SUS_ASSERT(sock && key);
+	SUS_ATOM atom = susAtomFind(key);
+	return atom ? susSocketGetPropertyAtom(sock, atom) : 0;
+}
 
 // -----------------------------------------------
 
@@ -353,10 +371,15 @@ static sus_lpbyte_t SUSAPI susFindDoubleNull(_In_ sus_lpbyte_t data, _In_ sus_si
 BOOL SUSAPI susSocketRead(_Inout_ SUS_LPSOCKET sock)
 {
 	SUS_ASSERT(sock && sock->super != INVALID_SOCKET && sock->buffers.readBuffer);
-	sus_byte_t chunkBuffer[SUS_SOCKET_CHUNK_BUFFER_SIZE] = { 0 };
 	INT bytesRead;
 	do {
-		bytesRead = recv(sock->super, (PCHAR)chunkBuffer, (INT)sizeof(chunkBuffer), 0);
+		sus_lpbyte_t chunk = susBufferPrepare(&sock->buffers.readBuffer, SUS_SOCKET_CHUNK_BUFFER_SIZE);
+		if (!chunk) {
+			susSocketCallMessage(sock, SUS_SM_ERROR, (WPARAM)0, SUS_SOCKET_ERROR_FAILED_READ);
+			return FALSE;
+		}
+		bytesRead = recv(sock->super, (PCHAR)chunk, SUS_SOCKET_CHUNK_BUFFER_SIZE, 0);
+		if (bytesRead > 0) susBufferCommit(sock->buffers.readBuffer, bytesRead);
 		if (!bytesRead) {
 			susSocketShutdown(sock);
 			return FALSE;
@@ -367,19 +390,30 @@ BOOL SUSAPI susSocketRead(_Inout_ SUS_LPSOCKET sock)
 			susSocketCallMessage(sock, SUS_SM_ERROR, (WPARAM)err, SUS_SOCKET_ERROR_FAILED_READ);
 			return FALSE;
 		}
-		susBufferPush(&sock->buffers.readBuffer, chunkBuffer, bytesRead);
 		do {
-			sus_lpbyte_t endMsg = susFindDoubleNull(sock->buffers.readBuffer->data, sock->buffers.readBuffer->size);
+			sus_lpbyte_t message = susBufferReadData(sock->buffers.readBuffer);
+			sus_lpbyte_t endMsg = susFindDoubleNull(message, susBufferReadSize(sock->buffers.readBuffer));
 			if (!endMsg) break;
-			sus_size_t msgSize = (sus_size_t)(endMsg - sock->buffers.readBuffer->data);
-			if (msgSize) susSocketCallMessage(sock, SUS_SM_DATA, (WPARAM)msgSize, (LPARAM)sock->buffers.readBuffer->data);
-			susBufferErase(&sock->buffers.readBuffer, 0, (sus_size32_t)msgSize + 2);
-		} while (sock->buffers.readBuffer->size);
-		if (sock->buffers.readBuffer->size > SUS_SOCKET_MAX_MESSAGE_SIZE) if (sock->handler && !sock->handler(sock, SUS_SM_ERROR, (WPARAM)0, SUS_SOCKET_ERROR_BUFFER_OVERFLOW)) {
+			sus_size_t msgSize = (sus_size_t)(endMsg - message);
+			if (msgSize) susSocketCallMessage(sock, SUS_SM_DATA, (WPARAM)msgSize, (LPARAM)message);
+			susBufferConsume(sock->buffers.readBuffer, (sus_csize_t)msgSize + 2);
+		} while (susBufferReadSize(sock->buffers.readBuffer));
+		if (susBufferReadSize(sock->buffers.readBuffer) > SUS_SOCKET_MAX_MESSAGE_SIZE) if (sock->handler && !sock->handler(sock, SUS_SM_ERROR, (WPARAM)0, SUS_SOCKET_ERROR_BUFFER_OVERFLOW)) {
 			susSocketEnd(sock);
 			return FALSE;
 		}
-	} while (bytesRead == sizeof(chunkBuffer));
+	} while (bytesRead == SUS_SOCKET_CHUNK_BUFFER_SIZE);
+	return TRUE;
+}
+// Send the data of the chain to the socket
+BOOL SUSAPI susSocketWriteChain(_Inout_ SUS_LPSOCKET sock, _In_ SUS_LPCHAIN chain)
+{
+	SUS_PRINTDL("Socket write of %d bytes", chain->size);
+	SUS_ASSERT(sock && sock->buffers.writeBuffer && chain && chain->size < SUS_SOCKET_MAX_MESSAGE_SIZE);
+	// The space is reserved once and the blocks are copied into it
+	sus_lpbyte_t buff = susBufferPush(&sock->buffers.writeBuffer, NULL, (sus_csize_t)chain->size);
+	if (!buff) return FALSE;
+	susChainRead(chain, buff, chain->size);
 	return TRUE;
 }
 // Flushing the send buffer
@@ -387,15 +421,15 @@ sus_size_t SUSAPI susSocketFlush(_Inout_ SUS_LPSOCKET sock)
 {
 	SUS_ASSERT(sock && sock->super != INVALID_SOCKET && sock->buffers.writeBuffer);
 	susSocketCallMessage(sock, SUS_SM_WRITE, 0, 0);
-	while (sock->buffers.writeBuffer->size) {
-		INT bytesWrite = send(sock->super, (PCHAR)sock->buffers.writeBuffer->data, (INT)sock->buffers.writeBuffer->size, 0);
+	while (susBufferReadSize(sock->buffers.writeBuffer)) {
+		INT bytesWrite = send(sock->super, (PCHAR)susBufferReadData(sock->buffers.writeBuffer), (INT)susBufferReadSize(sock->buffers.writeBuffer), 0);
 		if (bytesWrite == SOCKET_ERROR) {
 			INT err = WSAGetLastError();
-			if (err == WSAEWOULDBLOCK) return sock->buffers.writeBuffer->size;
+			if (err == WSAEWOULDBLOCK) return susBufferReadSize(sock->buffers.writeBuffer);
 			susSocketCallMessage(sock, SUS_SM_ERROR, (WPARAM)err, (LPARAM)SUS_SOCKET_ERROR_FAILED_WRITE);
-			return sock->buffers.writeBuffer->size;
+			return susBufferReadSize(sock->buffers.writeBuffer);
 		}
-		susBufferErase(&sock->buffers.writeBuffer, 0, bytesWrite);
+		susBufferConsume(sock->buffers.writeBuffer, bytesWrite);
 		SUS_PRINTDL("The socket sent %d bytes", bytesWrite);
 	};
 	return 0;
@@ -414,8 +448,11 @@ SUS_SERVER_SOCKET SUSAPI susServerSetup(_In_opt_ SUS_SOCKET_HANDLER serverHandle
 {
 	SUS_PRINTDL("Creating a server");
 	SUS_SERVER_SOCKET server = { susSocketSetup(serverHandler, userData), .clientHandler = clientHandler };
-	server.clientfds = susNewVector(sizeof(WSAPOLLFD));
-	server.clients = susNewVector(sizeof(SUS_SOCKET));
+	server.clientfds = susPollFdVectorNew();
+	server.clients = susSocketVectorNew();
+	// Clients connect and disconnect all the time - do not reallocate the lists on every change
+	if (server.clientfds) susVectorSetPolicy(server.clientfds, SUS_GROWTH_POLICY_HYSTERESIS);
+	if (server.clients) susVectorSetPolicy(server.clients, SUS_GROWTH_POLICY_HYSTERESIS);
 	return server;
 }
 // Cleaning up server resources
@@ -423,7 +460,7 @@ static VOID SUSAPI susServerClose(_Inout_ SUS_LPSERVER_SOCKET server)
 {
 	SUS_ASSERT(server && server->clients && server->clientfds);
 	susSocketClose((SUS_LPSOCKET)server);
-	susVecForeach(i, server->clients) susSocketShutdown((SUS_LPSOCKET)susVectorAt(server->clients, i));
+	susVecForeach(i, server->clients) susSocketShutdown(susSocketVectorAt(server->clients, i));
 	susVectorDestroy(server->clientfds);
 	susVectorDestroy(server->clients);
 }
@@ -463,8 +500,11 @@ BOOL SUSAPI susServerListen(_Inout_ SUS_LPSERVER_SOCKET server, _In_ ADDRESS_FAM
 static BOOL SUSAPI susServerAddClient(_Inout_ SUS_LPSERVER_SOCKET server, _In_ SUS_LPSOCKET client) {
 	SUS_ASSERT(server && server->clientfds && server->clients && client);
 	WSAPOLLFD fd = { .fd = client->super, .events = POLLIN | POLLOUT, .revents = 0 };
-	if (!susVectorPush(&server->clientfds, &fd)) return FALSE;
-	if (!susVectorPush(&server->clients, client)) return FALSE;
+	if (!susPollFdVectorPush(&server->clientfds, fd)) return FALSE;
+	if (!susSocketVectorPush(&server->clients, *client)) {
+		susPollFdVectorPop(&server->clientfds);
+		return FALSE;
+	}
 	susSocketCallMessage(client, SUS_SM_START, (WPARAM)0, (LPARAM)0);
 	return TRUE;
 }
@@ -490,7 +530,7 @@ static VOID SUSAPI susServerRemoveClient(_Inout_ SUS_LPSERVER_SOCKET server, _In
 // Process a disconnected client
 static VOID SUSAPI susServerClientError(_Inout_ SUS_LPSERVER_SOCKET server, _In_ UINT index) {
 	SUS_ASSERT(server);
-	SUS_LPSOCKET client = susVectorAt(server->clients, index);
+	SUS_LPSOCKET client = susSocketVectorAt(server->clients, index);
 	susSocketClose(client);
 	susServerRemoveClient(server, index);
 	SUS_PRINTDL("Client %s caused a critical error", susSocketAddressToString(client->address));
@@ -498,7 +538,7 @@ static VOID SUSAPI susServerClientError(_Inout_ SUS_LPSERVER_SOCKET server, _In_
 // Process a disconnected client
 static VOID SUSAPI susServerClientClose(_Inout_ SUS_LPSERVER_SOCKET server, _In_ UINT index) {
 	SUS_ASSERT(server);
-	SUS_LPSOCKET client = susVectorAt(server->clients, index);
+	SUS_LPSOCKET client = susSocketVectorAt(server->clients, index);
 	susSocketShutdown(client);
 	susServerRemoveClient(server, index);
 	SUS_PRINTDL("Client %s has disconnected from the server", susSocketAddressToString(client->address));
@@ -532,13 +572,12 @@ static BOOL SUSAPI susServerClientsUpdate(_In_ SUS_LPSERVER_SOCKET server)
 {
 	SUS_ASSERT(server && server->clientfds && server->clients);
 	if (!server->clients->length) return TRUE;
-	INT pollResult = WSAPoll((WSAPOLLFD*)server->clientfds->data, server->clientfds->length, SUS_SOCKET_POLL_TIMEOUT);
+	INT pollResult = WSAPoll(susPollFdVectorData(server->clientfds), server->clientfds->length, SUS_SOCKET_POLL_TIMEOUT);
 	if (pollResult < 0) return pollResult == 0;
 	susVecForeachReverse(i, server->clients) {
-		SUS_LPSOCKET client = susVectorAt(server->clients, i);
-		LPWSAPOLLFD fd = susVectorAt(server->clientfds, i);
-		if (!fd->revents) continue;
-		susServerClientPoll(server, i, client, fd->revents);
+		SHORT revents = susPollFdVectorData(server->clientfds)[i].revents;
+		if (!revents) continue;
+		susServerClientPoll(server, i, susSocketVectorAt(server->clients, i), revents);
 	}
 	return TRUE;
 }
@@ -0,0 +1,451 @@
+// tree.c
+//
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_MAP
+#include "coreframe.h"
+#include "include/susfwk/core.h"
+#include "include/susfwk/memory.h"
+#include "include/susfwk/tree.h"
+
+// =======================================================================================
+
+// Get the minimum number of the keys in a node that is not the root
+#define susTreeMinCount(tree, node) (((node)->leaf ? (tree)->leafCapacity : (tree)->innerCapacity) / 2)
+// Check if the node is full
+#define susTreeIsFull(tree, node) ((node)->count == ((node)->leaf ? (tree)->leafCapacity : (tree)->innerCapacity))
+
+// Create a tree node
+static SUS_LPTREE_NODE SUSAPI susTreeNewNode(_In_ const SUS_LPTREE tree, _In_ BOOL leaf)
+{
+	SIZE_T size = leaf
+		? sizeof(SUS_TREE_NODE) + (SIZE_T)tree->leafCapacity * (tree->keySize + tree->valueSize)
+		: sizeof(SUS_TREE_NODE) + SUS_ALIGN((SIZE_T)tree->innerCapacity * tree->keySize, sizeof(SUS_LPTREE_NODE)) + ((SIZE_T)tree->innerCapacity + 1) * sizeof(SUS_LPTREE_NODE);
+	SUS_LPTREE_NODE node = sus_malloc(size);
+	if (!node) return NULL;
+	node->count = 0;
+	node->leaf = leaf;
+	node->prev = NULL;
+	node->next = NULL;
+	return node;
+}
+// Free the node with all its children
+static VOID SUSAPI susTreeFreeNode(_In_ const SUS_LPTREE tree, _In_ SUS_LPTREE_NODE node)
+{
+	if (!node->leaf) {
+		SUS_LPTREE_NODE* children = susTreeNodeChildren(tree, node);
+		for (DWORD i = 0; i <= node->count; i++) susTreeFreeNode(tree, children[i]);
+	}
+	sus_free(node);
+}
+
+// -------------------------------------------------------------------
+
+// Get the index of the first key of the node not less than the key
+static DWORD SUSAPI susTreeLowerIndex(_In_ const SUS_LPTREE tree, _In_ const SUS_LPTREE_NODE node, _In_ const SUS_OBJECT key)
+{
+	DWORD low = 0, high = node->count;
+	while (low < high) {
+		DWORD mid = low + (high - low) / 2;
+		if (tree->cmpKeys(susTreeNodeKey(tree, node, mid), key, tree->keySize) < 0) low = mid + 1;
+		else high = mid;
+	}
+	return low;
+}
+// Get the index of the first key of the node greater than the key (the index of the child that holds the key)
+static DWORD SUSAPI susTreeUpperIndex(_In_ const SUS_LPTREE tree, _In_ const SUS_LPTREE_NODE node, _In_ const SUS_OBJECT key)
+{
+	DWORD low = 0, high = node->count;
+	while (low < high) {
+		DWORD mid = low + (high - low) / 2;
+		if (tree->cmpKeys(susTreeNodeKey(tree, node, mid), key, tree->keySize) <= 0) low = mid + 1;
+		else high = mid;
+	}
+	return low;
+}
+// Find the leaf that holds the key
+static SUS_LPTREE_NODE SUSAPI susTreeFindLeaf(_In_ const SUS_LPTREE tree, _In_ const SUS_OBJECT key)
+{
+	SUS_LPTREE_NODE node = tree->root;
+	if (!node) return NULL;
+	while (!node->leaf) node = susTreeNodeChildren(tree, node)[susTreeUpperIndex(tree, node, key)];
+	return node;
+}
+
+// -------------------------------------------------------------------
+
+// Insert a key and a child to the inner node
+static VOID SUSAPI susTreeInnerInsert(_In_ const SUS_LPTREE tree, _Inout_ SUS_LPTREE_NODE node, _In_ DWORD index, _In_ const SUS_OBJECT key, _In_ SUS_LPTREE_NODE child)
+{
+	SUS_LPTREE_NODE* children = susTreeNodeChildren(tree, node);
+	sus_memmove(susTreeNodeKey(tree, node, index + 1), susTreeNodeKey(tree, node, index), (SIZE_T)(node->count - index) * tree->keySize);
+	sus_memmove(children + index + 2, children + index + 1, (SIZE_T)(node->count - index) * sizeof(SUS_LPTREE_NODE));
+	sus_memcpy(susTreeNodeKey(tree, node, index), key, tree->keySize);
+	children[index + 1] = child;
+	node->count++;
+}
+// Split the full child of the inner node in two halves (\return FALSE if there is not enough memory)
+static BOOL SUSAPI susTreeSplitChild(_In_ const SUS_LPTREE tree, _Inout_ SUS_LPTREE_NODE parent, _In_ DWORD index)
+{
+	SUS_LPTREE_NODE child = susTreeNodeChildren(tree, parent)[index];
+	SUS_LPTREE_NODE right = susTreeNewNode(tree, child->leaf);
+	if (!right) return FALSE;
+	DWORD mid = child->count / 2;
+	if (child->leaf) {
+		right->count = child->count - mid;
+		sus_memcpy(susTreeNodeKey(tree, right, 0), susTreeNodeKey(tree, child, mid), (SIZE_T)right->count * tree->keySize);
+		sus_memcpy(susTreeLeafValue(tree, right, 0), susTreeLeafValue(tree, child, mid), (SIZE_T)right->count * tree->valueSize);
+		child->count = mid;
+		right->prev = child;
+		right->next = child->next;
+		if (child->next) child->next->prev = right;
+		child->next = right;
+		// The first key of the right leaf separates the halves
+		susTreeInnerInsert(tree, parent, index, susTreeNodeKey(tree, right, 0), right);
+		return TRUE;
+	}
+	// The middle key goes up to the parent
+	right->count = child->count - mid - 1;
+	sus_memcpy(susTreeNodeKey(tree, right, 0), susTreeNodeKey(tree, child, mid + 1), (SIZE_T)right->count * tree->keySize);
+	sus_memcpy(susTreeNodeChildren(tree, right), susTreeNodeChildren(tree, child) + mid + 1, ((SIZE_T)right->count + 1) * sizeof(SUS_LPTREE_NODE));
+	child->count = mid;
+	susTreeInnerInsert(tree, parent, index, susTreeNodeKey(tree, child, mid), right);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Move the last pair of the left sibling to the node
+static VOID SUSAPI susTreeBorrowLeft(_In_ const SUS_LPTREE tree, _Inout_ SUS_LPTREE_NODE parent, _In_ DWORD index, _Inout_ SUS_LPTREE_NODE node, _Inout_ SUS_LPTREE_NODE left)
+{
+	if (node->leaf) {
+		sus_memmove(susTreeNodeKey(tree, node, 1), susTreeNodeKey(tree, node, 0), (SIZE_T)node->count * tree->keySize);
+		sus_memmove(susTreeLeafValue(tree, node, 1), susTreeLeafValue(tree, node, 0), (SIZE_T)node->count * tree->valueSize);
+		sus_memcpy(susTreeNodeKey(tree, node, 0), susTreeNodeKey(tree, left, left->count - 1), tree->keySize);
+		sus_memcpy(susTreeLeafValue(tree, node, 0), susTreeLeafValue(tree, left, left->count - 1), tree->valueSize);
+		sus_memcpy(susTreeNodeKey(tree, parent, index - 1), susTreeNodeKey(tree, node, 0), tree->keySize);
+	}
+	else {
+		SUS_LPTREE_NODE* children = susTreeNodeChildren(tree, node);
+		sus_memmove(susTreeNodeKey(tree, node, 1), susTreeNodeKey(tree, node, 0), (SIZE_T)node->count * tree->keySize);
+		sus_memmove(children + 1, children, ((SIZE_T)node->count + 1) * sizeof(SUS_LPTREE_NODE));
+		// The separator goes down and the last key of the sibling goes up
+		sus_memcpy(susTreeNodeKey(tree, node, 0), susTreeNodeKey(tree, parent, index - 1), tree->keySize);
+		children[0] = susTreeNodeChildren(tree, left)[left->count];
+		sus_memcpy(susTreeNodeKey(tree, parent, index - 1), susTreeNodeKey(tree, left, left->count - 1), tree->keySize);
+	}
+	left->count--;
+	node->count++;
+}
+// Move the first pair of the right sibling to the node
+static VOID SUSAPI susTreeBorrowRight(_In_ const SUS_LPTREE tree, _Inout_ SUS_LPTREE_NODE parent, _In_ DWORD index, _Inout_ SUS_LPTREE_NODE node, _Inout_ SUS_LPTREE_NODE right)
+{
+	if (node->leaf) {
+		sus_memcpy(susTreeNodeKey(tree, node, node->count), susTreeNodeKey(tree, right, 0), tree->keySize);
+		sus_memcpy(susTreeLeafValue(tree, node, node->count), susTreeLeafValue(tree, right, 0), tree->valueSize);
+		sus_memmove(susTreeNodeKey(tree, right, 0), susTreeNodeKey(tree, right, 1), (SIZE_T)(right->count - 1) * tree->keySize);
+		sus_memmove(susTreeLeafValue(tree, right, 0), susTreeLeafValue(tree, right, 1), (SIZE_T)(right->count - 1) * tree->valueSize);
+		sus_memcpy(susTreeNodeKey(tree, parent, index), susTreeNodeKey(tree, right, 0), tree->keySize);
+	}
+	else {
+		SUS_LPTREE_NODE* children = susTreeNodeChildren(tree, right);
+		// The separator goes down and the first key of the sibling goes up
+		sus_memcpy(susTreeNodeKey(tree, node, node->count), susTreeNodeKey(tree, parent, index), tree->keySize);
+		susTreeNodeChildren(tree, node)[node->count + 1] = children[0];
+		sus_memcpy(susTreeNodeKey(tree, parent, index), susTreeNodeKey(tree, right, 0), tree->keySize);
+		sus_memmove(susTreeNodeKey(tree, right, 0), susTreeNodeKey(tree, right, 1), (SIZE_T)(right->count - 1) * tree->keySize);
+		sus_memmove(children, children + 1, (SIZE_T)right->count * sizeof(SUS_LPTREE_NODE));
+	}
+	right->count--;
+	node->count++;
+}
+// Merge the child of the inner node with its right sibling
+static VOID SUSAPI susTreeMerge(_In_ const SUS_LPTREE tree, _Inout_ SUS_LPTREE_NODE parent, _In_ DWORD index)
+{
+	SUS_LPTREE_NODE* children = susTreeNodeChildren(tree, parent);
+	SUS_LPTREE_NODE left = children[index], right = children[index + 1];
+	if (left->leaf) {
+		sus_memcpy(susTreeNodeKey(tree, left, left->count), susTreeNodeKey(tree, right, 0), (SIZE_T)right->count * tree->keySize);
+		sus_memcpy(susTreeLeafValue(tree, left, left->count), susTreeLeafValue(tree, right, 0), (SIZE_T)right->count * tree->valueSize);
+		left->count += right->count;
+		left->next = right->next;
+		if (right->next) right->next->prev = left;
+	}
+	else {
+		// The separator goes down between the keys of the siblings
+		sus_memcpy(susTreeNodeKey(tree, left, left->count), susTreeNodeKey(tree, parent, index), tree->keySize);
+		sus_memcpy(susTreeNodeKey(tree, left, left->count + 1), susTreeNodeKey(tree, right, 0), (SIZE_T)right->count * tree->keySize);
+		sus_memcpy(susTreeNodeChildren(tree, left) + left->count + 1, susTreeNodeChildren(tree, right), ((SIZE_T)right->count + 1) * sizeof(SUS_LPTREE_NODE));
+		left->count += right->count + 1;
+	}
+	sus_memmove(susTreeNodeKey(tree, parent, index), susTreeNodeKey(tree, parent, index + 1), (SIZE_T)(parent->count - index - 1) * tree->keySize);
+	sus_memmove(children + index + 1, children + index + 2, (SIZE_T)(parent->count - index - 1) * sizeof(SUS_LPTREE_NODE));
+	parent->count--;
+	sus_free(right);
+}
+
+// =======================================================================================
+
+// Create an ordered map
+SUS_TREE SUSAPI susTreeSetupEx(_In_ SIZE_T keySize, _In_ SIZE_T valueSize, _In_opt_ SUS_TREE_CMP_CALLBACK cmpKeys)
+{
+	SUS_ASSERT(keySize);
+	SUS_TREE tree = {
+		.root = NULL,
+		.cmpKeys = cmpKeys ? cmpKeys : susDefTreeCmpKeys,
+		.keySize = (DWORD)keySize,
+		.valueSize = (DWORD)valueSize,
+		.count = 0,
+		.height = 0
+	};
+	SIZE_T space = SUS_TREE_NODE_SIZE - sizeof(SUS_TREE_NODE);
+	tree.leafCapacity = (DWORD)max(SUS_TREE_MIN_ORDER, space / (keySize + valueSize));
+	tree.innerCapacity = (DWORD)max(SUS_TREE_MIN_ORDER, (space - sizeof(SUS_LPTREE_NODE)) / (keySize + sizeof(SUS_LPTREE_NODE)));
+	return tree;
+}
+// Remove all the key-value pairs
+VOID SUSAPI susTreeCleanup(_Inout_ SUS_LPTREE tree)
+{
+	SUS_ASSERT(tree);
+	if (tree->root) susTreeFreeNode(tree, tree->root);
+	tree->root = NULL;
+	tree->count = 0;
+	tree->height = 0;
+}
+// Fill an empty tree from the strictly ascending keys
+BOOL SUSAPI susTreeBulkLoad(_Inout_ SUS_LPTREE tree, _In_reads_bytes_(count * tree->keySize) const SUS_OBJECT keys, _In_reads_bytes_opt_(count * tree->valueSize) const SUS_OBJECT values, _In_ DWORD count)
+{
+	SUS_ASSERT(tree && !tree->root && (keys || !count));
+	if (!count) return TRUE;
+	// The pairs are spread evenly, so every node is at least half full
+	DWORD nodeCount = (count + tree->leafCapacity - 1) / tree->leafCapacity;
+	SUS_LPTREE_NODE* nodes = sus_malloc((SIZE_T)nodeCount * sizeof(SUS_LPTREE_NODE));
+	if (!nodes) return FALSE;
+	SUS_LPTREE_NODE prev = NULL;
+	for (DWORD i = 0, offset = 0; i < nodeCount; i++) {
+		SUS_LPTREE_NODE leaf = susTreeNewNode(tree, TRUE);
+		if (!leaf) {
+			for (DWORD j = 0; j < i; j++) sus_free(nodes[j]);
+			sus_free(nodes);
+			return FALSE;
+		}
+		leaf->count = count / nodeCount + (i < count % nodeCount);
+		sus_memcpy(leaf->data, (LPBYTE)keys + (SIZE_T)offset * tree->keySize, (SIZE_T)leaf->count * tree->keySize);
+		if (values) sus_memcpy(susTreeLeafValue(tree, leaf, 0), (LPBYTE)values + (SIZE_T)offset * tree->valueSize, (SIZE_T)leaf->count * tree->valueSize);
+		else sus_zeromem(susTreeLeafValue(tree, leaf, 0), (SIZE_T)leaf->count * tree->valueSize);
+		leaf->prev = prev;
+		if (prev) prev->next = leaf;
+		prev = leaf;
+		nodes[i] = leaf;
+		offset += leaf->count;
+	}
+	DWORD height = 1;
+	while (nodeCount > 1) {
+		// The parents replace their children in the array, the separators are the first keys of the subtrees
+		DWORD parentCount = (nodeCount + tree->innerCapacity) / (tree->innerCapacity + 1);
+		for (DWORD i = 0, offset = 0; i < parentCount; i++) {
+			SUS_LPTREE_NODE parent = susTreeNewNode(tree, FALSE);
+			if (!parent) {
+				for (DWORD j = 0; j < i; j++) susTreeFreeNode(tree, nodes[j]);
+				for (DWORD j = offset; j < nodeCount; j++) susTreeFreeNode(tree, nodes[j]);
+				sus_free(nodes);
+				return FALSE;
+			}
+			DWORD childCount = nodeCount / parentCount + (i < nodeCount % parentCount);
+			SUS_LPTREE_NODE* children = susTreeNodeChildren(tree, parent);
+			sus_memcpy(children, nodes + offset, (SIZE_T)childCount * sizeof(SUS_LPTREE_NODE));
+			parent->count = childCount - 1;
+			for (DWORD j = 1; j < childCount; j++) {
+				SUS_LPTREE_NODE node = children[j];
+				while (!node->leaf) node = susTreeNodeChildren(tree, node)[0];
+				sus_memcpy(susTreeNodeKey(tree, parent, j - 1), susTreeNodeKey(tree, node, 0), tree->keySize);
+			}
+			nodes[i] = parent;
+			offset += childCount;
+		}
+		nodeCount = parentCount;
+		height++;
+	}
+	tree->root = nodes[0];
+	tree->count = count;
+	tree->height = height;
+	sus_free(nodes);
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Get the value by key
+SUS_OBJECT SUSAPI susTreeGet(_In_ const SUS_LPTREE tree, _In_bytecount_(tree->keySize) const SUS_OBJECT key)
+{
+	SUS_ASSERT(tree && key);
+	SUS_LPTREE_NODE leaf = susTreeFindLeaf(tree, key);
+	if (!leaf) return NULL;
+	DWORD index = susTreeLowerIndex(tree, leaf, key);
+	if (index < leaf->count && !tree->cmpKeys(susTreeNodeKey(tree, leaf, index), key, tree->keySize)) return susTreeLeafValue(tree, leaf, index);
+	return NULL;
+}
+// Add or change a value
+SUS_OBJECT SUSAPI susTreeInsert(_Inout_ SUS_LPTREE tree, _In_bytecount_(tree->keySize) const SUS_OBJECT key, _In_opt_bytecount_(tree->valueSize) const SUS_OBJECT value)
+{
+	SUS_ASSERT(tree && key);
+	if (!tree->root) {
+		tree->root = susTreeNewNode(tree, TRUE);
+		if (!tree->root) return NULL;
+		tree->height = 1;
+	}
+	// The full nodes are split on the way down, so a split never goes up
+	if (susTreeIsFull(tree, tree->root)) {
+		SUS_ASSERT(tree->height < SUS_TREE_MAX_HEIGHT);
+		SUS_LPTREE_NODE root = susTreeNewNode(tree, FALSE);
+		if (!root) return NULL;
+		susTreeNodeChildren(tree, root)[0] = tree->root;
+		if (!susTreeSplitChild(tree, root, 0)) {
+			sus_free(root);
+			return NULL;
+		}
+		tree->root = root;
+		tree->height++;
+	}
+	SUS_LPTREE_NODE node = tree->root;
+	while (!node->leaf) {
+		DWORD index = susTreeUpperIndex(tree, node, key);
+		if (susTreeIsFull(tree, susTreeNodeChildren(tree, node)[index])) {
+			if (!susTreeSplitChild(tree, node, index)) return NULL;
+			if (tree->cmpKeys(key, susTreeNodeKey(tree, node, index), tree->keySize) >= 0) index++;
+		}
+		node = susTreeNodeChildren(tree, node)[index];
+	}
+	DWORD index = susTreeLowerIndex(tree, node, key);
+	if (index >= node->count || tree->cmpKeys(susTreeNodeKey(tree, node, index), key, tree->keySize)) {
+		sus_memmove(susTreeNodeKey(tree, node, index + 1), susTreeNodeKey(tree, node, index), (SIZE_T)(node->count - index) * tree->keySize);
+		sus_memmove(susTreeLeafValue(tree, node, index + 1), susTreeLeafValue(tree, node, index), (SIZE_T)(node->count - index) * tree->valueSize);
+		sus_memcpy(susTreeNodeKey(tree, node, index), key, tree->keySize);
+		node->count++;
+		tree->count++;
+	}
+	SUS_OBJECT lpValue = susTreeLeafValue(tree, node, index);
+	if (value) sus_memcpy(lpValue, value, tree->valueSize);
+	else sus_zeromem(lpValue, tree->valueSize);
+	return lpValue;
+}
+// Delete a key-value pair
+BOOL SUSAPI susTreeRemove(_Inout_ SUS_LPTREE tree, _In_bytecount_(tree->keySize) const SUS_OBJECT key)
+{
+	SUS_ASSERT(tree && key);
+	if (!tree->root) return FALSE;
+	struct { SUS_LPTREE_NODE node; DWORD index; } path[SUS_TREE_MAX_HEIGHT];
+	DWORD depth = 0;
+	SUS_LPTREE_NODE node = tree->root;
+	while (!node->leaf) {
+		DWORD index = susTreeUpperIndex(tree, node, key);
+		path[depth].node = node;
+		path[depth++].index = index;
+		node = susTreeNodeChildren(tree, node)[index];
+	}
+	DWORD index = susTreeLowerIndex(tree, node, key);
+	if (index >= node->count || tree->cmpKeys(susTreeNodeKey(tree, node, index), key, tree->keySize)) return FALSE;
+	sus_memmove(susTreeNodeKey(tree, node, index), susTreeNodeKey(tree, node, index + 1), (SIZE_T)(node->count - index - 1) * tree->keySize);
+	sus_memmove(susTreeLeafValue(tree, node, index), susTreeLeafValue(tree, node, index + 1), (SIZE_T)(node->count - index - 1) * tree->valueSize);
+	node->count--;
+	tree->count--;
+	// The separators of the removed key stay valid, only the underloaded nodes are repaired
+	while (depth && node->count < susTreeMinCount(tree, node)) {
+		SUS_LPTREE_NODE parent = path[--depth].node;
+		DWORD child = path[depth].index;
+		SUS_LPTREE_NODE* children = susTreeNodeChildren(tree, parent);
+		SUS_LPTREE_NODE left = child ? children[child - 1] : NULL;
+		SUS_LPTREE_NODE right = child < parent->count ? children[child + 1] : NULL;
+		if (left && left->count > susTreeMinCount(tree, left)) susTreeBorrowLeft(tree, parent, child, node, left);
+		else if (right && right->count > susTreeMinCount(tree, right)) susTreeBorrowRight(tree, parent, child, node, right);
+		else susTreeMerge(tree, parent, left ? child - 1 : child);
+		node = parent;
+	}
+	if (!tree->root->count) {
+		SUS_LPTREE_NODE root = tree->root;
+		tree->root = root->leaf ? NULL : susTreeNodeChildren(tree, root)[0];
+		tree->height--;
+		sus_free(root);
+	}
+	return TRUE;
+}
+
+// -------------------------------------------------------------------
+
+// Get the cursor to the first pair
+SUS_TREE_CURSOR SUSAPI susTreeFirst(_In_ const SUS_LPTREE tree)
+{
+	SUS_ASSERT(tree);
+	SUS_TREE_CURSOR cursor = { .tree = tree, .node = tree->root, .index = 0 };
+	if (cursor.node) {
+		while (!cursor.node->leaf) cursor.node = susTreeNodeChildren(tree, cursor.node)[0];
+	}
+	return cursor;
+}
+// Get the cursor to the last pair
+SUS_TREE_CURSOR SUSAPI susTreeLast(_In_ const SUS_LPTREE tree)
+{
+	SUS_ASSERT(tree);
+	SUS_TREE_CURSOR cursor = { .tree = tree, .node = tree->root, .index = 0 };
+	if (cursor.node) {
+		while (!cursor.node->leaf) cursor.node = susTreeNodeChildren(tree, cursor.node)[cursor.node->count];
+		cursor.index = cursor.node->count - 1;
+	}
+	return cursor;
+}
+// Get the cursor to the first pair with the key not less than the key
+SUS_TREE_CURSOR SUSAPI susTreeLowerBound(_In_ const SUS_LPTREE tree, _In_bytecount_(tree->keySize) const SUS_OBJECT key)
+{
+	SUS_ASSERT(tree && key);
+	SUS_TREE_CURSOR cursor = { .tree = tree, .node = susTreeFindLeaf(tree, key), .index = 0 };
+	if (cursor.node) {
+		cursor.index = susTreeLowerIndex(tree, cursor.node, key);
+		if (cursor.index >= cursor.node->count) {
+			cursor.node = cursor.node->next;
+			cursor.index = 0;
+		}
+	}
+	return cursor;
+}
+// Get the cursor to the first pair with the key greater than the key
+SUS_TREE_CURSOR SUSAPI susTreeUpperBound(_In_ const SUS_LPTREE tree, _In_bytecount_(tree->keySize) const SUS_OBJECT key)
+{
+	SUS_ASSERT(tree && key);
+	SUS_TREE_CURSOR cursor = { .tree = tree, .node = susTreeFindLeaf(tree, key), .index = 0 };
+	if (cursor.node) {
+		cursor.index = susTreeUpperIndex(tree, cursor.node, key);
+		if (cursor.index >= cursor.node->count) {
+			cursor.node = cursor.node->next;
+			cursor.index = 0;
+		}
+	}
+	return cursor;
+}
+// Go to the next pair
+BOOL SUSAPI susTreeCursorNext(_Inout_ SUS_LPTREE_CURSOR cursor)
+{
+	SUS_ASSERT(cursor);
+	if (!cursor->node) return FALSE;
+	if (++cursor->index >= cursor->node->count) {
+		cursor->node = cursor->node->next;
+		cursor->index = 0;
+	}
+	return cursor->node != NULL;
+}
+// Go to the previous pair
+BOOL SUSAPI susTreeCursorPrev(_Inout_ SUS_LPTREE_CURSOR cursor)
+{
+	SUS_ASSERT(cursor);
+	if (!cursor->node) {
+		SUS_TREE_CURSOR last = susTreeLast(cursor->tree);
+		if (!last.node) return FALSE;
+		*cursor = last;
+		return TRUE;
+	}
+	if (cursor->index) {
+		cursor->index--;
+		return TRUE;
+	}
+	if (!cursor->node->prev) return FALSE;
+	cursor->node = cursor->node->prev;
+	cursor->index = cursor->node->count - 1;
+	return TRUE;
+}
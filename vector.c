@@ -1,5 +1,6 @@
 // vector.c
 //
+#define SUS_MEMORY_SUBSYSTEM SUS_MEMORY_TAG_VECTOR
 #include "coreframe.h"
 #include "include/susfwk/core.h"
 #include "include/susfwk/memory.h"
@@ -9,51 +10,108 @@
 
 // -------------------------------------
 
-// Create a new vector
-SUS_VECTOR SUSAPI susNewVectorEx(_In_ sus_size_t itemSize) {
+// Create a new vector in the allocator memory
+SUS_VECTOR SUSAPI susNewVectorAllocator(_In_ sus_size_t itemSize, _In_opt_ SUS_LPALLOCATOR allocator) {
 	SUS_PRINTDL("A new array of %d bytes is created", itemSize);
 	SUS_ASSERT(itemSize);
-	SUS_VECTOR vector = sus_malloc(sizeof(SUS_VECTOR_STRUCT) + SUS_VECTOR_CAPACITY * itemSize);
+	SUS_VECTOR vector = susAllocatorAlloc(allocator, sizeof(SUS_VECTOR_STRUCT) + SUS_VECTOR_CAPACITY * itemSize);
 	if (!vector) return NULL;
 	vector->itemSize = itemSize;
 	vector->length = 0;
 	vector->capacity = SUS_VECTOR_CAPACITY;
+	vector->allocator = allocator;
+	vector->policy = SUS_GROWTH_POLICY_FACTOR;
+	vector->underload = 0;
+	return vector;
+}
+// Create a new vector
+SUS_VECTOR SUSAPI susNewVectorEx(_In_ sus_size_t itemSize) {
+	return susNewVectorAllocator(itemSize, NULL);
+}
+// Create a new vector with the aligned data
+SUS_VECTOR SUSAPI susNewVectorAlignedEx(_In_ sus_size_t itemSize, _In_ SIZE_T alignment) {
+	SUS_LPALLOCATOR allocator = NULL;
+	if (alignment > MEMORY_ALLOCATION_ALIGNMENT) {
+		allocator = susAlignedAllocator(alignment, sizeof(SUS_VECTOR_STRUCT));
+		if (!allocator) return NULL;
+	}
+	return susNewVectorAllocator(itemSize, allocator);
+}
+// Create a new vector that grows in place inside a reserved region
+SUS_VECTOR SUSAPI susNewVectorRegionEx(_In_ sus_size_t itemSize, _In_ SIZE_T maxCount, _In_ SUS_VREGION_FLAGS flags) {
+	SUS_ASSERT(itemSize && maxCount);
+	// The growth step may overshoot the maximum, the reserve only costs address space
+	SUS_LPVREGION region = susNewVRegion(sizeof(SUS_VECTOR_STRUCT) + maxCount * itemSize * 2, flags);
+	if (!region) return NULL;
+	SUS_VECTOR vector = susNewVectorAllocator(itemSize, &region->super);
+	if (!vector) susVRegionDestroy(region);
 	return vector;
 }
 // Delete a vector
 VOID SUSAPI susVectorDestroy(_In_ SUS_VECTOR vector) {
 	SUS_PRINTDL("Deleting an array");
 	SUS_ASSERT(vector);
-	sus_free(vector);
+	susAllocatorFree(vector->allocator, vector, sizeof(SUS_VECTOR_STRUCT) + vector->capacity * vector->itemSize);
 }
-// Apply changes to the vector
-BOOL SUSAPI susVectorFlush(_Inout_ SUS_LPVECTOR lpVector) {
+// Change the capacity of the vector
+static BOOL SUSAPI susVectorResize(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t oldCapacity) {
 	SUS_ASSERT(lpVector && *lpVector);
-	SUS_VECTOR newVector = (SUS_VECTOR)sus_realloc(*lpVector, sizeof(SUS_VECTOR_STRUCT) + (*lpVector)->capacity * (*lpVector)->itemSize);
-	if (!newVector) return FALSE;
+	SUS_VECTOR vector = *lpVector;
+	SUS_VECTOR newVector = (SUS_VECTOR)susAllocatorRealloc(vector->allocator, vector,
+		sizeof(SUS_VECTOR_STRUCT) + oldCapacity * vector->itemSize,
+		sizeof(SUS_VECTOR_STRUCT) + vector->capacity * vector->itemSize
+	);
+	if (!newVector) {
+		vector->capacity = oldCapacity;
+		return FALSE;
+	}
 	*lpVector = newVector;
 	return TRUE;
 }
+// Apply changes to the vector
+BOOL SUSAPI susVectorFlush(_Inout_ SUS_LPVECTOR lpVector) {
+	SUS_ASSERT(lpVector && *lpVector);
+	return susVectorResize(lpVector, (*lpVector)->capacity);
+}
 
 // ---------------------------------------------------------------------------------------
 
-// Reserve elements in an array
-static BOOL SUSAPI susVectorReserve(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t reserve) {
+// Guarantee the space for the specified number of elements after the end of the array
+BOOL SUSAPI susVectorReserve(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t reserve) {
 	SUS_ASSERT(lpVector && *lpVector);
 	SUS_VECTOR vector = *lpVector;
+	if (reserve > SUS_CSIZE_MAX - vector->length) {
+		SUS_PRINTDE("The vector length exceeds the limit of sus_csize_t");
+		return FALSE;
+	}
 	if (vector->capacity < vector->length + reserve) {
-		vector->capacity = (sus_size32_t)((vector->length + reserve) * SUS_BUFFER_GROW_FACTOR);
-		return susVectorFlush(lpVector);
+		sus_csize_t oldCapacity = vector->capacity;
+		vector->capacity = susGrowthPolicyGrow(vector->policy, vector->length + reserve);
+		vector->underload = 0;
+		return susVectorResize(lpVector, oldCapacity);
 	}
 	return TRUE;
 }
-// Compress the array
-static BOOL SUSAPI susVectorCompress(_Inout_ SUS_LPVECTOR lpVector) {
+// Shrink the capacity of the vector to its length
+BOOL SUSAPI susVectorShrinkToFit(_Inout_ SUS_LPVECTOR lpVector) {
 	SUS_ASSERT(lpVector && *lpVector);
 	SUS_VECTOR vector = *lpVector;
-	if (vector->capacity > SUS_VECTOR_CAPACITY * SUS_BUFFER_GROW_FACTOR && vector->capacity > vector->length * SUS_BUFFER_SHRINK_THRESHOLD) {
-		vector->capacity = (sus_size32_t)((sus_float_t)vector->length * SUS_BUFFER_GROW_FACTOR);
-		return susVectorFlush(lpVector);
+	sus_csize_t capacity = max(vector->length, 1);
+	if (vector->capacity == capacity) return TRUE;
+	sus_csize_t oldCapacity = vector->capacity;
+	vector->capacity = capacity;
+	vector->underload = 0;
+	return susVectorResize(lpVector, oldCapacity);
+}
+// Compress the array according to its policy
+BOOL SUSAPI susVectorCompress(_Inout_ SUS_LPVECTOR lpVector) {
+	SUS_ASSERT(lpVector && *lpVector);
+	SUS_VECTOR vector = *lpVector;
+	sus_csize_t capacity = susGrowthPolicyShrink(vector->policy, vector->length, vector->capacity, SUS_VECTOR_CAPACITY, &vector->underload);
+	if (capacity < vector->capacity) {
+		sus_csize_t oldCapacity = vector->capacity;
+		vector->capacity = capacity;
+		return susVectorResize(lpVector, oldCapacity);
 	}
 	return TRUE;
 }
@@ -61,10 +119,10 @@ static BOOL SUSAPI susVectorCompress(_Inout_ SUS_LPVECTOR lpVector) {
 // -------------------------------------
 
 // Insert elements into an array
-SUS_LPMEMORY SUSAPI susVectorInsertArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_uint_t count)
+SUS_LPMEMORY SUSAPI susVectorInsertArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_csize_t count)
 {
 	SUS_PRINTDL("Inserting elements into the %d index", i);
-	SUS_ASSERT(lpVector && *lpVector && i < (*lpVector)->length);
+	SUS_ASSERT(lpVector && *lpVector && i <= (*lpVector)->length);
 	if (!susVectorReserve(lpVector, count)) return NULL;
 	SUS_VECTOR vector = *lpVector;
 	sus_size_t byteToMove = (sus_size_t)(vector->length - i) * vector->itemSize;
@@ -75,7 +133,7 @@ SUS_LPMEMORY SUSAPI susVectorInsertArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus
 	return vector->data + i * vector->itemSize;
 }
 // Set the value of the array elements
-SUS_LPMEMORY SUSAPI susVectorSetArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_uint_t count)
+SUS_LPMEMORY SUSAPI susVectorSetArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_csize_t count)
 {
 	SUS_PRINTDL("Setting the values of elements with %d indices", i);
 	SUS_ASSERT(lpVector && *lpVector && i + count <= (*lpVector)->length);
@@ -85,7 +143,7 @@ SUS_LPMEMORY SUSAPI susVectorSetArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_ui
 	return vector->data + i * vector->itemSize;
 }
 // Remove elements from an array
-BOOL SUSAPI susVectorEraseArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i, _In_ sus_uint_t count)
+BOOL SUSAPI susVectorEraseArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i, _In_ sus_csize_t count)
 {
 	SUS_PRINTDL("Deleting array elements from %d", i);
 	SUS_ASSERT(lpVector && *lpVector && i + count <= (*lpVector)->length);
@@ -96,7 +154,7 @@ BOOL SUSAPI susVectorEraseArray(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i
 	return susVectorCompress(lpVector);
 }
 // Swap the elements in the array
-BOOL SUSAPI susVectorSwap(_In_ SUS_VECTOR vector, _In_ sus_uint_t from, _In_ sus_uint_t to)
+BOOL SUSAPI susVectorSwap(_In_ SUS_VECTOR vector, _In_ sus_csize_t from, _In_ sus_csize_t to)
 {
 	SUS_PRINTDL("Replacing element %d with element %d",from, to);
 	SUS_ASSERT(vector && from < vector->length && to < vector->length);
@@ -111,33 +169,360 @@ BOOL SUSAPI susVectorSwap(_In_ SUS_VECTOR vector, _In_ sus_uint_t from, _In_ sus
 	return TRUE;
 }
 // Swap places and delete
-BOOL SUSAPI susVectorSwapErase(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_uint_t i) {
+BOOL SUSAPI susVectorSwapErase(_Inout_ SUS_LPVECTOR lpVector, _In_ sus_csize_t i) {
 	SUS_ASSERT(lpVector && *lpVector);
 	if (!susVectorSwap(*lpVector, i, (*lpVector)->length - 1)) return FALSE;
 	return susVectorPop(lpVector) ? TRUE : FALSE;
 }
 
 // Default item search function
-static BOOL SUSAPI susVectorDefIndexOfFunc(_In_ SUS_VECTOR vector, _In_ sus_uint_t current, _In_ SUS_OBJECT target) {
+static BOOL SUSAPI susVectorDefIndexOfFunc(_In_ SUS_VECTOR vector, _In_ sus_csize_t current, _In_ SUS_OBJECT target) {
 	return sus_memcmp(susVectorAt(vector, current), target, vector->itemSize);
 }
 // Find an element in an array starting from the beginning
-sus_int_t SUSAPI susVectorIndexOf(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_opt_ SUS_VECTOR_INDEXOF_FUNC func) {
+sus_csize_t SUSAPI susVectorIndexOf(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_opt_ SUS_VECTOR_INDEXOF_FUNC func) {
 	SUS_ASSERT(vector && value);
+	if (!func && sus_memfindable(vector->itemSize)) {
+		SIZE_T i = sus_memfind(vector->data, vector->length, value, vector->itemSize);
+		return i != (SIZE_T)-1 ? (sus_csize_t)i : SUS_CSIZE_MAX;
+	}
 	if (!func) func = susVectorDefIndexOfFunc;
 	susVecForeach(i, vector) {
 		if (func(vector, i, value)) return i;
 	}
-	return -1;
+	return SUS_CSIZE_MAX;
 }
 // Find an array element starting from the end
-sus_int_t SUSAPI susVectorLastIndexOf(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_opt_ SUS_VECTOR_INDEXOF_FUNC func) {
+sus_csize_t SUSAPI susVectorLastIndexOf(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_opt_ SUS_VECTOR_INDEXOF_FUNC func) {
 	SUS_ASSERT(vector && value);
 	if (!func) func = susVectorDefIndexOfFunc;
 	susVecForeachReverse(i, vector) {
 		if (func(vector, i, value)) return i;
 	}
-	return -1;
+	return SUS_CSIZE_MAX;
+}
+
+// -------------------------------------
+
+// Swap two elements of the array
+SUS_INLINE VOID SUSAPI susVectorSwapItems(_Inout_ sus_lpbyte_t a, _Inout_ sus_lpbyte_t b, _In_ sus_size_t size) {
+	for (sus_size_t i = 0; i < size; i++) {
+		sus_byte_t tmp = a[i];
+		a[i] = b[i];
+		b[i] = tmp;
+	}
+}
+// Restore the heap property starting from the root
+static VOID SUSAPI susVectorSiftDown(_Inout_ sus_lpbyte_t data, _In_ sus_size_t size, _In_ sus_csize_t root, _In_ sus_csize_t count, _In_ SUS_VECTOR_COMPARE_FUNC cmp) {
+	for (sus_csize_t child; (child = root * 2 + 1) < count; root = child) {
+		if (child + 1 < count && cmp(data + child * size, data + (child + 1) * size) < 0) child++;
+		if (cmp(data + root * size, data + child * size) >= 0) return;
+		susVectorSwapItems(data + root * size, data + child * size, size);
+	}
+}
+// Sort a part of the array by inserts
+static VOID SUSAPI susVectorInsertionSort(_Inout_ sus_lpbyte_t data, _In_ sus_size_t size, _In_ sus_csize_t count, _In_ SUS_VECTOR_COMPARE_FUNC cmp) {
+	for (sus_csize_t i = 1; i < count; i++) {
+		for (sus_csize_t j = i; j && cmp(data + (j - 1) * size, data + j * size) > 0; j--) {
+			susVectorSwapItems(data + (j - 1) * size, data + j * size, size);
+		}
+	}
+}
+// Sort a part of the array (introsort)
+static VOID SUSAPI susVectorSortRange(_Inout_ sus_lpbyte_t data, _In_ sus_size_t size, _In_ sus_csize_t count, _In_ sus_csize_t depth, _In_ SUS_VECTOR_COMPARE_FUNC cmp)
+{
+	while (count > SUS_VECTOR_INSERTION_SORT_THRESHOLD) {
+		if (!depth--) {
+			// Too many bad pivots - finish with the heap sort
+			for (sus_csize_t i = count / 2; i--;) susVectorSiftDown(data, size, i, count, cmp);
+			for (sus_csize_t i = count; --i;) {
+				susVectorSwapItems(data, data + i * size, size);
+				susVectorSiftDown(data, size, 0, i, cmp);
+			}
+			return;
+		}
+		// The median of three goes to the beginning, the last element stops the left scan
+		sus_lpbyte_t mid = data + (count / 2) * size, hi = data + (count - 1) * size;
+		if (cmp(mid, data) < 0) susVectorSwapItems(mid, data, size);
+		if (cmp(hi, mid) < 0) {
+			susVectorSwapItems(hi, mid, size);
+			if (cmp(mid, data) < 0) susVectorSwapItems(mid, data, size);
+		}
+		susVectorSwapItems(mid, data, size);
+		sus_lpbyte_t i = data + size, j = hi;
+		for (;;) {
+			while (cmp(i, data) < 0) i += size;
+			while (cmp(data, j) < 0) j -= size;
+			if (i >= j) break;
+			susVectorSwapItems(i, j, size);
+			i += size;
+			j -= size;
+		}
+		susVectorSwapItems(data, j, size);
+		// Recursion into the smaller part, the loop continues with the larger one
+		sus_csize_t left = (sus_csize_t)((j - data) / size), right = count - left - 1;
+		if (left < right) {
+			susVectorSortRange(data, size, left, depth, cmp);
+			data = j + size;
+			count = right;
+		}
+		else {
+			susVectorSortRange(j + size, size, right, depth, cmp);
+			count = left;
+		}
+	}
+	susVectorInsertionSort(data, size, count, cmp);
+}
+// Sort the array
+VOID SUSAPI susVectorSort(_Inout_ SUS_VECTOR vector, _In_ SUS_VECTOR_COMPARE_FUNC cmp) {
+	SUS_PRINTDL("Sorting an array");
+	SUS_ASSERT(vector && cmp);
+	susVectorSortRange(vector->data, vector->itemSize, vector->length, susVectorSortDepth(vector->length), cmp);
+}
+// Sort the array keeping the order of the equal elements
+BOOL SUSAPI susVectorStableSort(_Inout_ SUS_VECTOR vector, _In_ SUS_VECTOR_COMPARE_FUNC cmp)
+{
+	SUS_PRINTDL("Stable sorting an array");
+	SUS_ASSERT(vector && cmp);
+	sus_size_t size = vector->itemSize;
+	sus_csize_t count = vector->length;
+	for (sus_csize_t i = 0; i < count; i += SUS_VECTOR_INSERTION_SORT_THRESHOLD) {
+		susVectorInsertionSort(vector->data + i * size, size, min(SUS_VECTOR_INSERTION_SORT_THRESHOLD, count - i), cmp);
+	}
+	if (count <= SUS_VECTOR_INSERTION_SORT_THRESHOLD) return TRUE;
+	sus_lpbyte_t buffer = sus_malloc(count * size);
+	if (!buffer) return FALSE;
+	// Merging the runs back and forth between the array and the buffer
+	sus_lpbyte_t src = vector->data, dst = buffer;
+	for (sus_csize_t width = SUS_VECTOR_INSERTION_SORT_THRESHOLD; width < count; width *= 2) {
+		for (sus_csize_t lo = 0; lo < count; lo += width * 2) {
+			sus_csize_t mid = min(lo + width, count), hi = min(lo + width * 2, count);
+			sus_csize_t a = lo, b = mid, k = lo;
+			while (a < mid && b < hi) {
+				if (cmp(src + b * size, src + a * size) < 0) sus_memcpy(dst + (k++) * size, src + (b++) * size, size);
+				else sus_memcpy(dst + (k++) * size, src + (a++) * size, size);
+			}
+			if (a < mid) sus_memcpy(dst + k * size, src + a * size, (mid - a) * size);
+			if (b < hi) sus_memcpy(dst + k * size, src + b * size, (hi - b) * size);
+		}
+		sus_lpbyte_t tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	if (src != vector->data) sus_memcpy(vector->data, src, count * size);
+	sus_free(buffer);
+	return TRUE;
+}
+
+// -------------------------------------
+
+// Number of bits sorted in one radix pass
+#define SUS_VECTOR_RADIX_BITS 8
+// Number of radix buckets
+#define SUS_VECTOR_RADIX_SIZE (1 << SUS_VECTOR_RADIX_BITS)
+
+// Count the key digits for all the passes
+static VOID SUSAPI susVectorRadixHistogram(_Out_ sus_csize_t (*histogram)[SUS_VECTOR_RADIX_SIZE], _In_ sus_uint_t passes, _In_ sus_u64_t key) {
+	for (sus_uint_t pass = 0; pass < passes; pass++, key >>= SUS_VECTOR_RADIX_BITS) histogram[pass][key & (SUS_VECTOR_RADIX_SIZE - 1)]++;
+}
+// Turn the digit counters into the bucket offsets (\return FALSE if all the keys have the same digit)
+static BOOL SUSAPI susVectorRadixOffsets(_Inout_ sus_csize_t* counters, _In_ sus_csize_t count) {
+	sus_csize_t offset = 0;
+	for (sus_uint_t i = 0; i < SUS_VECTOR_RADIX_SIZE; i++) {
+		if (counters[i] == count) return FALSE;
+		sus_csize_t digits = counters[i];
+		counters[i] = offset;
+		offset += digits;
+	}
+	return TRUE;
+}
+// Sort the unsigned numbers by the radix
+static BOOL SUSAPI susVectorRadixSortNumbers(_Inout_ SUS_VECTOR vector, _In_ sus_uint_t passes)
+{
+	SUS_ASSERT(vector && vector->itemSize == passes * SUS_VECTOR_RADIX_BITS / 8);
+	sus_csize_t count = vector->length;
+	if (count < 2) return TRUE;
+	sus_csize_t histogram[8][SUS_VECTOR_RADIX_SIZE] = { 0 };
+	for (sus_csize_t i = 0; i < count; i++) {
+		susVectorRadixHistogram(histogram, passes, passes == 4 ? ((sus_u32_t*)vector->data)[i] : ((sus_u64_t*)vector->data)[i]);
+	}
+	sus_lpbyte_t buffer = sus_malloc(count * vector->itemSize);
+	if (!buffer) return FALSE;
+	sus_lpbyte_t src = vector->data, dst = buffer;
+	for (sus_uint_t pass = 0; pass < passes; pass++) {
+		if (!susVectorRadixOffsets(histogram[pass], count)) continue;
+		sus_uint_t shift = pass * SUS_VECTOR_RADIX_BITS;
+		if (passes == 4) for (sus_csize_t i = 0; i < count; i++) {
+			sus_u32_t key = ((sus_u32_t*)src)[i];
+			((sus_u32_t*)dst)[histogram[pass][(key >> shift) & (SUS_VECTOR_RADIX_SIZE - 1)]++] = key;
+		}
+		else for (sus_csize_t i = 0; i < count; i++) {
+			sus_u64_t key = ((sus_u64_t*)src)[i];
+			((sus_u64_t*)dst)[histogram[pass][(key >> shift) & (SUS_VECTOR_RADIX_SIZE - 1)]++] = key;
+		}
+		sus_lpbyte_t tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	if (src != vector->data) sus_memcpy(vector->data, src, count * vector->itemSize);
+	sus_free(buffer);
+	return TRUE;
+}
+// Sort an array of sus_u32_t
+BOOL SUSAPI susVectorRadixSort32(_Inout_ SUS_VECTOR vector) {
+	SUS_PRINTDL("Radix sorting an array of numbers");
+	return susVectorRadixSortNumbers(vector, sizeof(sus_u32_t));
+}
+// Sort an array of sus_u64_t
+BOOL SUSAPI susVectorRadixSort64(_Inout_ SUS_VECTOR vector) {
+	SUS_PRINTDL("Radix sorting an array of numbers");
+	return susVectorRadixSortNumbers(vector, sizeof(sus_u64_t));
+}
+// Sort the array by the element keys
+BOOL SUSAPI susVectorRadixSortBy(_Inout_ SUS_VECTOR vector, _In_ SUS_VECTOR_KEY_FUNC key)
+{
+	SUS_PRINTDL("Radix sorting an array by the keys");
+	SUS_ASSERT(vector && key);
+	sus_csize_t count = vector->length;
+	if (count < 2) return TRUE;
+	sus_size_t size = vector->itemSize;
+	// The keys and the elements are moved together, the key function is called once per element
+	sus_lpbyte_t buffer = sus_malloc(count * (sizeof(sus_u64_t) * 2 + size));
+	if (!buffer) return FALSE;
+	sus_u64_t* keys = (sus_u64_t*)buffer;
+	sus_u64_t* keysTmp = keys + count;
+	sus_lpbyte_t src = vector->data, dst = (sus_lpbyte_t)(keysTmp + count);
+	sus_csize_t histogram[8][SUS_VECTOR_RADIX_SIZE] = { 0 };
+	for (sus_csize_t i = 0; i < count; i++) {
+		keys[i] = key(src + i * size);
+		susVectorRadixHistogram(histogram, 8, keys[i]);
+	}
+	for (sus_uint_t pass = 0; pass < 8; pass++) {
+		if (!susVectorRadixOffsets(histogram[pass], count)) continue;
+		sus_uint_t shift = pass * SUS_VECTOR_RADIX_BITS;
+		for (sus_csize_t i = 0; i < count; i++) {
+			sus_csize_t j = histogram[pass][(keys[i] >> shift) & (SUS_VECTOR_RADIX_SIZE - 1)]++;
+			keysTmp[j] = keys[i];
+			sus_memcpy(dst + j * size, src + i * size, size);
+		}
+		sus_u64_t* tmpKeys = keys;
+		keys = keysTmp;
+		keysTmp = tmpKeys;
+		sus_lpbyte_t tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	if (src != vector->data) sus_memcpy(vector->data, src, count * size);
+	sus_free(buffer);
+	return TRUE;
+}
+
+// -------------------------------------
+
+// Find the first element that is not less than the value in a sorted array
+sus_csize_t SUSAPI susVectorLowerBound(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_ SUS_VECTOR_COMPARE_FUNC cmp) {
+	SUS_ASSERT(vector && value && cmp);
+	sus_csize_t first = 0, count = vector->length;
+	while (count) {
+		sus_csize_t half = count / 2;
+		if (cmp(susVectorAt(vector, first + half), value) < 0) {
+			first += half + 1;
+			count -= half + 1;
+		}
+		else count = half;
+	}
+	return first;
+}
+// Find the first element that is greater than the value in a sorted array
+sus_csize_t SUSAPI susVectorUpperBound(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_ SUS_VECTOR_COMPARE_FUNC cmp) {
+	SUS_ASSERT(vector && value && cmp);
+	sus_csize_t first = 0, count = vector->length;
+	while (count) {
+		sus_csize_t half = count / 2;
+		if (cmp(susVectorAt(vector, first + half), value) <= 0) {
+			first += half + 1;
+			count -= half + 1;
+		}
+		else count = half;
+	}
+	return first;
+}
+// Find an element in a sorted array
+sus_csize_t SUSAPI susVectorBinarySearch(_In_ SUS_VECTOR vector, _In_ SUS_LPMEMORY value, _In_ SUS_VECTOR_COMPARE_FUNC cmp) {
+	sus_csize_t i = susVectorLowerBound(vector, value, cmp);
+	return i < vector->length && !cmp(susVectorAt(vector, i), value) ? i : SUS_CSIZE_MAX;
+}
+
+// -------------------------------------
+
+// Guarantee the space for the specified number of elements after the end of the array
+BOOL SUSAPI susSmallVectorReserve(_Inout_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t reserve)
+{
+	SUS_ASSERT(vector);
+	if (vector->length + reserve <= vector->capacity) return TRUE;
+	sus_uint_t capacity = max(susGrowthPolicyGrow(SUS_GROWTH_POLICY_FACTOR, vector->length + reserve), SUS_VECTOR_CAPACITY);
+	sus_lpbyte_t heap = vector->heap
+		? susAllocatorRealloc(vector->allocator, vector->heap, (SIZE_T)vector->capacity * vector->itemSize, (SIZE_T)capacity * vector->itemSize)
+		: susAllocatorAlloc(vector->allocator, (SIZE_T)capacity * vector->itemSize);
+	if (!heap) return FALSE;
+	if (!vector->heap && vector->length) sus_memcpy(heap, (sus_lpbyte_t)vector + vector->inlineOffset, (SIZE_T)vector->length * vector->itemSize);
+	vector->heap = heap;
+	vector->capacity = capacity;
+	return TRUE;
+}
+// Shrink the capacity of the vector to its length
+BOOL SUSAPI susSmallVectorShrinkToFit(_Inout_ SUS_SMALL_VECTOR vector)
+{
+	SUS_ASSERT(vector);
+	if (!vector->heap || vector->capacity == vector->length) return TRUE;
+	if (vector->length <= vector->inlineCapacity) {
+		if (vector->length) sus_memcpy((sus_lpbyte_t)vector + vector->inlineOffset, vector->heap, (SIZE_T)vector->length * vector->itemSize);
+		susAllocatorFree(vector->allocator, vector->heap, (SIZE_T)vector->capacity * vector->itemSize);
+		vector->heap = NULL;
+		vector->capacity = vector->inlineCapacity;
+		return TRUE;
+	}
+	sus_lpbyte_t heap = susAllocatorRealloc(vector->allocator, vector->heap, (SIZE_T)vector->capacity * vector->itemSize, (SIZE_T)vector->length * vector->itemSize);
+	if (!heap) return FALSE;
+	vector->heap = heap;
+	vector->capacity = vector->length;
+	return TRUE;
+}
+// Insert elements into an array
+SUS_LPMEMORY SUSAPI susSmallVectorInsertArray(_Inout_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t i, _In_opt_ SUS_LPMEMORY data, _In_ sus_uint_t count)
+{
+	SUS_ASSERT(vector && i <= vector->length);
+	if (!susSmallVectorReserve(vector, count)) return NULL;
+	sus_lpbyte_t item = susSmallVectorAt(vector, i);
+	SIZE_T byteToMove = (SIZE_T)(vector->length - i) * vector->itemSize;
+	if (byteToMove) sus_memmove(item + (SIZE_T)count * vector->itemSize, item, byteToMove);
+	if (data) sus_memcpy(item, data, (SIZE_T)count * vector->itemSize);
+	else sus_zeromem(item, (SIZE_T)count * vector->itemSize);
+	vector->length += count;
+	return item;
+}
+// Remove elements from an array
+VOID SUSAPI susSmallVectorEraseArray(_Inout_ SUS_SMALL_VECTOR vector, _In_ sus_uint_t i, _In_ sus_uint_t count)
+{
+	SUS_ASSERT(vector && i + count <= vector->length);
+	sus_lpbyte_t item = susSmallVectorAt(vector, i);
+	SIZE_T byteToMove = (SIZE_T)(vector->length - i - count) * vector->itemSize;
+	if (byteToMove) sus_memmove(item, item + (SIZE_T)count * vector->itemSize, byteToMove);
+	vector->length -= count;
+}
+// Find an element in an array
+sus_csize_t SUSAPI susSmallVectorIndexOf(_In_ SUS_SMALL_VECTOR vector, _In_ SUS_LPMEMORY value)
+{
+	SUS_ASSERT(vector && value);
+	sus_lpbyte_t data = susSmallVectorData(vector);
+	if (sus_memfindable(vector->itemSize)) {
+		SIZE_T i = sus_memfind(data, vector->length, value, vector->itemSize);
+		return i != (SIZE_T)-1 ? (sus_csize_t)i : SUS_CSIZE_MAX;
+	}
+	susSmallVectorForeach(i, vector) {
+		if (sus_memcmp(data + (SIZE_T)i * vector->itemSize, value, vector->itemSize)) return i;
+	}
+	return SUS_CSIZE_MAX;
 }
 
 // -------------------------------------